@@ -0,0 +1,284 @@
+/**
+ * @file blocktransfer.h
+ * @brief Deklaracja klasy BlockTransfer — przesyłania bloków danych (konfiguracji) do i z urządzenia.
+ *
+ * Pojedyncze polecenia (ramka 0xB5, SerialReader::sendData()) przenoszą jedną wartość float.
+ * Większe dane (harmonogramy nastaw, tablice, kalibracja) przesyłane są jako transfer podzielony
+ * na bloki z numerami sekwencyjnymi i sumą CRC-16 każdego bloku. Nadawca utrzymuje okno
+ * niepotwierdzonych bloków (Go-Back-N z potwierdzeniami skumulowanymi), więc łącze jest zajęte
+ * również wtedy, gdy potwierdzenia są w drodze. Ramki urządzenia (0xA7) przeplatają się z ramkami
+ * telemetrii i są wydzielane przez FrameDecoder; na czas transferu urządzenie wysyła telemetrię
+ * rzadziej (dzielnik w bloku otwarcia). Format ramek: blocktransfer.cpp.
+ *
+ * Klasa realizuje stronę hosta i nie zależy od Qt ani od portu — bajty do wysłania dopisuje
+ * do przekazanego bufora, a czas dostaje z zewnątrz (SerialReader, tools/wds_block_transfer_sim).
+ * Nie jest bezpieczna wątkowo.
+ */
+
+#ifndef BLOCKTRANSFER_H
+#define BLOCKTRANSFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @enum BlockOp
+ * @brief Kod operacji ramki transferu blokowego.
+ */
+enum BlockOp : uint8_t {
+    BlockOpenWrite = 0x01, ///< Host: otwarcie zapisu (blok 0).
+    BlockOpenRead = 0x02,  ///< Host: otwarcie odczytu (blok 0).
+    BlockData = 0x03,      ///< Blok danych (host przy zapisie, urządzenie przy odczycie).
+    BlockAck = 0x04,       ///< Potwierdzenie skumulowane: numer następnego oczekiwanego bloku.
+    BlockDone = 0x05,      ///< Urządzenie: koniec transferu (status i CRC-32 całych danych).
+    BlockAbort = 0x06,     ///< Host: przerwanie transferu.
+    BlockError = 0x07      ///< Urządzenie: odrzucenie transferu (status).
+};
+
+/**
+ * @struct BlockFrame
+ * @brief Sparsowana ramka transferu blokowego.
+ */
+struct BlockFrame {
+    uint8_t op = 0;               ///< Kod operacji (BlockOp).
+    uint8_t transfer = 0;         ///< Identyfikator transferu.
+    uint16_t seq = 0;             ///< Numer bloku (dla BlockAck — następny oczekiwany).
+    std::vector<uint8_t> payload; ///< Dane bloku.
+};
+
+/**
+ * @struct BlockTransferOptions
+ * @brief Parametry transferu.
+ */
+struct BlockTransferOptions {
+    int blockSize = 128;            ///< Rozmiar danych w bloku [bajty], 1..maxPayload.
+    int window = 8;                 ///< Liczba niepotwierdzonych bloków w drodze, 1..64.
+    int telemetryDivider = 10;      ///< Urządzenie wysyła co n-tą ramkę telemetrii podczas transferu.
+    int timeoutMs = 0;              ///< Czas bez postępu do retransmisji (0 = z przepustowości łącza).
+    int maxRetries = 8;             ///< Kolejne retransmisje bez postępu, po których transfer jest przerywany.
+    double linkBytesPerSecond = 0.0; ///< Przepustowość łącza (prędkość / 10) do wyznaczenia czasu oczekiwania.
+};
+
+/**
+ * @struct BlockTransferStats
+ * @brief Liczniki transferu.
+ */
+struct BlockTransferStats {
+    uint64_t payloadBytes = 0;  ///< Bajty danych przesłane z potwierdzeniem.
+    uint64_t wireBytesSent = 0; ///< Bajty wysłane przez hosta (z nagłówkami i retransmisjami).
+    uint64_t blocksSent = 0;    ///< Wysłane ramki (z retransmisjami).
+    uint64_t retransmits = 0;   ///< Ramki wysłane ponownie.
+    uint64_t timeouts = 0;      ///< Upływy czasu oczekiwania.
+    int64_t startNs = 0;        ///< Początek transferu [ns].
+    int64_t endNs = 0;          ///< Koniec transferu [ns] (0 = trwa).
+
+    /**
+     * @brief Przepustowość danych [B/s] (do bieżącej chwili, jeśli transfer trwa).
+     */
+    double throughput(int64_t nowNs) const;
+};
+
+/**
+ * @class BlockTransfer
+ * @brief Strona hosta protokołu transferu blokowego (zapis i odczyt obszarów urządzenia).
+ */
+class BlockTransfer
+{
+public:
+    static constexpr uint8_t hostStartByte = 0xB6;   ///< Bajt startu ramek hosta.
+    static constexpr uint8_t deviceStartByte = 0xA7; ///< Bajt startu ramek urządzenia.
+    static constexpr int headerSize = 6;             ///< Start, operacja, transfer, numer (2), długość.
+    static constexpr int overhead = headerSize + 2;  ///< Nagłówek i CRC-16.
+    static constexpr int maxPayload = 240;           ///< Największa długość danych w ramce.
+    static constexpr int maxBlocks = 65534;          ///< Największa liczba bloków danych w transferze.
+
+    /**
+     * @enum State
+     * @brief Stan transferu.
+     */
+    enum class State {
+        Idle,      ///< Brak transferu.
+        Running,   ///< Przesyłanie bloków.
+        Finishing, ///< Wszystkie bloki potwierdzone, oczekiwanie na BlockDone.
+        Done,      ///< Zakończony poprawnie.
+        Failed     ///< Przerwany (error()).
+    };
+
+    /**
+     * @brief Rozpoczyna zapis danych do obszaru urządzenia.
+     * @param region Identyfikator obszaru (znaczenie ustala oprogramowanie urządzenia).
+     * @param data Dane.
+     * @param options Parametry transferu.
+     * @param nowNs Bieżący czas [ns, zegar monotoniczny].
+     * @param out Bufor, do którego dopisywane są bajty do wysłania.
+     * @return false, jeśli transfer trwa lub parametry są niepoprawne (error()).
+     */
+    bool startUpload(uint8_t region, std::vector<uint8_t> data, const BlockTransferOptions &options,
+                     int64_t nowNs, std::string &out);
+
+    /**
+     * @brief Rozpoczyna odczyt fragmentu obszaru urządzenia.
+     * @param region Identyfikator obszaru.
+     * @param offset Przesunięcie w obszarze [bajty].
+     * @param size Liczba bajtów do odczytu.
+     * @param options Parametry transferu (okno ogranicza urządzenie).
+     * @param nowNs Bieżący czas [ns].
+     * @param out Bufor bajtów do wysłania.
+     * @return false, jeśli transfer trwa lub parametry są niepoprawne (error()).
+     */
+    bool startDownload(uint8_t region, uint32_t offset, uint32_t size, const BlockTransferOptions &options,
+                       int64_t nowNs, std::string &out);
+
+    /**
+     * @brief Obsługuje ramkę urządzenia (ramki innych transferów są pomijane).
+     * @param frame Ramka wydzielona przez FrameDecoder.
+     * @param nowNs Bieżący czas [ns].
+     * @param out Bufor bajtów do wysłania.
+     */
+    void handleFrame(const BlockFrame &frame, int64_t nowNs, std::string &out);
+
+    /**
+     * @brief Sprawdza czas oczekiwania i w razie potrzeby ponawia bloki od ostatniego potwierdzonego.
+     * @param nowNs Bieżący czas [ns].
+     * @param out Bufor bajtów do wysłania.
+     */
+    void poll(int64_t nowNs, std::string &out);
+
+    /**
+     * @brief Przerywa trwający transfer (wysyła BlockAbort).
+     * @param nowNs Bieżący czas [ns].
+     * @param out Bufor bajtów do wysłania.
+     * @param reason Opis błędu zwracany przez error().
+     */
+    void abort(int64_t nowNs, std::string &out, const std::string &reason = "Transfer przerwany");
+
+    /**
+     * @brief Czy transfer trwa.
+     */
+    bool isActive() const { return phase == State::Running || phase == State::Finishing; }
+
+    /**
+     * @brief Zwraca stan transferu.
+     */
+    State state() const { return phase; }
+
+    /**
+     * @brief Czy trwający lub ostatni transfer jest zapisem.
+     */
+    bool isUpload() const { return upload; }
+
+    /**
+     * @brief Opis błędu (stan Failed).
+     */
+    const std::string &error() const { return message; }
+
+    /**
+     * @brief Dane zapisywane lub odczytane.
+     */
+    const std::vector<uint8_t> &data() const { return bytes; }
+
+    /**
+     * @brief Liczba bajtów danych potwierdzonych (zapis) lub odebranych (odczyt).
+     */
+    size_t bytesDone() const;
+
+    /**
+     * @brief Całkowita liczba bajtów danych transferu.
+     */
+    size_t bytesTotal() const { return total; }
+
+    /**
+     * @brief Zwraca liczniki ostatniego transferu.
+     */
+    const BlockTransferStats &stats() const { return counters; }
+
+    /**
+     * @brief Składa ramkę transferu blokowego.
+     * @param start Bajt startu (hostStartByte lub deviceStartByte).
+     * @param op Kod operacji.
+     * @param transfer Identyfikator transferu.
+     * @param seq Numer bloku.
+     * @param payload Dane (najwyżej maxPayload bajtów).
+     * @param size Długość danych.
+     * @param out Bufor, do którego dopisywana jest ramka.
+     */
+    static void encode(uint8_t start, uint8_t op, uint8_t transfer, uint16_t seq, const uint8_t *payload, int size,
+                       std::string &out);
+
+    /**
+     * @brief Zwraca długość ramki zaczynającej się w buforze.
+     * @param bytes Początek ramki (bajt startu).
+     * @param available Liczba dostępnych bajtów.
+     * @return Długość ramki, 0 jeśli nagłówek jest niepełny, -1 jeśli nagłówek jest niepoprawny.
+     */
+    static int frameLength(const char *bytes, int available);
+
+    /**
+     * @brief Weryfikuje CRC i parsuje ramkę.
+     * @param frame Początek ramki.
+     * @param size Długość ramki (frameLength()).
+     * @param out Sparsowana ramka.
+     * @return true jeśli ramka jest poprawna.
+     */
+    static bool parse(const char *frame, int size, BlockFrame &out);
+
+    /**
+     * @brief CRC-16/CCITT-FALSE (wielomian 0x1021, wartość początkowa 0xFFFF).
+     */
+    static uint16_t crc16(const uint8_t *data, size_t size);
+
+    /**
+     * @brief CRC-32 (jak w zlib) całych danych transferu.
+     */
+    static uint32_t crc32(const uint8_t *data, size_t size);
+
+private:
+    /**
+     * @brief Sprawdza parametry i przygotowuje stan nowego transferu.
+     */
+    bool begin(const BlockTransferOptions &options, int64_t nowNs);
+
+    /**
+     * @brief Wysyła blok o numerze seq (0 = otwarcie).
+     */
+    void sendBlock(uint16_t seq, std::string &out);
+
+    /**
+     * @brief Wysyła kolejne bloki zapisu, dopóki mieszczą się w oknie.
+     */
+    void fillWindow(std::string &out);
+
+    /**
+     * @brief Wysyła potwierdzenie odczytu (następny oczekiwany blok).
+     */
+    void sendAck(std::string &out);
+
+    /**
+     * @brief Kończy transfer z błędem.
+     */
+    void fail(const std::string &reason, int64_t nowNs);
+
+    State phase = State::Idle;      ///< Stan transferu.
+    bool upload = true;             ///< Kierunek.
+    uint8_t id = 0;                 ///< Identyfikator bieżącego transferu.
+    uint8_t regionId = 0;           ///< Obszar urządzenia.
+    uint32_t regionOffset = 0;      ///< Przesunięcie odczytu.
+    BlockTransferOptions config;    ///< Parametry.
+    std::vector<uint8_t> bytes;     ///< Dane zapisu lub odebrane dane odczytu.
+    size_t total = 0;               ///< Liczba bajtów danych.
+    uint16_t blocks = 0;            ///< Liczba bloków danych (numery 1..blocks).
+    uint16_t base = 0;              ///< Najstarszy niepotwierdzony blok (zapis) / następny oczekiwany (odczyt).
+    uint16_t next = 0;              ///< Następny blok do wysłania (zapis).
+    uint16_t sentEnd = 0;           ///< Numer za najwyższym wysłanym blokiem (do liczenia retransmisji).
+    int64_t timeoutNs = 0;          ///< Czas oczekiwania na postęp.
+    int64_t progressNs = 0;         ///< Czas ostatniego postępu.
+    int retries = 0;                ///< Kolejne retransmisje bez postępu.
+    int duplicateAcks = 0;          ///< Kolejne potwierdzenia bez postępu (zapis).
+    int recoveryBase = -1;          ///< Blok, od którego wykonano już szybkie ponowienie.
+    std::string message;            ///< Opis błędu.
+    BlockTransferStats counters;    ///< Liczniki.
+};
+
+#endif // BLOCKTRANSFER_H
@@ -5,6 +5,20 @@
  * Plik nagłówkowy definiuje klasę ChartsManager, która umożliwia tworzenie,
  * konfigurowanie i aktualizowanie dynamicznych wykresów parametrów silnika.
  * Obsługuje typowe parametry: PWM, RPM, napięcie, prąd, moc.
+ *
+ * Wykresy tworzone są leniwie — dopiero przy pierwszym pokazaniu widżetu, w którym mają się
+ * znaleźć — a niewidoczne wykresy (ukryte lub w zminimalizowanym oknie) nie są aktualizowane.
+ * Po ponownym pokazaniu seria odtwarzana jest z historii pomiarów (setHistorySource()).
+ *
+ * Opcjonalny wykres zbiorczy (setupCombinedChart()) rysuje wszystkie kanały na jednej scenie,
+ * ze wspólną osią czasu i osią Y znormalizowaną do zakresu każdego kanału.
+ *
+ * Wykresy kanałów pochodnych (derivedChartType()) rejestrowane są tak samo jak wbudowane, mogą być
+ * usuwane (removeChart()) i mają oś Y dopasowywaną do wartości (setAutoRange()); nie trafiają
+ * na wykres zbiorczy.
+ *
+ * Na wykres można nałożyć dodatkowe serie (setOverlay()) rysowane na tych samych osiach, np. zapisy
+ * kilku sesji do porównania; oś X takiego wykresu można ustawić na stały przedział (setXRange()).
  */
 
 #ifndef CHARTSMANAGER_H
@@ -13,6 +27,7 @@
 #include <QObject>
 #include <QtCharts>
 #include <QMap>
+#include <functional>
 
 /**
  * @enum ChartType
@@ -25,9 +40,18 @@ enum class ChartType {
     RPM,     ///< Obroty silnika [obr/min].
     Voltage, ///< Napięcie zasilania [V].
     Current, ///< Prąd [mA].
-    Power    ///< Moc [W].
+    Power,   ///< Moc [W].
+    Derived  ///< Pierwszy kanał pochodny (derivedChartType()); kolejne kanały mają kolejne wartości.
 };
 
+/**
+ * @brief Zwraca typ wykresu kanału pochodnego o podanym numerze.
+ * @param index Numer kanału pochodnego (od 0).
+ */
+inline ChartType derivedChartType(int index) {
+    return static_cast<ChartType>(static_cast<int>(ChartType::Derived) + index);
+}
+
 /**
  * @class ChartsManager
  * @brief Klasa do zarządzania dynamicznymi wykresami QtCharts.
@@ -42,6 +66,9 @@ class ChartsManager : public QObject
 {
     Q_OBJECT
 public:
+    /// Źródło punktów do odtworzenia wykresu: (typ, początek [s], koniec [s]) -> punkty (x w sekundach).
+    using HistorySource = std::function<QVector<QPointF>(ChartType type, qreal fromSeconds, qreal toSeconds)>;
+
     /**
      * @brief Konstruktor klasy ChartsManager.
      * @param parent Obiekt nadrzędny (domyślnie nullptr).
@@ -49,7 +76,9 @@ public:
     explicit ChartsManager(QObject *parent = nullptr);
 
     /**
-     * @brief Konfiguruje i dodaje nowy wykres do podanego layoutu.
+     * @brief Rejestruje wykres w podanym layoucie.
+     *
+     * Obiekty QChart/QChartView tworzone są przy pierwszym pokazaniu widżetu-rodzica layoutu.
      * @param type Typ wykresu (ChartType).
      * @param targetLayout Layout, do którego ma zostać dodany wykres.
      * @param title Tytuł wykresu.
@@ -60,6 +89,50 @@ public:
      */
     void setupChart(ChartType type, QLayout *targetLayout, const QString &title, const QString &yLabel, float yMax, int xRange = 5, bool nice_numbers = true);
 
+    /**
+     * @brief Usuwa wykres (np. kanału pochodnego) wraz z jego widokiem.
+     * @param type Typ wykresu.
+     */
+    void removeChart(ChartType type);
+
+    /**
+     * @brief Włącza rozszerzanie osi Y tak, aby obejmowała wszystkie rysowane wartości.
+     * @param type Typ wykresu.
+     * @param enabled Czy oś Y ma się dopasowywać (zakres z setupChart() jest zakresem początkowym).
+     */
+    void setAutoRange(ChartType type, bool enabled);
+
+    /**
+     * @brief Ustawia serię nakładaną na wykres (na tych samych osiach co seria główna).
+     *
+     * Seria jest tworzona przy pierwszym użyciu numeru; oś Y wykresu z setAutoRange() obejmuje jej wartości.
+     * @param type Typ wykresu.
+     * @param index Numer serii nakładanej (od 0, wyznacza też jej kolor).
+     * @param name Nazwa serii w legendzie.
+     * @param points Punkty (x w sekundach).
+     */
+    void setOverlay(ChartType type, int index, const QString &name, const QVector<QPointF> &points);
+
+    /**
+     * @brief Usuwa wszystkie serie nakładane z wykresu.
+     * @param type Typ wykresu.
+     */
+    void clearOverlays(ChartType type);
+
+    /**
+     * @brief Ustawia stały przedział osi X (wykres nie jest wtedy przewijany przez addPoint()).
+     * @param type Typ wykresu.
+     * @param from Początek przedziału [s].
+     * @param to Koniec przedziału [s].
+     */
+    void setXRange(ChartType type, qreal from, qreal to);
+
+    /**
+     * @brief Zwraca kolor serii nakładanej o podanym numerze.
+     * @param index Numer serii nakładanej.
+     */
+    static QColor overlayColor(int index);
+
     /**
      * @brief Dodaje nowy punkt danych do wykresu.
      * @param type Typ wykresu.
@@ -68,6 +141,48 @@ public:
      */
     void addPoint(ChartType type, qreal time, qreal value);
 
+    /**
+     * @brief Rejestruje wykres zbiorczy wszystkich kanałów w podanym layoucie.
+     *
+     * Każdy kanał zarejestrowany wcześniej przez setupChart() jest osobną serią, a jego wartości
+     * są normalizowane do procentu maksimum osi Y kanału (yMax), dzięki czemu kanały o różnych
+     * jednostkach mają wspólną oś Y. Wykres jest tworzony przy pierwszym pokazaniu, tak jak
+     * pojedyncze wykresy, i aktualizowany tylko wtedy, gdy jest widoczny.
+     * @param targetLayout Layout, do którego ma zostać dodany wykres.
+     * @param title Tytuł wykresu.
+     */
+    void setupCombinedChart(QLayout *targetLayout, const QString &title);
+
+    /**
+     * @brief Pokazuje lub ukrywa serię kanału na wykresie zbiorczym.
+     * @param type Typ wykresu (kanał).
+     * @param visible Czy seria ma być widoczna.
+     */
+    void setCombinedSeriesVisible(ChartType type, bool visible);
+
+    /**
+     * @brief Ustawia tytuł wykresu zbiorczego.
+     * @param title Nowy tytuł.
+     */
+    void setCombinedTitle(const QString &title);
+
+    /**
+     * @brief Ustawia źródło danych używane do odtworzenia wykresu po jego pokazaniu.
+     * @param source Funkcja zwracająca punkty z zadanego przedziału czasu.
+     */
+    void setHistorySource(HistorySource source);
+
+    /**
+     * @brief Sprawdza, czy wykres jest utworzony i widoczny (czyli aktualizowany).
+     * @param type Typ wykresu.
+     */
+    bool isChartActive(ChartType type) const;
+
+    /**
+     * @brief Zwraca liczbę utworzonych wykresów.
+     */
+    int createdChartCount() const;
+
     /**
      * @brief Ustawia tytuł wykresu.
      * @param type Typ wykresu.
@@ -89,29 +204,131 @@ public:
      */
     void setXAxisTitle(ChartType type, const QString &title);
 
+protected:
+    /**
+     * @brief Tworzy wykres przy pierwszym pokazaniu widżetu i odtwarza wstrzymane wykresy.
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
+    /**
+     * @struct Overlay
+     * @brief Seria nakładana na wykres (setOverlay()).
+     */
+    struct Overlay {
+        QString name;                  ///< Nazwa serii.
+        QList<QPointF> points;         ///< Punkty serii.
+        QLineSeries *series = nullptr; ///< Seria (po utworzeniu wykresu).
+    };
+
     /**
      * @struct ChartComponents
      * @brief Struktura przechowująca komponenty pojedynczego wykresu.
      */
     struct ChartComponents {
-        ChartType type;               ///< Typ wykresu
-        QLineSeries *series;          ///< Seria danych do rysowania
-        QChart *chart;                ///< Wskaźnik na obiekt QChart.
-        QChartView *chartView;        ///< Wskaźnik na obiekt QChartView (widok wykresu)
-        QValueAxis *axisX;            ///< Oś X (czas)
-        QValueAxis *axisY;            ///< Oś Y (wartość parametru).
-        int xRange;                   ///< Zakres osi X (czas w sekundach).
+        ChartType type;                    ///< Typ wykresu
+        QLineSeries *series = nullptr;     ///< Seria danych do rysowania
+        QChart *chart = nullptr;           ///< Wskaźnik na obiekt QChart.
+        QChartView *chartView = nullptr;   ///< Wskaźnik na obiekt QChartView (widok wykresu)
+        QValueAxis *axisX = nullptr;       ///< Oś X (czas)
+        QValueAxis *axisY = nullptr;       ///< Oś Y (wartość parametru).
+        int xRange = 5;                    ///< Zakres osi X (czas w sekundach).
+        QLayout *layout = nullptr;         ///< Layout, do którego trafi widok.
+        QString title;                     ///< Tytuł wykresu.
+        QString seriesName;                ///< Nazwa serii.
+        QString yLabel;                    ///< Opis osi Y.
+        QString xLabel;                    ///< Opis osi X.
+        float yMin = 0.0f;                 ///< Minimalna wartość osi Y.
+        float yMax = 0.0f;                 ///< Maksymalna wartość osi Y.
+        bool autoRange = false;            ///< Czy oś Y rozszerza się do rysowanych wartości.
+        bool niceNumbers = true;           ///< Czy użyć applyNiceNumbers() na osi Y.
+        bool stale = false;                ///< Czy pominięto punkty podczas wstrzymania.
+        qreal lastTime = 0.0;              ///< Czas ostatniego punktu (również pominiętego) [s].
+        QList<Overlay> overlays;           ///< Serie nakładane (indeks = numer serii).
+        bool fixedX = false;               ///< Czy oś X ma stały przedział (setXRange()).
+        qreal xFrom = 0.0;                 ///< Początek stałego przedziału osi X [s].
+        qreal xTo = 0.0;                   ///< Koniec stałego przedziału osi X [s].
+    };
+
+    /**
+     * @struct CombinedChart
+     * @brief Komponenty wykresu zbiorczego (jedna scena, wspólne osie, seria na kanał).
+     */
+    struct CombinedChart {
+        QChart *chart = nullptr;              ///< Wskaźnik na obiekt QChart.
+        QChartView *chartView = nullptr;      ///< Widok wykresu.
+        QValueAxis *axisX = nullptr;          ///< Wspólna oś X (czas).
+        QValueAxis *axisY = nullptr;          ///< Wspólna oś Y [% zakresu kanału].
+        QMap<ChartType, QLineSeries *> series; ///< Serie kanałów.
+        QMap<ChartType, bool> hidden;         ///< Kanały ukryte przez setCombinedSeriesVisible().
+        int xRange = 5;                       ///< Zakres osi X (czas w sekundach).
+        QLayout *layout = nullptr;            ///< Layout, do którego trafi widok.
+        QString title;                        ///< Tytuł wykresu.
+        bool stale = false;                   ///< Czy pominięto punkty podczas wstrzymania.
+        qreal lastTime = 0.0;                 ///< Czas ostatniego punktu (również pominiętego) [s].
     };
 
+    /**
+     * @brief Tworzy obiekty QtCharts zarejestrowanego wykresu i dodaje widok do layoutu.
+     * @param c Komponenty wykresu.
+     */
+    void createChart(ChartComponents &c);
+
+    /**
+     * @brief Tworzy serię nakładaną na utworzonym wykresie.
+     * @param c Komponenty wykresu.
+     * @param index Numer serii nakładanej.
+     */
+    void createOverlaySeries(ChartComponents &c, int index);
+
+    /**
+     * @brief Tworzy wykres (jeśli trzeba) i odtwarza jego serię z historii, jeśli była wstrzymana.
+     * @param type Typ wykresu.
+     */
+    void activateChart(ChartType type);
+
+    /**
+     * @brief Tworzy wykres zbiorczy (jeśli trzeba) i odtwarza jego serie z historii.
+     */
+    void activateCombinedChart();
+
+    /**
+     * @brief Zwraca nazwę serii kanału na wykresie zbiorczym (nazwa i zakres osi Y kanału).
+     */
+    static QString combinedSeriesName(const ChartComponents &c);
+
+    /**
+     * @brief Przelicza wartość kanału na procent maksimum jego osi Y.
+     */
+    static qreal normalized(const ChartComponents &c, qreal value);
+
+    /**
+     * @brief Rozszerza oś Y wykresu z autoRange tak, aby obejmowała wartości z przedziału [low, high].
+     */
+    static void expandRange(ChartComponents &c, qreal low, qreal high);
+
+    /**
+     * @brief Sprawdza, czy widok wykresu istnieje i jest widoczny na ekranie.
+     */
+    static bool isVisibleOnScreen(const QChartView *view);
+
+    /**
+     * @brief Kolejkuje aktywację wykresów, których widżet-rodzic właśnie stał się widoczny.
+     * @param watched Obiekt, dla którego odebrano zdarzenie (widżet-rodzic lub okno).
+     */
+    void scheduleActivation(QObject *watched);
+
     /**
      * @brief Usuwa stare punkty danych spoza aktualnego zakresu osi X.
      * @param series Seria danych.
      * @param currentTime Aktualny czas (prawy koniec osi X).
+     * @param window Szerokość okna czasu [s].
      */
-    void removeOldPoints(QLineSeries *series, qreal currentTime);
+    void removeOldPoints(QLineSeries *series, qreal currentTime, qreal window);
 
     QMap<ChartType, ChartComponents> charts; ///< Mapa wykresów powiązana z ich typami.
+    CombinedChart combined;                  ///< Wykres zbiorczy (opcjonalny).
+    HistorySource historySource;             ///< Źródło danych do odtwarzania wykresów.
 };
 
 #endif // CHARTSMANAGER_H
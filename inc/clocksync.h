@@ -0,0 +1,167 @@
+/**
+ * @file clocksync.h
+ * @brief Deklaracja klasy ClockSync — synchronizacji zegara urządzenia z zegarem hosta.
+ *
+ * Ramka rozszerzona (0xA6) niesie 32-bitowy znacznik czasu mikrokontrolera [µs]. Czas odebrania
+ * ramki na hoście zawiera opóźnienie USB/UART, które zmienia się o kilka milisekund, natomiast
+ * znacznik urządzenia jest dokładny. Z każdego przedziału bucketUs czasu urządzenia ClockSync
+ * zachowuje parę (urządzenie, host) o najmniejszym opóźnieniu, a na parach z przesuwanego okna
+ * dopasowuje metodą najmniejszych kwadratów prostą host = a + b * urządzenie — dzięki temu
+ * śledzi dryft kwarcu mikrokontrolera. Prosta jest przesuwana do dolnej obwiedni punktów
+ * (najmniejsze zaobserwowane opóźnienie), a próbki otrzymują czas hosta wyliczony z własnego
+ * znacznika — bez szumu opóźnienia transmisji.
+ *
+ * Przestój hosta (np. zablokowana pętla zdarzeń) opóźnia odbiór, ale nie zmienia znaczników,
+ * więc próbki o dużym dodatnim opóźnieniu są pomijane przy dopasowaniu, a estymacja zaczyna się
+ * od nowa dopiero, gdy utrzymują się przez outlierConfirmUs. Zmiany dopasowania nie są
+ * przenoszone skokowo, lecz wygaszane z prędkością maxSlewPpm — zwracane czasy nie maleją.
+ */
+
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class ClockSync
+ * @brief Estymator przesunięcia i dryftu zegara urządzenia względem zegara monotonicznego hosta.
+ *
+ * Klasa nie jest bezpieczna wątkowo — używana wyłącznie w wątku odbioru danych.
+ */
+class ClockSync
+{
+public:
+    /**
+     * @brief Konstruktor.
+     * @param window Liczba przedziałów (par o najmniejszym opóźnieniu) używanych do dopasowania.
+     */
+    explicit ClockSync(size_t window = 600);
+
+    /**
+     * @brief Dodaje parę pomiarową i zwraca czas próbki na osi hosta.
+     *
+     * Znacznik urządzenia jest rozwijany (przepełnienie licznika 32-bitowego co ~71 min).
+     * Cofnięcie się znacznika lub wyprzedzenie dopasowania o więcej niż resetThresholdUs (restart
+     * urządzenia) powoduje ponowne rozpoczęcie estymacji; opóźnienie większe niż outlierUs — tylko
+     * wtedy, gdy utrzymuje się dłużej niż outlierConfirmUs czasu hosta.
+     * @param deviceUs Znacznik czasu z ramki [µs zegara urządzenia].
+     * @param hostNs Czas odebrania ramki [ns, zegar monotoniczny hosta].
+     * @return Czas próbki [ns, zegar monotoniczny hosta], niemalejący między wywołaniami;
+     *         przed zamknięciem pierwszego przedziału — hostNs.
+     */
+    int64_t update(uint32_t deviceUs, int64_t hostNs);
+
+    /**
+     * @brief Przelicza rozwinięty czas urządzenia na czas hosta według bieżącego dopasowania.
+     * @param deviceUs Rozwinięty czas urządzenia [µs].
+     * @return Czas hosta [ns].
+     */
+    int64_t toHostNs(int64_t deviceUs) const;
+
+    /**
+     * @brief Zapomina wszystkie pomiary (np. po ponownym otwarciu portu), łącznie z ostatnim
+     * zwróconym czasem.
+     */
+    void reset();
+
+    /**
+     * @brief Czy dopasowanie jest używane (zamknięto co najmniej jeden przedział).
+     */
+    bool isLocked() const { return locked; }
+
+    /**
+     * @brief Przesunięcie zegarów: czas hosta minus czas urządzenia w ostatniej próbce [µs].
+     */
+    double offsetUs() const { return offset; }
+
+    /**
+     * @brief Dryft zegara urządzenia względem hosta [ppm] (dodatni: zegar urządzenia spóźnia się).
+     */
+    double driftPpm() const { return (slope - 1.0) * 1e6; }
+
+    /**
+     * @brief Odchylenie standardowe opóźnień próbek względem dopasowania (jitter transmisji) [µs].
+     */
+    double jitterUs() const { return jitter; }
+
+    /**
+     * @brief Liczba ponownych rozpoczęć estymacji spowodowanych restartem zegara urządzenia.
+     */
+    uint64_t resyncCount() const { return resyncs; }
+
+    /// Długość przedziału czasu urządzenia, z którego zachowywana jest jedna para [µs].
+    static constexpr int64_t bucketUs = 100000;
+    /// Minimalna liczba przedziałów, od której szacowany jest dryft (wcześniej tylko przesunięcie).
+    static constexpr size_t minDriftSamples = 8;
+    /// Wyprzedzenie dopasowania przez czas odebrania, powyżej którego zegar urządzenia uznaje się za zrestartowany [µs].
+    static constexpr double resetThresholdUs = 500000.0;
+    /// Opóźnienie względem dopasowania, powyżej którego próbka uznawana jest za opóźnioną przez hosta [µs].
+    static constexpr double outlierUs = 20000.0;
+    /// Czas hosta, przez który opóźnione próbki muszą następować bez przerwy, aby uznać dopasowanie za nieaktualne [µs].
+    static constexpr int64_t outlierConfirmUs = 2000000;
+    /// Maksymalna prędkość wygaszania zmian dopasowania [ppm czasu urządzenia].
+    static constexpr double maxSlewPpm = 1000.0;
+
+private:
+    /**
+     * @brief Para pomiarowa względem punktu odniesienia (pierwszej pary po resecie).
+     */
+    struct Point {
+        double deviceUs; ///< Czas urządzenia od odniesienia [µs].
+        double hostUs;   ///< Czas hosta od odniesienia [µs].
+    };
+
+    /**
+     * @brief Dopasowuje prostą w oknie i przesuwa ją do dolnej obwiedni punktów.
+     */
+    void refit();
+
+    /**
+     * @brief Rozpoczyna estymację od nowa po restarcie zegara urządzenia, zachowując ostatni zwrócony czas.
+     */
+    void restart();
+
+    /**
+     * @brief Zwraca czas nie mniejszy niż poprzednio zwrócony i zapamiętuje go.
+     */
+    int64_t monotonic(int64_t ns);
+
+    /**
+     * @brief Aktualizuje wykładniczo ważoną wariancję opóźnień (jitter).
+     * @param residualUs Opóźnienie próbki względem dopasowania [µs].
+     */
+    void recordResidual(double residualUs);
+
+    /**
+     * @brief Wartość dopasowania dla czasu urządzenia liczonego od odniesienia [µs hosta od odniesienia].
+     */
+    double predict(double deviceUs) const { return intercept + slope * deviceUs; }
+
+    std::vector<Point> points;   ///< Bufor cykliczny par pomiarowych.
+    size_t capacity;             ///< Rozmiar okna.
+    size_t next = 0;             ///< Indeks następnego zapisu w buforze.
+    Point bucketBest{0.0, 0.0};  ///< Para o najmniejszym opóźnieniu w bieżącym przedziale.
+    int64_t bucketEndUs = 0;     ///< Koniec bieżącego przedziału (czas urządzenia od odniesienia) [µs].
+    bool started = false;        ///< Czy ustalono punkt odniesienia.
+    bool locked = false;         ///< Czy dopasowanie jest używane.
+    uint32_t lastRawUs = 0;      ///< Ostatni surowy znacznik urządzenia.
+    uint32_t originRawUs = 0;    ///< Surowy znacznik urządzenia w punkcie odniesienia.
+    int64_t unwrappedUs = 0;     ///< Rozwinięty czas urządzenia od odniesienia [µs].
+    int64_t hostOriginNs = 0;    ///< Czas hosta w punkcie odniesienia [ns].
+    double intercept = 0.0;      ///< Wyraz wolny dopasowania [µs].
+    double slope = 1.0;          ///< Nachylenie dopasowania (1 + dryft).
+    double offset = 0.0;         ///< Ostatnie przesunięcie zegarów [µs].
+    double jitter = 0.0;         ///< Odchylenie standardowe opóźnień [µs].
+    double residualMean = 0.0;   ///< Średnia wykładnicza opóźnień [µs].
+    double residualVariance = 0.0; ///< Wariancja wykładnicza opóźnień [µs^2].
+    uint64_t resyncs = 0;        ///< Liczba restartów estymacji.
+    double correctionUs = 0.0;   ///< Wygaszana różnica między poprzednim a bieżącym dopasowaniem [µs].
+    bool delayed = false;        ///< Czy ostatnie próbki są opóźnione o więcej niż outlierUs.
+    int64_t delayedSinceNs = 0;  ///< Czas hosta pierwszej z kolejnych opóźnionych próbek [ns].
+    int64_t lastMappedNs = std::numeric_limits<int64_t>::min(); ///< Ostatni zwrócony czas [ns].
+};
+
+#endif // CLOCKSYNC_H
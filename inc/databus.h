@@ -0,0 +1,312 @@
+/**
+ * @file databus.h
+ * @brief Szablon DataBus — typowana magistrala danych w procesie z dostarczaniem porcjami.
+ *
+ * Producent publikuje porcje elementów do wspólnego bufora pierścieniowego, a każdy
+ * subskrybent ma własny kursor (numer kolejnego elementu do odczytu). Subskrybenci
+ * z funkcją zwrotną dostają w dispatch() całą zaległość jako jeden lub dwa ciągłe
+ * fragmenty bufora (bez kopiowania), pozostali odczytują ją sami przez read() — także
+ * z innego wątku. Koszt dostarczania rośnie z liczbą porcji i subskrybentów, a nie
+ * z iloczynem liczby ramek i odbiorców, jak przy sygnale Qt emitowanym dla każdej ramki.
+ *
+ * Subskrybent, który nie odczytał danych przed ich nadpisaniem, przeskakuje do
+ * najstarszego dostępnego elementu, a pominięte elementy są liczone (overruns).
+ *
+ * Szablon nie zależy od Qt (narzędzie tools/wds_databus_bench).
+ */
+
+#ifndef DATABUS_H
+#define DATABUS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @struct DataBusStats
+ * @brief Liczniki subskrybenta magistrali.
+ */
+struct DataBusStats {
+    uint64_t delivered = 0; ///< Elementy dostarczone subskrybentowi.
+    uint64_t batches = 0;   ///< Wywołania funkcji zwrotnej lub niepuste odczyty read().
+    uint64_t overruns = 0;  ///< Elementy nadpisane przed odczytem.
+    size_t maxLag = 0;      ///< Największa zaległość przy odczycie [elementy].
+};
+
+/**
+ * @class DataBus
+ * @brief Bufor pierścieniowy elementów typu T z kursorami subskrybentów.
+ *
+ * publish() i dispatch() wywołuje jeden wątek producenta. Funkcje zwrotne wykonywane są
+ * w wątku producenta bez blokady (tylko producent zapisuje bufor), read() można wywołać
+ * z dowolnego wątku. Magistrala bez subskrybentów z funkcją zwrotną (np. dziennik poleceń
+ * SerialReader::commandLog()) może mieć wielu producentów — publish() działa pod blokadą.
+ */
+template <typename T>
+class DataBus
+{
+public:
+    /**
+     * @brief Funkcja zwrotna subskrybenta.
+     * @param items Ciągły fragment bufora.
+     * @param count Liczba elementów we fragmencie.
+     * @param sequence Numer pierwszego elementu fragmentu.
+     */
+    using Callback = std::function<void(const T *items, size_t count, uint64_t sequence)>;
+
+    static constexpr size_t defaultCapacity = 16384; ///< Domyślna pojemność [elementy].
+
+    /**
+     * @brief Konstruktor magistrali.
+     * @param capacity Pojemność bufora, zaokrąglana w górę do potęgi dwójki.
+     */
+    explicit DataBus(size_t capacity = defaultCapacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        ring.resize(size);
+        mask = size - 1;
+    }
+
+    /**
+     * @brief Dodaje subskrybenta.
+     * @param callback Funkcja zwrotna wywoływana w dispatch(); pusta — odczyt przez read().
+     * @param fromStart true — od najstarszego dostępnego elementu, false — od następnej publikacji.
+     * @return Identyfikator subskrybenta (do read() i unsubscribe()).
+     */
+    int subscribe(Callback callback = Callback(), bool fromStart = false) {
+        const std::lock_guard<std::mutex> guard(lock);
+        Subscriber subscriber;
+        subscriber.id = ++lastId;
+        subscriber.cursor = fromStart ? oldest() : head;
+        if (callback)
+            subscriber.callback = std::make_shared<const Callback>(std::move(callback));
+        subscribers.push_back(std::move(subscriber));
+        return lastId;
+    }
+
+    /**
+     * @brief Usuwa subskrybenta (bezpieczne także z jego funkcji zwrotnej).
+     */
+    void unsubscribe(int id) {
+        const std::lock_guard<std::mutex> guard(lock);
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                         [id](const Subscriber &subscriber) { return subscriber.id == id; }),
+                          subscribers.end());
+        unsubscribes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Publikuje porcję elementów (wątek producenta).
+     *
+     * Porcja większa od pojemności zachowuje tylko ostatnie capacity() elementów.
+     */
+    void publish(const T *items, size_t count) {
+        if (count == 0)
+            return;
+        const std::lock_guard<std::mutex> guard(lock);
+        const size_t skip = count > ring.size() ? count - ring.size() : 0;
+        head += skip;
+        for (size_t i = skip; i < count; ++i)
+            ring[static_cast<size_t>(head++) & mask] = items[i];
+        ++published;
+    }
+
+    /**
+     * @brief Przekazuje zaległe elementy subskrybentom z funkcją zwrotną (wątek producenta).
+     *
+     * Każdy subskrybent dostaje całą zaległość od swojego kursora — jedno wywołanie,
+     * albo dwa, gdy zaległość przechodzi przez koniec bufora. Subskrybent usunięty w trakcie
+     * (także z funkcji zwrotnej) nie dostaje już porcji. Wywołanie nie jest wielobieżne.
+     */
+    void dispatch() {
+        uint64_t end = 0;
+        uint64_t removals = 0;
+        {
+            const std::lock_guard<std::mutex> guard(lock);
+            end = head;
+            pending.clear();
+            for (Subscriber &subscriber : subscribers) {
+                if (subscriber.callback && subscriber.cursor < end)
+                    pending.push_back({subscriber.id, advance(subscriber, end), subscriber.callback});
+            }
+            removals = unsubscribes.load(std::memory_order_relaxed);
+        }
+        for (const Pending &delivery : pending) {
+            if (unsubscribes.load(std::memory_order_relaxed) == removals || active(delivery.id))
+                deliver(*delivery.callback, delivery.cursor, end);
+        }
+        pending.clear();
+    }
+
+    /**
+     * @brief Kopiuje zaległe elementy subskrybenta (dowolny wątek).
+     * @param id Identyfikator z subscribe().
+     * @param out Wektor wynikowy (poprzednia zawartość jest usuwana, pojemność ponownie używana).
+     * @param maxCount Największa liczba elementów (0 — bez limitu).
+     * @return Liczba skopiowanych elementów.
+     */
+    size_t read(int id, std::vector<T> &out, size_t maxCount = 0) {
+        out.clear();
+        const std::lock_guard<std::mutex> guard(lock);
+        Subscriber *subscriber = find(id);
+        if (!subscriber || subscriber->cursor >= head)
+            return 0;
+        uint64_t end = head;
+        if (maxCount > 0)
+            end = std::min<uint64_t>(end, std::max(subscriber->cursor, oldest()) + maxCount);
+        uint64_t cursor = advance(*subscriber, end);
+        out.reserve(static_cast<size_t>(end - cursor));
+        for (; cursor < end; ++cursor)
+            out.push_back(ring[static_cast<size_t>(cursor) & mask]);
+        return out.size();
+    }
+
+    /**
+     * @brief Zwraca liczniki subskrybenta (zerowe dla nieznanego identyfikatora).
+     */
+    DataBusStats stats(int id) const {
+        const std::lock_guard<std::mutex> guard(lock);
+        for (const Subscriber &subscriber : subscribers) {
+            if (subscriber.id == id)
+                return subscriber.stats;
+        }
+        return DataBusStats();
+    }
+
+    /**
+     * @brief Zwraca sumę liczników wszystkich subskrybentów.
+     */
+    DataBusStats totals() const {
+        const std::lock_guard<std::mutex> guard(lock);
+        DataBusStats sum;
+        for (const Subscriber &subscriber : subscribers) {
+            sum.delivered += subscriber.stats.delivered;
+            sum.batches += subscriber.stats.batches;
+            sum.overruns += subscriber.stats.overruns;
+            sum.maxLag = std::max(sum.maxLag, subscriber.stats.maxLag);
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Zwraca numer następnego publikowanego elementu (liczba wszystkich opublikowanych).
+     */
+    uint64_t sequence() const {
+        const std::lock_guard<std::mutex> guard(lock);
+        return head;
+    }
+
+    /**
+     * @brief Zwraca liczbę wywołań publish() z niepustą porcją.
+     */
+    uint64_t publishedBatches() const {
+        const std::lock_guard<std::mutex> guard(lock);
+        return published;
+    }
+
+    /**
+     * @brief Zwraca liczbę aktywnych subskrybentów.
+     */
+    size_t subscriberCount() const {
+        const std::lock_guard<std::mutex> guard(lock);
+        return subscribers.size();
+    }
+
+    /**
+     * @brief Zwraca pojemność bufora [elementy].
+     */
+    size_t capacity() const { return ring.size(); }
+
+private:
+    /**
+     * @brief Stan subskrybenta.
+     */
+    struct Subscriber {
+        int id = 0;          ///< Identyfikator.
+        uint64_t cursor = 0; ///< Numer kolejnego elementu do odczytu.
+        std::shared_ptr<const Callback> callback; ///< Funkcja zwrotna (pusta — odczyt przez read()).
+        DataBusStats stats;  ///< Liczniki.
+    };
+
+    /**
+     * @brief Numer najstarszego elementu w buforze (wywoływane pod blokadą).
+     */
+    uint64_t oldest() const { return head > ring.size() ? head - ring.size() : 0; }
+
+    /**
+     * @brief Pomija nadpisane elementy, aktualizuje liczniki i przesuwa kursor do end
+     * (wywoływane pod blokadą).
+     * @return Numer pierwszego elementu do odczytu.
+     */
+    uint64_t advance(Subscriber &subscriber, uint64_t end) {
+        uint64_t cursor = subscriber.cursor;
+        if (cursor < oldest()) {
+            subscriber.stats.overruns += oldest() - cursor;
+            cursor = oldest();
+        }
+        subscriber.stats.maxLag = std::max(subscriber.stats.maxLag, static_cast<size_t>(head - cursor));
+        subscriber.stats.delivered += end - cursor;
+        ++subscriber.stats.batches;
+        subscriber.cursor = end;
+        return cursor;
+    }
+
+    /**
+     * @brief Dostarcza elementy [cursor, end) jednym lub dwoma wywołaniami (przejście przez koniec bufora).
+     */
+    void deliver(const Callback &callback, uint64_t cursor, uint64_t end) const {
+        while (cursor < end) {
+            const size_t offset = static_cast<size_t>(cursor) & mask;
+            const size_t count = static_cast<size_t>(std::min<uint64_t>(end - cursor, ring.size() - offset));
+            callback(&ring[offset], count, cursor);
+            cursor += count;
+        }
+    }
+
+    /**
+     * @brief Sprawdza, czy subskrybent nie został usunięty (np. przez funkcję zwrotną innego).
+     */
+    bool active(int id) {
+        const std::lock_guard<std::mutex> guard(lock);
+        return find(id) != nullptr;
+    }
+
+    /**
+     * @brief Zwraca subskrybenta o danym identyfikatorze (wywoływane pod blokadą).
+     */
+    Subscriber *find(int id) {
+        for (Subscriber &subscriber : subscribers) {
+            if (subscriber.id == id)
+                return &subscriber;
+        }
+        return nullptr;
+    }
+
+
+    mutable std::mutex lock;             ///< Chroni kursory, liczniki i zapis bufora.
+    std::vector<T> ring;                 ///< Bufor pierścieniowy.
+    size_t mask = 0;                     ///< ring.size() - 1.
+    uint64_t head = 0;                   ///< Numer następnego publikowanego elementu.
+    uint64_t published = 0;              ///< Liczba niepustych publikacji.
+    std::vector<Subscriber> subscribers; ///< Subskrybenci.
+    int lastId = 0;                      ///< Ostatnio nadany identyfikator.
+    std::atomic<uint64_t> unsubscribes{0}; ///< Liczba wywołań unsubscribe() (sprawdzenie w dispatch() bez blokady).
+
+    /**
+     * @brief Porcja do dostarczenia w dispatch() (zebrana pod jedną blokadą).
+     */
+    struct Pending {
+        int id;                                   ///< Identyfikator subskrybenta.
+        uint64_t cursor;                          ///< Pierwszy element porcji.
+        std::shared_ptr<const Callback> callback; ///< Funkcja zwrotna (ważna także po unsubscribe()).
+    };
+    std::vector<Pending> pending;        ///< Porcje bieżącego dispatch() (pojemność ponownie używana).
+};
+
+#endif // DATABUS_H
@@ -0,0 +1,149 @@
+/**
+ * @file derivedchannel.h
+ * @brief Deklaracja kanałów pochodnych — wyrażeń nad polami SerialData kompilowanych do kodu bajtowego.
+ *
+ * Kanał pochodny definiowany jest wierszem "<nazwa> = <wyrażenie>", np.
+ *
+ *     moc_el = voltage * current / 1000
+ *     blad_rpm = setpoint - rpm
+ *     sprawnosc = 100 * power / max(voltage * current, 1)
+ *
+ * W wyrażeniu można używać nazw kanałów (channelName()), zmiennej setpoint (zadane RPM),
+ * liczb, operatorów + - * / ^, nawiasów oraz funkcji abs(), sqrt(), min(), max().
+ *
+ * Wyrażenie kompilowane jest raz do kodu w odwrotnej notacji polskiej (ze zwinięciem stałych),
+ * a wykonywane blokami: każda instrukcja przetwarza cały blok wartości kolumnowych, więc koszt
+ * interpretacji (wybór instrukcji) przypada na blok, a pętle arytmetyczne są wektoryzowane.
+ * Plik nie zależy od Qt.
+ */
+
+#ifndef DERIVEDCHANNEL_H
+#define DERIVEDCHANNEL_H
+
+#include "serialdata.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class DerivedExpression
+ * @brief Skompilowane wyrażenie kanału pochodnego.
+ *
+ * Obiekt po kompilacji jest niezmienny; evaluate() można wywoływać równolegle z wielu wątków.
+ */
+class DerivedExpression
+{
+public:
+    /// Liczba próbek przetwarzanych jednym przebiegiem kodu.
+    static constexpr size_t blockSize = 256;
+    /// Maksymalna głębokość stosu wartości (ogranicza złożoność wyrażenia).
+    static constexpr int maxStackDepth = 16;
+    /// Maksymalne zagnieżdżenie nawiasów, wywołań funkcji i operatorów '-' oraz '^' (ogranicza rekurencję kompilatora).
+    static constexpr int maxNestingDepth = 256;
+
+    /**
+     * @brief Kompiluje wyrażenie.
+     *
+     * Przy błędzie wyrażenie pozostaje bez zmian.
+     * @param text Wyrażenie (składnia w nagłówku pliku).
+     * @param error Opis błędu.
+     * @return true jeśli wyrażenie jest poprawne.
+     */
+    bool compile(const std::string &text, std::string &error);
+
+    /**
+     * @brief Oblicza wyrażenie dla danych kolumnowych.
+     * @param columns Tablice wartości indeksowane kanałem (Channel); wystarczą kanały z inputs().
+     * @param count Liczba próbek.
+     * @param setpoint Wartość zmiennej setpoint.
+     * @param out Wyniki (count elementów).
+     */
+    void evaluate(const float *const columns[channelCount], size_t count, float setpoint, float *out) const;
+
+    /**
+     * @brief Oblicza wyrażenie dla partii próbek (kanały są najpierw kopiowane do kolumn).
+     * @param samples Próbki.
+     * @param count Liczba próbek.
+     * @param setpoint Wartość zmiennej setpoint.
+     * @param out Wyniki (count elementów).
+     */
+    void evaluate(const SerialData *samples, size_t count, float setpoint, float *out) const;
+
+    /**
+     * @brief Oblicza wyrażenie dla pojedynczej próbki.
+     */
+    float evaluate(const SerialData &sample, float setpoint) const;
+
+    /**
+     * @brief Kanały używane przez wyrażenie (bez powtórzeń).
+     */
+    const std::vector<Channel> &inputs() const { return channels; }
+
+    /**
+     * @brief Tekst wyrażenia.
+     */
+    const std::string &text() const { return source; }
+
+    /**
+     * @brief Liczba instrukcji kodu po zwinięciu stałych.
+     */
+    size_t instructionCount() const { return code.size(); }
+
+    /**
+     * @brief Czy wyrażenie nie zostało skompilowane.
+     */
+    bool empty() const { return code.empty(); }
+
+    /**
+     * @brief Kod operacji.
+     */
+    enum class Op : uint8_t {
+        Load,     ///< Wartość kanału.
+        Setpoint, ///< Wartość zmiennej setpoint.
+        Constant, ///< Stała.
+        Add, Sub, Mul, Div, Pow, Min, Max, ///< Operacje dwuargumentowe.
+        Neg, Abs, Sqrt                     ///< Operacje jednoargumentowe.
+    };
+
+    /**
+     * @brief Instrukcja kodu.
+     */
+    struct Instruction {
+        Op op;                 ///< Kod operacji.
+        Channel channel;       ///< Kanał (Op::Load).
+        float constant;        ///< Stała (Op::Constant).
+    };
+
+private:
+    std::vector<Instruction> code; ///< Kod w odwrotnej notacji polskiej.
+    std::vector<Channel> channels; ///< Kanały używane przez wyrażenie.
+    std::string source;            ///< Tekst wyrażenia.
+};
+
+/**
+ * @struct DerivedChannel
+ * @brief Nazwany kanał pochodny.
+ */
+struct DerivedChannel {
+    std::string name;              ///< Nazwa kanału (identyfikator).
+    DerivedExpression expression;  ///< Skompilowane wyrażenie.
+
+    /**
+     * @brief Tworzy kanał z definicji "<nazwa> = <wyrażenie>".
+     *
+     * Nazwa musi być identyfikatorem różnym od nazw kanałów SerialData, funkcji i zmiennej setpoint.
+     * @param definition Definicja.
+     * @param error Opis błędu.
+     * @return true jeśli definicja jest poprawna.
+     */
+    bool parse(const std::string &definition, std::string &error);
+
+    /**
+     * @brief Zwraca definicję w postaci "<nazwa> = <wyrażenie>".
+     */
+    std::string definition() const { return name + " = " + expression.text(); }
+};
+
+#endif // DERIVEDCHANNEL_H
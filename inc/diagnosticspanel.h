@@ -0,0 +1,73 @@
+/**
+ * @file diagnosticspanel.h
+ * @brief Deklaracja klasy DiagnosticsPanel — dokowanego panelu diagnostycznego.
+ *
+ * Panel zawiera zakładki; pierwsza to podgląd dziennika w pamięci (Log) z filtrem poziomu,
+ * wstrzymaniem przewijania, zapisem do pliku i zestawieniem miejsc wywołania z liczbą
+ * komunikatów zapisanych i pominiętych przez limit. Rekordy formatowane są dopiero tutaj,
+ * okresowo i tylko gdy panel jest widoczny.
+ */
+
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include "logring.h"
+#include <QDockWidget>
+#include <QTimer>
+#include <vector>
+
+class QCheckBox;
+class QComboBox;
+class QPlainTextEdit;
+class QTabWidget;
+class QTableWidget;
+
+/**
+ * @class DiagnosticsPanel
+ * @brief Dokowany panel z dziennikiem i innymi zakładkami diagnostycznymi.
+ */
+class DiagnosticsPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy DiagnosticsPanel.
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit DiagnosticsPanel(QWidget *parent = nullptr);
+
+    /**
+     * @brief Dodaje zakładkę diagnostyczną.
+     * @param page Widżet zakładki (panel przejmuje go na własność).
+     * @param title Tytuł zakładki.
+     */
+    void addPage(QWidget *page, const QString &title);
+
+private slots:
+    /**
+     * @brief Odczytuje nowe rekordy dziennika i odświeża zestawienie miejsc wywołania.
+     */
+    void refresh();
+
+    /**
+     * @brief Zapisuje cały bufor dziennika do pliku wybranego przez użytkownika.
+     */
+    void saveLog();
+
+private:
+    /**
+     * @brief Odświeża tabelę miejsc wywołania.
+     */
+    void refreshSites();
+
+    QTabWidget *tabs;              ///< Zakładki panelu.
+    QPlainTextEdit *logView;       ///< Sformatowane rekordy dziennika.
+    QComboBox *levelFilter;        ///< Najniższy pokazywany poziom.
+    QCheckBox *pauseBox;           ///< Wstrzymanie dopisywania rekordów.
+    QTableWidget *sitesTable;      ///< Miejsca wywołania z licznikami.
+    QTimer refreshTimer;           ///< Timer odczytu dziennika.
+    uint64_t cursor = 0;           ///< Numer kolejnego rekordu do odczytu.
+    std::vector<LogRecord> records; ///< Bufor odczytu (ponownie używany).
+};
+
+#endif // DIAGNOSTICSPANEL_H
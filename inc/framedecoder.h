@@ -0,0 +1,116 @@
+/**
+ * @file framedecoder.h
+ * @brief Deklaracja klasy FrameDecoder składającej ramki telemetrii ze strumienia bajtów.
+ *
+ * Dekoder jest niezależny od źródła danych (QSerialPort, plik, symulator) — przyjmuje
+ * kolejne porcje bajtów, wyszukuje bajt startu 0xA5 (ramka podstawowa) lub 0xA6 (ramka
+ * rozszerzona o znacznik czasu urządzenia), weryfikuje sumę kontrolną XOR
+ * i zwraca sparsowane struktury SerialData. Prowadzi również statystyki poprawnych
+ * ramek i błędów, wykorzystywane m.in. przy automatycznym wykrywaniu prędkości transmisji.
+ *
+ * Po błędzie sumy kontrolnej dekoder przesuwa się tylko o jeden bajt i szuka kolejnego
+ * bajtu startu wewnątrz odrzuconej ramki, więc poprawna ramka zaczynająca się w tym oknie
+ * nie jest tracona. Ramka z poprawną sumą jest odrzucana, jeśli bezpośrednio po niej odebrano
+ * bajt inny niż bajt startu, a do czasu odzyskania synchronizacji czeka na ten bajt — przypadkowe
+ * 0xA5/0xA6 w danych z pasującą sumą XOR rzadko dają wtedy fałszywe ramki.
+ *
+ * W tym samym strumieniu mogą pojawić się ramki transferu blokowego urządzenia (0xA7,
+ * zmienna długość, CRC-16 — blocktransfer.h); są wydzielane osobno i nie liczą się
+ * jako ramki telemetrii.
+ */
+
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include "serialdata.h"
+#include "blocktransfer.h"
+#include <QByteArray>
+#include <QVector>
+#include <vector>
+
+/**
+ * @struct DecoderStats
+ * @brief Liczniki dekodera ramek.
+ */
+struct DecoderStats {
+    quint64 validFrames = 0;    ///< Liczba poprawnie sparsowanych ramek.
+    quint64 checksumErrors = 0; ///< Liczba ramek z błędną sumą kontrolną.
+    quint64 droppedBytes = 0;   ///< Liczba bajtów odrzuconych podczas synchronizacji.
+    quint64 resyncs = 0;        ///< Liczba utrat synchronizacji (błąd ramki po poprawnej ramce).
+    quint64 blockFrames = 0;    ///< Liczba poprawnych ramek transferu blokowego.
+};
+
+/**
+ * @class FrameDecoder
+ * @brief Składa ramki telemetrii z kolejnych porcji bajtów.
+ */
+class FrameDecoder
+{
+public:
+    static constexpr int frameSize = 32;     ///< Długość ramki telemetrii.
+    static constexpr quint8 startByte = 0xA5; ///< Bajt startu ramki telemetrii.
+    static constexpr int extendedFrameSize = 36;      ///< Długość ramki rozszerzonej (ze znacznikiem czasu).
+    static constexpr quint8 extendedStartByte = 0xA6; ///< Bajt startu ramki rozszerzonej.
+
+    /**
+     * @brief Zwraca długość ramki dla bajtu startu (0, jeśli bajt nie rozpoczyna ramki).
+     * @param start Bajt startu.
+     */
+    static int frameSizeFor(quint8 start) {
+        return start == startByte ? frameSize : start == extendedStartByte ? extendedFrameSize : 0;
+    }
+
+    /**
+     * @brief Czy bajt rozpoczyna ramkę telemetrii lub ramkę transferu blokowego.
+     * @param start Bajt startu.
+     */
+    static bool isStartByte(quint8 start) {
+        return frameSizeFor(start) > 0 || start == BlockTransfer::deviceStartByte;
+    }
+
+    /**
+     * @brief Dodaje porcję bajtów i dekoduje wszystkie pełne ramki.
+     * @param data Wskaźnik na odebrane bajty.
+     * @param size Liczba bajtów.
+     * @param out Wektor, na którego koniec dopisywane są sparsowane ramki telemetrii.
+     * @param blocks Wektor na ramki transferu blokowego (nullptr = ramki są pomijane).
+     * @return Liczba sparsowanych ramek telemetrii.
+     */
+    int feed(const char *data, int size, QVector<SerialData> &out, std::vector<BlockFrame> *blocks = nullptr);
+
+    /**
+     * @brief Czyści bufor (np. po zmianie prędkości transmisji). Statystyki pozostają bez zmian.
+     */
+    void reset();
+
+    /**
+     * @brief Zeruje statystyki dekodera.
+     */
+    void resetStats();
+
+    /**
+     * @brief Zwraca statystyki dekodera.
+     */
+    const DecoderStats &stats() const { return counters; }
+
+    /**
+     * @brief Weryfikuje sumę kontrolną i parsuje jedną ramkę.
+     * @param frame Wskaźnik na początek ramki (bajt startu).
+     * @param size Długość ramki.
+     * @param data Struktura, do której zapisane zostaną odczytane dane.
+     * @return true jeśli parsowanie i suma kontrolna są poprawne, false w przeciwnym wypadku.
+     */
+    static bool parseFrame(const char *frame, int size, SerialData &data);
+
+private:
+    /**
+     * @brief Oznacza utratę synchronizacji (zlicza ją tylko raz do odzyskania synchronizacji).
+     */
+    void loseSync();
+
+    QByteArray buffer;     ///< Bufor do składania ramek z bajtów.
+    DecoderStats counters; ///< Statystyki dekodera.
+    bool synced = false;   ///< Czy ostatnia ramka była poprawna i kończyła się tuż przed bieżącą pozycją.
+};
+
+#endif // FRAMEDECODER_H
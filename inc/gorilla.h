@@ -0,0 +1,199 @@
+/**
+ * @file gorilla.h
+ * @brief Kodowanie strumieni czasu i wartości float w stylu Gorilla (Facebook).
+ *
+ * Plik nagłówkowy definiuje strumień bitowy (GorillaBitStream) oraz kodery i dekodery:
+ * - znaczników czasu metodą delta-of-delta,
+ * - wartości float metodą XOR z poprzednią wartością.
+ * Kodowanie jest bezstratne i wykorzystywane przez HistoryStore do kompresji starszych bloków historii.
+ */
+
+#ifndef GORILLA_H
+#define GORILLA_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class GorillaBitStream
+ * @brief Ciągły strumień bitów zapisywany w słowach 64-bitowych (od najstarszego bitu).
+ */
+class GorillaBitStream
+{
+public:
+    /**
+     * @brief Dopisuje do strumienia najmłodsze bity wartości.
+     * @param value Wartość, z której brane są bity.
+     * @param bits Liczba bitów do zapisania (0-64).
+     */
+    void write(uint64_t value, int bits);
+
+    /**
+     * @brief Zwraca liczbę zapisanych bitów.
+     */
+    uint64_t bitCount() const { return bits; }
+
+    /**
+     * @brief Zwraca rozmiar strumienia w bajtach (zaokrąglony w górę).
+     */
+    uint64_t byteCount() const { return (bits + 7) / 8; }
+
+    /**
+     * @brief Zwalnia nadmiarową pamięć po zakończeniu zapisu.
+     */
+    void shrink() { words.shrink_to_fit(); }
+
+    /**
+     * @brief Usuwa zawartość strumienia.
+     */
+    void clear();
+
+private:
+    friend class GorillaBitReader;
+
+    std::vector<uint64_t> words; ///< Słowa przechowujące bity.
+    uint64_t bits = 0;           ///< Liczba zapisanych bitów.
+};
+
+/**
+ * @class GorillaBitReader
+ * @brief Sekwencyjny odczyt bitów ze strumienia GorillaBitStream.
+ */
+class GorillaBitReader
+{
+public:
+    /**
+     * @brief Konstruktor czytnika.
+     * @param stream Strumień do odczytu (musi istnieć przez cały czas odczytu).
+     */
+    explicit GorillaBitReader(const GorillaBitStream &stream) : stream(stream) {}
+
+    /**
+     * @brief Odczytuje kolejne bity.
+     * @param bits Liczba bitów (0-64).
+     * @return Odczytana wartość w najmłodszych bitach.
+     */
+    uint64_t read(int bits);
+
+    /**
+     * @brief Odczytuje pojedynczy bit.
+     */
+    bool readBit() { return read(1) != 0; }
+
+    /**
+     * @brief Sprawdza, czy w strumieniu zostały jeszcze bity.
+     */
+    bool atEnd() const { return position >= stream.bits; }
+
+private:
+    const GorillaBitStream &stream; ///< Odczytywany strumień.
+    uint64_t position = 0;          ///< Pozycja odczytu w bitach.
+};
+
+/**
+ * @class GorillaTimestampEncoder
+ * @brief Koder znaczników czasu (delta-of-delta, kubełki 7/9/12/32/64 bity).
+ */
+class GorillaTimestampEncoder
+{
+public:
+    /**
+     * @brief Dodaje kolejny znacznik czasu.
+     * @param timestamp Znacznik czasu (np. w mikrosekundach).
+     */
+    void append(int64_t timestamp);
+
+    /**
+     * @brief Zwraca zakodowany strumień.
+     */
+    GorillaBitStream &stream() { return out; }
+    const GorillaBitStream &stream() const { return out; }
+
+private:
+    GorillaBitStream out;     ///< Strumień wyjściowy.
+    int64_t previous = 0;     ///< Poprzedni znacznik czasu.
+    int64_t previousDelta = 0;///< Poprzednia różnica czasów.
+    uint64_t count = 0;       ///< Liczba zakodowanych wartości.
+};
+
+/**
+ * @class GorillaTimestampDecoder
+ * @brief Dekoder strumienia utworzonego przez GorillaTimestampEncoder.
+ */
+class GorillaTimestampDecoder
+{
+public:
+    /**
+     * @brief Konstruktor dekodera.
+     * @param stream Strumień zakodowanych znaczników czasu.
+     */
+    explicit GorillaTimestampDecoder(const GorillaBitStream &stream) : reader(stream) {}
+
+    /**
+     * @brief Odczytuje kolejny znacznik czasu.
+     * @return Zdekodowany znacznik czasu.
+     */
+    int64_t next();
+
+private:
+    GorillaBitReader reader;   ///< Czytnik bitów.
+    int64_t previous = 0;      ///< Poprzedni znacznik czasu.
+    int64_t previousDelta = 0; ///< Poprzednia różnica czasów.
+    uint64_t count = 0;        ///< Liczba zdekodowanych wartości.
+};
+
+/**
+ * @class GorillaFloatEncoder
+ * @brief Koder wartości float (XOR z poprzednią wartością, 5 bitów zer wiodących, 5 bitów długości).
+ */
+class GorillaFloatEncoder
+{
+public:
+    /**
+     * @brief Dodaje kolejną wartość.
+     * @param value Wartość do zakodowania.
+     */
+    void append(float value);
+
+    /**
+     * @brief Zwraca zakodowany strumień.
+     */
+    GorillaBitStream &stream() { return out; }
+    const GorillaBitStream &stream() const { return out; }
+
+private:
+    GorillaBitStream out;     ///< Strumień wyjściowy.
+    uint32_t previous = 0;    ///< Bity poprzedniej wartości.
+    int previousLeading = -1; ///< Liczba zer wiodących poprzedniego okna (-1 = brak okna).
+    int previousTrailing = 0; ///< Liczba zer końcowych poprzedniego okna.
+    uint64_t count = 0;       ///< Liczba zakodowanych wartości.
+};
+
+/**
+ * @class GorillaFloatDecoder
+ * @brief Dekoder strumienia utworzonego przez GorillaFloatEncoder.
+ */
+class GorillaFloatDecoder
+{
+public:
+    /**
+     * @brief Konstruktor dekodera.
+     * @param stream Strumień zakodowanych wartości.
+     */
+    explicit GorillaFloatDecoder(const GorillaBitStream &stream) : reader(stream) {}
+
+    /**
+     * @brief Odczytuje kolejną wartość.
+     * @return Zdekodowana wartość.
+     */
+    float next();
+
+private:
+    GorillaBitReader reader;  ///< Czytnik bitów.
+    uint32_t previous = 0;    ///< Bity poprzedniej wartości.
+    int leading = 0;          ///< Liczba zer wiodących bieżącego okna.
+    int trailing = 0;         ///< Liczba zer końcowych bieżącego okna.
+    uint64_t count = 0;       ///< Liczba zdekodowanych wartości.
+};
+
+#endif // GORILLA_H
@@ -0,0 +1,34 @@
+/**
+ * @file headless.h
+ * @brief Tryb pracy bez interfejsu graficznego (uruchamiany opcją --headless).
+ *
+ * Funkcje działają w pętli zdarzeń QCoreApplication i korzystają z tych samych modułów
+ * co GUI (SerialReader, ProfileRunner, FrameDecoder), dzięki czemu wyniki są porównywalne.
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QString>
+
+/**
+ * @brief Otwiera port, wykonuje profil nastaw i kończy działanie.
+ * @param portName Nazwa portu (np. /dev/ttyUSB0).
+ * @param baudRate Prędkość transmisji [Bd].
+ * @param profilePath Plik profilu (format: setpointprofile.h).
+ * @param logPath Plik dziennika wykonania CSV (pusty = bez dziennika).
+ * @return Kod wyjścia: 0 - profil wykonany, 1 - błąd lub przerwanie.
+ */
+int runHeadlessProfile(const QString &portName, int baudRate, const QString &profilePath, const QString &logPath);
+
+/**
+ * @brief Analizuje wsadowo nagrania (.wds, .bin, .raw) z katalogu i wypisuje tabelę wskaźników.
+ * @param path Katalog z nagraniami lub pojedynczy plik.
+ * @param csvPath Plik CSV ze wskaźnikami (pusty = bez pliku).
+ * @param jobs Liczba wątków (0 = liczba rdzeni).
+ * @return Kod wyjścia: 0 - wszystkie pliki przeanalizowane, 1 - błąd któregoś pliku lub zapisu,
+ *         2 - brak plików do analizy.
+ */
+int runBatchAnalysis(const QString &path, const QString &csvPath, int jobs);
+
+#endif // HEADLESS_H
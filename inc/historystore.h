@@ -0,0 +1,228 @@
+/**
+ * @file historystore.h
+ * @brief Deklaracja klasy HistoryStore — skompresowanej historii pomiarów w pamięci.
+ *
+ * Historia składa się z dwóch warstw:
+ * - "gorącego" ogona nieskompresowanych próbek (ostatnie blockSize próbek),
+ * - zamkniętych bloków, w których czas kodowany jest metodą delta-of-delta,
+ *   a każdy kanał SerialData osobnym strumieniem XOR (Gorilla).
+ * Dzięki kolumnowemu układowi bloków pojedynczy kanał można zdekodować
+ * bez dekodowania pozostałych (np. na potrzeby wykresu).
+ *
+ * Opcjonalnie (HistoryEncoding::Quantized) kanały bloków zapisywane są stratnie jako int16/int8
+ * z krokiem dobranym do zakresu bloku i rozdzielczości czujnika (QuantizedColumn); czas
+ * pozostaje bezstratny.
+ *
+ * Retencja (setRetention()) ogranicza historię czasem lub rozmiarem bloków — najstarsze
+ * zamknięte bloki są usuwane w całości po zamknięciu kolejnego bloku.
+ */
+
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include "serialdata.h"
+#include "gorilla.h"
+#include "quantizedcolumn.h"
+#include <QPointF>
+#include <QVector>
+#include <array>
+#include <deque>
+#include <string>
+#include <variant>
+#include <vector>
+
+/**
+ * @struct HistorySample
+ * @brief Pojedyncza próbka historii: znacznik czasu i dane z mikrokontrolera.
+ */
+struct HistorySample {
+    qint64 timeUs = 0; ///< Czas próbki [us] od początku sesji.
+    SerialData data;   ///< Dane z mikrokontrolera.
+};
+
+/**
+ * @enum HistoryEncoding
+ * @brief Sposób zapisu kanałów w zamkniętych blokach historii.
+ */
+enum class HistoryEncoding {
+    Gorilla,  ///< Bezstratnie, XOR z poprzednią wartością (gorilla.h).
+    Quantized ///< Stratnie, int16 z przesunięciem i krokiem bloku (quantizedcolumn.h).
+};
+
+/**
+ * @class HistoryStore
+ * @brief Historia pomiarów z kompresją starszych bloków i nieskompresowanym ogonem.
+ */
+class HistoryStore
+{
+public:
+    /**
+     * @brief Konstruktor historii.
+     * @param blockSize Liczba próbek w jednym bloku (i maksymalny rozmiar ogona).
+     * @param encoding Sposób zapisu kanałów w blokach.
+     */
+    explicit HistoryStore(int blockSize = 1024, HistoryEncoding encoding = HistoryEncoding::Gorilla);
+
+    /**
+     * @brief Ustawia sposób zapisu kanałów; dotyczy bloków zamykanych od tej chwili.
+     */
+    void setEncoding(HistoryEncoding encoding) { mode = encoding; }
+
+    /**
+     * @brief Zwraca sposób zapisu kanałów nowych bloków.
+     */
+    HistoryEncoding encoding() const { return mode; }
+
+    /**
+     * @brief Ustawia rozdzielczość czujnika kanału — najmniejszy krok kwantyzacji (HistoryEncoding::Quantized).
+     * @param channel Kanał.
+     * @param lsb Rozdzielczość w jednostkach kanału (0 — krok tylko z zakresu bloku).
+     */
+    void setResolution(Channel channel, float lsb) { resolution[static_cast<int>(channel)] = lsb; }
+
+    /**
+     * @brief Zwraca największy zmierzony błąd kwantyzacji kanału we wszystkich blokach.
+     * @return Błąd bezwzględny w jednostkach kanału (0 dla bloków bezstratnych).
+     */
+    float maxQuantizationError(Channel channel) const { return quantizationError[static_cast<int>(channel)]; }
+
+    /**
+     * @brief Ustawia retencję historii; nadmiarowe bloki usuwane są przy zamknięciu kolejnego bloku.
+     * @param maxAgeUs Największa różnica czasu między najnowszą próbką a końcem najstarszego bloku [us] (0 — bez limitu).
+     * @param maxBytes Największy rozmiar zamkniętych bloków [bajty] (0 — bez limitu).
+     */
+    void setRetention(qint64 maxAgeUs, qint64 maxBytes);
+
+    /**
+     * @brief Zwraca liczbę próbek usuniętych przez retencję od utworzenia lub clear().
+     */
+    qint64 evictedSamples() const { return evicted; }
+
+    /**
+     * @brief Dodaje nową próbkę na koniec historii.
+     * @param timeUs Czas próbki [us]; kolejne próbki muszą mieć niemalejący czas.
+     * @param data Dane z mikrokontrolera.
+     */
+    void append(qint64 timeUs, const SerialData &data);
+
+    /**
+     * @brief Usuwa całą historię.
+     */
+    void clear();
+
+    /**
+     * @brief Zwraca liczbę wszystkich próbek w historii.
+     */
+    qint64 sampleCount() const;
+
+    /**
+     * @brief Zwraca punkty (czas [s], wartość) jednego kanału z podanego przedziału czasu.
+     *
+     * Dekodowane są tylko bloki nachodzące na przedział i tylko strumień wybranego kanału.
+     * @param channel Kanał.
+     * @param fromUs Początek przedziału [us].
+     * @param toUs Koniec przedziału [us].
+     */
+    QVector<QPointF> channelPoints(Channel channel, qint64 fromUs, qint64 toUs) const;
+
+    /**
+     * @brief Zwraca czasy i wartości wybranych kanałów z podanego przedziału czasu w układzie kolumnowym.
+     *
+     * Dekodowane są tylko strumienie czasu i wybranych kanałów; kolumny pozostałych kanałów są puste.
+     * @param selected Kanały do odczytania.
+     * @param fromUs Początek przedziału [us].
+     * @param toUs Koniec przedziału [us].
+     * @param timesUs Czasy próbek [us].
+     * @param columns Wartości kanałów (indeks = Channel), po jednej na próbkę.
+     */
+    void channelColumns(const std::vector<Channel> &selected, qint64 fromUs, qint64 toUs,
+                        std::vector<qint64> &timesUs, std::array<std::vector<float>, channelCount> &columns) const;
+
+    /**
+     * @brief Zwraca pełne próbki z podanego przedziału czasu (np. do eksportu).
+     * @param fromUs Początek przedziału [us].
+     * @param toUs Koniec przedziału [us].
+     */
+    QVector<HistorySample> samples(qint64 fromUs, qint64 toUs) const;
+
+    /**
+     * @brief Zwraca liczbę bajtów zajmowanych przez zamknięte (skompresowane) bloki.
+     */
+    qint64 compressedBytes() const;
+
+    /**
+     * @brief Zwraca liczbę próbek w zamkniętych blokach.
+     */
+    qint64 compressedSamples() const { return sealedSamples; }
+
+    /**
+     * @brief Zwraca średnią liczbę bajtów na próbkę w skompresowanych blokach.
+     * @return Bajty na próbkę lub 0, jeśli nie zamknięto jeszcze żadnego bloku.
+     */
+    double bytesPerSample() const;
+
+    /**
+     * @brief Zwraca nazwę sposobu zapisu ("gorilla", "quantized").
+     */
+    static const char *encodingName(HistoryEncoding encoding);
+
+    /**
+     * @brief Odczytuje sposób zapisu z nazwy (jak w encodingName()).
+     * @return false jeśli nazwa jest nieznana.
+     */
+    static bool parseEncoding(const std::string &name, HistoryEncoding &encoding);
+
+private:
+    using GorillaChannels = std::vector<GorillaFloatEncoder>; ///< Strumienie kanałów bloku (Gorilla).
+    using QuantizedChannels = std::vector<QuantizedColumn>;   ///< Kolumny kanałów bloku (Quantized).
+
+    /**
+     * @struct Block
+     * @brief Zamknięty, skompresowany blok historii.
+     *
+     * Blok przechowuje tylko koder swojego sposobu zapisu (channelCount elementów).
+     */
+    struct Block {
+        qint64 firstUs = 0;            ///< Czas pierwszej próbki [us].
+        qint64 lastUs = 0;             ///< Czas ostatniej próbki [us].
+        int count = 0;                 ///< Liczba próbek w bloku.
+        qint64 bytes = 0;              ///< Rozmiar bloku [bajty].
+        GorillaTimestampEncoder time;  ///< Strumień czasu.
+        std::variant<GorillaChannels, QuantizedChannels> channels; ///< Kanały w sposobie zapisu bloku.
+    };
+
+    /**
+     * @brief Kompresuje ogon do nowego bloku i czyści ogon.
+     */
+    void sealTail();
+
+    /**
+     * @brief Usuwa najstarsze bloki przekraczające retencję (najnowszy blok zostaje zawsze).
+     */
+    void evictBlocks();
+
+    /**
+     * @brief Dekoduje blok do pełnych próbek z przedziału czasu.
+     */
+    void decodeBlock(const Block &block, qint64 fromUs, qint64 toUs, QVector<HistorySample> &out) const;
+
+    /**
+     * @brief Dekoduje wszystkie wartości jednego kanału bloku.
+     * @param out Wektor wynikowy (block.count elementów).
+     */
+    static void decodeChannel(const Block &block, int channel, std::vector<float> &out);
+
+    int blockSize;               ///< Liczba próbek w bloku.
+    HistoryEncoding mode;        ///< Sposób zapisu kanałów nowych bloków.
+    std::deque<Block> blocks;    ///< Zamknięte bloki (posortowane po czasie).
+    QVector<HistorySample> tail; ///< Nieskompresowany ogon.
+    qint64 sealedSamples = 0;    ///< Liczba próbek w blokach.
+    qint64 sealedBytes = 0;      ///< Rozmiar bloków w bajtach.
+    qint64 retentionUs = 0;      ///< Retencja czasu [us] (0 — bez limitu).
+    qint64 retentionBytes = 0;   ///< Retencja rozmiaru bloków [bajty] (0 — bez limitu).
+    qint64 evicted = 0;          ///< Próbki usunięte przez retencję.
+    std::array<float, channelCount> resolution = {};        ///< Rozdzielczość czujników kanałów (0 — brak).
+    std::array<float, channelCount> quantizationError = {}; ///< Największy błąd kwantyzacji kanałów.
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,81 @@
+/**
+ * @file latencyhistogram.h
+ * @brief Deklaracja klasy LatencyHistogram — histogramu czasów (opóźnień) w nanosekundach.
+ *
+ * Histogram ma logarytmiczne kubełki (4 podkubełki na każdą potęgę dwójki, błąd względny do 25%)
+ * i atomowe liczniki, dzięki czemu jeden wątek może zapisywać próbki (np. wątek odbioru danych),
+ * a inny (GUI) jednocześnie odczytywać statystyki bez blokad.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class LatencyHistogram
+ * @brief Bezblokadowy histogram opóźnień.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Dodaje pomiar.
+     * @param ns Czas [ns]; wartości ujemne traktowane są jako 0.
+     */
+    void record(int64_t ns);
+
+    /**
+     * @brief Zwraca liczbę pomiarów.
+     */
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca sumę wszystkich pomiarów [ns] (dokładnie, bez zaokrągleń średniej).
+     */
+    uint64_t sumNs() const { return sum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca średnią [ns] lub 0, jeśli brak pomiarów.
+     */
+    double meanNs() const;
+
+    /**
+     * @brief Zwraca największy zarejestrowany czas [ns].
+     */
+    int64_t maxNs() const { return maximum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca przybliżony percentyl (górną granicę kubełka) [ns].
+     * @param percentile Percentyl w zakresie 0-100.
+     */
+    int64_t percentileNs(double percentile) const;
+
+    /**
+     * @brief Zeruje histogram.
+     */
+    void reset();
+
+private:
+    static constexpr int subBuckets = 4;              ///< Podkubełki na potęgę dwójki.
+    static constexpr int bucketCount = 64 * subBuckets; ///< Liczba kubełków.
+
+    /**
+     * @brief Zwraca indeks kubełka dla czasu.
+     */
+    static int bucketIndex(uint64_t ns);
+
+    /**
+     * @brief Zwraca górną granicę kubełka [ns].
+     */
+    static int64_t bucketUpperBound(int index);
+
+    std::array<std::atomic<uint64_t>, bucketCount> buckets{}; ///< Liczniki kubełków.
+    std::atomic<uint64_t> total{0};   ///< Liczba pomiarów.
+    std::atomic<uint64_t> sum{0};     ///< Suma czasów [ns].
+    std::atomic<int64_t> maximum{0};  ///< Największy czas [ns].
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,190 @@
+/**
+ * @file limitmonitor.h
+ * @brief Deklaracja klasy LimitMonitor — progów alarmowych sprawdzanych dla każdej odebranej ramki.
+ *
+ * Reguła opisywana jest tekstem:
+ *
+ *     <kanał><op><wartość>[:stop][:n=<N>]      — próg wartości, op: > lub <
+ *     d(<kanał>)><wartość>[:stop][:n=<N>]      — próg szybkości zmian |d/dt| [jednostka/s]
+ *
+ * np. "current>900:stop", "voltage<6", "d(rpm)>3000:stop:n=3". Flaga stop oznacza zatrzymanie
+ * awaryjne, a n — liczbę kolejnych próbek spełniających warunek potrzebną do wyzwolenia (domyślnie 1).
+ * Reguła wyzwala się raz i uzbraja ponownie, gdy warunek przestanie być spełniony.
+ *
+ * Dla każdego wyzwolenia zapisywany jest rekord alarmu z próbkami sprzed i po zdarzeniu.
+ * Plik nie zależy od Qt.
+ */
+
+#ifndef LIMITMONITOR_H
+#define LIMITMONITOR_H
+
+#include "serialdata.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @struct LimitRule
+ * @brief Pojedyncza reguła alarmowa.
+ */
+struct LimitRule {
+    /**
+     * @brief Rodzaj warunku.
+     */
+    enum class Kind {
+        Above,    ///< Wartość powyżej progu.
+        Below,    ///< Wartość poniżej progu.
+        RateAbove ///< Moduł szybkości zmian powyżej progu [jednostka/s].
+    };
+
+    Channel channel = Channel::Current; ///< Sprawdzany kanał.
+    Kind kind = Kind::Above;            ///< Rodzaj warunku.
+    float threshold = 0.0f;             ///< Próg.
+    bool emergencyStop = false;         ///< Czy wyzwolenie zatrzymuje silnik.
+    int holdSamples = 1;                ///< Liczba kolejnych próbek potrzebnych do wyzwolenia.
+    std::string text;                   ///< Opis reguły w postaci znormalizowanej.
+
+    /**
+     * @brief Tworzy regułę z opisu tekstowego (format w nagłówku pliku).
+     * @param spec Opis reguły.
+     * @param error Opis błędu.
+     * @return true jeśli opis jest poprawny.
+     */
+    bool parse(const std::string &spec, std::string &error);
+};
+
+/**
+ * @struct LimitEvent
+ * @brief Wyzwolenie reguły w sprawdzonej partii próbek.
+ */
+struct LimitEvent {
+    size_t rule = 0;            ///< Indeks reguły.
+    size_t sampleIndex = 0;     ///< Indeks próbki w partii.
+    float value = 0.0f;         ///< Wartość (lub szybkość zmian), która przekroczyła próg.
+    bool emergencyStop = false; ///< Czy reguła wymaga zatrzymania awaryjnego.
+};
+
+/**
+ * @struct AlarmRecord
+ * @brief Rekord alarmu: reguła, czasy reakcji i próbki wokół zdarzenia.
+ */
+struct AlarmRecord {
+    std::string rule;               ///< Opis reguły.
+    float value = 0.0f;             ///< Wartość, która przekroczyła próg.
+    bool emergencyStop = false;     ///< Czy wysłano zatrzymanie awaryjne.
+    int64_t sampleTimeUs = 0;       ///< Czas próbki wyzwalającej [µs, zegar monotoniczny hosta].
+    int64_t arrivalNs = 0;          ///< Czas odebrania porcji z próbką wyzwalającą [ns].
+    int64_t detectedNs = 0;         ///< Czas wykrycia przekroczenia [ns].
+    int64_t commandNs = 0;          ///< Czas zapisania polecenia zatrzymania do portu [ns] (0 = brak).
+    std::vector<SerialData> samples; ///< Próbki przed zdarzeniem, próbka wyzwalająca i próbki po nim.
+    size_t triggerIndex = 0;        ///< Indeks próbki wyzwalającej w samples.
+
+    /**
+     * @brief Zapisuje rekord w formacie CSV (nagłówek z opisem zdarzenia w komentarzach '#').
+     * @param path Ścieżka pliku.
+     * @return true jeśli zapis się powiódł.
+     */
+    bool writeCsv(const std::string &path) const;
+};
+
+/**
+ * @class LimitMonitor
+ * @brief Sprawdza reguły alarmowe dla partii próbek i zbiera rekordy alarmów.
+ *
+ * Nie jest bezpieczna wątkowo — SerialReader wywołuje ją w wątku odbioru pod własną blokadą.
+ */
+class LimitMonitor
+{
+public:
+    /**
+     * @brief Konstruktor.
+     * @param preSamples Liczba próbek zapisywanych przed zdarzeniem.
+     * @param postSamples Liczba próbek zapisywanych po zdarzeniu.
+     */
+    explicit LimitMonitor(size_t preSamples = 250, size_t postSamples = 250);
+
+    /**
+     * @brief Zastępuje zestaw reguł; przy błędzie którejkolwiek reguły zestaw pozostaje bez zmian.
+     * @param specs Opisy reguł.
+     * @param error Opis błędu.
+     * @return true jeśli wszystkie opisy są poprawne.
+     */
+    bool setRules(const std::vector<std::string> &specs, std::string &error);
+
+    /**
+     * @brief Zwraca reguły.
+     */
+    const std::vector<LimitRule> &rules() const { return limits; }
+
+    /**
+     * @brief Sprawdza partię próbek (w kolejności czasu).
+     *
+     * Dla każdego wyzwolenia dopisuje zdarzenie do events i rozpoczyna rekord alarmu.
+     * @param samples Próbki (surowe, z ustawionym SerialData::timeUs).
+     * @param count Liczba próbek.
+     * @param arrivalNs Czas odebrania porcji [ns].
+     * @param events Wyzwolenia (lista jest najpierw czyszczona).
+     * @return Liczba rekordów alarmów ukończonych w tym wywołaniu (do odebrania przez takeCompleted()).
+     */
+    size_t check(const SerialData *samples, size_t count, int64_t arrivalNs, std::vector<LimitEvent> &events);
+
+    /**
+     * @brief Uzupełnia czasy wykrycia i wysłania polecenia w rekordach rozpoczętych przez ostatnie check().
+     * @param detectedNs Czas wykrycia [ns].
+     * @param commandNs Czas zapisania polecenia zatrzymania [ns] (0 = brak).
+     */
+    void markReaction(int64_t detectedNs, int64_t commandNs);
+
+    /**
+     * @brief Pobiera najstarszy ukończony rekord alarmu (zebrano próbki po zdarzeniu).
+     * @param record Rekord.
+     * @return false jeśli nie ma ukończonych rekordów.
+     */
+    bool takeCompleted(AlarmRecord &record);
+
+    /**
+     * @brief Zapomina historię próbek i stan reguł (np. po ponownym połączeniu).
+     */
+    void reset();
+
+private:
+    /**
+     * @brief Stan reguły między partiami.
+     */
+    struct RuleState {
+        int hits = 0;             ///< Kolejne próbki spełniające warunek.
+        bool fired = false;       ///< Czy reguła jest wyzwolona (czeka na ustąpienie warunku).
+        bool hasPrevious = false; ///< Czy znana jest poprzednia próbka (szybkość zmian).
+        float previous = 0.0f;    ///< Poprzednia wartość kanału.
+        int64_t previousUs = 0;   ///< Czas poprzedniej próbki [µs].
+    };
+
+    /**
+     * @brief Rekord w trakcie zbierania próbek po zdarzeniu.
+     */
+    struct Pending {
+        AlarmRecord record;      ///< Rekord.
+        size_t remaining = 0;    ///< Liczba próbek do zebrania.
+        bool fresh = true;       ///< Czy rekord pochodzi z ostatniego check() (markReaction()).
+    };
+
+    /**
+     * @brief Sprawdza warunek reguły dla próbki.
+     * @param value Wartość (lub szybkość zmian) porównywana z progiem.
+     * @return true jeśli warunek jest spełniony.
+     */
+    bool evaluate(const LimitRule &rule, RuleState &state, const SerialData &sample, float &value) const;
+
+    size_t preSamples;                ///< Liczba próbek przed zdarzeniem.
+    size_t postSamples;               ///< Liczba próbek po zdarzeniu.
+    std::vector<LimitRule> limits;    ///< Reguły.
+    std::vector<RuleState> states;    ///< Stan reguł.
+    std::deque<SerialData> recent;    ///< Ostatnie próbki (do preSamples).
+    std::vector<Pending> pending;     ///< Rekordy zbierające próbki po zdarzeniu.
+    std::deque<AlarmRecord> completed; ///< Ukończone rekordy.
+};
+
+#endif // LIMITMONITOR_H
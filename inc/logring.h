@@ -0,0 +1,252 @@
+/**
+ * @file logring.h
+ * @brief Dziennik w pamięci: binarne rekordy w buforze cyklicznym z formatowaniem odroczonym.
+ *
+ * Makra LOG_DEBUG / LOG_INFO / LOG_WARNING / LOG_ERROR("tekst {} i {}", a, b) zapisują do
+ * wstępnie zaalokowanego bufora jedynie czas, wskaźnik miejsca wywołania i surowe argumenty
+ * (liczby, krótkie teksty). Tekst składany jest dopiero przy odczycie (panel diagnostyczny,
+ * zapis do pliku). Każde miejsce wywołania ma własny limit liczby komunikatów na sekundę;
+ * nadmiarowe są zliczane i raportowane w kolejnym rekordzie z tego miejsca lub w podsumowaniu.
+ *
+ * Zapis nie blokuje: miejsce w buforze rezerwowane jest licznikiem atomowym, a spójność
+ * rekordu przy odczycie sprawdzana numerem sekwencji (najstarsze rekordy są nadpisywane).
+ * Dziennik jest całkowicie usuwany z kodu przy budowie bez WDS_LOG (opcja CMake
+ * WDS_ENABLE_LOG=OFF); gdy jest wkompilowany, a poziom wyłączony, koszt to jeden odczyt
+ * zmiennej atomowej. Plik nie zależy od Qt.
+ */
+
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @enum LogLevel
+ * @brief Poziom ważności komunikatu.
+ */
+enum class LogLevel : uint8_t {
+    Debug,   ///< Szczegóły diagnostyczne.
+    Info,    ///< Informacja.
+    Warning, ///< Ostrzeżenie.
+    Error,   ///< Błąd.
+    Off      ///< Próg wyłączający dziennik.
+};
+
+/**
+ * @brief Zwraca nazwę poziomu ("DEBUG", "INFO", ...).
+ */
+const char *logLevelName(LogLevel level);
+
+/**
+ * @struct LogSite
+ * @brief Miejsce wywołania makra LOG_* (obiekt statyczny) wraz ze stanem limitu.
+ *
+ * Miejsca rejestrują się przy pierwszym komunikacie na liście odczytywanej przez Log::sites().
+ */
+struct LogSite {
+    const char *file;                    ///< Plik źródłowy.
+    int line;                            ///< Wiersz.
+    LogLevel level;                      ///< Poziom komunikatu.
+    const char *format;                  ///< Szablon tekstu ("{}" = kolejny argument).
+    std::atomic<int64_t> windowStartNs{0};  ///< Początek bieżącego okna limitu [ns].
+    std::atomic<uint32_t> windowCount{0};   ///< Komunikaty zapisane w bieżącym oknie.
+    std::atomic<uint32_t> suppressed{0};    ///< Komunikaty pominięte, jeszcze niezgłoszone.
+    std::atomic<uint64_t> written{0};       ///< Komunikaty zapisane łącznie.
+    std::atomic<uint64_t> suppressedTotal{0}; ///< Komunikaty pominięte i już zgłoszone (bez suppressed).
+    std::atomic<bool> registered{false};    ///< Czy miejsce jest na liście Log::sites().
+    LogSite *next = nullptr;                ///< Następne zarejestrowane miejsce.
+
+    constexpr LogSite(const char *file, int line, LogLevel level, const char *format)
+        : file(file), line(line), level(level), format(format) {}
+};
+
+/**
+ * @struct LogArg
+ * @brief Argument komunikatu zapisany w postaci binarnej.
+ */
+struct LogArg {
+    /**
+     * @brief Rodzaj argumentu.
+     */
+    enum class Type : uint8_t {
+        Int,    ///< Liczba całkowita (int64).
+        Double, ///< Liczba zmiennoprzecinkowa.
+        Text    ///< Tekst w LogRecord::text od przesunięcia offset.
+    };
+    Type type = Type::Int; ///< Rodzaj.
+    union {
+        int64_t i;         ///< Wartość Int.
+        double d;          ///< Wartość Double.
+        uint32_t offset;   ///< Przesunięcie tekstu (Text).
+    };
+    LogArg() : i(0) {}
+};
+
+/**
+ * @struct LogRecord
+ * @brief Rekord dziennika o stałym rozmiarze (bez alokacji).
+ */
+struct LogRecord {
+    static constexpr int maxArgs = 4;     ///< Maksymalna liczba argumentów.
+    static constexpr int textSize = 160;  ///< Miejsce na teksty argumentów (z zerami kończącymi).
+
+    int64_t timeNs = 0;          ///< Czas zapisu [ns, zegar monotoniczny].
+    const LogSite *site = nullptr; ///< Miejsce wywołania.
+    uint32_t suppressed = 0;     ///< Komunikaty z tego miejsca pominięte przed tym rekordem.
+    uint16_t threadId = 0;       ///< Numer wątku (kolejność pierwszego zapisu).
+    uint8_t argCount = 0;        ///< Liczba argumentów.
+    uint8_t textUsed = 0;        ///< Zajęta część text.
+    bool summary = false;        ///< Rekord podsumowania pominiętych komunikatów (bez argumentów).
+    LogArg args[maxArgs];        ///< Argumenty.
+    char text[textSize];         ///< Teksty argumentów.
+
+    /// Dodaje argument liczbowy całkowity.
+    void add(int64_t value) {
+        if (argCount < maxArgs) {
+            args[argCount].type = LogArg::Type::Int;
+            args[argCount++].i = value;
+        }
+    }
+    /// Dodaje argument zmiennoprzecinkowy.
+    void add(double value) {
+        if (argCount < maxArgs) {
+            args[argCount].type = LogArg::Type::Double;
+            args[argCount++].d = value;
+        }
+    }
+    /// Dodaje tekst (obcinany do wolnego miejsca w text).
+    void add(const char *value, size_t length);
+};
+
+/**
+ * @class Log
+ * @brief Globalny dziennik w pamięci.
+ */
+class Log
+{
+public:
+    /// Pojemność bufora w rekordach (potęga dwójki).
+    static constexpr size_t capacity = 8192;
+
+    /**
+     * @brief Czy komunikaty danego poziomu są zapisywane.
+     */
+    static bool isEnabled(LogLevel level) {
+        return static_cast<uint8_t>(level) >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Ustawia najniższy zapisywany poziom (LogLevel::Off wyłącza dziennik).
+     */
+    static void setLevel(LogLevel level);
+
+    /**
+     * @brief Ustawia limit komunikatów z jednego miejsca na sekundę (0 = bez limitu).
+     */
+    static void setRateLimit(uint32_t perSecond);
+
+    /**
+     * @brief Zapisuje komunikat z argumentami (wywoływane przez makra LOG_*).
+     * @return false jeśli komunikat został pominięty przez limit.
+     */
+    template <typename... Args>
+    static bool write(LogSite &site, const Args &...args) {
+        LogRecord *record = begin(site);
+        if (!record)
+            return false;
+        (append(*record, args), ...);
+        commit(record);
+        return true;
+    }
+
+    /**
+     * @brief Odczytuje rekordy od pozycji cursor (aktualizowanej) do bieżącego końca dziennika.
+     * @param cursor Numer kolejnego rekordu do odczytu (początkowo 0).
+     * @param out Wektor, na którego koniec dopisywane są rekordy.
+     * @param maxRecords Maksymalna liczba odczytanych rekordów.
+     * @return Liczba rekordów utraconych (nadpisanych przed odczytem).
+     */
+    static uint64_t read(uint64_t &cursor, std::vector<LogRecord> &out, size_t maxRecords = capacity);
+
+    /**
+     * @brief Zapisuje rekordy podsumowania dla miejsc, których okno limitu minęło z pominiętymi komunikatami.
+     */
+    static void flushSuppressed();
+
+    /**
+     * @brief Zwraca zarejestrowane miejsca wywołania (do zestawienia w panelu).
+     */
+    static std::vector<const LogSite *> sites();
+
+    /**
+     * @brief Składa tekst rekordu: "[czas s] POZIOM tekst (pominięto N)".
+     */
+    static std::string format(const LogRecord &record);
+
+    /**
+     * @brief Zapisuje wszystkie rekordy z bufora do pliku tekstowego.
+     * @return true jeśli zapis się powiódł.
+     */
+    static bool dump(const std::string &path);
+
+    /**
+     * @brief Czas procesu w chwili utworzenia dziennika [ns] (początek osi czasu rekordów).
+     */
+    static int64_t startNs();
+
+private:
+    /**
+     * @brief Sprawdza limit i rezerwuje rekord (nullptr = komunikat pominięty).
+     */
+    static LogRecord *begin(LogSite &site);
+
+    /**
+     * @brief Publikuje wypełniony rekord.
+     */
+    static void commit(LogRecord *record);
+
+    template <typename T>
+    static void append(LogRecord &record, const T &value) {
+        if constexpr (std::is_same_v<T, bool>)
+            record.add(static_cast<int64_t>(value));
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            record.add(static_cast<int64_t>(value));
+        else if constexpr (std::is_floating_point_v<T>)
+            record.add(static_cast<double>(value));
+        else if constexpr (std::is_convertible_v<T, const char *>)
+            record.add(static_cast<const char *>(value), std::strlen(value));
+        else
+            record.add(value.data(), value.size());
+    }
+
+    static std::atomic<uint8_t> minimumLevel; ///< Najniższy zapisywany poziom.
+};
+
+#define LOG_CONCAT_INNER(a, b) a##b
+#define LOG_CONCAT(a, b) LOG_CONCAT_INNER(a, b)
+
+#ifdef WDS_LOG
+/// Zapisuje komunikat o poziomie level (argumenty nie są obliczane, gdy poziom jest wyłączony).
+#define LOG_AT(level, format, ...)                                                                \
+    do {                                                                                          \
+        if (Log::isEnabled(level)) {                                                              \
+            static LogSite LOG_CONCAT(logSite, __LINE__)(__FILE__, __LINE__, level, format);      \
+            Log::write(LOG_CONCAT(logSite, __LINE__), ##__VA_ARGS__);                             \
+        }                                                                                         \
+    } while (0)
+#else
+#define LOG_AT(level, format, ...) do {} while (0)
+#endif
+
+#define LOG_DEBUG(format, ...) LOG_AT(LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_AT(LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...) LOG_AT(LogLevel::Warning, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_AT(LogLevel::Error, format, ##__VA_ARGS__)
+
+#endif // LOGRING_H
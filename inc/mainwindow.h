@@ -11,6 +11,15 @@
 
 #include "serialreader.h"
 #include "chartsmanager.h"
+#include "historystore.h"
+#include "portwatcher.h"
+#include "metricsexporter.h"
+#include "profilerunner.h"
+#include "derivedchannel.h"
+#include "diagnosticspanel.h"
+#include "plantpanel.h"
+#include "sessionfile.h"
+#include "stallwatchdog.h"
 #include <QElapsedTimer>
 #include <QMainWindow>
 #include <QSerialPort>
@@ -52,13 +61,87 @@ public:
      */
     ~MainWindow();
 
-private slots:
+    /**
+     * @brief Uruchamia eksporter metryk Prometheus (port TCP na localhost i/lub gniazdo lokalne).
+     * @param tcpPort Port TCP (0 = bez serwera TCP).
+     * @param socketPath Ścieżka gniazda lokalnego (pusta = bez gniazda).
+     * @return true jeśli uruchomiono wszystkie żądane serwery.
+     */
+    bool startMetricsExporter(quint16 tcpPort, const QString &socketPath);
+
+    /**
+     * @brief Włącza udostępnianie telemetrii w pamięci współdzielonej (jak opcja w menu Narzędzia).
+     */
+    void enableSharedMemory();
+
+    /**
+     * @brief Ustawia łańcuch filtrów kanału z przypisania "<kanał>=<opis>", np. "current=median:5,ema:0.2".
+     * @param assignment Przypisanie (nazwy kanałów: channelName(), format opisu: signalfilter.h).
+     * @return true jeśli przypisanie jest poprawne.
+     */
+    bool setChannelFilter(const QString &assignment);
 
     /**
-     * @brief Obsługuje nowe dane odebrane z portu szeregowego.
-     * @param data Struktura SerialData z danymi.
+     * @brief Zastępuje zestaw kanałów pochodnych i ich wykresów.
+     *
+     * Przy błędzie którejkolwiek definicji dotychczasowe kanały pozostają bez zmian.
+     * @param definitions Definicje "<nazwa> = <wyrażenie>" (składnia: derivedchannel.h).
+     * @return true jeśli wszystkie definicje są poprawne.
      */
-    void handleNewSerialData(const SerialData &data);
+    bool setDerivedChannels(const QStringList &definitions);
+
+    /**
+     * @brief Ustawia reguły alarmowe sprawdzane w wątku odbioru (składnia: limitmonitor.h).
+     *
+     * Przy błędzie którejkolwiek reguły dotychczasowe reguły pozostają bez zmian.
+     * @param specs Opisy reguł, np. "current>900:stop".
+     * @return true jeśli wszystkie opisy są poprawne.
+     */
+    bool setLimitRules(const QStringList &specs);
+
+    /**
+     * @brief Ustawia limity buforów odbioru i politykę usuwania nadmiaru próbek (samplequeue.h).
+     * @param policy Nazwa polityki: "oldest", "newest" lub "decimate".
+     * @param queueFrames Pojemność kolejki próbek do GUI (0 = bez zmian).
+     * @param readBufferBytes Limit bufora odczytu QSerialPort [bajty] (-1 = bez zmian, 0 = bez limitu).
+     * @return true jeśli nazwa polityki jest poprawna.
+     */
+    bool setBackpressure(const QString &policy, int queueFrames, qint64 readBufferBytes);
+
+    /**
+     * @brief Ustawia sposób zapisu historii pomiarów (historystore.h) i rozdzielczość czujników.
+     *
+     * Dotyczy bloków historii zamykanych od tej chwili.
+     * @param encoding Nazwa: "gorilla" (bezstratnie) lub "quantized" (int16/int8).
+     * @param resolutions Przypisania "<kanał>=<LSB>", np. "voltage=0.004" (najmniejszy krok kwantyzacji).
+     * @return true jeśli nazwa i wszystkie przypisania są poprawne.
+     */
+    bool setHistoryEncoding(const QString &encoding, const QStringList &resolutions);
+
+    static constexpr int defaultHistoryMinutes = 60;    ///< Domyślna retencja historii [min].
+    static constexpr int defaultHistoryMegabytes = 256; ///< Domyślny limit rozmiaru jednej historii [MiB].
+
+    /**
+     * @brief Ustawia retencję historii pomiarów (obu warstw: surowej i po filtrach).
+     * @param minutes Najdłuższy przechowywany okres [min] (0 — bez limitu czasu).
+     * @param megabytes Największy rozmiar skompresowanych bloków jednej historii [MiB] (0 — bez limitu).
+     */
+    void setHistoryRetention(int minutes, int megabytes);
+
+    /**
+     * @brief Rozpoczyna nagrywanie odbieranych próbek do pliku sesji (.wds).
+     * @param path Ścieżka pliku.
+     * @return true jeśli plik został utworzony.
+     */
+    bool startSessionRecording(const QString &path);
+
+    /**
+     * @brief Otwiera nowe okno przeglądarki sesji.
+     * @param paths Nagrania otwierane od razu (mogą być puste).
+     */
+    void openSessionViewer(const QStringList &paths = QStringList());
+
+private slots:
 
     /**
      * @brief Obsługuje błędy komunikacji szeregowej.
@@ -71,6 +154,12 @@ private slots:
      */
     void handlePortDisconnected();
 
+    /**
+     * @brief Obsługuje wynik automatycznego wykrywania prędkości transmisji.
+     * @param baudRate Wykryta prędkość [Bd].
+     */
+    void handleBaudRateDetected(int baudRate);
+
     /**
      * @brief Obsługuje zmianę wartości suwaka PWM w trybie manualnym.
      * @param value Wartość PWM w zakresie 0-100%.
@@ -98,15 +187,103 @@ private slots:
     void on_ConnectPortClicked();
 
     /**
-     * @brief Obsługuje przycisk Odśwież porty.
+     * @brief Obsługuje przycisk Odśwież porty (zleca enumerację w tle).
      */
     void refreshSerialPortList();
 
+    /**
+     * @brief Dodaje port zgłoszony przez PortWatcher do listy wyboru.
+     * @param port Opis portu.
+     */
+    void handlePortAdded(const PortDescriptor &port);
+
+    /**
+     * @brief Usuwa port zgłoszony przez PortWatcher z listy wyboru.
+     * @param systemLocation Ścieżka portu.
+     */
+    void handlePortRemoved(const QString &systemLocation);
+
+    /**
+     * @brief Obsługuje nagłe odłączenie urządzenia i przygotowuje automatyczne ponowne połączenie.
+     */
+    void handleDeviceLost();
+
+    /**
+     * @brief Zapisuje zebrany ślad wykonania do pliku JSON wybranego przez użytkownika.
+     */
+    void saveTrace();
+
+    /**
+     * @brief Otwiera okno konfiguracji filtrów kanałów.
+     */
+    void editFilters();
+
+    /**
+     * @brief Otwiera okno definicji kanałów pochodnych.
+     */
+    void editDerivedChannels();
+
+    /**
+     * @brief Otwiera okno reguł alarmowych.
+     */
+    void editLimits();
+
+    /**
+     * @brief Obsługuje wyzwolenie reguły alarmowej (zatrzymanie awaryjne zostało już wysłane).
+     * @param rule Opis reguły.
+     * @param value Wartość, która przekroczyła próg.
+     * @param emergencyStop Czy wysłano zatrzymanie awaryjne.
+     * @param reactionNs Czas od odebrania danych do zapisania zatrzymania do portu [ns].
+     */
+    void handleLimitExceeded(const QString &rule, float value, bool emergencyStop, qint64 reactionNs);
+
+    /**
+     * @brief Zapisuje ukończone rekordy alarmów do plików CSV.
+     */
+    void saveAlarmRecords();
+
+    /**
+     * @brief Zdejmuje blokadę po zatrzymaniu awaryjnym.
+     */
+    void clearEmergencyStop();
+
+    /**
+     * @brief Włącza lub wyłącza nagrywanie sesji (plik w katalogu sessions w danych aplikacji).
+     * @param enabled Czy nagrywać.
+     */
+    void setSessionRecording(bool enabled);
+
+    /**
+     * @brief Kończy nagrywanie sesji i zapisuje indeks pliku.
+     */
+    void stopSessionRecording();
+
+    /**
+     * @brief Wczytuje plik profilu nastaw wybrany przez użytkownika i uruchamia jego wykonanie.
+     */
+    void runProfile();
+
+    /**
+     * @brief Przerywa wykonywanie profilu nastaw.
+     */
+    void stopProfile();
+
+    /**
+     * @brief Raportuje jitter i zapisuje dziennik po zakończeniu profilu (wątek GUI).
+     * @param completed false jeśli profil został przerwany.
+     */
+    void handleProfileFinished(bool completed);
+
     /**
      * @brief Obsługuje przycisk Zapisz wartości PID.
      */
     void on_buttonSavePID_clicked();
 
+    /**
+     * @brief Wpisuje nastawy zaproponowane przez identyfikację obiektu do pól PID (bez wysyłania).
+     */
+    void applySuggestedGains(double kp, double ki, double kd);
+
     /**
      * @brief Przełącza interfejs na język polski.
      */
@@ -129,6 +306,20 @@ private:
      */
     void configureInitialMode();
 
+    /**
+     * @brief Obsługuje porcję próbek z magistrali SerialReader::dataBus() (historia, nagrywanie).
+     * @param samples Próbki surowe i po filtrach kanałów.
+     * @param count Liczba próbek.
+     */
+    void handleSampleBatch(const SamplePair *samples, size_t count);
+
+    /**
+     * @brief Obsługuje porcję próbek z magistrali SerialReader::displayBus() (wartości bieżące).
+     * @param samples Próbki surowe i po filtrach kanałów.
+     * @param count Liczba próbek.
+     */
+    void handleDisplayBatch(const SamplePair *samples, size_t count);
+
     /**
      * @brief Ustawia walidatory pól edycji dla parametrów PID.
      */
@@ -154,6 +345,19 @@ private:
      */
     void setupCharts();
 
+    /**
+     * @brief Oblicza kanał pochodny dla próbek historii z przedziału czasu (odtwarzanie wykresu).
+     * @param index Numer kanału pochodnego.
+     * @param fromSeconds Początek przedziału [s].
+     * @param toSeconds Koniec przedziału [s].
+     */
+    QVector<QPointF> derivedHistory(int index, qreal fromSeconds, qreal toSeconds) const;
+
+    /**
+     * @brief Pokazuje wykresy pojedyncze lub zbiorczy zgodnie z menu "Wykresy".
+     */
+    void updateChartVisibility();
+
     /**
      * @brief Konfiguruje i uruchamia timery aktualizujące GUI i wykresy.
      */
@@ -164,18 +368,76 @@ private:
      */
     void retranslateCharts();
 
+    /**
+     * @brief Zapisuje dane połączonego portu i aktualizuje GUI po nawiązaniu połączenia.
+     * @param portName Nazwa portu.
+     */
+    void markConnected(const QString &portName);
+
+    /**
+     * @brief Próbuje ponownie połączyć się z urządzeniem po jego ponownym podłączeniu.
+     * @param port Opis portu.
+     * @param attempt Numer próby (od 0).
+     */
+    void reconnectDevice(const PortDescriptor &port, int attempt);
+
+    /**
+     * @brief Przywraca tryb i nastawy zapamiętane przy odłączeniu urządzenia (silnik pozostaje zatrzymany).
+     */
+    void restoreSession();
+
+    /**
+     * @struct SessionState
+     * @brief Ustawienia sesji zapamiętywane przy nagłym odłączeniu urządzenia.
+     */
+    struct SessionState {
+        qint32 baudRate = 115200;  ///< Prędkość transmisji.
+        bool manualMode = true;    ///< Tryb pracy (true = manualny).
+        bool motorRunning = false; ///< Czy silnik był uruchomiony.
+        int pwmPercent = 0;        ///< Nastawa PWM [%] (tryb manualny).
+        int targetRpm = 0;         ///< Zadane RPM (tryb automatyczny).
+        float kp = 0.0f;           ///< Wzmocnienie Kp.
+        float ki = 0.0f;           ///< Wzmocnienie Ki.
+        float kd = 0.0f;           ///< Wzmocnienie Kd.
+        bool gainsKnown = false;   ///< Czy nastawy PID pochodzą z telemetrii (odebrano próbkę przed odłączeniem).
+    };
+
     Ui::MainWindow *ui;                 ///< Wskaźnik na interfejs użytkownika (GUI).
     SerialReader *serialReader;         ///< Obiekt do komunikacji szeregowej.
+    int sampleSubscription = 0;         ///< Identyfikator subskrypcji magistrali próbek.
+    int displaySubscription = 0;        ///< Identyfikator subskrypcji magistrali próbek do wyświetlenia.
     QElapsedTimer elapsed;              ///< Timer odmierzający czas od uruchomienia aplikacji.
+    qint64 timelineOriginUs = 0;        ///< Chwila startu elapsed [µs, zegar monotoniczny] — początek osi czasu historii.
     QTimer *updateChartsTimer;          ///< Timer do odświeżania wykresów.
     QTimer *updateGUITimer;             ///< Timer do odświeżania GUI.
     ChartsManager *charts;              ///< Obiekt do zarządzania wykresami.
     SerialData latestData;              ///< Ostatnie dane odebrane z mikrokontrolera.
+    HistoryStore history;               ///< Skompresowana historia wszystkich odebranych próbek.
+    HistoryStore filteredHistory;       ///< Historia próbek po filtrach kanałów (źródło wykresów).
     QString currentPortName;            ///< Nazwa aktualnie podłączonego portu.
     qint32 currentBaudRate = 115200;    ///< Aktualna prędkość transmisji (domyślnie 115200).
     bool isManualMode = true;           ///< Tryb pracy (true = manualny, false = automatyczny).
     bool isMotorRunning = false;        ///< Stan pracy silnika (true = uruchomiony).
     bool isPortConnected = false;       ///< Status połączenia z portem szeregowym.
     QTranslator translator;             ///< Tłumacz (translator) do zmiany języka interfejsu.
+    PortWatcher *portWatcher;           ///< Obserwator portów szeregowych działający w tle.
+    QMap<QString, PortDescriptor> availablePorts; ///< Porty zgłoszone przez obserwatora.
+    PortDescriptor connectedDevice;     ///< Urządzenie ostatnio połączone (do ponownego połączenia).
+    SessionState savedSession;          ///< Ustawienia zapamiętane przy odłączeniu urządzenia.
+    bool telemetryReceived = false;     ///< Czy od połączenia odebrano próbkę (latestData pochodzi z urządzenia).
+    bool reconnectPending = false;      ///< Czy oczekujemy na ponowne podłączenie urządzenia.
+    QElapsedTimer reconnectTimer;       ///< Czas od odłączenia urządzenia (pomiar czasu ponownego połączenia).
+    int targetRpm = 0;                  ///< Ostatnio zadana prędkość obrotowa (tryb automatyczny).
+    MetricsExporter *metricsExporter = nullptr; ///< Eksporter metryk (tworzony na żądanie).
+    ProfileRunner profileRunner;        ///< Wykonanie profilu nastaw w osobnym wątku.
+    QString profilePath;                ///< Plik aktualnie wykonywanego profilu.
+    std::vector<DerivedChannel> derivedChannels; ///< Kanały pochodne (indeks = numer wykresu, derivedChartType()).
+    QList<QWidget *> derivedChartHosts; ///< Widżety wykresów kanałów pochodnych.
+    DiagnosticsPanel *diagnostics = nullptr; ///< Dokowany panel diagnostyczny (dziennik).
+    StallWatchdog *stallWatchdog = nullptr; ///< Strażnik opóźnień pętli zdarzeń GUI.
+    PlantAnalysisWorker plantAnalysis;  ///< Identyfikacja obiektu (model FOPDT) w osobnym wątku.
+    PlantPanel *plantPanel = nullptr;   ///< Zakładka wyniku identyfikacji i proponowanych nastaw.
+    SessionWriter sessionWriter;        ///< Nagrywanie sesji do pliku.
+    SessionLinkStats recordingLinkStart; ///< Liczniki łącza w chwili rozpoczęcia nagrania.
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,71 @@
+/**
+ * @file metricsexporter.h
+ * @brief Deklaracja klasy MetricsExporter — serwera metryk w formacie Prometheus.
+ *
+ * Serwer nasłuchuje na porcie TCP (tylko localhost) i/lub gnieździe lokalnym (Unix domain
+ * socket) i na każde żądanie HTTP GET odpowiada tekstem z TelemetryMetrics. Działa w osobnym
+ * wątku, więc odpytywanie nie angażuje pętli zdarzeń GUI, okna głównego ani wykresów.
+ */
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include "telemetrymetrics.h"
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class QIODevice;
+
+/**
+ * @class MetricsExporter
+ * @brief Wbudowany eksporter metryk (HTTP/1.0, text/plain; version=0.0.4).
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy MetricsExporter.
+     * @param metrics Metryki do eksportu (muszą istnieć dłużej niż eksporter).
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit MetricsExporter(const TelemetryMetrics &metrics, QObject *parent = nullptr);
+
+    /**
+     * @brief Zamyka serwery i zatrzymuje wątek eksportera.
+     */
+    ~MetricsExporter();
+
+    /**
+     * @brief Uruchamia nasłuchiwanie na porcie TCP interfejsu loopback (127.0.0.1).
+     * @param port Numer portu.
+     * @return true jeśli serwer nasłuchuje.
+     */
+    bool listenTcp(quint16 port);
+
+    /**
+     * @brief Uruchamia nasłuchiwanie na gnieździe lokalnym (na Linuksie: Unix domain socket).
+     * @param path Ścieżka gniazda; istniejący plik gniazda jest usuwany.
+     * @return true jeśli serwer nasłuchuje.
+     */
+    bool listenLocal(const QString &path);
+
+private:
+    /**
+     * @brief Uruchamia wątek eksportera (przy pierwszym wywołaniu listen*()).
+     */
+    void ensureThread();
+
+    /**
+     * @brief Obsługuje połączenie klienta: czeka na nagłówek żądania i wysyła odpowiedź.
+     * @param socket Gniazdo klienta (QTcpSocket lub QLocalSocket).
+     */
+    void serveClient(QIODevice *socket);
+
+    const TelemetryMetrics &metrics; ///< Eksportowane metryki.
+    QThread thread;                  ///< Wątek eksportera.
+    QObject *worker = nullptr;       ///< Obiekt kontekstu (rodzic serwerów) żyjący w wątku eksportera.
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,123 @@
+/**
+ * @file plantanalysisworker.h
+ * @brief Deklaracja klasy PlantAnalysisWorker — identyfikacji obiektu w tle (PlantIdentifier).
+ *
+ * Wątek analizy co zadany okres odczytuje przez DataBus::read() nowe próbki z magistrali
+ * SerialReader::dataBus() i nowe polecenia z dziennika SerialReader::commandLog(), dopisuje je
+ * do siatki PlantIdentifier i identyfikuje model FOPDT w oknie przesuwnym. Wejściem są polecenia
+ * PWM w trybie ręcznym i zadane RPM w trybie automatycznym (według pola SerialData::mode), przy
+ * zatrzymanym silniku (polecenie start_stop = 0) wejście wynosi 0; zmiana trybu rozpoczyna
+ * identyfikację od nowa. Wątek GUI nie wykonuje żadnych obliczeń —
+ * wynik trafia do funkcji zwrotnej wywoływanej w wątku analizy.
+ */
+
+#ifndef PLANTANALYSISWORKER_H
+#define PLANTANALYSISWORKER_H
+
+#include "databus.h"
+#include "plantidentifier.h"
+#include "samplequeue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct PlantEstimate
+ * @brief Wynik jednej analizy okna.
+ */
+struct PlantEstimate {
+    PlantModel model;       ///< Zidentyfikowany model (lub powód jego braku).
+    double analysisMs = 0.0; ///< Czas identyfikacji [ms].
+    uint64_t samples = 0;   ///< Próbki odczytane z magistrali od startu.
+    uint64_t overruns = 0;  ///< Próbki nadpisane przed odczytem (wątek analizy nie nadążał).
+};
+
+/**
+ * @class PlantAnalysisWorker
+ * @brief Okresowa identyfikacja modelu FOPDT w osobnym wątku.
+ */
+class PlantAnalysisWorker
+{
+public:
+    /// Wywoływane w wątku analizy po każdej analizie z nowymi danymi.
+    using ResultCallback = std::function<void(const PlantEstimate &estimate)>;
+
+    static constexpr int defaultPeriodMs = 500; ///< Domyślny okres analizy [ms].
+
+    PlantAnalysisWorker() = default;
+    ~PlantAnalysisWorker();
+
+    PlantAnalysisWorker(const PlantAnalysisWorker &) = delete;
+    PlantAnalysisWorker &operator=(const PlantAnalysisWorker &) = delete;
+
+    /**
+     * @brief Subskrybuje magistrale i uruchamia wątek analizy; poprzednie wykonanie jest zatrzymywane.
+     *
+     * Magistrale muszą istnieć do wywołania stop().
+     * @param samples Magistrala próbek (SerialReader::dataBus()).
+     * @param commands Dziennik poleceń (SerialReader::commandLog()).
+     * @param onResult Odbiorca wyników.
+     * @param config Parametry identyfikacji.
+     * @param periodMs Okres analizy [ms].
+     */
+    void start(DataBus<SamplePair> &samples, DataBus<CommandSample> &commands, ResultCallback onResult,
+               const PlantIdentifierConfig &config = PlantIdentifierConfig(), int periodMs = defaultPeriodMs);
+
+    /**
+     * @brief Zatrzymuje wątek analizy i usuwa subskrypcje.
+     */
+    void stop();
+
+    /**
+     * @brief Sprawdza, czy wątek analizy działa.
+     */
+    bool isRunning() const { return running; }
+
+private:
+    /**
+     * @brief Pętla wątku analizy.
+     */
+    void run();
+
+    /**
+     * @brief Dopisuje nowe polecenia i próbki do identyfikatora.
+     * @return true jeśli przybyły nowe komórki siatki.
+     */
+    bool collect();
+
+    /**
+     * @brief Rozpoczyna identyfikację dla nowego wejścia, z ostatnim poleceniem tego rodzaju
+     * (albo z wejściem 0, jeśli silnik jest zatrzymany).
+     */
+    void switchInput(PlantInput input);
+
+    /**
+     * @brief Czy ostatnie polecenie start_stop zatrzymało silnik.
+     */
+    bool isStopped() const { return lastStartStop.timeUs != 0 && lastStartStop.value == 0.0f; }
+
+    DataBus<SamplePair> *sampleBus = nullptr;     ///< Magistrala próbek.
+    DataBus<CommandSample> *commandBus = nullptr; ///< Dziennik poleceń.
+    int sampleSubscription = 0;        ///< Subskrypcja magistrali próbek.
+    int commandSubscription = 0;       ///< Subskrypcja dziennika poleceń.
+    ResultCallback resultCallback;     ///< Odbiorca wyników.
+    PlantIdentifier identifier;        ///< Siatka pomiarów i identyfikacja (wątek analizy).
+    bool inputKnown = false;           ///< Czy wejście zostało ustalone z pierwszej próbki.
+    CommandSample lastPwm;             ///< Ostatnie polecenie PWM (timeUs = 0 — brak).
+    CommandSample lastSetpoint;        ///< Ostatnie polecenie RPM (timeUs = 0 — brak).
+    CommandSample lastStartStop;       ///< Ostatnie polecenie start_stop (timeUs = 0 — brak).
+    std::vector<SamplePair> sampleBatch;       ///< Bufor odczytu próbek.
+    std::vector<CommandSample> commandBatch;   ///< Bufor odczytu poleceń.
+    uint64_t samplesRead = 0;          ///< Próbki odczytane od startu.
+    uint64_t analysedRevision = 0;     ///< PlantIdentifier::revision() przy ostatniej analizie.
+    int period = defaultPeriodMs;      ///< Okres analizy [ms].
+    std::thread worker;                ///< Wątek analizy.
+    std::atomic<bool> running{false};  ///< Czy wątek ma działać.
+    std::mutex wakeMutex;              ///< Chroni oczekiwanie na okres lub stop().
+    std::condition_variable wake;      ///< Przerywa oczekiwanie przy stop().
+};
+
+#endif // PLANTANALYSISWORKER_H
@@ -0,0 +1,175 @@
+/**
+ * @file plantidentifier.h
+ * @brief Deklaracja klasy PlantIdentifier — identyfikacji modelu FOPDT silnika z poleceń i pomiarów RPM.
+ *
+ * Pomiary RPM uśredniane są przyrostowo w komórkach równomiernej siatki czasu (domyślnie 10 ms)
+ * w oknie przesuwnym, a wejście (wysłane polecenia PWM lub zadane RPM) jest odtwarzane na tej
+ * siatce jako sygnał schodkowy. Model pierwszego rzędu z opóźnieniem (FOPDT) dopasowywany jest
+ * jako dyskretny model ARX y[k+1] = a·y[k] + b·u[k-d] + c metodą najmniejszych kwadratów dla
+ * wszystkich opóźnień d naraz: sumy zależne od opóźnienia są korelacjami wzajemnymi wejścia
+ * i wyjścia. Dla małych okien liczone są wprost (N·D), dla dużych przez FFT, więc koszt analizy
+ * długiego okna lub gęstej siatki rośnie jak N·log N, a nie N·D.
+ * Modele ARX są punktem startowym dopasowania błędu wyjścia (symulacji), które nie zaniża
+ * stałej czasowej przy szumie pomiaru; opóźnienie wybierane jest przeszukiwaniem od siatki
+ * zgrubnej. Z a i b wynikają wzmocnienie K = b/(1-a), stała czasowa T = -Ts/ln a
+ * i opóźnienie θ = d·Ts.
+ *
+ * Dla danych z trybu ręcznego (wejście PWM, pętla otwarta) proponowane są nastawy PID według
+ * reguł IMC dla modelu FOPDT. Dane z trybu automatycznego (wejście zadane RPM) opisują pętlę
+ * zamkniętą — model jest wyznaczany, ale nastawy nie są proponowane.
+ *
+ * Klasa nie zależy od Qt (narzędzie tools/wds_plant_ident_sim).
+ */
+
+#ifndef PLANTIDENTIFIER_H
+#define PLANTIDENTIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum PlantInput
+ * @brief Wejście identyfikowanego obiektu.
+ */
+enum class PlantInput : uint8_t {
+    Pwm,     ///< Polecenia PWM (tryb ręczny, pętla otwarta).
+    Setpoint ///< Zadana prędkość RPM (tryb automatyczny, pętla zamknięta).
+};
+
+/**
+ * @struct PlantIdentifierConfig
+ * @brief Parametry identyfikacji.
+ */
+struct PlantIdentifierConfig {
+    double sampleS = 0.01;      ///< Krok siatki czasu Ts [s].
+    double windowS = 60.0;      ///< Długość okna analizy [s].
+    double maxDeadTimeS = 2.0;  ///< Największe sprawdzane opóźnienie [s].
+    float minStep = 1.0f;       ///< Najmniejsza zmiana wejścia liczona jako pobudzenie.
+};
+
+/**
+ * @struct PlantModel
+ * @brief Wynik identyfikacji modelu FOPDT: K·e^(-θs)/(T·s + 1).
+ */
+struct PlantModel {
+    bool valid = false;         ///< Czy model jest wiarygodny (w przeciwnym razie patrz reason).
+    PlantInput input = PlantInput::Pwm; ///< Wejście modelu.
+    double gain = 0.0;          ///< Wzmocnienie K [obr/min na jednostkę wejścia].
+    double timeConstantS = 0.0; ///< Stała czasowa T [s].
+    double deadTimeS = 0.0;     ///< Opóźnienie θ [s].
+    double fitPercent = 0.0;    ///< Dopasowanie symulacji modelu do pomiaru: 100·(1 - |y-ŷ|/|y-ȳ|) [%].
+    double windowS = 0.0;       ///< Długość przeanalizowanych danych [s].
+    size_t steps = 0;           ///< Liczba zmian wejścia w analizowanych danych.
+    std::string reason;         ///< Powód odrzucenia modelu (pusty dla valid).
+};
+
+/**
+ * @struct PidSuggestion
+ * @brief Nastawy PID w postaci równoległej: u = Kp·e + Ki·∫e dt + Kd·de/dt.
+ */
+struct PidSuggestion {
+    bool valid = false;   ///< Czy nastawy zostały wyznaczone.
+    double kp = 0.0;      ///< Wzmocnienie proporcjonalne [jednostki wejścia na obr/min].
+    double ki = 0.0;      ///< Wzmocnienie całkujące [1/s].
+    double kd = 0.0;      ///< Wzmocnienie różniczkujące [s].
+    double lambdaS = 0.0; ///< Stała czasowa pętli zamkniętej λ użyta w regule IMC [s].
+};
+
+/**
+ * @class PlantIdentifier
+ * @brief Przyrostowa siatka pomiarów i identyfikacja modelu FOPDT w oknie przesuwnym.
+ *
+ * Metody nie są bezpieczne wątkowo — obiekt należy do jednego wątku (PlantAnalysisWorker).
+ */
+class PlantIdentifier
+{
+public:
+    /**
+     * @brief Konstruktor identyfikatora.
+     * @param config Parametry identyfikacji.
+     */
+    explicit PlantIdentifier(const PlantIdentifierConfig &config = PlantIdentifierConfig());
+
+    /**
+     * @brief Usuwa pomiary i polecenia oraz ustawia wejście (np. po zmianie trybu pracy).
+     */
+    void reset(PlantInput input);
+
+    /**
+     * @brief Zwraca bieżące wejście.
+     */
+    PlantInput input() const { return source; }
+
+    /**
+     * @brief Dodaje polecenie (wartość wejścia obowiązującą od chwili timeUs).
+     *
+     * Polecenia mogą przychodzić z opóźnieniem względem pomiarów — są wstawiane według czasu.
+     */
+    void addCommand(int64_t timeUs, float value);
+
+    /**
+     * @brief Dodaje pomiar wyjścia (RPM) z czasem na osi hosta.
+     */
+    void addMeasurement(int64_t timeUs, float output);
+
+    /**
+     * @brief Zwraca liczbę zamkniętych komórek siatki w oknie.
+     */
+    size_t gridSize() const { return cells.size(); }
+
+    /**
+     * @brief Zwraca liczbę komórek zamkniętych od utworzenia lub reset() (do wykrywania nowych danych).
+     */
+    uint64_t revision() const { return closedCells; }
+
+    /**
+     * @brief Identyfikuje model FOPDT z danych w oknie (od pierwszego znanego polecenia).
+     */
+    PlantModel identify() const;
+
+    /**
+     * @brief Proponuje nastawy PID regułą IMC dla modelu FOPDT (Rivera, Morari, Skogestad).
+     *
+     * Kp = (2T + θ) / (K·(2λ + θ)), Ti = T + θ/2, Td = T·θ / (2T + θ), Ki = Kp/Ti, Kd = Kp·Td.
+     * @param model Model z pętli otwartej (wejście PWM).
+     * @param lambdaS Stała czasowa pętli zamkniętej [s]; 0 — max(θ, T/5).
+     */
+    static PidSuggestion suggestPid(const PlantModel &model, double lambdaS = 0.0);
+
+    /**
+     * @brief Korelacja wzajemna r[l] = Σ x[k]·y[k+l] dla l = 0..maxLag przez FFT (radix-2).
+     * @param x Pierwszy sygnał.
+     * @param y Drugi sygnał (tej samej długości).
+     * @param maxLag Największe przesunięcie.
+     */
+    static std::vector<double> crossCorrelation(const std::vector<double> &x, const std::vector<double> &y, size_t maxLag);
+
+private:
+    /**
+     * @brief Zamyka bieżącą komórkę i uzupełnia przerwę do komórki index wartością ostatniej.
+     */
+    void closeCells(int64_t index);
+
+    /**
+     * @brief Zwraca wartość wejścia obowiązującą w chwili timeUs (bez polecenia przed nią — NaN).
+     */
+    double commandAt(int64_t timeUs) const;
+
+    PlantIdentifierConfig config;   ///< Parametry identyfikacji.
+    PlantInput source = PlantInput::Pwm; ///< Bieżące wejście.
+    int64_t cellUs = 10000;         ///< Krok siatki [µs].
+    size_t windowCells = 6000;      ///< Największa liczba komórek w oknie.
+    std::deque<float> cells;        ///< Średnie RPM zamkniętych komórek (najstarsza pierwsza).
+    int64_t frontIndex = 0;         ///< Numer komórki cells.front() (czas początku = frontIndex·cellUs).
+    int64_t openIndex = -1;         ///< Numer bieżącej komórki (-1 — brak pomiarów).
+    double openSum = 0.0;           ///< Suma pomiarów bieżącej komórki.
+    int openCount = 0;              ///< Liczba pomiarów bieżącej komórki.
+    uint64_t closedCells = 0;       ///< Licznik zamkniętych komórek.
+    std::vector<std::pair<int64_t, float>> commands; ///< Polecenia (czas [µs], wartość) rosnąco według czasu.
+};
+
+#endif // PLANTIDENTIFIER_H
@@ -0,0 +1,62 @@
+/**
+ * @file plantpanel.h
+ * @brief Deklaracja klasy PlantPanel — zakładki "Identyfikacja" panelu diagnostycznego.
+ *
+ * Zakładka pokazuje ostatni model FOPDT wyznaczony w tle przez PlantAnalysisWorker
+ * (wzmocnienie, stała czasowa, opóźnienie, dopasowanie) oraz nastawy PID z reguły IMC dla
+ * wybranej stałej czasowej pętli zamkniętej λ. Nastawy można wpisać do pól PID okna głównego;
+ * do mikrokontrolera wysyła je dopiero przycisk zapisu nastaw.
+ */
+
+#ifndef PLANTPANEL_H
+#define PLANTPANEL_H
+
+#include "plantanalysisworker.h"
+#include <QWidget>
+
+class QDoubleSpinBox;
+class QLabel;
+class QPushButton;
+
+/**
+ * @class PlantPanel
+ * @brief Widok wyniku identyfikacji obiektu i proponowanych nastaw PID.
+ */
+class PlantPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy PlantPanel.
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit PlantPanel(QWidget *parent = nullptr);
+
+public slots:
+    /**
+     * @brief Pokazuje wynik analizy (wywoływać w wątku GUI).
+     */
+    void showEstimate(const PlantEstimate &estimate);
+
+signals:
+    /**
+     * @brief Użytkownik wybrał wpisanie proponowanych nastaw do pól PID.
+     */
+    void applyGainsRequested(double kp, double ki, double kd);
+
+private:
+    /**
+     * @brief Przelicza nastawy PID dla bieżącego modelu i λ.
+     */
+    void updateSuggestion();
+
+    QLabel *statusLabel;         ///< Wejście, okno, liczba zmian wejścia, czas analizy.
+    QLabel *modelLabel;          ///< Parametry modelu lub powód jego braku.
+    QDoubleSpinBox *lambdaBox;   ///< Stała czasowa pętli zamkniętej λ [s] (0 — automatycznie).
+    QLabel *gainsLabel;          ///< Proponowane nastawy.
+    QPushButton *applyButton;    ///< Wpisanie nastaw do pól PID.
+    PlantModel model;            ///< Ostatni model.
+    PidSuggestion suggestion;    ///< Nastawy dla ostatniego modelu.
+};
+
+#endif // PLANTPANEL_H
@@ -0,0 +1,136 @@
+/**
+ * @file portwatcher.h
+ * @brief Deklaracja klasy PortWatcher — wykrywania podłączania i odłączania portów szeregowych w tle.
+ *
+ * Enumeracja portów (QSerialPortInfo::availablePorts()) jest wykonywana w osobnym wątku,
+ * dzięki czemu nie blokuje GUI przy dużej liczbie urządzeń USB. Na Linuksie zmiany wykrywane są
+ * przez gniazdo netlink z komunikatami uevent jądra, na pozostałych systemach (lub gdy gniazdo
+ * jest niedostępne) lista portów jest okresowo odpytywana.
+ */
+
+#ifndef PORTWATCHER_H
+#define PORTWATCHER_H
+
+#include <QMap>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class QSocketNotifier;
+class QTimer;
+
+/**
+ * @struct PortDescriptor
+ * @brief Opis portu szeregowego pozwalający rozpoznać to samo urządzenie po ponownym podłączeniu.
+ */
+struct PortDescriptor {
+    QString systemLocation; ///< Ścieżka portu (np. /dev/ttyUSB0).
+    QString serialNumber;   ///< Numer seryjny urządzenia USB (może być pusty).
+    QString description;    ///< Opis urządzenia.
+    quint16 vendorId = 0;   ///< Identyfikator producenta (VID).
+    quint16 productId = 0;  ///< Identyfikator produktu (PID).
+    bool hasIds = false;    ///< Czy VID:PID są znane.
+
+    /**
+     * @brief Sprawdza, czy opis dotyczy tego samego urządzenia.
+     *
+     * Porównywany jest numer seryjny oraz VID:PID; jeśli nie są znane, porównywana jest ścieżka portu.
+     * @param other Opis drugiego portu.
+     */
+    bool sameDevice(const PortDescriptor &other) const;
+};
+
+Q_DECLARE_METATYPE(PortDescriptor)
+
+/**
+ * @class PortWatcher
+ * @brief Obserwator portów szeregowych działający w osobnym wątku.
+ */
+class PortWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy PortWatcher.
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit PortWatcher(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor — zatrzymuje wątek obserwatora.
+     */
+    ~PortWatcher();
+
+    /**
+     * @brief Uruchamia wątek obserwatora i pierwszą enumerację portów.
+     */
+    void start();
+
+    /**
+     * @brief Sprawdza, czy port powinien być pokazywany na liście (ttyUSB, ttyACM, COM).
+     * @param systemLocation Ścieżka portu.
+     */
+    static bool isSupportedPort(const QString &systemLocation);
+
+public slots:
+
+    /**
+     * @brief Zleca ponowną enumerację portów w wątku obserwatora.
+     */
+    void rescan();
+
+    /**
+     * @brief Usuwa port z listy znanych portów i zleca enumerację.
+     *
+     * Pozwala wykryć urządzenie, które zostało odłączone i podłączone ponownie
+     * pod tą samą ścieżką szybciej niż między dwiema enumeracjami.
+     * @param systemLocation Ścieżka portu.
+     */
+    void forgetPort(const QString &systemLocation);
+
+signals:
+
+    /**
+     * @brief Sygnał emitowany po pojawieniu się nowego portu.
+     * @param port Opis portu.
+     */
+    void portAdded(const PortDescriptor &port);
+
+    /**
+     * @brief Sygnał emitowany po zniknięciu portu.
+     * @param systemLocation Ścieżka usuniętego portu.
+     */
+    void portRemoved(const QString &systemLocation);
+
+private:
+    /**
+     * @brief Otwiera gniazdo netlink lub uruchamia odpytywanie (wątek obserwatora).
+     */
+    void setupMonitor();
+
+    /**
+     * @brief Zamyka gniazdo netlink (wątek obserwatora).
+     */
+    void teardownMonitor();
+
+    /**
+     * @brief Odczytuje komunikaty uevent i planuje enumerację po zmianach w podsystemie tty.
+     */
+    void readUevents();
+
+    /**
+     * @brief Enumeruje porty i emituje różnice względem poprzedniej enumeracji (wątek obserwatora).
+     */
+    void scan();
+
+    QThread thread;                          ///< Wątek obserwatora.
+    QObject *worker = nullptr;               ///< Obiekt kontekstu żyjący w wątku obserwatora.
+    QSocketNotifier *notifier = nullptr;     ///< Powiadomienia o danych w gnieździe netlink.
+    QTimer *debounceTimer = nullptr;         ///< Opóźnienie enumeracji po serii zdarzeń uevent.
+    QTimer *pollTimer = nullptr;             ///< Timer odpytywania (gdy netlink jest niedostępny).
+    int netlinkFd = -1;                      ///< Deskryptor gniazda netlink.
+    QMap<QString, PortDescriptor> knownPorts;///< Porty z ostatniej enumeracji.
+};
+
+#endif // PORTWATCHER_H
@@ -0,0 +1,127 @@
+/**
+ * @file posixserialtransport.h
+ * @brief Deklaracja klasy PosixSerialTransport — niskoopóźnieniowego dostępu do portu (Linux).
+ *
+ * Alternatywa dla QSerialPort: port tty otwierany jest bezpośrednio, ustawiany w tryb surowy
+ * (termios, VMIN/VTIME), z flagą ASYNC_LOW_LATENCY (dla FTDI skraca licznik opóźnienia z 16 ms
+ * do 1 ms), a odczyt odbywa się w osobnym wątku przez epoll. Odebrane bajty przekazywane są
+ * wywołaniem zwrotnym razem z czasem ich odebrania (CLOCK_MONOTONIC).
+ */
+
+#ifndef POSIXSERIALTRANSPORT_H
+#define POSIXSERIALTRANSPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @class PosixSerialTransport
+ * @brief Port szeregowy obsługiwany przez epoll w dedykowanym wątku (tylko Linux).
+ */
+class PosixSerialTransport
+{
+public:
+    /// Wywołanie zwrotne z odebranymi bajtami i czasem odbioru [ns, CLOCK_MONOTONIC].
+    using DataCallback = std::function<void(const char *data, int size, int64_t arrivalNs)>;
+    /// Wywołanie zwrotne po błędzie portu (np. odłączeniu urządzenia).
+    using ErrorCallback = std::function<void(const std::string &message)>;
+
+    PosixSerialTransport() = default;
+    ~PosixSerialTransport();
+
+    PosixSerialTransport(const PosixSerialTransport &) = delete;
+    PosixSerialTransport &operator=(const PosixSerialTransport &) = delete;
+
+    /**
+     * @brief Sprawdza, czy transport jest dostępny na bieżącej platformie.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Otwiera port i uruchamia wątek odczytu.
+     * @param path Ścieżka portu (np. /dev/ttyUSB0).
+     * @param baudRate Prędkość transmisji [Bd].
+     * @param minBytes Wartość VMIN — liczba bajtów, po której epoll zgłasza gotowość (np. długość ramki).
+     * @param onData Wywołanie zwrotne z odebranymi danymi (wątek odczytu).
+     * @param onError Wywołanie zwrotne po błędzie (wątek odczytu).
+     * @return true jeśli port został otwarty.
+     */
+    bool open(const std::string &path, int baudRate, int minBytes, DataCallback onData, ErrorCallback onError);
+
+    /**
+     * @brief Zatrzymuje wątek odczytu i zamyka port.
+     */
+    void close();
+
+    /**
+     * @brief Sprawdza, czy port jest otwarty.
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Zapisuje dane do portu (bezpieczne wywołanie z dowolnego wątku).
+     *
+     * Zapisy z różnych wątków są szeregowane, więc ramki poleceń nie przeplatają się.
+     * @param data Dane do wysłania.
+     * @param size Liczba bajtów.
+     * @return true jeśli zapisano wszystkie bajty.
+     */
+    bool write(const char *data, int size);
+
+    /**
+     * @brief Zapisuje dane z pierwszeństwem przed innymi zapisami (np. zatrzymanie awaryjne).
+     *
+     * Bajty oczekujące w buforze nadawczym sterownika są odrzucane (tcflush(TCOFLUSH)), a trwający
+     * w innym wątku write() przerywa oczekiwanie na miejsce w buforze i zwraca false, więc dane
+     * nie czekają za wcześniej zleconymi zapisami.
+     * @param data Dane do wysłania.
+     * @param size Liczba bajtów.
+     * @return true jeśli zapisano wszystkie bajty.
+     */
+    bool writeUrgent(const char *data, int size);
+
+    /**
+     * @brief Zwraca opis ostatniego błędu.
+     */
+    const std::string &errorString() const { return lastError; }
+
+    /**
+     * @brief Czy sterownik przyjął flagę ASYNC_LOW_LATENCY.
+     */
+    bool lowLatencyEnabled() const { return lowLatency; }
+
+    /**
+     * @brief Zwraca bieżący czas zegara monotonicznego (CLOCK_MONOTONIC na Linuksie) [ns].
+     */
+    static int64_t monotonicNs();
+
+private:
+    /**
+     * @brief Pętla wątku odczytu (epoll).
+     */
+    void run();
+
+    /**
+     * @brief Zapisuje dane; wywoływana pod writeMutex.
+     * @param interruptible Czy przerwać zapis, gdy czeka zapis pilny (writeUrgent()).
+     */
+    bool writeLocked(const char *data, int size, bool interruptible);
+
+    int fd = -1;                       ///< Deskryptor portu.
+    int epollFd = -1;                  ///< Deskryptor epoll.
+    int wakeFd = -1;                   ///< eventfd do przerwania pętli odczytu.
+    bool lowLatency = false;           ///< Czy ustawiono ASYNC_LOW_LATENCY.
+    std::string lastError;             ///< Opis ostatniego błędu.
+    std::thread reader;                ///< Wątek odczytu.
+    std::atomic<bool> running{false};  ///< Flaga pracy wątku odczytu.
+    std::mutex writeMutex;             ///< Szereguje zapisy z różnych wątków.
+    std::atomic<int> urgentWriters{0}; ///< Liczba zapisów pilnych czekających na writeMutex.
+    DataCallback dataCallback;         ///< Wywołanie zwrotne danych.
+    ErrorCallback errorCallback;       ///< Wywołanie zwrotne błędu.
+};
+
+#endif // POSIXSERIALTRANSPORT_H
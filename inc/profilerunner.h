@@ -0,0 +1,136 @@
+/**
+ * @file profilerunner.h
+ * @brief Deklaracja klasy ProfileRunner — wykonania profilu nastaw w dedykowanym wątku.
+ *
+ * Każde polecenie profilu ma bezwzględny termin liczony od chwili startu (CLOCK_MONOTONIC),
+ * więc opóźnienia nie kumulują się. Na Linuksie wątek czeka na timerfd z TFD_TIMER_ABSTIME,
+ * na innych platformach na std::this_thread::sleep_until(). Dla każdego polecenia zapisywane są
+ * dwa czasy: wybudzenia wątku (spóźnienie względem terminu — histogram jitter()) oraz zapisu
+ * ramki do portu, zgłaszany przez wysyłającego (writeLateness(), queueDelay()). Przy QSerialPort
+ * polecenie jest zapisywane dopiero w pętli zdarzeń wątku portu, więc oba czasy mogą się różnić.
+ */
+
+#ifndef PROFILERUNNER_H
+#define PROFILERUNNER_H
+
+#include "latencyhistogram.h"
+#include "setpointprofile.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ProfileRunner
+ * @brief Wykonuje SetpointProfile w osobnym wątku z bezwzględnymi terminami.
+ */
+class ProfileRunner
+{
+public:
+    /// Zgłasza zapis ramki polecenia do portu (z dowolnego wątku, najwyżej raz) [ns, zegar monotoniczny].
+    using WrittenCallback = std::function<void(int64_t writtenNs)>;
+    /// Wysyła polecenie (wywoływane w wątku profilu — musi być bezpieczne wątkowo); po zapisaniu
+    /// ramki do portu wysyłający wywołuje onWritten (nie wywołuje, jeśli polecenie odrzucono).
+    using SendCallback = std::function<void(const ProfileStep &step, WrittenCallback onWritten)>;
+    /// Wywoływane w wątku profilu po wykonaniu ostatniego polecenia lub zatrzymaniu.
+    using FinishedCallback = std::function<void(bool completed)>;
+
+    ProfileRunner() = default;
+    ~ProfileRunner();
+
+    ProfileRunner(const ProfileRunner &) = delete;
+    ProfileRunner &operator=(const ProfileRunner &) = delete;
+
+    /**
+     * @brief Uruchamia profil; poprzednie wykonanie jest zatrzymywane.
+     * @param profile Profil do wykonania (kopiowany).
+     * @param onSend Wysłanie polecenia.
+     * @param onFinished Zakończenie wykonania (opcjonalnie).
+     */
+    void start(const SetpointProfile &profile, SendCallback onSend, FinishedCallback onFinished = {});
+
+    /**
+     * @brief Przerywa wykonanie i czeka na zakończenie wątku.
+     *
+     * Wywołane z wątku profilu (np. z FinishedCallback) jedynie przerywa pętlę — wątek i jego
+     * deskryptory zwalnia kolejne wywołanie stop() lub start() z innego wątku.
+     */
+    void stop();
+
+    /**
+     * @brief Sprawdza, czy profil jest wykonywany.
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Histogram spóźnień wybudzenia wątku profilu względem terminu [ns].
+     */
+    const LatencyHistogram &jitter() const { return lateness; }
+
+    /**
+     * @brief Histogram spóźnień zapisu ramki do portu względem terminu [ns].
+     */
+    const LatencyHistogram &writeLateness() const { return writes->lateness; }
+
+    /**
+     * @brief Histogram czasu od wybudzenia do zapisu ramki do portu (kolejkowanie w wysyłającym) [ns].
+     */
+    const LatencyHistogram &queueDelay() const { return writes->queue; }
+
+    /**
+     * @brief Zwraca tekstowe podsumowanie jittera wybudzenia i zapisu (wartości w µs).
+     */
+    std::string jitterSummary() const;
+
+    /**
+     * @brief Zapisuje dziennik wykonania w formacie CSV (termin, wybudzenie, zapis do portu, polecenie).
+     *
+     * Wywoływać po zakończeniu wykonania.
+     * @param path Ścieżka pliku.
+     * @return true jeśli zapis się powiódł.
+     */
+    bool writeLog(const std::string &path) const;
+
+private:
+    /**
+     * @brief Pętla wątku profilu.
+     */
+    void run();
+
+    /**
+     * @brief Czeka do bezwzględnego terminu (lub przerwania przez stop()).
+     * @param deadlineNs Termin [ns, zegar monotoniczny].
+     * @return false jeśli wykonanie zostało przerwane.
+     */
+    bool waitUntil(int64_t deadlineNs);
+
+    /**
+     * @struct WriteLog
+     * @brief Czasy zapisu poleceń do portu — współdzielone z WrittenCallback, które może zostać
+     * wywołane po zakończeniu wykonania (np. z pętli zdarzeń wątku portu).
+     */
+    struct WriteLog {
+        std::mutex mutex;               ///< Chroni writtenNs.
+        std::vector<int64_t> writtenNs; ///< Czasy zapisu do portu (0 = nie zapisano).
+        LatencyHistogram lateness;      ///< Termin -> zapis do portu [ns].
+        LatencyHistogram queue;         ///< Wybudzenie -> zapis do portu [ns].
+    };
+
+    std::vector<ProfileStep> steps;    ///< Polecenia wykonywanego profilu.
+    std::vector<int64_t> wokeNs;       ///< Czasy wybudzenia i przekazania polecenia (0 = nie wysłano).
+    std::shared_ptr<WriteLog> writes = std::make_shared<WriteLog>(); ///< Czasy zapisu bieżącego wykonania.
+    int64_t startNs = 0;               ///< Chwila startu profilu [ns].
+    SendCallback sendCallback;         ///< Wysłanie polecenia.
+    FinishedCallback finishedCallback; ///< Zakończenie wykonania.
+    LatencyHistogram lateness;         ///< Spóźnienia wybudzenia [ns].
+    std::thread worker;                ///< Wątek profilu.
+    std::atomic<bool> running{false};  ///< Czy profil jest wykonywany.
+    int timerFd = -1;                  ///< timerfd (Linux).
+    int wakeFd = -1;                   ///< eventfd przerywający oczekiwanie (Linux).
+};
+
+#endif // PROFILERUNNER_H
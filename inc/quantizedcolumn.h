@@ -0,0 +1,116 @@
+/**
+ * @file quantizedcolumn.h
+ * @brief Deklaracja klasy QuantizedColumn — stratnego zapisu kolumny wartości float w int16 lub int8.
+ *
+ * Kolumna (wartości jednego kanału z bloku historii) zapisywana jest jako przesunięcie i krok
+ * wspólne dla bloku oraz liczby int16 na próbkę: wartość = offset + step * q. Krok dobierany jest
+ * z zakresu wartości bloku (65534 przedziały), więc błąd zależy od zakresu, a nie od wielkości
+ * wartości. Gdy podana jest rozdzielczość czujnika (LSB), krok jest nie mniejszy od niej,
+ * a przesunięcie leży na siatce LSB — wartości odczytane z czujnika odtwarzane są dokładnie
+ * (z dokładnością float), a przy zakresie bloku do 253 LSB wystarcza int8 na próbkę.
+ * Kolumny stałe nie zajmują pamięci na próbkę, kolumny całkowite (PWM, tryb) zapisywane
+ * są bezstratnie z krokiem 1, a kolumny z wartościami NaN/nieskończonymi — bez kwantyzacji.
+ * Największy błąd jest mierzony przy kodowaniu (tym samym kodem co odczyt), a nie szacowany.
+ *
+ * Klasa nie zależy od Qt (narzędzie tools/wds_history_quant).
+ */
+
+#ifndef QUANTIZEDCOLUMN_H
+#define QUANTIZEDCOLUMN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class QuantizedColumn
+ * @brief Kolumna wartości float zapisana jako int16 z przesunięciem i krokiem.
+ */
+class QuantizedColumn
+{
+public:
+    /**
+     * @enum Mode
+     * @brief Sposób zapisu kolumny (wybierany przy kodowaniu).
+     */
+    enum class Mode : uint8_t {
+        Constant, ///< Wszystkie wartości równe offset (bez danych na próbkę).
+        Integer,  ///< Liczby całkowite z krokiem 1 (bezstratnie).
+        Scaled,   ///< offset + step * q (stratnie, błąd maxError()).
+        Raw       ///< Wartości float bez zmian (NaN/nieskończoność w bloku).
+    };
+
+    /**
+     * @brief Koduje kolumnę (poprzednia zawartość jest usuwana).
+     * @param values Wartości.
+     * @param count Liczba wartości.
+     * @param resolution Rozdzielczość czujnika (LSB) — najmniejszy krok; 0 — krok tylko z zakresu.
+     */
+    void encode(const float *values, size_t count, float resolution = 0.0f);
+
+    /**
+     * @brief Dekoduje całą kolumnę.
+     * @param out Tablica wynikowa (size() elementów).
+     */
+    void decode(float *out) const;
+
+    /**
+     * @brief Zwraca liczbę wartości.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Zwraca sposób zapisu.
+     */
+    Mode mode() const { return kind; }
+
+    /**
+     * @brief Zwraca liczbę bajtów na próbkę (0, 1, 2 lub 4).
+     */
+    int bytesPerValue() const;
+
+    /**
+     * @brief Zwraca krok kwantyzacji (0 dla kolumn stałych i bez kwantyzacji).
+     */
+    float step() const { return scale; }
+
+    /**
+     * @brief Zwraca największy zmierzony błąd bezwzględny odczytanej wartości.
+     */
+    float maxError() const { return error; }
+
+    /**
+     * @brief Zwraca liczbę bajtów danych na próbki (bez nagłówka kolumny).
+     */
+    uint64_t byteCount() const;
+
+    /**
+     * @brief Zwalnia nadmiarową pamięć po zakończeniu zapisu.
+     */
+    void shrink();
+
+    /**
+     * @brief Zamienia liczby int16 na wartości: out[i] = offset + step * in[i].
+     *
+     * Pętla bez rozgałęzień o stałych parametrach — kompilator wektoryzuje ją (SSE/AVX/NEON)
+     * jak gatherChannel() w serialdata.cpp.
+     */
+    static void dequantize(const int16_t *in, size_t count, float offset, float step, float *out);
+
+    /**
+     * @brief Jak dequantize() dla kolumn zapisanych w int8.
+     */
+    static void dequantize(const int8_t *in, size_t count, float offset, float step, float *out);
+
+private:
+    Mode kind = Mode::Constant;  ///< Sposób zapisu.
+    size_t count = 0;            ///< Liczba wartości.
+    float offset = 0.0f;         ///< Przesunięcie (wartość dla q = 0).
+    float scale = 0.0f;          ///< Krok kwantyzacji.
+    float error = 0.0f;          ///< Największy zmierzony błąd.
+    std::vector<int16_t> levels; ///< Wartości skwantowane (Integer, Scaled; zakres ponad int8).
+    std::vector<int8_t> narrow;  ///< Wartości skwantowane mieszczące się w int8.
+    std::vector<float> raw;      ///< Wartości bez zmian (Raw).
+};
+
+#endif // QUANTIZEDCOLUMN_H
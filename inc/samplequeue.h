@@ -0,0 +1,153 @@
+/**
+ * @file samplequeue.h
+ * @brief Deklaracja klasy SampleQueue — ograniczonej kolejki próbek między odbiorem a odbiorcą.
+ *
+ * Dekoder (wątek odbioru) dopisuje próbki porcjami, odbiorca (wątek GUI) zabiera je wszystkie
+ * naraz. Gdy odbiorca nie nadąża (np. zablokowana pętla zdarzeń), kolejka nie rośnie ponad
+ * pojemność — nadmiar usuwany jest zgodnie z polityką (BackpressurePolicy), a każda usunięta
+ * próbka jest liczona. Po zablokowaniu odbiorca dostaje najwyżej capacity() próbek zamiast
+ * całej zaległości, więc wyświetlanie od razu wraca do bieżących danych.
+ *
+ * Klasa nie zależy od Qt (narzędzie tools/wds_backpressure_sim).
+ */
+
+#ifndef SAMPLEQUEUE_H
+#define SAMPLEQUEUE_H
+
+#include "serialdata.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @enum BackpressurePolicy
+ * @brief Sposób usuwania nadmiaru próbek z pełnej kolejki.
+ */
+enum class BackpressurePolicy {
+    DropOldest, ///< Usuwa najstarsze próbki (odbiorca dostaje najnowsze).
+    DropNewest, ///< Odrzuca nowe próbki (odbiorca dostaje ciągły, ale przestarzały fragment).
+    Decimate    ///< Usuwa co drugą próbkę (zachowuje cały przedział czasu w mniejszej rozdzielczości).
+};
+
+/**
+ * @struct SamplePair
+ * @brief Próbka surowa i ta sama próbka po filtrach kanałów.
+ */
+struct SamplePair {
+    SerialData raw;      ///< Wartości surowe.
+    SerialData filtered; ///< Wartości po filtrach.
+};
+
+/**
+ * @struct BackpressureStats
+ * @brief Liczniki kolejki próbek.
+ */
+struct BackpressureStats {
+    uint64_t pushed = 0;        ///< Próbki dopisane przez odbiór.
+    uint64_t delivered = 0;     ///< Próbki zabrane przez odbiorcę.
+    uint64_t droppedFrames = 0; ///< Próbki usunięte przez politykę.
+    uint64_t overflows = 0;     ///< Dopisania, przy których kolejka była pełna.
+    size_t maxDepth = 0;        ///< Największa liczba próbek w kolejce.
+};
+
+/**
+ * @class SampleQueue
+ * @brief Ograniczona, bezpieczna wątkowo kolejka próbek z polityką usuwania nadmiaru.
+ */
+class SampleQueue
+{
+public:
+    static constexpr size_t defaultCapacity = 1024; ///< Domyślna pojemność [próbki] (zaległość do narysowania po zablokowaniu GUI).
+    static constexpr size_t unbounded = static_cast<size_t>(-1); ///< Pojemność kolejki bezstratnej (nic nie jest usuwane).
+
+    /**
+     * @brief Konstruktor kolejki.
+     * @param capacity Pojemność [próbki], co najmniej 2.
+     * @param policy Polityka usuwania nadmiaru.
+     */
+    explicit SampleQueue(size_t capacity = defaultCapacity, BackpressurePolicy policy = BackpressurePolicy::DropOldest);
+
+    /**
+     * @brief Ustawia pojemność; nadmiar ponad nową pojemność jest usuwany zgodnie z polityką.
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief Zwraca pojemność [próbki].
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Ustawia politykę usuwania nadmiaru.
+     */
+    void setPolicy(BackpressurePolicy policy);
+
+    /**
+     * @brief Zwraca politykę usuwania nadmiaru.
+     */
+    BackpressurePolicy policy() const;
+
+    /**
+     * @brief Dopisuje porcję próbek.
+     * @param raw Próbki surowe.
+     * @param filtered Próbki po filtrach (ta sama liczba).
+     * @param count Liczba próbek.
+     * @return true, jeśli odbiorcę trzeba powiadomić (pierwsze dopisanie od ostatniego take()).
+     */
+    bool push(const SerialData *raw, const SerialData *filtered, size_t count);
+
+    /**
+     * @brief Zabiera wszystkie próbki z kolejki.
+     * @param out Wektor wynikowy (poprzednia zawartość jest usuwana, pojemność ponownie używana).
+     * @return Liczba zabranych próbek.
+     */
+    size_t take(std::vector<SamplePair> &out);
+
+    /**
+     * @brief Zwraca liczbę próbek w kolejce.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Usuwa próbki z kolejki (bez liczenia ich jako odrzuconych).
+     */
+    void clear();
+
+    /**
+     * @brief Zwraca kopię liczników.
+     */
+    BackpressureStats stats() const;
+
+    /**
+     * @brief Zeruje liczniki.
+     */
+    void resetStats();
+
+    /**
+     * @brief Zwraca nazwę polityki ("oldest", "newest", "decimate").
+     */
+    static const char *policyName(BackpressurePolicy policy);
+
+    /**
+     * @brief Odczytuje politykę z nazwy (jak w policyName()).
+     * @return false jeśli nazwa jest nieznana.
+     */
+    static bool parsePolicy(const std::string &name, BackpressurePolicy &policy);
+
+private:
+    /**
+     * @brief Usuwa nadmiar ponad pojemność zgodnie z polityką (wywoływane pod blokadą).
+     */
+    void trim();
+
+    mutable std::mutex lock;        ///< Chroni wszystkie pola.
+    std::vector<SamplePair> items;  ///< Próbki od najstarszej.
+    size_t limit;                   ///< Pojemność.
+    BackpressurePolicy mode;        ///< Polityka.
+    bool notified = false;          ///< Czy odbiorca został powiadomiony od ostatniego take().
+    BackpressureStats counters;     ///< Liczniki.
+};
+
+#endif // SAMPLEQUEUE_H
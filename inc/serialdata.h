@@ -0,0 +1,109 @@
+/**
+ * @file serialdata.h
+ * @brief Deklaracja struktury SerialData i kanałów telemetrii.
+ *
+ * Plik nie zależy od modułów Qt, dzięki czemu struktura może być używana zarówno
+ * przez SerialReader, jak i przez niezależne moduły (dekoder ramek, historia, narzędzia).
+ */
+
+#ifndef SERIALDATA_H
+#define SERIALDATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct SerialData
+ * @brief Struktura przechowująca dane odebrane z mikrokontrolera.
+ */
+struct SerialData {
+    float rpm = 0.0f;     ///< Obroty silnika [obr/min]
+    uint8_t pwm = 0.0f;   ///< Wypełnienie PWM [%]
+    float current = 0.0f; ///< Prąd [mA]
+    float voltage = 0.0f; ///< Napięcie [V]
+    float power = 0.0f;   ///< Moc [W]
+    float kp = 0.0f;      ///< Wzmocnienie proporcjonalne regulatora PID
+    float ki = 0.0f;      ///< Wzmocnienie całkujące regulatora PID
+    float kd = 0.0f;      ///< Wzmocnienie różniczkujące regulatora PID
+    uint8_t mode = 0.0f;  ///< Tryb pracy: 0 - ręczny, 1 - automatyczny
+    bool hasDeviceTime = false; ///< Czy ramka zawierała znacznik czasu urządzenia (ramka 0xA6)
+    uint32_t deviceTimeUs = 0;  ///< Znacznik czasu urządzenia [µs, licznik 32-bitowy]
+    int64_t timeUs = 0;   ///< Czas próbki na osi hosta [µs, zegar monotoniczny] — ustawia SerialReader
+};
+
+/**
+ * @struct CommandSample
+ * @brief Polecenie wysłane do mikrokontrolera (dziennik poleceń SerialReader::commandLog()).
+ */
+struct CommandSample {
+    int64_t timeUs = 0; ///< Czas zapisu ramki do portu na osi hosta [µs, zegar monotoniczny].
+    uint8_t type = 0;   ///< Typ polecenia (DataType).
+    float value = 0.0f; ///< Wartość w postaci wysłanej w ramce.
+};
+
+/**
+ * @enum Channel
+ * @brief Kanał (pole) struktury SerialData.
+ *
+ * Kolejność odpowiada kolejności pól w SerialData i jest wykorzystywana
+ * m.in. przez kolumnowy zapis historii (HistoryStore).
+ */
+enum class Channel : int {
+    Rpm,     ///< Obroty silnika [obr/min].
+    Pwm,     ///< Wypełnienie PWM (0-255).
+    Current, ///< Prąd [mA].
+    Voltage, ///< Napięcie [V].
+    Power,   ///< Moc [mW].
+    Kp,      ///< Wzmocnienie Kp.
+    Ki,      ///< Wzmocnienie Ki.
+    Kd,      ///< Wzmocnienie Kd.
+    Mode,    ///< Tryb pracy.
+    Count    ///< Liczba kanałów.
+};
+
+/// Liczba kanałów w strukturze SerialData.
+constexpr int channelCount = static_cast<int>(Channel::Count);
+
+/**
+ * @brief Zwraca wartość wybranego kanału jako float.
+ * @param data Dane z mikrokontrolera.
+ * @param channel Kanał.
+ */
+float channelValue(const SerialData &data, Channel channel);
+
+/**
+ * @brief Ustawia wartość wybranego kanału.
+ * @param data Dane do zmodyfikowania.
+ * @param channel Kanał.
+ * @param value Nowa wartość.
+ */
+void setChannelValue(SerialData &data, Channel channel, float value);
+
+/**
+ * @brief Kopiuje wartości jednego kanału partii próbek do ciągłej tablicy float.
+ *
+ * Pole struktury wybierane jest raz na partię, a nie dla każdej próbki, dzięki czemu pętla
+ * kopiowania może zostać zwektoryzowana przez kompilator.
+ * @param samples Próbki.
+ * @param count Liczba próbek.
+ * @param channel Kanał.
+ * @param out Tablica wynikowa (count elementów).
+ */
+void gatherChannel(const SerialData *samples, size_t count, Channel channel, float *out);
+
+/**
+ * @brief Zwraca nazwę kanału używaną w opcjach i plikach konfiguracyjnych (np. "current").
+ * @param channel Kanał.
+ */
+const char *channelName(Channel channel);
+
+/**
+ * @brief Wyszukuje kanał po nazwie (channelName()).
+ * @param name Nazwa kanału.
+ * @param channel Znaleziony kanał.
+ * @return true jeśli nazwa jest poprawna.
+ */
+bool channelFromName(const std::string &name, Channel &channel);
+
+#endif // SERIALDATA_H
@@ -2,7 +2,7 @@
  * @file serialreader.h
  * @brief Deklaracja klasy SerialReader do obsługi komunikacji szeregowej.
  *
- * Plik nagłówkowy definiujący strukturę SerialData, enumerację DataType oraz klasę SerialReader.
+ * Plik nagłówkowy definiujący enumerację DataType oraz klasę SerialReader (struktura SerialData: serialdata.h).
  * Klasa umożliwia komunikację z mikrokontrolerem przez port szeregowy (UART-USB),
  * obsługuje wysyłanie i odbiór danych w formacie ramek binarnych oraz
  * emituje odpowiednie sygnały do interfejsu użytkownika.
@@ -11,24 +11,28 @@
 #ifndef SERIALREADER_H
 #define SERIALREADER_H
 
+#include "serialdata.h"
+#include "blocktransfer.h"
+#include "clocksync.h"
+#include "databus.h"
+#include "framedecoder.h"
+#include "latencyhistogram.h"
+#include "limitmonitor.h"
+#include "posixserialtransport.h"
+#include "samplequeue.h"
+#include "telemetrymetrics.h"
+#include "shmtelemetry.h"
+#include "signalfilter.h"
 #include <QObject>
 #include <QSerialPort>
-
-/**
- * @struct SerialData
- * @brief Struktura przechowująca dane odebrane z mikrokontrolera.
- */
-struct SerialData {
-    float rpm = 0.0f;     ///< Obroty silnika [obr/min]
-    uint8_t pwm = 0.0f;   ///< Wypełnienie PWM [%]
-    float current = 0.0f; ///< Prąd [mA]
-    float voltage = 0.0f; ///< Napięcie [V]
-    float power = 0.0f;   ///< Moc [W]
-    float kp = 0.0f;      ///< Wzmocnienie proporcjonalne regulatora PID
-    float ki = 0.0f;      ///< Wzmocnienie całkujące regulatora PID
-    float kd = 0.0f;      ///< Wzmocnienie różniczkujące regulatora PID
-    uint8_t mode = 0.0f;  ///< Tryb pracy: 0 - ręczny, 1 - automatyczny
-};
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 /**
  * @enum DataType
@@ -44,9 +48,25 @@ enum DataType : quint8 {
     start_stop = 0x07 ///< Start/Stop silnika.
 };
 
+/**
+ * @enum SerialBackend
+ * @brief Sposób dostępu do portu szeregowego.
+ */
+enum class SerialBackend {
+    QtSerialPort, ///< QSerialPort w pętli zdarzeń osobnego wątku portu (domyślnie, wszystkie platformy).
+    Posix         ///< Bezpośredni dostęp do tty przez epoll w osobnym wątku (tylko Linux).
+};
+
+Q_DECLARE_METATYPE(SerialData)
+
 /**
  * @class SerialReader
  * @brief Klasa odpowiedzialna za komunikację z mikrokontrolerem przez port szeregowy.
+ *
+ * Dekodowanie, reguły alarmowe i zatrzymanie awaryjne działają w wątku odbioru: przy transporcie
+ * POSIX w wątku epoll, przy QSerialPort w osobnym wątku portu (ioThread), do którego należą
+ * QSerialPort i timery transferu blokowego oraz wykrywania prędkości. Metody publiczne wywoływane
+ * z wątku GUI wykonują operacje na QSerialPort w wątku portu (z oczekiwaniem na wynik).
  */
 class SerialReader : public QObject {
     Q_OBJECT
@@ -57,6 +77,11 @@ public:
      */
     explicit SerialReader(QObject *parent = nullptr);
 
+    /**
+     * @brief Zamyka port i kończy wątek portu.
+     */
+    ~SerialReader() override;
+
     /**
      * @brief Rozpoczyna komunikację przez port szeregowy.
      * @param portName Nazwa portu (np. COM3 lub /dev/ttyUSB0).
@@ -64,17 +89,260 @@ public:
      */
     void start(const QString &portName, int baudRate = QSerialPort::Baud115200);
 
+    /**
+     * @brief Otwiera port i automatycznie wykrywa prędkość transmisji.
+     *
+     * Kolejne prędkości są sprawdzane przez krótki czas; wybierana jest ta,
+     * przy której odbierane są poprawne ramki 0xA5 z prawidłową sumą kontrolną.
+     * Wynik zgłaszany jest sygnałem baudRateDetected() lub baudRateDetectionFailed().
+     * @param portName Nazwa portu (np. COM3 lub /dev/ttyUSB0).
+     * @param candidates Prędkości do sprawdzenia (pusta lista = autoBaudCandidates()).
+     */
+    void startAutoBaud(const QString &portName, const QList<int> &candidates = {});
+
+    /**
+     * @brief Zwraca domyślną listę prędkości sprawdzanych przy automatycznym wykrywaniu.
+     */
+    static QList<int> autoBaudCandidates();
+
     /**
      * @brief Zatrzymuje komunikację (zamyka port).
      */
     void stop();
 
+    /**
+     * @brief Wybiera sposób dostępu do portu; zmiana obowiązuje od następnego wywołania start().
+     * @param backend Sposób dostępu (QSerialPort lub transport POSIX).
+     */
+    void setBackend(SerialBackend backend);
+
+    /**
+     * @brief Zwraca wybrany sposób dostępu do portu.
+     */
+    SerialBackend backend() const { return activeBackend; }
+
+    /**
+     * @brief Histogram czasu od odebrania bajtów do sparsowania ramki [ns] (od ostatniego start()).
+     */
+    const LatencyHistogram &parseLatency() const { return parseLatencyNs; }
+
+    /**
+     * @brief Histogram opóźnienia dostarczenia ramki: czas przetworzenia na hoście minus czas nadania
+     * wyznaczony ze znacznika urządzenia (ClockSync) [ns].
+     *
+     * W odróżnieniu od parseLatency() obejmuje całą drogę od urządzenia — sterownik, bufor
+     * QSerialPort i oczekiwanie w pętli zdarzeń wątku portu — więc porównuje sposoby dostępu na równych
+     * zasadach. Liczony względem najmniejszego zaobserwowanego opóźnienia (dolna obwiednia
+     * ClockSync), tylko dla ramek 0xA6 po synchronizacji zegarów.
+     */
+    const LatencyHistogram &deliveryLatency() const { return deliveryLatencyNs; }
+
+    /**
+     * @brief Histogram odstępów między kolejnymi porcjami danych zawierającymi ramki [ns].
+     */
+    const LatencyHistogram &arrivalInterval() const { return arrivalIntervalNs; }
+
+    /**
+     * @brief Zwraca tekstowe podsumowanie pomiarów opóźnień dla bieżącego sposobu dostępu.
+     */
+    QString latencySummary() const;
+
+    /**
+     * @brief Ustawia limit bufora odczytu QSerialPort (0 = bez limitu, jak domyślnie w Qt).
+     *
+     * Obowiązuje od następnego otwarcia portu. Przy pełnym buforze QSerialPort przestaje
+     * czytać z systemu do czasu opróżnienia; takie odczyty są liczone w metrykach.
+     * @param bytes Rozmiar bufora [bajty].
+     */
+    void setReadBufferSize(qint64 bytes);
+
+    /**
+     * @brief Ustawia pojemność kolejki próbek oczekujących na wyświetlenie (displayBus()).
+     * @param frames Pojemność [próbki].
+     */
+    void setDeliveryQueueSize(size_t frames) { deliveryQueue.setCapacity(frames); }
+
+    /**
+     * @brief Ustawia politykę usuwania nadmiaru próbek, gdy odbiorca nie nadąża.
+     */
+    void setBackpressurePolicy(BackpressurePolicy policy) { deliveryQueue.setPolicy(policy); }
+
+    /**
+     * @brief Zwraca liczniki kolejki próbek do wyświetlenia.
+     */
+    BackpressureStats backpressureStats() const { return deliveryQueue.stats(); }
+
+    /**
+     * @brief Zwraca magistralę wszystkich próbek (historia, nagrywanie, analiza).
+     *
+     * Polityka usuwania nadmiaru (setBackpressurePolicy()) tej magistrali nie dotyczy — próbki
+     * czekają na wątek GUI w kolejce bez limitu i są publikowane wszystkie, porcjami nie większymi
+     * niż pojemność magistrali, z dispatch() po każdej. Subskrybenci z funkcją zwrotną dostają
+     * każdą porcję w wątku GUI, pozostali odczytują ją przez DataBus::read() (także z innego wątku).
+     * Pole SerialData::timeUs zawiera czas próbki: ze znacznika urządzenia przeliczonego przez
+     * ClockSync (ramka 0xA6) lub czas odebrania porcji danych (ramka 0xA5). Wartości po filtrach
+     * kanałów (setChannelFilter()) są w SamplePair::filtered.
+     */
+    DataBus<SamplePair> &dataBus() { return sampleBus; }
+
+    /**
+     * @brief Zwraca magistralę próbek do wyświetlenia (wartości bieżące, wykresy).
+     *
+     * Te same próbki co w dataBus(), ale po kolejce z polityką usuwania nadmiaru — po zablokowaniu
+     * wątku GUI odbiorca dostaje najwyżej pojemność kolejki najnowszych próbek zamiast zaległości.
+     */
+    DataBus<SamplePair> &displayBus() { return displaySampleBus; }
+
+    /**
+     * @brief Zwraca dziennik poleceń wysłanych do mikrokontrolera.
+     *
+     * Każda ramka polecenia zapisana do portu (sendData(), postCommand(), zatrzymanie awaryjne)
+     * jest publikowana z czasem zapisu na tej samej osi co SerialData::timeUs. Publikacja odbywa
+     * się w wątku wysyłającym, więc dziennik odczytuje się wyłącznie przez DataBus::read().
+     */
+    DataBus<CommandSample> &commandLog() { return commandBus; }
+
+    /**
+     * @brief Wstępnie zagregowane metryki odbioru danych (do eksportu przez MetricsExporter).
+     */
+    TelemetryMetrics &metrics() { return telemetry; }
+
+    /**
+     * @brief Włącza lub wyłącza publikowanie próbek do pamięci współdzielonej (ShmTelemetryWriter).
+     *
+     * Przy włączeniu tworzony jest segment i uruchamiany odbiór poleceń klientów,
+     * które są przekazywane do sendData(). Segment istnieje do zniszczenia obiektu.
+     * @param enabled true = publikowanie włączone.
+     * @param name Nazwa segmentu.
+     * @return true jeśli publikowanie jest aktywne (lub zostało wyłączone).
+     */
+    bool setSharedMemoryEnabled(bool enabled, const QString &name = QString::fromLatin1(shmDefaultName));
+
+    /**
+     * @brief Ustawia łańcuch filtrów kanału (format: signalfilter.h), np. "median:5,ema:0.2".
+     *
+     * Bezpieczne wywołanie z wątku GUI również podczas odbioru danych; stan filtrów kanału
+     * zaczyna się od nowa.
+     * @param channel Kanał.
+     * @param spec Opis łańcucha (pusty = brak filtrowania).
+     * @param error Opis błędu (opcjonalnie).
+     * @return true jeśli opis jest poprawny.
+     */
+    bool setChannelFilter(Channel channel, const QString &spec, QString *error = nullptr);
+
+    /**
+     * @brief Zwraca opis łańcucha filtrów kanału.
+     */
+    QString channelFilter(Channel channel) const;
+
+    /**
+     * @brief Ustawia reguły alarmowe (format: limitmonitor.h), sprawdzane dla każdej ramki w wątku odbioru.
+     *
+     * Przy błędzie którejkolwiek reguły zestaw pozostaje bez zmian.
+     * @param specs Opisy reguł (pusta lista = brak monitorowania).
+     * @param error Opis błędu (opcjonalnie).
+     * @return true jeśli wszystkie opisy są poprawne.
+     */
+    bool setLimitRules(const QStringList &specs, QString *error = nullptr);
+
+    /**
+     * @brief Zwraca opisy reguł alarmowych w postaci znormalizowanej.
+     */
+    QStringList limitRules() const;
+
+    /**
+     * @brief Wysyła zatrzymanie awaryjne (STOP i PWM 0) z pominięciem kolejki GUI i blokuje uruchomienie.
+     *
+     * Trwający transfer blokowy jest przerywany (kolejne jego ramki nie są już zapisywane), a bajty
+     * oczekujące w buforze nadawczym są przed zapisem odrzucane, więc zatrzymanie nie czeka
+     * za wcześniej zleconymi danymi. Bezpieczne wywołanie z dowolnego wątku; do czasu
+     * clearEmergencyStop() polecenia uruchomienia silnika (START, niezerowe PWM lub RPM) są odrzucane.
+     */
+    void emergencyStop();
+
+    /**
+     * @brief Zdejmuje blokadę po zatrzymaniu awaryjnym.
+     */
+    void clearEmergencyStop();
+
+    /**
+     * @brief Czy aktywna jest blokada po zatrzymaniu awaryjnym.
+     */
+    bool isEmergencyStopped() const { return emergencyLatched.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Histogram czasu od odebrania porcji z przekroczeniem do zapisania zatrzymania do portu [ns].
+     */
+    const LatencyHistogram &emergencyStopLatency() const { return emergencyLatencyNs; }
+
+    /**
+     * @brief Pobiera ukończone rekordy alarmów (z próbkami po zdarzeniu).
+     */
+    std::vector<AlarmRecord> takeAlarmRecords();
+
+    /**
+     * @brief Rozpoczyna zapis bloku danych (np. tablicy nastaw, kalibracji) do obszaru urządzenia.
+     *
+     * Transfer przebiega asynchronicznie: bloki wysyłane są z oknem potwierdzeń (blocktransfer.h),
+     * postęp zgłaszany jest sygnałem blockTransferProgress(), a wynik — blockTransferFinished().
+     * Telemetria jest w tym czasie odbierana dalej (urządzenie wysyła ją rzadziej).
+     * @param region Identyfikator obszaru urządzenia.
+     * @param data Dane do zapisania.
+     * @param options Parametry transferu (przepustowość łącza uzupełniana z prędkości portu).
+     * @return false, jeśli port jest zamknięty, trwa inny transfer, aktywne jest zatrzymanie awaryjne
+     * lub parametry są niepoprawne.
+     */
+    bool startBlockUpload(quint8 region, const QByteArray &data, BlockTransferOptions options = {});
+
+    /**
+     * @brief Rozpoczyna odczyt fragmentu obszaru urządzenia; dane przekazuje blockTransferFinished().
+     * @param region Identyfikator obszaru urządzenia.
+     * @param offset Przesunięcie w obszarze [bajty].
+     * @param size Liczba bajtów do odczytu.
+     * @param options Parametry transferu.
+     * @return false, jeśli port jest zamknięty, trwa inny transfer, aktywne jest zatrzymanie awaryjne
+     * lub parametry są niepoprawne.
+     */
+    bool startBlockDownload(quint8 region, quint32 offset, quint32 size, BlockTransferOptions options = {});
+
+    /**
+     * @brief Przerywa trwający transfer blokowy.
+     */
+    void abortBlockTransfer();
+
+    /**
+     * @brief Czy trwa transfer blokowy.
+     */
+    bool isBlockTransferActive() const;
+
+    /**
+     * @brief Zwraca tekstowe podsumowanie ostatniego transferu (przepustowość względem łącza).
+     */
+    QString blockTransferSummary() const;
+
     /**
      * @brief Wysyła ramkę danych do mikrokontrolera.
      * @param type Typ danych (enum DataType), określający rodzaj wysyłanej wartości.
      * @param value Wartość typu float do wysłania.
+     * @return true jeśli ramka została zapisana do portu.
+     */
+    bool sendData(DataType type, float value);
+
+    /**
+     * @brief Wysyła polecenie z dowolnego wątku (np. z wątku profilu nastaw).
+     * @param type Typ danych.
+     * @param value Wartość do wysłania.
+     * @param onWritten Wywoływane z chwilą zapisu ramki do portu [ns, PosixSerialTransport::monotonicNs()];
+     *        przy QSerialPort dopiero z pętli zdarzeń wątku portu. Nie jest wywoływane, jeśli polecenie odrzucono.
      */
-    void sendData(DataType type, float value);
+    void postCommand(DataType type, float value, std::function<void(int64_t)> onWritten = {});
+
+    /**
+     * @brief Buduje 7-bajtową ramkę polecenia (0xB5, typ, float, XOR).
+     * @param type Typ danych.
+     * @param value Wartość do wysłania.
+     */
+    static QByteArray encodeCommand(DataType type, float value);
 
     /**
      * @brief Sprawdza, czy port szeregowy jest otwarty.
@@ -90,12 +358,6 @@ public:
 
 signals:
 
-    /**
-     * @brief Sygnał emitowany po odebraniu i sparsowaniu poprawnej ramki.
-     * @param data Struktura zawierająca wszystkie dane z ramki.
-     */
-    void newDataReceived(const SerialData &data);
-
     /**
      * @brief Sygnał emitowany w przypadku błędu otwarcia lub pracy z portem.
      * @param error Treść komunikatu błędu.
@@ -107,6 +369,46 @@ signals:
      */
     void portDisconnected();
 
+    /**
+     * @brief Sygnał emitowany po automatycznym wykryciu prędkości transmisji.
+     * @param baudRate Wykryta prędkość [Bd].
+     */
+    void baudRateDetected(int baudRate);
+
+    /**
+     * @brief Sygnał emitowany, gdy żadna ze sprawdzanych prędkości nie dała poprawnych ramek.
+     */
+    void baudRateDetectionFailed();
+
+    /**
+     * @brief Sygnał emitowany po wyzwoleniu reguły alarmowej (zatrzymanie awaryjne zostało już wysłane).
+     * @param rule Opis reguły.
+     * @param value Wartość, która przekroczyła próg.
+     * @param emergencyStop Czy wysłano zatrzymanie awaryjne.
+     * @param reactionNs Czas od odebrania porcji danych do zapisania zatrzymania do portu [ns] (0 = brak).
+     */
+    void limitExceeded(const QString &rule, float value, bool emergencyStop, qint64 reactionNs);
+
+    /**
+     * @brief Sygnał emitowany, gdy rekordy alarmów są gotowe do pobrania (takeAlarmRecords()).
+     */
+    void alarmRecorded();
+
+    /**
+     * @brief Sygnał postępu transferu blokowego.
+     * @param done Bajty potwierdzone (zapis) lub odebrane (odczyt).
+     * @param total Wszystkie bajty transferu.
+     */
+    void blockTransferProgress(qint64 done, qint64 total);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu transferu blokowego.
+     * @param ok Czy transfer zakończył się poprawnie.
+     * @param data Odczytane dane (odczyt) lub dane zapisane (zapis).
+     * @param error Opis błędu (gdy ok == false).
+     */
+    void blockTransferFinished(bool ok, const QByteArray &data, const QString &error);
+
 private slots:
 
     /**
@@ -115,18 +417,182 @@ private slots:
      */
     void handleReadyRead();
 
+    /**
+     * @brief Kończy bieżący krok automatycznego wykrywania prędkości i przechodzi do następnego.
+     */
+    void finishBaudProbeStep();
+
+    /**
+     * @brief Przekazuje polecenia klientów pamięci współdzielonej do sendData().
+     */
+    void processSharedCommands();
+
+    /**
+     * @brief Zabiera próbki z obu kolejek i publikuje je subskrybentom dataBus() i displayBus().
+     */
+    void deliverSamples();
+
+    /**
+     * @brief Sprawdza czas oczekiwania transferu blokowego (ponowienia bloków).
+     */
+    void pollBlockTransfer();
+
 private:
-    QSerialPort serial; ///< Obiekt Qt obsługujący port szeregowy
-    QByteArray buffer;  ///< Bufor do składania ramek z bajtów
-    static constexpr int frameSize = 32; ///< Długość oczekiwanej ramki danych
+    /**
+     * @brief Otwiera port przez QSerialPort.
+     * @param portName Nazwa portu.
+     * @param baudRate Prędkość transmisji [Bd].
+     */
+    void openQtPort(const QString &portName, int baudRate);
+
+    /**
+     * @brief Otwiera port przez PosixSerialTransport (wątek epoll).
+     * @param portName Nazwa portu.
+     * @param baudRate Prędkość transmisji [Bd].
+     */
+    void openPosixPort(const QString &portName, int baudRate);
+
+    /**
+     * @brief Dekoduje porcję bajtów, mierzy opóźnienia i przekazuje próbki do kolejki dostarczania.
+     *
+     * Wywoływana w wątku portu (QSerialPort) lub w wątku odczytu (transport POSIX); próbki
+     * dostarczane są do wątku GUI jednym zdarzeniem na wszystkie próbki zebrane od poprzedniego
+     * dostarczenia.
+     * @param data Odebrane bajty.
+     * @param size Liczba bajtów.
+     * @param arrivalNs Czas odebrania bajtów [ns, zegar monotoniczny].
+     */
+    void processChunk(const char *data, int size, qint64 arrivalNs);
+
+    /**
+     * @brief Sprawdza reguły alarmowe dla ostatniej porcji ramek i w razie potrzeby zatrzymuje silnik.
+     * @param arrivalNs Czas odebrania porcji [ns].
+     */
+    void checkLimits(qint64 arrivalNs);
+
+    /**
+     * @brief Przekazuje ramki transferu blokowego z ostatniej porcji danych do BlockTransfer.
+     */
+    void handleBlockFrames();
+
+    /**
+     * @struct BlockNotice
+     * @brief Postęp lub wynik transferu blokowego do zgłoszenia po zwolnieniu blockMutex.
+     */
+    struct BlockNotice {
+        bool progress = false; ///< Czy zgłosić postęp.
+        qint64 done = 0;       ///< Bajty przesłane.
+        qint64 total = 0;      ///< Wszystkie bajty.
+        bool finished = false; ///< Czy zgłosić zakończenie.
+        bool ok = false;       ///< Wynik.
+        QByteArray data;       ///< Dane transferu.
+        QString error;         ///< Opis błędu.
+    };
+
+    /**
+     * @brief Wysyła bajty transferu blokowego i zbiera zmiany do zgłoszenia (wywoływana pod blockMutex).
+     *
+     * Niepełny zapis do portu lub zatrzymanie awaryjne przerywa transfer z błędem.
+     * @param out Bajty do wysłania.
+     */
+    BlockNotice flushBlockTransfer(const std::string &out);
+
+    /**
+     * @brief Emituje sygnały postępu i zakończenia transferu blokowego.
+     */
+    void emitBlockNotice(const BlockNotice &notice);
+
+    /**
+     * @brief Zapisuje bajty do otwartego portu (transport POSIX z dowolnego wątku, QSerialPort w wątku portu).
+     * @return true jeśli zapisano (QSerialPort: przyjęto do bufora) wszystkie bajty.
+     */
+    bool writeRaw(const char *data, int size);
 
     /**
-   * @brief Próbuje sparsować jedną ramkę danych z bufora.
-   * @param frame Bufor zawierający odebraną ramkę.
-   * @param data Struktura, do której zapisane zostaną odczytane dane.
-   * @return true jeśli parsowanie i suma kontrolna są poprawne, false w przeciwnym wypadku.
-   */
-    bool parseFrame(const QByteArray &frame, SerialData &data);
+     * @brief Publikuje wysłane ramki poleceń w dzienniku commandLog().
+     * @param frames Jedna lub więcej 7-bajtowych ramek z encodeCommand().
+     */
+    void logCommands(const QByteArray &frames);
+
+    /**
+     * @brief Czy polecenie uruchamia silnik przy aktywnej blokadzie zatrzymania awaryjnego.
+     */
+    bool isBlockedByEmergencyStop(DataType type, float value) const;
+
+    /**
+     * @brief Ustawia prędkość transmisji na otwartym porcie.
+     *
+     * Prędkości powyżej 115200 Bd ustawiane są na Linuksie przez termios2/BOTHER.
+     * @param baudRate Prędkość transmisji [Bd].
+     * @return true jeśli prędkość została ustawiona.
+     */
+    bool applyBaudRate(int baudRate);
+
+    /**
+     * @brief Wykonuje funkcję w wątku portu i czeka na jej zakończenie (w wątku portu — od razu).
+     *
+     * Wątek portu nigdy nie czeka na wątek GUI, więc oczekiwanie nie grozi zakleszczeniem,
+     * o ile wywołujący nie trzyma blokady używanej w wątku portu.
+     */
+    template <typename Function>
+    void runOnIoThread(Function &&function);
+
+    QThread ioThread;             ///< Wątek portu: QSerialPort, timery transferu i wykrywania prędkości
+    QObject ioContext;            ///< Kontekst wywołań w wątku portu
+    QSerialPort serial;           ///< Obiekt Qt obsługujący port szeregowy (wątek portu)
+    std::atomic<bool> serialOpen{false}; ///< Czy QSerialPort jest otwarty (odczyt z dowolnego wątku)
+    PosixSerialTransport posix;   ///< Transport POSIX (epoll, ASYNC_LOW_LATENCY)
+    SerialBackend activeBackend = SerialBackend::QtSerialPort; ///< Wybrany sposób dostępu do portu
+    FrameDecoder decoder;         ///< Dekoder ramek telemetrii
+    QVector<SerialData> decoded;  ///< Ramki zdekodowane z ostatniej porcji danych
+    QVector<SerialData> filtered; ///< Ramki z ostatniej porcji po filtrach kanałów
+    ChannelFilterBank filters;    ///< Łańcuchy filtrów kanałów
+    SampleQueue deliveryQueue;    ///< Próbki oczekujące na wyświetlenie (ograniczona pojemność)
+    SampleQueue recordQueue{SampleQueue::unbounded}; ///< Wszystkie próbki oczekujące na publikację w dataBus()
+    std::vector<SamplePair> delivering; ///< Próbki zabrane z kolejki w deliverSamples()
+    DataBus<SamplePair> sampleBus; ///< Magistrala wszystkich próbek (porcjami)
+    DataBus<SamplePair> displaySampleBus; ///< Magistrala próbek do wyświetlenia (po polityce kolejki)
+    DataBus<CommandSample> commandBus{1024}; ///< Dziennik wysłanych poleceń
+    uint64_t deliveryDropsReported = 0; ///< Usunięte próbki już dodane do metryk
+    qint64 readBufferBytes = 64 * 1024; ///< Limit bufora odczytu QSerialPort [bajty]
+    mutable std::mutex filtersMutex; ///< Chroni filters (konfiguracja z GUI, przetwarzanie w wątku odczytu)
+    LimitMonitor limits;          ///< Reguły alarmowe i rekordy alarmów
+    std::vector<LimitEvent> limitEvents; ///< Wyzwolenia z ostatniej porcji danych
+    mutable std::mutex limitsMutex; ///< Chroni limits (konfiguracja z GUI, sprawdzanie w wątku odczytu)
+    std::atomic<bool> limitsActive{false};     ///< Czy są reguły do sprawdzania
+    std::atomic<bool> emergencyLatched{false}; ///< Blokada po zatrzymaniu awaryjnym
+    LatencyHistogram emergencyLatencyNs; ///< Czas wykrycie -> zatrzymanie zapisane do portu
+    QTimer baudProbeTimer;        ///< Timer kroku wykrywania prędkości transmisji (wątek portu)
+    QList<int> baudProbeRates;    ///< Prędkości pozostałe do sprawdzenia
+    int baudProbeCurrent = 0;     ///< Aktualnie sprawdzana prędkość
+    int baudProbeBest = 0;        ///< Najlepsza dotychczas prędkość
+    quint64 baudProbeBestScore = 0; ///< Liczba poprawnych ramek dla najlepszej prędkości
+    bool baudProbing = false;     ///< Czy trwa wykrywanie prędkości transmisji
+    LatencyHistogram parseLatencyNs;    ///< Czas odbiór -> sparsowana ramka (bieżące połączenie)
+    LatencyHistogram parseLatencyTotalNs; ///< Czas odbiór -> sparsowana ramka od startu procesu (metryki)
+    LatencyHistogram arrivalIntervalNs; ///< Odstępy między porcjami danych z ramkami
+    LatencyHistogram deliveryLatencyNs; ///< Znacznik urządzenia -> ramka przetworzona na hoście
+    qint64 lastArrivalNs = 0;     ///< Czas odebrania poprzedniej porcji z ramkami
+    ClockSync clockSync;          ///< Synchronizacja zegara urządzenia (wątek odbioru danych)
+    TelemetryMetrics telemetry;   ///< Liczniki i ostatnie wartości do eksportu metryk
+    ShmTelemetryWriter shm;       ///< Bufor próbek i kolejka poleceń w pamięci współdzielonej
+    std::atomic<bool> shmPublishing{false}; ///< Czy próbki są publikowane do pamięci współdzielonej
+    QTimer shmCommandTimer;       ///< Timer odbioru poleceń z pamięci współdzielonej
+    BlockTransfer blockTransfer;  ///< Strona hosta transferu blokowego
+    std::vector<BlockFrame> blockFrames; ///< Ramki transferu blokowego z ostatniej porcji danych
+    mutable std::mutex blockMutex; ///< Chroni blockTransfer (start z GUI, potwierdzenia w wątku odczytu)
+    qint64 blockProgressReported = -1; ///< Ostatnio zgłoszony postęp transferu [bajty]
+    bool blockFinishPending = false; ///< Czy zakończenie transferu nie zostało jeszcze zgłoszone
+    QTimer blockTimer;            ///< Timer sprawdzania czasu oczekiwania transferu blokowego (wątek portu)
+    std::atomic<int> linkBaudRate{0}; ///< Prędkość otwartego portu [Bd] (zapis w wątku portu, odczyt z dowolnego wątku)
 };
 
+template <typename Function>
+void SerialReader::runOnIoThread(Function &&function) {
+    if (QThread::currentThread() == &ioThread)
+        function();
+    else
+        QMetaObject::invokeMethod(&ioContext, std::forward<Function>(function), Qt::BlockingQueuedConnection);
+}
+
 #endif // SERIALREADER_H
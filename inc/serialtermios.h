@@ -0,0 +1,28 @@
+/**
+ * @file serialtermios.h
+ * @brief Niskopoziomowe ustawienia portu szeregowego (Linux termios2/BOTHER).
+ *
+ * Funkcje pozwalają ustawić niestandardową prędkość transmisji (np. 1-3 Mbaud
+ * na przejściówkach CH340/CP210x/FTDI), dla której nie istnieje stała Bxxx.
+ * Na systemach innych niż Linux funkcje zwracają błąd.
+ */
+
+#ifndef SERIALTERMIOS_H
+#define SERIALTERMIOS_H
+
+/**
+ * @brief Ustawia dowolną prędkość transmisji przez termios2 (flaga BOTHER).
+ * @param fd Deskryptor otwartego portu szeregowego.
+ * @param baudRate Prędkość transmisji [Bd].
+ * @return true jeśli sterownik przyjął prędkość, false w przeciwnym wypadku.
+ */
+bool setCustomBaudRate(int fd, int baudRate);
+
+/**
+ * @brief Odczytuje prędkość transmisji faktycznie ustawioną przez sterownik.
+ * @param fd Deskryptor otwartego portu szeregowego.
+ * @return Prędkość [Bd] lub -1 w przypadku błędu.
+ */
+int actualBaudRate(int fd);
+
+#endif // SERIALTERMIOS_H
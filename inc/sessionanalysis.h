@@ -0,0 +1,169 @@
+/**
+ * @file sessionanalysis.h
+ * @brief Wsadowa analiza nagranych sesji: wskaźniki (KPI) każdego przebiegu.
+ *
+ * Każdy plik przetwarzany jest jednym przebiegiem strumieniowym, bez wczytywania całości:
+ * - nagrania sesji (.wds, SessionFile) — blok po bloku ze zmapowanego pliku,
+ * - surowe zapisy strumienia z portu (.bin, .raw) — porcjami przez FrameDecoder, ten sam
+ *   dekoder co w SerialReader, więc liczniki błędów są liczone tak samo jak na żywo.
+ *
+ * Pliki rozdzielane są między wątki dynamicznie (wspólny licznik zadań, największe pliki
+ * najpierw), więc wolniejszy wątek nie zostaje z kolejką przydzieloną z góry.
+ *
+ * Czas ustalenia RPM liczony jest dla skoków PWM w trybie ręcznym: od skoku do ostatniego wyjścia
+ * RPM poza pasmo wokół wartości ustalonej (średnia z ostatnich settleHoldS sekund przed kolejnym
+ * skokiem, najwyżej maxSettlingS po skoku).
+ */
+
+#ifndef SESSIONANALYSIS_H
+#define SESSIONANALYSIS_H
+
+#include "serialdata.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct AnalysisOptions
+ * @brief Parametry analizy.
+ */
+struct AnalysisOptions {
+    double settleBand = 0.02;        ///< Pasmo ustalenia względem wartości ustalonej (2%).
+    double settleBandMinRpm = 20.0;  ///< Najwęższe pasmo ustalenia [obr/min].
+    double settleHoldS = 0.5;        ///< Okno wyznaczania wartości ustalonej [s].
+    double maxSettlingS = 30.0;      ///< Najdłuższy analizowany czas po skoku [s] (ogranicza pamięć).
+    float pwmStepThreshold = 5.0f;   ///< Najmniejsza zmiana PWM (0-255) uznawana za skok.
+    double maxGapS = 1.0;            ///< Przerwy dłuższe nie są całkowane do energii [s].
+    int64_t rawSamplePeriodUs = 1000; ///< Okres próbek surowego zapisu bez znaczników czasu urządzenia [µs].
+};
+
+/**
+ * @struct SessionKpi
+ * @brief Wskaźniki jednego przebiegu.
+ */
+struct SessionKpi {
+    QString path;                 ///< Plik.
+    QString error;                ///< Opis błędu (pusty = analiza poprawna).
+    bool raw = false;             ///< Czy plik był surowym zapisem strumienia.
+    qint64 bytes = 0;             ///< Rozmiar pliku [B].
+    qint64 samples = 0;           ///< Liczba próbek.
+    double durationS = 0.0;       ///< Czas przebiegu [s].
+    double meanCurrent = 0.0;     ///< Średni prąd [mA].
+    float peakCurrent = 0.0f;     ///< Szczytowy prąd [mA].
+    double meanRpm = 0.0;         ///< Średnie obroty [obr/min].
+    float peakRpm = 0.0f;         ///< Szczytowe obroty [obr/min].
+    int steps = 0;                ///< Liczba przeanalizowanych skoków PWM.
+    int unsettledSteps = 0;       ///< Skoki, po których RPM nie ustaliło się w oknie.
+    double meanSettlingS = 0.0;   ///< Średni czas ustalenia RPM [s] (skoki ustalone).
+    double maxSettlingS = 0.0;    ///< Najdłuższy czas ustalenia RPM [s].
+    double energyJ = 0.0;         ///< Zużyta energia [J] (całka mocy).
+    uint64_t frames = 0;          ///< Poprawne ramki.
+    uint64_t checksumErrors = 0;  ///< Ramki z błędną sumą kontrolną.
+    uint64_t droppedBytes = 0;    ///< Bajty odrzucone przy synchronizacji.
+    double analysisMs = 0.0;      ///< Czas analizy pliku [ms].
+
+    /**
+     * @brief Czy analiza zakończyła się poprawnie.
+     */
+    bool ok() const { return error.isEmpty(); }
+
+    /**
+     * @brief Udział ramek z błędną sumą kontrolną wśród wszystkich ramek.
+     */
+    double checksumErrorRate() const {
+        const uint64_t total = frames + checksumErrors;
+        return total > 0 ? static_cast<double>(checksumErrors) / total : 0.0;
+    }
+};
+
+/**
+ * @class SessionAnalyzer
+ * @brief Akumulator wskaźników przebiegu zasilany kolejnymi próbkami.
+ */
+class SessionAnalyzer
+{
+public:
+    /**
+     * @brief Konstruktor akumulatora.
+     * @param options Parametry analizy.
+     */
+    explicit SessionAnalyzer(const AnalysisOptions &options = AnalysisOptions());
+
+    /**
+     * @brief Dodaje próbkę.
+     * @param timeUs Czas próbki [µs]; kolejne próbki muszą mieć niemalejący czas.
+     * @param rpm Obroty [obr/min].
+     * @param pwm Wypełnienie PWM (0-255).
+     * @param current Prąd [mA].
+     * @param power Moc [mW].
+     * @param mode Tryb pracy (0 = ręczny).
+     */
+    void add(int64_t timeUs, float rpm, float pwm, float current, float power, float mode);
+
+    /**
+     * @brief Czy dodano już jakąkolwiek próbkę.
+     */
+    bool hasSamples() const { return samples > 0; }
+
+    /**
+     * @brief Kończy analizę i uzupełnia wskaźniki próbek w kpi (liczniki łącza pozostają bez zmian).
+     */
+    void finish(SessionKpi &kpi);
+
+private:
+    /**
+     * @brief Wyznacza czas ustalenia dla bieżącego skoku i kończy jego zbieranie.
+     */
+    void closeStep();
+
+    AnalysisOptions options;      ///< Parametry analizy.
+    qint64 samples = 0;           ///< Liczba próbek.
+    int64_t firstUs = 0;          ///< Czas pierwszej próbki [µs].
+    int64_t lastUs = 0;           ///< Czas ostatniej próbki [µs].
+    double currentSum = 0.0;      ///< Suma prądu.
+    double rpmSum = 0.0;          ///< Suma obrotów.
+    float peakCurrent = 0.0f;     ///< Szczytowy prąd.
+    float peakRpm = 0.0f;         ///< Szczytowe obroty.
+    double energyMilliJ = 0.0;    ///< Energia [mJ].
+    float lastPower = 0.0f;       ///< Moc poprzedniej próbki [mW].
+    float lastPwm = 0.0f;         ///< PWM poprzedniej próbki.
+    bool inStep = false;          ///< Czy zbierane są próbki po skoku.
+    int64_t stepUs = 0;           ///< Czas skoku [µs].
+    std::vector<int64_t> stepTimes; ///< Czasy próbek po skoku.
+    std::vector<float> stepRpm;   ///< Obroty po skoku.
+    int steps = 0;                ///< Przeanalizowane skoki.
+    int unsettled = 0;            ///< Skoki bez ustalenia.
+    double settlingSum = 0.0;     ///< Suma czasów ustalenia [s].
+    double settlingMax = 0.0;     ///< Najdłuższy czas ustalenia [s].
+};
+
+/**
+ * @brief Analizuje jeden plik (.wds lub surowy zapis strumienia) jednym przebiegiem.
+ * @param path Ścieżka pliku.
+ * @param options Parametry analizy.
+ */
+SessionKpi analyzeSessionFile(const QString &path, const AnalysisOptions &options = AnalysisOptions());
+
+/**
+ * @brief Analizuje pliki równolegle.
+ * @param paths Ścieżki plików.
+ * @param jobs Liczba wątków (0 = liczba rdzeni).
+ * @param options Parametry analizy.
+ * @return Wskaźniki w kolejności paths.
+ */
+QVector<SessionKpi> analyzeSessions(const QStringList &paths, int jobs, const AnalysisOptions &options = AnalysisOptions());
+
+/**
+ * @brief Składa tabelę podsumowania (stała szerokość kolumn) z wierszem sumarycznym.
+ */
+QString formatKpiTable(const QVector<SessionKpi> &kpis);
+
+/**
+ * @brief Zapisuje wskaźniki do pliku CSV (separator ',', liczby w locale "C").
+ * @return true jeśli zapis się powiódł.
+ */
+bool writeKpiCsv(const QString &path, const QVector<SessionKpi> &kpis);
+
+#endif // SESSIONANALYSIS_H
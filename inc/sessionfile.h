@@ -0,0 +1,261 @@
+/**
+ * @file sessionfile.h
+ * @brief Pliki nagranych sesji (.wds): zapis blokami z indeksem czasu i odczyt przez mapowanie pliku.
+ *
+ * Plik składa się z nagłówka, bloków próbek i indeksu zapisywanego przy zamknięciu:
+ * - blok zawiera do blockSamples próbek w układzie kolumnowym (czasy, potem kolejne kanały),
+ *   dzięki czemu pojedynczy kanał czyta się bez dotykania pozostałych,
+ * - wpis indeksu to przesunięcie bloku w pliku, zakres czasu oraz minimum i maksimum
+ *   każdego kanału w bloku,
+ * - stopka o stałym rozmiarze na końcu pliku wskazuje indeks i zawiera statystyki łącza.
+ *
+ * SessionFile mapuje cały plik do pamięci (QFile::map) i korzysta z indeksu bezpośrednio
+ * w zmapowanym obszarze, więc otwarcie nie zależy od długości nagrania. Przegląd całego
+ * nagrania składany jest z podsumowań bloków, a skok do dowolnej chwili to wyszukiwanie
+ * binarne w indeksie i odczyt tylko potrzebnych bloków. Plik bez stopki (przerwane nagranie)
+ * jest otwierany po odbudowaniu indeksu z nagłówków bloków.
+ *
+ * Liczby zapisywane są w porządku bajtów gospodarza (little-endian na obsługiwanych platformach).
+ */
+
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include "serialdata.h"
+#include <QFile>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct SessionLinkStats
+ * @brief Statystyki łącza z czasu nagrania (zapisywane w stopce pliku).
+ */
+struct SessionLinkStats {
+    uint64_t frames = 0;         ///< Poprawne ramki.
+    uint64_t checksumErrors = 0; ///< Ramki z błędną sumą kontrolną.
+    uint64_t droppedBytes = 0;   ///< Bajty odrzucone przy synchronizacji.
+};
+
+/**
+ * @struct SessionBlockInfo
+ * @brief Wpis indeksu: położenie bloku, zakres czasu i podsumowanie kanałów.
+ */
+struct SessionBlockInfo {
+    uint64_t offset = 0;   ///< Przesunięcie nagłówka bloku w pliku [B].
+    uint32_t count = 0;    ///< Liczba próbek w bloku.
+    uint32_t reserved = 0; ///< Wyrównanie.
+    int64_t firstUs = 0;   ///< Czas pierwszej próbki [µs od początku nagrania].
+    int64_t lastUs = 0;    ///< Czas ostatniej próbki [µs od początku nagrania].
+    float minimum[channelCount] = {}; ///< Minimum każdego kanału w bloku.
+    float maximum[channelCount] = {}; ///< Maksimum każdego kanału w bloku.
+};
+
+/**
+ * @struct SessionBlockData
+ * @brief Widok kolumn jednego bloku w zmapowanym pliku (ważny do zamknięcia pliku).
+ */
+struct SessionBlockData {
+    int count = 0;                  ///< Liczba próbek.
+    const int64_t *timeUs = nullptr; ///< Czasy próbek [µs od początku nagrania].
+    std::array<const float *, channelCount> columns = {}; ///< Wartości kanałów (indeks = Channel).
+};
+
+/**
+ * @class SessionWriter
+ * @brief Zapis nagrania sesji do pliku .wds.
+ */
+class SessionWriter
+{
+public:
+    /// Domyślna liczba próbek w bloku.
+    static constexpr int defaultBlockSamples = 4096;
+
+    SessionWriter() = default;
+    SessionWriter(const SessionWriter &) = delete;
+    SessionWriter &operator=(const SessionWriter &) = delete;
+
+    /**
+     * @brief Zamyka plik (z zapisem indeksu), jeśli jest otwarty.
+     */
+    ~SessionWriter();
+
+    /**
+     * @brief Tworzy plik nagrania i zapisuje nagłówek.
+     * @param path Ścieżka pliku (istniejący plik jest nadpisywany).
+     * @param blockSamples Liczba próbek w bloku.
+     * @return true jeśli plik został utworzony.
+     */
+    bool open(const QString &path, int blockSamples = defaultBlockSamples);
+
+    /**
+     * @brief Dopisuje próbkę; pełny blok jest zapisywany do pliku.
+     * @param timeUs Czas próbki [µs]; czas pierwszej próbki staje się początkiem nagrania.
+     * @param data Dane z mikrokontrolera.
+     */
+    void append(qint64 timeUs, const SerialData &data);
+
+    /**
+     * @brief Ustawia statystyki łącza zapisywane w stopce przy zamknięciu.
+     */
+    void setLinkStats(const SessionLinkStats &stats) { link = stats; }
+
+    /**
+     * @brief Zapisuje niepełny blok, indeks i stopkę, a następnie zamyka plik.
+     * @return true jeśli cały plik został zapisany bez błędów.
+     */
+    bool close();
+
+    /**
+     * @brief Czy nagranie jest otwarte.
+     */
+    bool isOpen() const { return file.isOpen(); }
+
+    /**
+     * @brief Zwraca liczbę próbek dopisanych od otwarcia.
+     */
+    qint64 sampleCount() const { return samples; }
+
+    /**
+     * @brief Zwraca ścieżkę pliku nagrania.
+     */
+    QString fileName() const { return file.fileName(); }
+
+    /**
+     * @brief Zwraca opis ostatniego błędu zapisu.
+     */
+    QString errorString() const { return file.errorString(); }
+
+private:
+    /**
+     * @brief Zapisuje buforowane próbki jako blok i dodaje wpis indeksu.
+     */
+    void flushBlock();
+
+    QFile file;                                           ///< Plik nagrania.
+    int blockSamples = defaultBlockSamples;               ///< Liczba próbek w bloku.
+    std::vector<int64_t> times;                           ///< Czasy buforowanego bloku.
+    std::array<std::vector<float>, channelCount> columns; ///< Kanały buforowanego bloku.
+    std::vector<SessionBlockInfo> index;                  ///< Wpisy indeksu zapisanych bloków.
+    SessionLinkStats link;                                ///< Statystyki łącza do stopki.
+    qint64 originUs = 0;                                  ///< Czas pierwszej próbki [µs].
+    int64_t lastUs = 0;                                   ///< Czas ostatniej próbki [µs od początku].
+    qint64 samples = 0;                                   ///< Liczba dopisanych próbek.
+    bool failed = false;                                  ///< Czy wystąpił błąd zapisu.
+};
+
+/**
+ * @class SessionFile
+ * @brief Odczyt nagrania sesji przez mapowanie pliku do pamięci.
+ */
+class SessionFile
+{
+public:
+    SessionFile() = default;
+    SessionFile(const SessionFile &) = delete;
+    SessionFile &operator=(const SessionFile &) = delete;
+
+    /**
+     * @brief Otwiera i mapuje plik nagrania.
+     * @param path Ścieżka pliku.
+     * @return true jeśli plik ma poprawny nagłówek (indeks jest odbudowywany, gdy brak stopki).
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Zwalnia mapowanie i zamyka plik.
+     */
+    void close();
+
+    /**
+     * @brief Zwraca opis błędu ostatniego otwarcia.
+     */
+    QString errorString() const { return error; }
+
+    /**
+     * @brief Zwraca ścieżkę otwartego pliku.
+     */
+    QString fileName() const { return file.fileName(); }
+
+    /**
+     * @brief Czy indeks pochodzi z pliku (false = odbudowany po przerwanym nagraniu).
+     */
+    bool hasStoredIndex() const { return storedIndex; }
+
+    /**
+     * @brief Zwraca czas rozpoczęcia nagrania [ms od epoki Unix].
+     */
+    qint64 startMsSinceEpoch() const { return startMs; }
+
+    /**
+     * @brief Zwraca liczbę próbek w nagraniu.
+     */
+    qint64 sampleCount() const { return samples; }
+
+    /**
+     * @brief Zwraca czas ostatniej próbki [µs od początku nagrania].
+     */
+    qint64 durationUs() const { return blocks > 0 ? index[blocks - 1].lastUs : 0; }
+
+    /**
+     * @brief Zwraca statystyki łącza zapisane w stopce (zera dla przerwanego nagrania).
+     */
+    const SessionLinkStats &linkStats() const { return link; }
+
+    /**
+     * @brief Zwraca liczbę bloków.
+     */
+    int blockCount() const { return blocks; }
+
+    /**
+     * @brief Zwraca wpis indeksu bloku.
+     */
+    const SessionBlockInfo &blockInfo(int block) const { return index[block]; }
+
+    /**
+     * @brief Zwraca kolumny bloku bezpośrednio ze zmapowanego pliku.
+     */
+    SessionBlockData blockData(int block) const;
+
+    /**
+     * @brief Zwraca numer pierwszego bloku, którego ostatnia próbka nie jest wcześniejsza niż timeUs.
+     * @return Numer bloku lub blockCount(), jeśli timeUs jest po końcu nagrania.
+     */
+    int findBlock(qint64 timeUs) const;
+
+    /**
+     * @brief Zwraca punkty (czas [s od początku nagrania], wartość) kanału z przedziału czasu.
+     *
+     * Gdy przedział zawiera więcej próbek niż maxPoints, wynik jest obwiednią minimum/maksimum
+     * w maxPoints/2 przedziałach; bloki mieszczące się w jednym przedziale są brane z indeksu
+     * bez odczytu próbek.
+     * @param channel Kanał.
+     * @param fromUs Początek przedziału [µs od początku nagrania].
+     * @param toUs Koniec przedziału [µs od początku nagrania].
+     * @param maxPoints Maksymalna liczba punktów.
+     */
+    QVector<QPointF> channelPoints(Channel channel, qint64 fromUs, qint64 toUs, int maxPoints) const;
+
+private:
+    /**
+     * @brief Odtwarza indeks z nagłówków bloków (plik bez stopki).
+     */
+    void rebuildIndex(qint64 dataEnd);
+
+    QFile file;                              ///< Otwarty plik.
+    const uchar *base = nullptr;             ///< Początek zmapowanego pliku.
+    qint64 size = 0;                         ///< Rozmiar pliku [B].
+    const SessionBlockInfo *index = nullptr; ///< Indeks (w zmapowanym pliku lub w rebuiltIndex).
+    std::vector<SessionBlockInfo> rebuiltIndex; ///< Indeks odbudowany po przerwanym nagraniu.
+    int blocks = 0;                          ///< Liczba bloków.
+    qint64 samples = 0;                      ///< Liczba próbek.
+    qint64 startMs = 0;                      ///< Czas rozpoczęcia nagrania [ms od epoki].
+    SessionLinkStats link;                   ///< Statystyki łącza.
+    bool storedIndex = false;                ///< Czy indeks pochodzi z pliku.
+    QString error;                           ///< Opis błędu otwarcia.
+};
+
+#endif // SESSIONFILE_H
@@ -0,0 +1,118 @@
+/**
+ * @file sessionviewer.h
+ * @brief Deklaracja klasy SessionViewer — przeglądarki nagranych sesji (.wds).
+ *
+ * Okno otwiera jedno lub kilka nagrań (SessionFile) i nakłada je na wspólne osie wykresów
+ * ChartsManager, z czasem liczonym od początku każdego nagrania — do porównywania przebiegów.
+ * Wykres przeglądu pokazuje obwiednię całych nagrań zbudowaną z indeksu, a wykres szczegółowy
+ * okno czasu wybrane suwakiem lub polem "Od", odczytywane tylko z potrzebnych bloków.
+ */
+
+#ifndef SESSIONVIEWER_H
+#define SESSIONVIEWER_H
+
+#include "chartsmanager.h"
+#include "sessionfile.h"
+#include <QWidget>
+#include <memory>
+#include <vector>
+
+class QComboBox;
+class QDoubleSpinBox;
+class QListWidget;
+class QListWidgetItem;
+class QSlider;
+
+/**
+ * @class SessionViewer
+ * @brief Okno przeglądania i porównywania nagranych sesji.
+ */
+class SessionViewer : public QWidget
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy SessionViewer.
+     * @param parent Obiekt nadrzędny (domyślnie nullptr); okno jest zawsze osobnym oknem.
+     */
+    explicit SessionViewer(QWidget *parent = nullptr);
+
+    /**
+     * @brief Otwiera nagranie i dodaje je do porównania.
+     * @param path Ścieżka pliku .wds.
+     * @return true jeśli plik został otwarty.
+     */
+    bool openSession(const QString &path);
+
+private slots:
+    /**
+     * @brief Otwiera nagrania wybrane przez użytkownika.
+     */
+    void openFiles();
+
+    /**
+     * @brief Zamyka zaznaczone na liście nagranie.
+     */
+    void closeSelected();
+
+    /**
+     * @brief Tworzy wykresy dla wybranego kanału i rysuje je od nowa.
+     */
+    void changeChannel();
+
+    /**
+     * @brief Rysuje obwiednie całych nagrań na wykresie przeglądu.
+     */
+    void updateOverview();
+
+    /**
+     * @brief Rysuje wybrane okno czasu na wykresie szczegółowym.
+     */
+    void updateDetail();
+
+    /**
+     * @brief Przesuwa okno czasu po zmianie położenia suwaka.
+     * @param value Położenie suwaka (promile najdłuższego nagrania).
+     */
+    void handleSliderMoved(int value);
+
+    /**
+     * @brief Obsługuje zaznaczenie lub odznaczenie nagrania na liście.
+     */
+    void handleItemChanged(QListWidgetItem *item);
+
+private:
+    /**
+     * @brief Zwraca kanał wybrany na liście kanałów.
+     */
+    Channel currentChannel() const;
+
+    /**
+     * @brief Zwraca długość najdłuższego otwartego nagrania [s].
+     */
+    qreal longestDuration() const;
+
+    /**
+     * @brief Zwraca punkty kanału nagrania z przedziału [from, to] w sekundach (PWM w procentach).
+     */
+    QVector<QPointF> sessionPoints(const SessionFile &session, qreal from, qreal to) const;
+
+    /**
+     * @brief Rejestruje wykresy kanału type w obu obszarach wykresów.
+     */
+    void setupCharts(ChartType type);
+
+    std::vector<std::unique_ptr<SessionFile>> sessions; ///< Otwarte nagrania (indeks = numer serii).
+    QListWidget *sessionList;     ///< Lista nagrań (zaznaczenie = widoczność).
+    QComboBox *channelBox;        ///< Wybór kanału.
+    QDoubleSpinBox *positionBox;  ///< Początek okna szczegółowego [s].
+    QDoubleSpinBox *windowBox;    ///< Szerokość okna szczegółowego [s].
+    QSlider *positionSlider;      ///< Położenie okna szczegółowego w nagraniu.
+    QWidget *overviewHost;        ///< Obszar wykresu przeglądu.
+    QWidget *detailHost;          ///< Obszar wykresu szczegółowego.
+    ChartsManager *overviewCharts; ///< Wykres przeglądu.
+    ChartsManager *detailCharts;   ///< Wykres szczegółowy.
+    ChartType shownType = ChartType::RPM; ///< Typ wykresu aktualnie wybranego kanału.
+};
+
+#endif // SESSIONVIEWER_H
@@ -0,0 +1,70 @@
+/**
+ * @file setpointprofile.h
+ * @brief Deklaracja klasy SetpointProfile — sekwencji nastaw wykonywanej w zadanych chwilach.
+ *
+ * Profil zapisywany jest w pliku tekstowym, jedna instrukcja w linii (czas w sekundach od startu):
+ *
+ *     # komentarz
+ *     <t> <kanał> <wartość>                              — pojedyncza nastawa
+ *     ramp <t0> <t1> <kanał> <v0> <v1> <krok>            — rampa liniowa co <krok> s
+ *     sine <t0> <t1> <kanał> <środek> <amplituda> <f> <krok> — sinusoida o częstotliwości <f> Hz
+ *
+ * Kanały: pwm [%], rpm, kp, ki, kd, mode (0 - ręczny, 1 - automatyczny), start (0/1).
+ * Wartość PWM podawana jest w procentach i skalowana do 0-255 tak jak suwak w GUI.
+ */
+
+#ifndef SETPOINTPROFILE_H
+#define SETPOINTPROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ProfileStep
+ * @brief Pojedyncze polecenie profilu.
+ */
+struct ProfileStep {
+    int64_t timeUs = 0; ///< Chwila wysłania liczona od startu profilu [µs].
+    uint8_t type = 0;   ///< Typ polecenia (wartość DataType).
+    float value = 0.0f; ///< Wartość przekazywana do SerialReader::sendData().
+};
+
+/**
+ * @class SetpointProfile
+ * @brief Posortowana w czasie lista poleceń wczytana z pliku profilu.
+ */
+class SetpointProfile
+{
+public:
+    /**
+     * @brief Wczytuje profil z tekstu (format opisany w nagłówku pliku).
+     * @param text Treść profilu.
+     * @param error Opis błędu (numer linii i przyczyna), jeśli wczytanie się nie powiodło.
+     * @return true jeśli profil jest poprawny.
+     */
+    bool parse(const std::string &text, std::string &error);
+
+    /**
+     * @brief Wczytuje profil z pliku.
+     * @param path Ścieżka pliku.
+     * @param error Opis błędu.
+     * @return true jeśli profil jest poprawny.
+     */
+    bool load(const std::string &path, std::string &error);
+
+    /**
+     * @brief Zwraca polecenia posortowane według czasu (stabilnie — kolejność z pliku dla równych czasów).
+     */
+    const std::vector<ProfileStep> &steps() const { return profileSteps; }
+
+    /**
+     * @brief Zwraca czas trwania profilu (czas ostatniego polecenia) [µs].
+     */
+    int64_t durationUs() const { return profileSteps.empty() ? 0 : profileSteps.back().timeUs; }
+
+private:
+    std::vector<ProfileStep> profileSteps; ///< Polecenia profilu.
+};
+
+#endif // SETPOINTPROFILE_H
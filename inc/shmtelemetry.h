@@ -0,0 +1,219 @@
+/**
+ * @file shmtelemetry.h
+ * @brief Udostępnianie telemetrii innym procesom przez pamięć współdzieloną POSIX.
+ *
+ * Aplikacja (jedyny proces z otwartym portem tty) publikuje każdą sparsowaną próbkę do bufora
+ * cyklicznego w segmencie shm_open(). Każde gniazdo bufora chronione jest licznikiem sekwencji
+ * (seqlock): zapis nigdy nie czeka na czytelników, a dowolna liczba czytelników kopiuje próbki
+ * bezpośrednio z segmentu i wykrywa nadpisane w trakcie odczytu lub pominięte próbki.
+ *
+ * W przeciwnym kierunku klienci wstawiają polecenia (DataType + wartość) do ograniczonej kolejki
+ * wielu producentów / jednego konsumenta; aplikacja odbiera je i wysyła przez SerialReader::sendData().
+ *
+ * Plik nie zależy od Qt — razem z shmtelemetry.cpp tworzy bibliotekę wds_shm używaną przez
+ * narzędzia zewnętrzne (przykład: tools/wds_shm_client.cpp).
+ */
+
+#ifndef SHMTELEMETRY_H
+#define SHMTELEMETRY_H
+
+#include "serialdata.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/// Domyślna nazwa segmentu pamięci współdzielonej.
+constexpr const char *shmDefaultName = "/wds_motor_telemetry";
+/// Pojemność bufora próbek (potęga dwójki).
+constexpr uint32_t shmSampleCapacity = 4096;
+/// Pojemność kolejki poleceń (potęga dwójki).
+constexpr uint32_t shmCommandCapacity = 64;
+/// Znacznik poprawnie zainicjalizowanego segmentu ("WDSM").
+constexpr uint32_t shmMagic = 0x4D534457;
+/// Wersja układu segmentu — zmieniana przy każdej niekompatybilnej zmianie struktur.
+constexpr uint32_t shmLayoutVersion = 2;
+
+static_assert(std::is_trivially_copyable<SerialData>::value, "SerialData musi być kopiowalne bajtowo");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Wymagane bezblokadowe liczniki 64-bitowe");
+
+/**
+ * @struct ShmSample
+ * @brief Próbka telemetrii odczytana z pamięci współdzielonej.
+ */
+struct ShmSample {
+    uint64_t index = 0;  ///< Numer kolejny próbki (od 0 w danej sesji zapisu).
+    int64_t timeUs = 0;  ///< Czas próbki [µs, CLOCK_MONOTONIC — wspólny dla procesów] (SerialData::timeUs).
+    SerialData data;     ///< Dane z mikrokontrolera.
+};
+
+/**
+ * @struct ShmCommand
+ * @brief Polecenie klienta przekazywane do SerialReader::sendData().
+ */
+struct ShmCommand {
+    uint8_t type = 0;    ///< Typ polecenia (wartość DataType).
+    float value = 0.0f;  ///< Wartość polecenia.
+};
+
+/**
+ * @struct ShmLayout
+ * @brief Układ segmentu pamięci współdzielonej.
+ *
+ * Liczniki zapisywane przez różne procesy leżą w osobnych liniach pamięci podręcznej.
+ */
+struct ShmLayout {
+    /// Gniazdo bufora próbek. sequence: nieparzysta = zapis w toku, 2*(index+1) = próbka index gotowa.
+    struct SampleSlot {
+        std::atomic<uint64_t> sequence;
+        int64_t timeUs;
+        SerialData data;
+    };
+    /// Gniazdo kolejki poleceń (algorytm ograniczonej kolejki MPMC D. Vyukova).
+    struct CommandSlot {
+        std::atomic<uint64_t> sequence;
+        ShmCommand command;
+    };
+
+    uint32_t magic;              ///< shmMagic po zakończeniu inicjalizacji.
+    uint32_t version;            ///< shmLayoutVersion.
+    uint32_t sampleCapacity;     ///< Liczba gniazd próbek.
+    uint32_t commandCapacity;    ///< Liczba gniazd poleceń.
+    std::atomic<uint64_t> session; ///< Numer sesji zapisu (zwiększany przy każdym otwarciu przez aplikację).
+    alignas(64) std::atomic<uint64_t> published;   ///< Liczba opublikowanych próbek.
+    alignas(64) std::atomic<uint64_t> commandWrite; ///< Pozycja zapisu kolejki poleceń (klienci).
+    alignas(64) std::atomic<uint64_t> commandRead;  ///< Pozycja odczytu kolejki poleceń (aplikacja).
+    alignas(64) SampleSlot samples[shmSampleCapacity]; ///< Bufor cykliczny próbek.
+    CommandSlot commands[shmCommandCapacity];           ///< Kolejka poleceń.
+};
+
+/**
+ * @class ShmTelemetryWriter
+ * @brief Strona zapisująca (aplikacja): tworzy segment, publikuje próbki, odbiera polecenia.
+ */
+class ShmTelemetryWriter
+{
+public:
+    ShmTelemetryWriter() = default;
+    ~ShmTelemetryWriter();
+
+    ShmTelemetryWriter(const ShmTelemetryWriter &) = delete;
+    ShmTelemetryWriter &operator=(const ShmTelemetryWriter &) = delete;
+
+    /**
+     * @brief Sprawdza, czy pamięć współdzielona POSIX jest dostępna na bieżącej platformie.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Tworzy (lub przejmuje) segment i inicjalizuje go dla nowej sesji.
+     * @param name Nazwa segmentu (np. "/wds_motor_telemetry").
+     * @return true jeśli segment jest gotowy do zapisu.
+     */
+    bool open(const std::string &name = shmDefaultName);
+
+    /**
+     * @brief Odłącza i usuwa segment.
+     */
+    void close();
+
+    /**
+     * @brief Sprawdza, czy segment jest otwarty.
+     */
+    bool isOpen() const { return layout != nullptr; }
+
+    /**
+     * @brief Publikuje próbkę (bez blokad; wywołanie tylko z jednego wątku naraz).
+     * @param timeUs Czas próbki [µs, zegar monotoniczny].
+     * @param data Dane z mikrokontrolera.
+     */
+    void publish(int64_t timeUs, const SerialData &data);
+
+    /**
+     * @brief Pobiera jedno oczekujące polecenie klienta.
+     * @param command Odczytane polecenie.
+     * @return true jeśli pobrano polecenie.
+     */
+    bool takeCommand(ShmCommand &command);
+
+    /**
+     * @brief Zwraca opis ostatniego błędu.
+     */
+    const std::string &errorString() const { return lastError; }
+
+private:
+    ShmLayout *layout = nullptr; ///< Zmapowany segment.
+    std::string segmentName;     ///< Nazwa segmentu (do shm_unlink).
+    std::string lastError;       ///< Opis ostatniego błędu.
+};
+
+/**
+ * @class ShmTelemetryReader
+ * @brief Strona odczytująca (inne procesy): kopiuje nowe próbki i wysyła polecenia.
+ *
+ * Czytelnik nie modyfikuje bufora próbek, więc nie spowalnia aplikacji ani innych czytelników.
+ * Jeśli czytelnik nie nadąża, pominięte (nadpisane) próbki są zliczane w lostSamples().
+ */
+class ShmTelemetryReader
+{
+public:
+    ShmTelemetryReader() = default;
+    ~ShmTelemetryReader();
+
+    ShmTelemetryReader(const ShmTelemetryReader &) = delete;
+    ShmTelemetryReader &operator=(const ShmTelemetryReader &) = delete;
+
+    /**
+     * @brief Dołącza do istniejącego segmentu i ustawia pozycję odczytu na najnowszą próbkę.
+     * @param name Nazwa segmentu.
+     * @return true jeśli segment istnieje i ma zgodny układ.
+     */
+    bool open(const std::string &name = shmDefaultName);
+
+    /**
+     * @brief Odłącza segment.
+     */
+    void close();
+
+    /**
+     * @brief Sprawdza, czy segment jest dołączony.
+     */
+    bool isOpen() const { return layout != nullptr; }
+
+    /**
+     * @brief Kopiuje próbki opublikowane od poprzedniego wywołania.
+     * @param out Bufor wyjściowy.
+     * @param maxSamples Pojemność bufora wyjściowego.
+     * @return Liczba skopiowanych próbek.
+     */
+    size_t read(ShmSample *out, size_t maxSamples);
+
+    /**
+     * @brief Liczba próbek nadpisanych, zanim czytelnik zdążył je odczytać.
+     */
+    uint64_t lostSamples() const { return lost; }
+
+    /**
+     * @brief Wstawia polecenie do kolejki aplikacji.
+     * @param type Typ polecenia (wartość DataType, 1-7).
+     * @param value Wartość polecenia.
+     * @return false jeśli kolejka jest pełna lub segment nie jest dołączony.
+     */
+    bool sendCommand(uint8_t type, float value);
+
+    /**
+     * @brief Zwraca opis ostatniego błędu.
+     */
+    const std::string &errorString() const { return lastError; }
+
+private:
+    ShmLayout *layout = nullptr; ///< Zmapowany segment.
+    uint64_t session = 0;        ///< Numer sesji zapisu, do której odnosi się next.
+    uint64_t next = 0;           ///< Indeks następnej próbki do odczytu.
+    uint64_t lost = 0;           ///< Liczba pominiętych próbek.
+    std::string lastError;       ///< Opis ostatniego błędu.
+};
+
+#endif // SHMTELEMETRY_H
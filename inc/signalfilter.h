@@ -0,0 +1,142 @@
+/**
+ * @file signalfilter.h
+ * @brief Deklaracja łańcuchów filtrów sygnału (mediana, EMA, Butterworth, Kalman) dla kanałów telemetrii.
+ *
+ * Łańcuch opisywany jest tekstem — kolejne stopnie oddzielone przecinkami:
+ *
+ *     median:<N>            — mediana krocząca z N próbek (N nieparzyste, 3-31)
+ *     ema:<alfa>            — średnia wykładnicza, 0 < alfa <= 1
+ *     butter:<fc>:<fs>      — dolnoprzepustowy Butterworth 2. rzędu, fc [Hz] przy próbkowaniu fs [Hz]
+ *     kalman:<q>:<r>        — skalarny filtr Kalmana (błądzenie losowe), wariancje procesu q i pomiaru r
+ *
+ * np. "median:5,butter:20:1000". Pusty opis oznacza brak filtrowania.
+ *
+ * Stopnie przetwarzają bloki próbek jednego kanału (ciągła tablica float) — wywołanie wirtualne
+ * przypada na blok, a nie na próbkę. Plik nie zależy od Qt.
+ */
+
+#ifndef SIGNALFILTER_H
+#define SIGNALFILTER_H
+
+#include "serialdata.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class FilterStage
+ * @brief Pojedynczy stopień filtra przetwarzający blok próbek w miejscu.
+ */
+class FilterStage
+{
+public:
+    virtual ~FilterStage() = default;
+
+    /**
+     * @brief Filtruje blok próbek (wynik zastępuje dane wejściowe).
+     * @param samples Próbki kanału w kolejności czasu.
+     * @param count Liczba próbek.
+     */
+    virtual void process(float *samples, size_t count) = 0;
+
+    /**
+     * @brief Zeruje stan filtra; kolejna próbka inicjalizuje go od nowa.
+     */
+    virtual void reset() = 0;
+};
+
+/**
+ * @class FilterChain
+ * @brief Szeregowe połączenie stopni filtra dla jednego kanału.
+ */
+class FilterChain
+{
+public:
+    /**
+     * @brief Buduje łańcuch z opisu tekstowego (format w nagłówku pliku).
+     *
+     * Przy błędzie łańcuch pozostaje bez zmian.
+     * @param spec Opis łańcucha.
+     * @param error Opis błędu.
+     * @return true jeśli opis jest poprawny.
+     */
+    bool parse(const std::string &spec, std::string &error);
+
+    /**
+     * @brief Przepuszcza blok próbek przez kolejne stopnie.
+     * @param samples Próbki kanału.
+     * @param count Liczba próbek.
+     */
+    void process(float *samples, size_t count);
+
+    /**
+     * @brief Zeruje stan wszystkich stopni.
+     */
+    void reset();
+
+    /**
+     * @brief Czy łańcuch nie zawiera żadnego stopnia.
+     */
+    bool empty() const { return stages.empty(); }
+
+    /**
+     * @brief Zwraca opis łańcucha w postaci znormalizowanej.
+     */
+    const std::string &spec() const { return text; }
+
+private:
+    std::vector<std::unique_ptr<FilterStage>> stages; ///< Stopnie w kolejności przetwarzania.
+    std::string text;                                 ///< Opis łańcucha.
+};
+
+/**
+ * @class ChannelFilterBank
+ * @brief Łańcuchy filtrów wszystkich kanałów SerialData przetwarzające partie próbek.
+ *
+ * Dla każdego kanału z niepustym łańcuchem wartości partii są kopiowane do ciągłej tablicy,
+ * filtrowane i wpisywane do próbek wyjściowych; pozostałe kanały są kopiowane bez zmian.
+ * Nie jest bezpieczna wątkowo.
+ */
+class ChannelFilterBank
+{
+public:
+    /**
+     * @brief Ustawia łańcuch filtrów kanału.
+     * @param channel Kanał.
+     * @param spec Opis łańcucha (pusty = brak filtrowania).
+     * @param error Opis błędu.
+     * @return true jeśli opis jest poprawny.
+     */
+    bool setFilter(Channel channel, const std::string &spec, std::string &error);
+
+    /**
+     * @brief Zwraca opis łańcucha kanału.
+     */
+    const std::string &filter(Channel channel) const { return chains[static_cast<int>(channel)].spec(); }
+
+    /**
+     * @brief Czy którykolwiek kanał jest filtrowany.
+     */
+    bool active() const;
+
+    /**
+     * @brief Filtruje partię próbek.
+     * @param in Próbki surowe.
+     * @param out Próbki przefiltrowane (count elementów; może być tą samą tablicą co in).
+     * @param count Liczba próbek.
+     */
+    void process(const SerialData *in, SerialData *out, size_t count);
+
+    /**
+     * @brief Zeruje stan wszystkich łańcuchów (np. po ponownym połączeniu).
+     */
+    void reset();
+
+private:
+    FilterChain chains[channelCount]; ///< Łańcuch każdego kanału.
+    std::vector<float> scratch;       ///< Bufor wartości jednego kanału z partii.
+};
+
+#endif // SIGNALFILTER_H
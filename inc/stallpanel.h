@@ -0,0 +1,70 @@
+/**
+ * @file stallpanel.h
+ * @brief Deklaracja klasy StallPanel — zakładki "Pętla GUI" panelu diagnostycznego.
+ *
+ * Zakładka pokazuje percentyle opóźnień pętli zdarzeń i czasów klatek zbierane przez
+ * StallWatchdog oraz listę zablokowań; po wybraniu zablokowania widać otwarte wtedy zakresy
+ * TRACE_SCOPE i natywny stos wątku GUI. Dane odczytywane są okresowo, tylko gdy zakładka
+ * jest widoczna.
+ */
+
+#ifndef STALLPANEL_H
+#define STALLPANEL_H
+
+#include "stallwatchdog.h"
+#include <QTimer>
+#include <QWidget>
+
+class QLabel;
+class QPlainTextEdit;
+class QSpinBox;
+class QTableWidget;
+
+/**
+ * @class StallPanel
+ * @brief Widok statystyk i zablokowań pętli zdarzeń GUI.
+ */
+class StallPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor klasy StallPanel.
+     * @param watchdog Strażnik, którego dane są pokazywane (musi istnieć dłużej niż panel).
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit StallPanel(StallWatchdog *watchdog, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    /**
+     * @brief Odświeża statystyki i listę zablokowań.
+     */
+    void refresh();
+
+    /**
+     * @brief Pokazuje aktywność i stos wybranego zablokowania.
+     */
+    void showSelected();
+
+    /**
+     * @brief Zeruje statystyki strażnika.
+     */
+    void resetStats();
+
+private:
+    StallWatchdog *watchdog;       ///< Źródło danych.
+    QLabel *latencyLabel;          ///< Percentyle opóźnień pętli.
+    QLabel *framesLabel;           ///< Percentyle czasów klatek.
+    QSpinBox *thresholdBox;        ///< Próg zablokowania [ms].
+    QTableWidget *stallTable;      ///< Lista zablokowań (najnowsze na górze).
+    QPlainTextEdit *detailView;    ///< Aktywność i stos wybranego zablokowania.
+    QTimer refreshTimer;           ///< Timer odświeżania.
+    std::vector<StallRecord> shown; ///< Zablokowania widoczne w tabeli (najnowsze pierwsze).
+    uint64_t shownCount = 0;       ///< Liczba zablokowań w chwili przebudowy tabeli.
+};
+
+#endif // STALLPANEL_H
@@ -0,0 +1,163 @@
+/**
+ * @file stallwatchdog.h
+ * @brief Deklaracja klasy StallWatchdog — strażnika opóźnień pętli zdarzeń wątku GUI.
+ *
+ * Odbiór z portu (SerialReader z QSerialPort) i wykresy dzielą pętlę zdarzeń GUI, więc każda
+ * długa operacja w tym wątku (np. retranslateUi, ciężkie przerysowanie) opóźnia odczyt UART.
+ * Wątek strażnika co heartbeatMs wstawia do kolejki zdarzeń GUI "puls" i mierzy, po jakim czasie
+ * zostaje on obsłużony (histogram opóźnień pętli). Jeśli puls czeka dłużej niż próg, strażnik
+ * — jeszcze w trakcie zablokowania — zapisuje otwarte w GUI zakresy TRACE_SCOPE (ActivityStack),
+ * a na Linuksie także natywny stos wątku GUI (próbkowany sygnałem). Po obsłużeniu pulsu
+ * zablokowanie trafia do listy (panel Diagnostyka), dziennika i śladu wykonania.
+ *
+ * Czasy zakresów zewnętrznych TRACE_SCOPE w wątku GUI (rysowanie wykresów, odświeżanie)
+ * zbierane są w histogramie czasów klatek. Bez WDS_TRACE dostępne są tylko opóźnienia pętli
+ * i stos natywny.
+ */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include "latencyhistogram.h"
+#include "trace.h"
+#include <QObject>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+/**
+ * @struct StallRecord
+ * @brief Jedno zablokowanie pętli zdarzeń GUI.
+ */
+struct StallRecord {
+    qint64 startMs = 0;            ///< Początek (czas systemowy, ms od epoki).
+    int64_t durationNs = 0;        ///< Czas oczekiwania pulsu na obsłużenie [ns].
+    std::string activity;          ///< Otwarte zakresy TRACE_SCOPE w chwili wykrycia.
+    std::vector<std::string> stack; ///< Natywny stos wątku GUI (Linux; pusty, gdy niedostępny).
+};
+
+/**
+ * @class StallWatchdog
+ * @brief Strażnik opóźnień pętli zdarzeń wątku, w którym został uruchomiony.
+ */
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int defaultHeartbeatMs = 10;  ///< Domyślny okres pulsu [ms].
+    static constexpr int defaultThresholdMs = 100; ///< Domyślny próg zablokowania [ms].
+    static constexpr size_t maxRecords = 100;      ///< Liczba pamiętanych zablokowań.
+
+    /**
+     * @brief Konstruktor klasy StallWatchdog.
+     * @param parent Obiekt nadrzędny (domyślnie nullptr).
+     */
+    explicit StallWatchdog(QObject *parent = nullptr);
+    ~StallWatchdog() override;
+
+    /**
+     * @brief Uruchamia strażnika dla pętli zdarzeń bieżącego wątku (wywoływać z wątku GUI).
+     * @param heartbeatMs Okres pulsu [ms].
+     * @param thresholdMs Próg zablokowania [ms].
+     */
+    void start(int heartbeatMs = defaultHeartbeatMs, int thresholdMs = defaultThresholdMs);
+
+    /**
+     * @brief Zatrzymuje wątek strażnika.
+     */
+    void stop();
+
+    /**
+     * @brief Czy strażnik działa.
+     */
+    bool isRunning() const { return worker.joinable(); }
+
+    /**
+     * @brief Ustawia próg zablokowania [ms].
+     */
+    void setThresholdMs(int thresholdMs) { threshold.store(thresholdMs, std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca próg zablokowania [ms].
+     */
+    int thresholdMs() const { return threshold.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Histogram opóźnień obsługi pulsu (opóźnienie pętli zdarzeń).
+     */
+    const LatencyHistogram &loopLatency() const { return latency; }
+
+    /**
+     * @brief Histogram czasów zakresów zewnętrznych TRACE_SCOPE w wątku GUI (rysowanie, odświeżanie).
+     */
+    const LatencyHistogram &frameTimes() const { return frames; }
+
+    /**
+     * @brief Liczba zablokowań od uruchomienia (lub wyzerowania).
+     */
+    uint64_t stallCount() const { return stallsTotal.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca kopię zapamiętanych zablokowań (najstarsze pierwsze).
+     */
+    std::vector<StallRecord> stalls() const;
+
+    /**
+     * @brief Zeruje histogramy i listę zablokowań.
+     */
+    void reset();
+
+signals:
+    /**
+     * @brief Zablokowanie się zakończyło (emitowany w wątku GUI).
+     * @param durationMs Czas zablokowania [ms].
+     */
+    void stallDetected(double durationMs);
+
+private:
+    /**
+     * @brief Pętla wątku strażnika: wysyła pulsy i wykrywa przekroczenie progu.
+     */
+    void run(int heartbeatMs);
+
+    /**
+     * @brief Obsługa pulsu w wątku GUI.
+     * @param postedNs Czas wysłania pulsu.
+     */
+    void beat(int64_t postedNs);
+
+    /**
+     * @brief Zapisuje aktywność (i stos natywny) wątku GUI w trakcie zablokowania.
+     */
+    void capture(int64_t postedNs);
+
+    ActivityStack activity;         ///< Stos otwartych zakresów wątku GUI.
+    LatencyHistogram latency;       ///< Opóźnienia pulsu.
+    LatencyHistogram frames;        ///< Czasy klatek.
+    std::atomic<int> threshold{defaultThresholdMs}; ///< Próg zablokowania [ms].
+    std::atomic<int64_t> pendingNs{0}; ///< Czas wysłania oczekującego pulsu (0 = brak).
+    std::atomic<uint64_t> stallsTotal{0}; ///< Liczba zablokowań.
+
+    std::thread worker;             ///< Wątek strażnika.
+    std::mutex wakeLock;            ///< Chroni stopping.
+    std::condition_variable wake;   ///< Budzi wątek przy zatrzymaniu.
+    bool stopping = false;          ///< Żądanie zatrzymania.
+
+    mutable std::mutex recordsLock; ///< Chroni records i captured.
+    std::deque<StallRecord> records; ///< Zakończone zablokowania.
+    StallRecord captured;           ///< Aktywność zapisana dla bieżącego pulsu.
+    int64_t capturedFor = 0;        ///< Puls, którego dotyczy captured.
+
+#ifdef __linux__
+    pthread_t guiThread{};          ///< Wątek GUI (cel próbkowania stosu).
+#endif
+};
+
+#endif // STALLWATCHDOG_H
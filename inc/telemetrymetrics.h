@@ -0,0 +1,140 @@
+/**
+ * @file telemetrymetrics.h
+ * @brief Deklaracja klasy TelemetryMetrics — wstępnie zagregowanych metryk stanowiska.
+ *
+ * Liczniki i wskaźniki są zmiennymi atomowymi aktualizowanymi w ścieżce odbioru danych
+ * (SerialReader) i w GUI (stan połączenia). Eksport (MetricsExporter) odczytuje je z innego
+ * wątku bez blokad, a koszt wygenerowania odpowiedzi nie zależy od długości sesji.
+ */
+
+#ifndef TELEMETRYMETRICS_H
+#define TELEMETRYMETRICS_H
+
+#include "latencyhistogram.h"
+#include "serialdata.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class TelemetryMetrics
+ * @brief Zbiór metryk pracy stanowiska w formacie gotowym do eksportu (Prometheus).
+ */
+class TelemetryMetrics
+{
+public:
+    /**
+     * @brief Konstruktor; zapamiętuje czas startu (do metryki czasu działania).
+     */
+    TelemetryMetrics();
+
+    /**
+     * @brief Rejestruje wynik dekodowania jednej porcji danych.
+     * @param rxBytes Liczba odebranych bajtów.
+     * @param frames Liczba poprawnych ramek.
+     * @param checksumErrors Liczba ramek z błędną sumą kontrolną.
+     * @param droppedBytes Liczba bajtów odrzuconych przy synchronizacji.
+     * @param last Ostatnia poprawna ramka (nullptr, jeśli frames == 0).
+     * @param arrivalNs Czas odebrania porcji [ns, zegar monotoniczny].
+     */
+    void recordChunk(uint64_t rxBytes, uint64_t frames, uint64_t checksumErrors, uint64_t droppedBytes,
+                     const SerialData *last, int64_t arrivalNs);
+
+    /**
+     * @brief Zapisuje bieżący stan synchronizacji zegara urządzenia (ClockSync).
+     * @param synced Czy dopasowanie jest używane.
+     * @param offsetUs Przesunięcie zegarów (host - urządzenie) [µs].
+     * @param driftPpm Dryft zegara urządzenia [ppm].
+     * @param jitterUs Jitter opóźnienia transmisji względem dopasowania [µs].
+     * @param resyncs Liczba restartów estymacji.
+     */
+    void setClockSync(bool synced, double offsetUs, double driftPpm, double jitterUs, uint64_t resyncs);
+
+    /**
+     * @brief Ustawia stan połączenia z urządzeniem.
+     */
+    void setConnected(bool connected);
+
+    /**
+     * @brief Zwiększa licznik automatycznych ponownych połączeń.
+     */
+    void addReconnect();
+
+    /**
+     * @brief Zwiększa licznik wyzwolonych alarmów (i zatrzymań awaryjnych).
+     * @param emergencyStop Czy alarm spowodował zatrzymanie awaryjne.
+     */
+    void addLimitAlarm(bool emergencyStop);
+
+    /**
+     * @brief Ustawia stan blokady po zatrzymaniu awaryjnym.
+     */
+    void setEmergencyStopped(bool stopped);
+
+    /**
+     * @brief Dodaje próbki usunięte z pełnej kolejki dostarczania (SampleQueue).
+     * @param frames Liczba usuniętych próbek.
+     */
+    void addDeliveryDrops(uint64_t frames);
+
+    /**
+     * @brief Zwiększa licznik odczytów, przy których bufor odczytu portu był pełny.
+     */
+    void addReadBufferFull();
+
+    /**
+     * @brief Wskazuje histogram czasu parsowania eksportowany jako podsumowanie (summary).
+     *
+     * Histogram nie może być zerowany w trakcie działania procesu — _count i _sum podsumowania
+     * muszą rosnąć monotonicznie, inaczej rate() w Prometheusie widzi fałszywe restarty.
+     * @param histogram Histogram (musi istnieć dłużej niż obiekt metryk) lub nullptr.
+     */
+    void setParseLatency(const LatencyHistogram *histogram) { parseLatency = histogram; }
+
+    /**
+     * @brief Zwraca liczbę poprawnych ramek od uruchomienia.
+     */
+    uint64_t frames() const { return framesTotal.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca liczbę ramek z błędną sumą kontrolną od uruchomienia.
+     */
+    uint64_t checksumErrors() const { return checksumErrorsTotal.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca liczbę bajtów odrzuconych przy synchronizacji od uruchomienia.
+     */
+    uint64_t droppedBytes() const { return droppedBytesTotal.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Generuje tekst w formacie Prometheus (text exposition format 0.0.4).
+     *
+     * Bezpieczne wywołanie z dowolnego wątku.
+     */
+    std::string renderPrometheus() const;
+
+private:
+    std::atomic<uint64_t> rxBytesTotal{0};         ///< Odebrane bajty.
+    std::atomic<uint64_t> framesTotal{0};          ///< Poprawne ramki.
+    std::atomic<uint64_t> checksumErrorsTotal{0};  ///< Ramki z błędną sumą kontrolną.
+    std::atomic<uint64_t> droppedBytesTotal{0};    ///< Bajty odrzucone przy synchronizacji.
+    std::atomic<uint64_t> reconnectsTotal{0};      ///< Automatyczne ponowne połączenia.
+    std::atomic<bool> connected{false};            ///< Stan połączenia.
+    std::atomic<int64_t> lastFrameNs{0};           ///< Czas ostatniej poprawnej ramki [ns].
+    std::atomic<float> channels[channelCount] = {}; ///< Ostatnie wartości kanałów telemetrii.
+    std::atomic<bool> clockSynced{false};          ///< Czy czas próbek pochodzi z synchronizacji zegara.
+    std::atomic<double> clockOffsetUs{0.0};        ///< Przesunięcie zegarów [µs].
+    std::atomic<double> clockDriftPpm{0.0};        ///< Dryft zegara urządzenia [ppm].
+    std::atomic<double> clockJitterUs{0.0};        ///< Jitter transmisji [µs].
+    std::atomic<uint64_t> clockResyncsTotal{0};    ///< Restarty estymacji zegara.
+    std::atomic<uint64_t> limitAlarmsTotal{0};     ///< Wyzwolone alarmy progowe.
+    std::atomic<uint64_t> emergencyStopsTotal{0};  ///< Zatrzymania awaryjne.
+    std::atomic<bool> emergencyStopped{false};     ///< Czy aktywna jest blokada po zatrzymaniu awaryjnym.
+    std::atomic<uint64_t> deliveryDropsTotal{0};   ///< Próbki usunięte z kolejki dostarczania.
+    std::atomic<uint64_t> readBufferFullTotal{0};  ///< Odczyty przy pełnym buforze odczytu portu.
+    const LatencyHistogram *parseLatency = nullptr; ///< Histogram czasu parsowania.
+    int64_t startNs;                               ///< Czas utworzenia obiektu [ns].
+};
+
+#endif // TELEMETRYMETRICS_H
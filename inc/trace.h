@@ -0,0 +1,169 @@
+/**
+ * @file trace.h
+ * @brief Lekka instrumentacja czasu wykonania (format Chrome trace-event / Perfetto).
+ *
+ * Makro TRACE_SCOPE("nazwa") mierzy czas wykonania bieżącego zakresu i zapisuje go do bufora
+ * lokalnego dla wątku (bez współdzielonej blokady w gorącej ścieżce). Zebrane zdarzenia można
+ * zapisać do pliku JSON otwieranego w chrome://tracing lub ui.perfetto.dev.
+ *
+ * Instrumentacja jest całkowicie usuwana z kodu, gdy projekt jest budowany bez WDS_TRACE
+ * (opcja CMake WDS_ENABLE_TRACE=OFF). Gdy jest wkompilowana, a nagrywanie wyłączone,
+ * koszt zakresu to jeden odczyt zmiennej atomowej.
+ *
+ * Wątek obserwowany przez StallWatchdog (GUI) ma dodatkowo stos aktywności (ActivityStack):
+ * otwarte zakresy są na nim widoczne dla innych wątków, a czas zakresów zewnętrznych
+ * trafia do histogramu czasów klatek — niezależnie od tego, czy nagrywanie jest włączone.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class LatencyHistogram;
+
+/**
+ * @struct ActivityStack
+ * @brief Stos nazw otwartych zakresów TRACE_SCOPE jednego wątku, czytelny z innych wątków.
+ */
+struct ActivityStack {
+    static constexpr int maxDepth = 16; ///< Głębsze zakresy są liczone, ale nie zapamiętywane.
+
+    /**
+     * @brief Otwiera zakres (wywoływane przez TraceScope w obserwowanym wątku).
+     */
+    void push(const char *name) {
+        const int d = depth.load(std::memory_order_relaxed);
+        if (d < maxDepth)
+            names[d].store(name, std::memory_order_relaxed);
+        depth.store(d + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Zamyka zakres; czas zakresu zewnętrznego trafia do frameTimes.
+     */
+    void pop(int64_t durationNs);
+
+    /**
+     * @brief Zwraca nazwy otwartych zakresów od zewnętrznego, rozdzielone " > ".
+     *
+     * Odczyt z innego wątku jest przybliżony: wątek obserwowany może w tym czasie zamknąć zakres.
+     */
+    std::string snapshot() const;
+
+    std::array<std::atomic<const char *>, maxDepth> names{}; ///< Nazwy otwartych zakresów.
+    std::atomic<int> depth{0};                 ///< Liczba otwartych zakresów.
+    LatencyHistogram *frameTimes = nullptr;    ///< Histogram czasów zakresów zewnętrznych.
+};
+
+/**
+ * @class Trace
+ * @brief Globalny rejestr śladów wykonania.
+ */
+class Trace
+{
+public:
+    /**
+     * @brief Włącza lub wyłącza nagrywanie zdarzeń.
+     * @param enabled true = nagrywanie włączone.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Sprawdza, czy nagrywanie jest włączone.
+     */
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Nadaje nazwę bieżącemu wątkowi (widoczną w przeglądarce śladów).
+     * @param name Nazwa wątku.
+     */
+    static void setThreadName(const char *name);
+
+    /**
+     * @brief Zapisuje zakończony zakres do bufora bieżącego wątku.
+     * @param name Nazwa zakresu (literał — wskaźnik musi pozostać ważny).
+     * @param startNs Początek [ns, zegar monotoniczny].
+     * @param durationNs Czas trwania [ns].
+     */
+    static void record(const char *name, int64_t startNs, int64_t durationNs);
+
+    /**
+     * @brief Zapisuje wszystkie zebrane zdarzenia w formacie Chrome trace-event JSON.
+     * @param path Ścieżka pliku wyjściowego.
+     * @return true jeśli zapis się powiódł.
+     */
+    static bool writeChromeJson(const std::string &path);
+
+    /**
+     * @brief Usuwa zebrane zdarzenia ze wszystkich buforów.
+     */
+    static void clear();
+
+    /**
+     * @brief Zwraca bieżący czas zegara monotonicznego [ns].
+     */
+    static int64_t nowNs();
+
+    /**
+     * @brief Ustawia stos aktywności bieżącego wątku (nullptr = wątek nieobserwowany).
+     */
+    static void setActivityStack(ActivityStack *stack) { currentActivity = stack; }
+
+    /**
+     * @brief Zwraca stos aktywności bieżącego wątku lub nullptr.
+     */
+    static ActivityStack *activityStack() { return currentActivity; }
+
+private:
+    static std::atomic<bool> enabledFlag; ///< Czy nagrywanie jest włączone.
+    static thread_local ActivityStack *currentActivity; ///< Stos aktywności bieżącego wątku.
+};
+
+/**
+ * @class TraceScope
+ * @brief Obiekt RAII mierzący czas życia zakresu (używany przez makro TRACE_SCOPE).
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : name(name), activity(Trace::activityStack()), traced(Trace::isEnabled()),
+          startNs(traced || activity ? Trace::nowNs() : 0) {
+        if (activity)
+            activity->push(name);
+    }
+    ~TraceScope() {
+        if (startNs == 0)
+            return;
+        const int64_t durationNs = Trace::nowNs() - startNs;
+        if (activity)
+            activity->pop(durationNs);
+        if (traced)
+            Trace::record(name, startNs, durationNs);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;         ///< Nazwa zakresu.
+    ActivityStack *activity;  ///< Stos aktywności wątku (nullptr = wątek nieobserwowany).
+    bool traced;              ///< Czy zakres jest nagrywany do śladu.
+    int64_t startNs;          ///< Początek zakresu (0 = ani nagrywanie, ani obserwacja).
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef WDS_TRACE
+/// Mierzy czas wykonania bieżącego zakresu pod podaną nazwą.
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#endif
+
+#endif // TRACE_H
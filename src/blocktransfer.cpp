@@ -0,0 +1,385 @@
+/**
+ * @file blocktransfer.cpp
+ * @brief Implementacja klasy BlockTransfer.
+ *
+ * Format ramki transferu blokowego (8-248 bajtów):
+ * - Start Byte (0xB6 — host, 0xA7 — urządzenie)
+ * - operacja (BlockOp), identyfikator transferu (uint8)
+ * - numer bloku (uint16, little-endian), długość danych n (uint8, 0-240)
+ * - dane (n bajtów)
+ * - CRC-16/CCITT-FALSE bajtów 0..5+n (uint16, little-endian)
+ *
+ * Blok 0 otwiera transfer. Dane BlockOpenWrite (12 bajtów): obszar, dzielnik telemetrii,
+ * rozmiar bloku, okno (uint8), rozmiar danych, CRC-32 danych (uint32). Dane BlockOpenRead
+ * (12 bajtów): obszar, dzielnik telemetrii, rozmiar bloku, okno (uint8), przesunięcie,
+ * rozmiar (uint32). Bloki danych mają numery 1..N i (poza ostatnim) pełny rozmiar bloku.
+ * Odbiorca przyjmuje bloki tylko po kolei i każdy potwierdza ramką BlockAck z numerem
+ * następnego oczekiwanego bloku; nadawca po upływie czasu bez postępu wysyła ponownie
+ * wszystko od najstarszego niepotwierdzonego bloku — od razu po fastRetransmitAcks powtórzonych
+ * potwierdzeniach (odbiorca potwierdza też bloki odrzucone jako nie po kolei), w przeciwnym razie
+ * po upływie czasu bez postępu. Po odebraniu lub wysłaniu wszystkich
+ * bloków urządzenie odpowiada BlockDone: status (uint8, 0 = poprawnie) i CRC-32 danych.
+ * Ramki urządzenia, które nie należą do bieżącego transferu, są pomijane.
+ */
+
+#include "../inc/blocktransfer.h"
+#include <algorithm>
+
+namespace {
+/// Długość danych bloków otwarcia.
+constexpr int openPayloadSize = 12;
+/// Długość danych BlockDone.
+constexpr int donePayloadSize = 5;
+/// Czas oczekiwania, gdy przepustowość łącza nie jest znana [ns].
+constexpr int64_t defaultTimeoutNs = 500'000'000;
+/// Stały składnik czasu oczekiwania (opóźnienie USB, obsługa w urządzeniu) [ns].
+constexpr int64_t timeoutMarginNs = 50'000'000;
+/// Liczba powtórzonych potwierdzeń, po której bloki są ponawiane bez czekania na czas oczekiwania.
+constexpr int fastRetransmitAcks = 2;
+
+void putLe16(uint8_t *out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLe32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t getLe32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8
+           | static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+bool isKnownOp(uint8_t op) {
+    return op >= BlockOpenWrite && op <= BlockError;
+}
+}
+
+double BlockTransferStats::throughput(int64_t nowNs) const {
+    const int64_t end = endNs > 0 ? endNs : nowNs;
+    return end > startNs ? static_cast<double>(payloadBytes) * 1e9 / static_cast<double>(end - startNs) : 0.0;
+}
+
+/**
+ * Dane są kopiowane do obiektu; CRC-32 całości trafia do bloku otwarcia, aby urządzenie
+ * mogło odrzucić zapis przed zastosowaniem danych.
+ */
+bool BlockTransfer::startUpload(uint8_t region, std::vector<uint8_t> data, const BlockTransferOptions &options,
+                                int64_t nowNs, std::string &out) {
+    if (isActive()) {
+        message = "Transfer już trwa";
+        return false;
+    }
+    if (data.empty() || data.size() > static_cast<size_t>(maxBlocks) * static_cast<size_t>(options.blockSize)) {
+        message = "Niepoprawny rozmiar danych";
+        return false;
+    }
+    if (!begin(options, nowNs))
+        return false;
+    upload = true;
+    regionId = region;
+    bytes = std::move(data);
+    total = bytes.size();
+    blocks = static_cast<uint16_t>((total + static_cast<size_t>(config.blockSize) - 1) / static_cast<size_t>(config.blockSize));
+    base = 0;
+    next = 0;
+    fillWindow(out);
+    return true;
+}
+
+bool BlockTransfer::startDownload(uint8_t region, uint32_t offset, uint32_t size, const BlockTransferOptions &options,
+                                  int64_t nowNs, std::string &out) {
+    if (isActive()) {
+        message = "Transfer już trwa";
+        return false;
+    }
+    if (size == 0 || size > static_cast<uint64_t>(maxBlocks) * static_cast<uint64_t>(options.blockSize)) {
+        message = "Niepoprawny rozmiar danych";
+        return false;
+    }
+    if (!begin(options, nowNs))
+        return false;
+    upload = false;
+    regionId = region;
+    regionOffset = offset;
+    bytes.clear();
+    bytes.reserve(size);
+    total = size;
+    blocks = static_cast<uint16_t>((total + static_cast<size_t>(config.blockSize) - 1) / static_cast<size_t>(config.blockSize));
+    base = 1;
+    sendBlock(0, out);
+    return true;
+}
+
+/**
+ * Czas oczekiwania obejmuje trzykrotny czas nadania pełnego okna (ramki w drodze w obu
+ * kierunkach i przeplatana telemetria) oraz stały margines na opóźnienia konwertera USB.
+ */
+bool BlockTransfer::begin(const BlockTransferOptions &options, int64_t nowNs) {
+    if (options.blockSize < 1 || options.blockSize > maxPayload || options.window < 1 || options.window > 64
+        || options.telemetryDivider < 1 || options.telemetryDivider > 255 || options.maxRetries < 0) {
+        message = "Niepoprawne parametry transferu";
+        return false;
+    }
+    config = options;
+    if (config.timeoutMs > 0) {
+        timeoutNs = static_cast<int64_t>(config.timeoutMs) * 1'000'000;
+    } else if (config.linkBytesPerSecond > 0.0) {
+        const double windowBytes = static_cast<double>(config.window) * (config.blockSize + overhead);
+        timeoutNs = static_cast<int64_t>(3.0 * windowBytes / config.linkBytesPerSecond * 1e9) + timeoutMarginNs;
+    } else {
+        timeoutNs = defaultTimeoutNs;
+    }
+    ++id;
+    phase = State::Running;
+    message.clear();
+    counters = BlockTransferStats();
+    counters.startNs = nowNs;
+    progressNs = nowNs;
+    retries = 0;
+    duplicateAcks = 0;
+    recoveryBase = -1;
+    sentEnd = 0;
+    return true;
+}
+
+/**
+ * Przy zapisie numer potwierdzenia przesuwa okno, a powtórzone potwierdzenia uruchamiają szybkie
+ * ponowienie (raz dla danego bloku; kolejne straty obsługuje poll()); BlockDone z poprawnym CRC kończy transfer
+ * (również wtedy, gdy ostatnie potwierdzenie zginęło). Przy odczycie przyjmowany jest tylko
+ * następny oczekiwany blok o spodziewanej długości, a każda ramka danych jest potwierdzana.
+ */
+void BlockTransfer::handleFrame(const BlockFrame &frame, int64_t nowNs, std::string &out) {
+    if (!isActive() || frame.transfer != id)
+        return;
+
+    switch (frame.op) {
+    case BlockAck:
+        if (upload && frame.seq > base && frame.seq <= next) {
+            base = frame.seq;
+            progressNs = nowNs;
+            retries = 0;
+            duplicateAcks = 0;
+            counters.payloadBytes = bytesDone();
+            if (base > blocks)
+                phase = State::Finishing;
+            else
+                fillWindow(out);
+        } else if (upload && frame.seq == base && base < next && ++duplicateAcks >= fastRetransmitAcks
+                   && recoveryBase != base) {
+            // Blok base zaginął, a kolejne dotarły — ponowienie bez czekania na czas oczekiwania
+            recoveryBase = base;
+            next = base;
+            fillWindow(out);
+        }
+        break;
+    case BlockData:
+        if (upload)
+            break;
+        if (frame.seq == base && base <= blocks) {
+            const size_t expected = std::min(static_cast<size_t>(config.blockSize), total - bytes.size());
+            if (frame.payload.size() != expected) {
+                fail("Niepoprawna długość bloku " + std::to_string(frame.seq), nowNs);
+                encode(hostStartByte, BlockAbort, id, 0, nullptr, 0, out);
+                return;
+            }
+            bytes.insert(bytes.end(), frame.payload.begin(), frame.payload.end());
+            ++base;
+            progressNs = nowNs;
+            retries = 0;
+            counters.payloadBytes = bytes.size();
+            if (base > blocks)
+                phase = State::Finishing;
+        }
+        sendAck(out);
+        break;
+    case BlockDone: {
+        if (frame.payload.size() != donePayloadSize) {
+            fail("Niepoprawna ramka zakończenia", nowNs);
+            return;
+        }
+        if (!upload && phase != State::Finishing)
+            break;
+        const uint8_t status = frame.payload[0];
+        if (status != 0) {
+            fail("Urządzenie zgłosiło błąd zapisu (status " + std::to_string(status) + ")", nowNs);
+            return;
+        }
+        if (getLe32(frame.payload.data() + 1) != crc32(bytes.data(), bytes.size())) {
+            fail("Niezgodna suma CRC-32 danych", nowNs);
+            return;
+        }
+        phase = State::Done;
+        counters.payloadBytes = total;
+        counters.endNs = nowNs;
+        break;
+    }
+    case BlockError:
+        fail("Urządzenie odrzuciło transfer (status "
+                 + std::to_string(frame.payload.empty() ? 0 : frame.payload[0]) + ")", nowNs);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Go-Back-N: przy zapisie ponawiane są wszystkie bloki od najstarszego niepotwierdzonego
+ * (po potwierdzeniu wszystkich — ostatni blok, na który urządzenie odpowiada ponownie BlockDone),
+ * przy odczycie — otwarcie lub ostatnie potwierdzenie, po którym urządzenie ponawia swoje bloki.
+ */
+void BlockTransfer::poll(int64_t nowNs, std::string &out) {
+    if (!isActive() || nowNs - progressNs < timeoutNs)
+        return;
+    ++counters.timeouts;
+    if (++retries > config.maxRetries) {
+        fail("Brak odpowiedzi urządzenia", nowNs);
+        encode(hostStartByte, BlockAbort, id, 0, nullptr, 0, out);
+        return;
+    }
+    progressNs = nowNs;
+    if (upload) {
+        if (phase == State::Finishing) {
+            sendBlock(blocks, out);
+        } else {
+            next = base;
+            fillWindow(out);
+        }
+    } else if (bytes.empty()) {
+        sendBlock(0, out);
+    } else {
+        sendAck(out);
+    }
+}
+
+void BlockTransfer::abort(int64_t nowNs, std::string &out, const std::string &reason) {
+    if (!isActive())
+        return;
+    encode(hostStartByte, BlockAbort, id, 0, nullptr, 0, out);
+    fail(reason, nowNs);
+}
+
+size_t BlockTransfer::bytesDone() const {
+    if (phase == State::Done)
+        return total;
+    if (!upload)
+        return bytes.size();
+    return base <= 1 ? 0 : std::min(total, static_cast<size_t>(base - 1) * static_cast<size_t>(config.blockSize));
+}
+
+/**
+ * Blok 0 to otwarcie transferu (zapis lub odczyt), pozostałe — kolejne fragmenty danych zapisu.
+ */
+void BlockTransfer::sendBlock(uint16_t seq, std::string &out) {
+    const size_t before = out.size();
+    if (seq == 0) {
+        uint8_t open[openPayloadSize];
+        open[0] = regionId;
+        open[1] = static_cast<uint8_t>(config.telemetryDivider);
+        open[2] = static_cast<uint8_t>(config.blockSize);
+        open[3] = static_cast<uint8_t>(config.window);
+        putLe32(open + 4, upload ? static_cast<uint32_t>(total) : regionOffset);
+        putLe32(open + 8, upload ? crc32(bytes.data(), bytes.size()) : static_cast<uint32_t>(total));
+        encode(hostStartByte, upload ? BlockOpenWrite : BlockOpenRead, id, 0, open, openPayloadSize, out);
+    } else {
+        const size_t offset = static_cast<size_t>(seq - 1) * static_cast<size_t>(config.blockSize);
+        const int size = static_cast<int>(std::min(static_cast<size_t>(config.blockSize), total - offset));
+        encode(hostStartByte, BlockData, id, seq, bytes.data() + offset, size, out);
+    }
+    ++counters.blocksSent;
+    counters.wireBytesSent += out.size() - before;
+    if (seq < sentEnd)
+        ++counters.retransmits;
+    else
+        sentEnd = static_cast<uint16_t>(seq + 1);
+}
+
+void BlockTransfer::fillWindow(std::string &out) {
+    while (next <= blocks && next < base + config.window)
+        sendBlock(next++, out);
+}
+
+void BlockTransfer::sendAck(std::string &out) {
+    encode(hostStartByte, BlockAck, id, base, nullptr, 0, out);
+    counters.wireBytesSent += overhead;
+}
+
+void BlockTransfer::fail(const std::string &reason, int64_t nowNs) {
+    phase = State::Failed;
+    message = reason;
+    counters.endNs = nowNs;
+}
+
+void BlockTransfer::encode(uint8_t start, uint8_t op, uint8_t transfer, uint16_t seq, const uint8_t *payload, int size,
+                           std::string &out) {
+    const size_t at = out.size();
+    out.resize(at + static_cast<size_t>(size + overhead));
+    auto *frame = reinterpret_cast<uint8_t *>(&out[at]);
+    frame[0] = start;
+    frame[1] = op;
+    frame[2] = transfer;
+    putLe16(frame + 3, seq);
+    frame[5] = static_cast<uint8_t>(size);
+    std::copy(payload, payload + size, frame + headerSize);
+    putLe16(frame + headerSize + size, crc16(frame, static_cast<size_t>(headerSize + size)));
+}
+
+/**
+ * Nieznana operacja lub długość ponad maxPayload oznacza przypadkowy bajt startu — dekoder
+ * może wtedy od razu szukać dalej, zamiast czekać na resztę rzekomej ramki.
+ */
+int BlockTransfer::frameLength(const char *bytes, int available) {
+    if (available < headerSize)
+        return 0;
+    const auto op = static_cast<uint8_t>(bytes[1]);
+    const auto size = static_cast<uint8_t>(bytes[5]);
+    if (!isKnownOp(op) || size > maxPayload)
+        return -1;
+    return size + overhead;
+}
+
+bool BlockTransfer::parse(const char *frame, int size, BlockFrame &out) {
+    if (frameLength(frame, size) != size)
+        return false;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(frame);
+    const uint16_t crc = static_cast<uint16_t>(bytes[size - 2] | bytes[size - 1] << 8);
+    if (crc != crc16(bytes, static_cast<size_t>(size - 2)))
+        return false;
+    out.op = bytes[1];
+    out.transfer = bytes[2];
+    out.seq = static_cast<uint16_t>(bytes[3] | bytes[4] << 8);
+    out.payload.assign(bytes + headerSize, bytes + size - 2);
+    return true;
+}
+
+uint16_t BlockTransfer::crc16(const uint8_t *data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit)
+            crc = static_cast<uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * Tablica dla wielomianu odwróconego 0xEDB88320 budowana jest przy pierwszym użyciu.
+ */
+uint32_t BlockTransfer::crc32(const uint8_t *data, size_t size) {
+    static const std::vector<uint32_t> table = []() {
+        std::vector<uint32_t> entries(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+                value = value & 1 ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+            entries[i] = value;
+        }
+        return entries;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
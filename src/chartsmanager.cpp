@@ -6,9 +6,81 @@
  * dla parametrów pracy silnika: PWM, RPM, napięcie, prąd, moc.
  * Umożliwia dynamiczne dodawanie punktów, automatyczne przewijanie osi X,
  * usuwanie starych punktów oraz zmianę tytułów i opisów wykresów.
+ * Wykresy kanałów pochodnych mogą być dodawane i usuwane w trakcie działania programu.
  */
 
 #include "../inc/chartsmanager.h"
+#include "../inc/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+/**
+ * Widok wykresu mierzący czas rysowania (paintEvent) na potrzeby śladu wykonania.
+ */
+class TracedChartView : public QChartView
+{
+public:
+    using QChartView::QChartView;
+
+protected:
+    void paintEvent(QPaintEvent *event) override {
+        TRACE_SCOPE("QChartView::paintEvent");
+        QChartView::paintEvent(event);
+    }
+};
+
+/// Minimalny odstęp punktów przy odtwarzaniu serii z historii (odpowiada okresowi odświeżania) [s].
+constexpr qreal rebuildSpacing = 0.01;
+/// Górna granica osi Y wykresu zbiorczego [% zakresu kanału].
+constexpr qreal combinedYMax = 110.0;
+
+/**
+ * Przerzedza punkty historii do odstępu rebuildSpacing i skaluje wartości (normalizacja).
+ */
+QList<QPointF> decimated(const QVector<QPointF> &history, qreal scale) {
+    QList<QPointF> points;
+    points.reserve(history.size());
+    for (const QPointF &p : history) {
+        if (points.isEmpty() || p.x() - points.last().x() >= rebuildSpacing)
+            points.append(QPointF(p.x(), p.y() * scale));
+    }
+    return points;
+}
+
+/**
+ * Widżet, w którym umieszczony jest widok wykresu (rodzic layoutu).
+ */
+QWidget *hostWidget(QLayout *layout) {
+    return layout ? layout->parentWidget() : nullptr;
+}
+
+/**
+ * Czy widżet jest widoczny w niezminimalizowanym oknie.
+ */
+bool isShowing(const QWidget *widget) {
+    return widget && widget->isVisible() && !widget->window()->isMinimized();
+}
+
+/**
+ * Kolor serii danego kanału (wspólny dla wykresów pojedynczych i zbiorczego).
+ */
+QColor seriesColor(ChartType type) {
+    switch (type) {
+    case ChartType::PWM:     return QColor("purple");
+    case ChartType::RPM:     return QColor("orange");
+    case ChartType::Voltage: return QColor("blue");
+    case ChartType::Current: return QColor("red");
+    case ChartType::Power:   return QColor("green");
+    case ChartType::Derived: break;
+    }
+    // Kanały pochodne: kolejne kolory palety, różne od kolorów kanałów wbudowanych
+    static const char *const palette[] = {"darkcyan", "magenta", "saddlebrown", "olive", "navy", "crimson"};
+    const int index = static_cast<int>(type) - static_cast<int>(ChartType::Derived);
+    return QColor(palette[index % static_cast<int>(std::size(palette))]);
+}
+}
 
 /**
  * Inicjalizuje obiekt ChartsManager.
@@ -17,8 +89,9 @@
 ChartsManager::ChartsManager(QObject *parent) : QObject{parent}{}
 
 /**
- * Funkcja tworzy nowy wykres o zadanym typie, konfiguruje osie, tytuły, kolory oraz dodaje go do podanego layoutu.
- * Wykres wyświetla parametr w funkcji czasu.
+ * Funkcja zapamiętuje parametry wykresu; sam wykres (osie, tytuły, kolory) tworzony jest w createChart()
+ * przy pierwszym pokazaniu widżetu-rodzica layoutu. Dzięki temu okno pojawia się bez czekania
+ * na konstrukcję wszystkich QChartView, a wykresy w ukrytych częściach GUI nie są w ogóle tworzone.
  * Użytkownik może ustawić czy oś Y ma korzystać z "ładnych" wartości (nice numbers).
  */
 
@@ -26,76 +99,430 @@ void ChartsManager::setupChart(ChartType type, QLayout *targetLayout, const QStr
     ChartComponents components;
 
     components.type = type;
-    components.series = new QLineSeries;
-    components.chart = new QChart;
-    components.chartView = new QChartView(components.chart);
-    components.axisX = new QValueAxis;
-    components.axisY = new QValueAxis;
     components.xRange = xRange;
-    components.series->setName(title);
-    components.chart->addSeries(components.series);
-    components.chart->setTitle(title);
+    components.layout = targetLayout;
+    components.title = title;
+    components.seriesName = title;
+    components.yLabel = yLabel;
+    components.xLabel = tr("Czas [s]");
+    components.yMax = yMax;
+    components.niceNumbers = nice_numbers;
+    charts[type] = components;
 
-    components.axisX->setRange(0, xRange);
-    components.axisX->setLabelFormat("%.1f");
-    components.axisX->setTitleText(tr("Czas [s]"));
-    components.chart->addAxis(components.axisX, Qt::AlignBottom);
-    components.series->attachAxis(components.axisX);
-    components.axisY->setRange(0, yMax);
-    if(nice_numbers){
-        components.axisY->applyNiceNumbers();
+    QWidget *host = hostWidget(targetLayout);
+    if (!host) {
+        createChart(charts[type]);
+        return;
     }
-    components.axisY->setTitleText(yLabel);
-    components.chart->addAxis(components.axisY, Qt::AlignLeft);
-    components.series->attachAxis(components.axisY);
-    if (type == ChartType::PWM)     components.series->setColor(QColor("purple"));
-    if (type == ChartType::RPM)     components.series->setColor(QColor("orange"));
-    if (type == ChartType::Voltage) components.series->setColor(QColor("blue"));
-    if (type == ChartType::Power)   components.series->setColor(QColor("green"));
-    if (type == ChartType::Current) components.series->setColor(QColor("red"));
 
-    components.chartView->setRenderHint(QPainter::Antialiasing);
+    host->installEventFilter(this);
+    host->window()->installEventFilter(this);
+    if (host->isVisible())
+        activateChart(type);
+}
+
+/**
+ * Funkcja tworzy obiekty QtCharts, konfiguruje osie, tytuły, kolory oraz dodaje widok do layoutu.
+ * Wykres wyświetla parametr w funkcji czasu.
+ */
+void ChartsManager::createChart(ChartComponents &c) {
+    TRACE_SCOPE("ChartsManager::createChart");
+    c.series = new QLineSeries;
+    c.chart = new QChart;
+    c.chartView = new TracedChartView(c.chart);
+    c.axisX = new QValueAxis;
+    c.axisY = new QValueAxis;
+    c.series->setName(c.seriesName);
+    c.chart->addSeries(c.series);
+    c.chart->setTitle(c.title);
 
-    if (targetLayout) {
-        targetLayout->addWidget(components.chartView);
+    if (c.fixedX)
+        c.axisX->setRange(c.xFrom, c.xTo);
+    else
+        c.axisX->setRange(0, c.xRange);
+    c.axisX->setLabelFormat("%.1f");
+    c.axisX->setTitleText(c.xLabel);
+    c.chart->addAxis(c.axisX, Qt::AlignBottom);
+    c.series->attachAxis(c.axisX);
+    c.axisY->setRange(c.yMin, c.yMax);
+    if(c.niceNumbers){
+        c.axisY->applyNiceNumbers();
     }
+    c.axisY->setTitleText(c.yLabel);
+    c.chart->addAxis(c.axisY, Qt::AlignLeft);
+    c.series->attachAxis(c.axisY);
+    c.series->setColor(seriesColor(c.type));
 
+    c.chartView->setRenderHint(QPainter::Antialiasing);
 
-    charts[type] = components;
+    for (int i = 0; i < c.overlays.size(); ++i)
+        createOverlaySeries(c, i);
+
+    if (c.layout) {
+        c.layout->addWidget(c.chartView);
+    }
+}
+
+/**
+ * Kolejne numery dostają odcienie rozłożone na kole barw.
+ */
+QColor ChartsManager::overlayColor(int index) {
+    return QColor::fromHsv((index * 67) % 360, 220, 200);
+}
+
+void ChartsManager::createOverlaySeries(ChartComponents &c, int index) {
+    Overlay &overlay = c.overlays[index];
+    overlay.series = new QLineSeries;
+    overlay.series->setName(overlay.name);
+    overlay.series->setColor(overlayColor(index));
+    c.chart->addSeries(overlay.series);
+    overlay.series->attachAxis(c.axisX);
+    overlay.series->attachAxis(c.axisY);
+    overlay.series->replace(overlay.points);
+
+    // Wykres z samymi seriami nakładanymi (np. przeglądarka sesji) nie pokazuje w legendzie pustej serii głównej
+    const QList<QLegendMarker *> markers = c.chart->legend()->markers(c.series);
+    if (!markers.isEmpty())
+        markers.first()->setVisible(c.series->count() > 0);
+}
+
+/**
+ * Punkty zapamiętywane są również przed utworzeniem wykresu i trafiają do serii w createChart().
+ * Brakujące numery serii (np. po usunięciu nagrania z porównania) pozostają pustymi seriami.
+ */
+void ChartsManager::setOverlay(ChartType type, int index, const QString &name, const QVector<QPointF> &points) {
+    const auto it = charts.find(type);
+    if (it == charts.end() || index < 0) return;
+
+    ChartComponents &c = *it;
+    while (c.overlays.size() <= index) {
+        c.overlays.append(Overlay());
+        if (c.chart) createOverlaySeries(c, c.overlays.size() - 1);
+    }
+    Overlay &overlay = c.overlays[index];
+    overlay.name = name;
+    overlay.points = QList<QPointF>(points.cbegin(), points.cend());
+    if (c.autoRange && !points.isEmpty()) {
+        const auto [low, high] = std::minmax_element(points.cbegin(), points.cend(),
+                                                     [](const QPointF &a, const QPointF &b) { return a.y() < b.y(); });
+        expandRange(c, low->y(), high->y());
+    }
+    if (overlay.series) {
+        overlay.series->setName(name);
+        overlay.series->replace(overlay.points);
+    }
+}
+
+/**
+ * Serie są usuwane ze sceny razem z obiektami.
+ */
+void ChartsManager::clearOverlays(ChartType type) {
+    const auto it = charts.find(type);
+    if (it == charts.end()) return;
+    for (Overlay &overlay : it->overlays) {
+        if (overlay.series) {
+            it->chart->removeSeries(overlay.series);
+            delete overlay.series;
+        }
+    }
+    it->overlays.clear();
+}
+
+void ChartsManager::setXRange(ChartType type, qreal from, qreal to) {
+    const auto it = charts.find(type);
+    if (it == charts.end()) return;
+    it->fixedX = true;
+    it->xFrom = from;
+    it->xTo = to;
+    if (it->axisX) it->axisX->setRange(from, to);
+}
+
+/**
+ * Wstrzymany wykres odtwarzany jest jednym wywołaniem QLineSeries::replace() z punktów historii
+ * z ostatniego okna osi X, przerzedzonych do odstępu odświeżania — tak jakby był aktualizowany cały czas.
+ */
+void ChartsManager::activateChart(ChartType type) {
+    if (!charts.contains(type)) return;
+
+    auto &c = charts[type];
+    if (!c.chartView) {
+        createChart(c);
+        c.stale = c.lastTime > 0.0;
+    }
+    if (!c.stale || !historySource) return;
+
+    TRACE_SCOPE("ChartsManager::activateChart");
+    const qreal from = c.lastTime - c.xRange;
+    const QList<QPointF> points = decimated(historySource(type, from, c.lastTime), 1.0);
+    if (c.autoRange && !points.isEmpty()) {
+        const auto [low, high] = std::minmax_element(points.cbegin(), points.cend(),
+                                                     [](const QPointF &a, const QPointF &b) { return a.y() < b.y(); });
+        expandRange(c, low->y(), high->y());
+    }
+    c.series->replace(points);
+    if (c.lastTime > c.xRange && !c.fixedX) {
+        c.axisX->setRange(c.lastTime - c.xRange, c.lastTime);
+    }
+    c.stale = false;
+}
+
+/**
+ * Funkcja tworzy wykres zbiorczy: jedną scenę ze wspólną osią czasu i wspólną osią Y w procentach
+ * zakresu kanału. Zastępuje pięć scen jedną, więc odświeżenie wszystkich kanałów to jedno
+ * przerysowanie zamiast pięciu. Wywoływać po setupChart() dla wszystkich kanałów.
+ */
+void ChartsManager::setupCombinedChart(QLayout *targetLayout, const QString &title) {
+    combined.layout = targetLayout;
+    combined.title = title;
+    for (const ChartComponents &c : std::as_const(charts)) {
+        combined.xRange = qMax(combined.xRange, c.xRange);
+    }
+
+    QWidget *host = hostWidget(targetLayout);
+    if (!host) {
+        activateCombinedChart();
+        return;
+    }
+
+    host->installEventFilter(this);
+    host->window()->installEventFilter(this);
+    if (host->isVisible())
+        activateCombinedChart();
+}
+
+/**
+ * Nazwa zawiera zakres osi Y kanału, aby z procentowej osi można było odczytać wartość bezwzględną.
+ */
+QString ChartsManager::combinedSeriesName(const ChartComponents &c) {
+    return QStringLiteral("%1 (100% = %2 %3)").arg(c.seriesName).arg(c.yMax).arg(c.yLabel);
+}
+
+qreal ChartsManager::normalized(const ChartComponents &c, qreal value) {
+    return c.yMax > 0.0f ? value * 100.0 / c.yMax : value;
+}
+
+/**
+ * Przy pierwszym wywołaniu tworzy scenę, osie i serie; wstrzymane serie odtwarzane są z historii
+ * tak samo jak w activateChart().
+ */
+void ChartsManager::activateCombinedChart() {
+    if (!combined.chartView) {
+        TRACE_SCOPE("ChartsManager::createCombinedChart");
+        combined.chart = new QChart;
+        combined.chartView = new TracedChartView(combined.chart);
+        combined.axisX = new QValueAxis;
+        combined.axisY = new QValueAxis;
+        combined.chart->setTitle(combined.title);
+
+        combined.axisX->setRange(0, combined.xRange);
+        combined.axisX->setLabelFormat("%.1f");
+        combined.axisX->setTitleText(tr("Czas [s]"));
+        combined.chart->addAxis(combined.axisX, Qt::AlignBottom);
+        combined.axisY->setRange(0, combinedYMax);
+        combined.axisY->setLabelFormat("%.0f");
+        combined.axisY->setTitleText(tr("% zakresu"));
+        combined.chart->addAxis(combined.axisY, Qt::AlignLeft);
+
+        for (const ChartComponents &c : std::as_const(charts)) {
+            if (c.type >= ChartType::Derived) continue;
+            QLineSeries *series = new QLineSeries;
+            series->setName(combinedSeriesName(c));
+            series->setColor(seriesColor(c.type));
+            series->setVisible(!combined.hidden.value(c.type, false));
+            combined.chart->addSeries(series);
+            series->attachAxis(combined.axisX);
+            series->attachAxis(combined.axisY);
+            combined.series.insert(c.type, series);
+        }
+        combined.chart->legend()->setAlignment(Qt::AlignBottom);
+        combined.chartView->setRenderHint(QPainter::Antialiasing);
+
+        if (combined.layout) {
+            combined.layout->addWidget(combined.chartView);
+        }
+        combined.stale = combined.lastTime > 0.0;
+    }
+    if (!combined.stale || !historySource) return;
+
+    TRACE_SCOPE("ChartsManager::activateCombinedChart");
+    const qreal from = combined.lastTime - combined.xRange;
+    for (auto it = combined.series.begin(); it != combined.series.end(); ++it) {
+        const ChartComponents &c = charts[it.key()];
+        it.value()->replace(decimated(historySource(it.key(), from, combined.lastTime), normalized(c, 1.0)));
+    }
+    if (combined.lastTime > combined.xRange) {
+        combined.axisX->setRange(combined.lastTime - combined.xRange, combined.lastTime);
+    }
+    combined.stale = false;
+}
+
+/**
+ * Widok jest właścicielem sceny, a scena serii i osi, więc usunięcie widoku zwalnia cały wykres.
+ * Zakolejkowane aktywacje usuniętego wykresu są pomijane (nie ma go już w mapie).
+ */
+void ChartsManager::removeChart(ChartType type) {
+    const auto it = charts.find(type);
+    if (it == charts.end()) return;
+    delete it->chartView;
+    charts.erase(it);
+}
+
+void ChartsManager::setAutoRange(ChartType type, bool enabled) {
+    const auto it = charts.find(type);
+    if (it != charts.end()) it->autoRange = enabled;
+}
+
+/**
+ * Zakres jest tylko rozszerzany (z 10% zapasem), aby oś nie skakała przy każdym punkcie.
+ */
+void ChartsManager::expandRange(ChartComponents &c, qreal low, qreal high) {
+    if (!c.autoRange || !std::isfinite(low) || !std::isfinite(high)) return;
+    if (low >= c.yMin && high <= c.yMax) return;
+
+    const qreal margin = 0.1 * qMax(high - low, qMax(qAbs(high), qAbs(low)));
+    if (low < c.yMin) c.yMin = static_cast<float>(low - margin);
+    if (high > c.yMax) c.yMax = static_cast<float>(high + margin);
+    if (c.axisY) {
+        c.axisY->setRange(c.yMin, c.yMax);
+        if (c.niceNumbers) c.axisY->applyNiceNumbers();
+    }
+}
+
+void ChartsManager::setCombinedSeriesVisible(ChartType type, bool visible) {
+    combined.hidden[type] = !visible;
+    if (QLineSeries *series = combined.series.value(type, nullptr))
+        series->setVisible(visible);
+}
+
+void ChartsManager::setCombinedTitle(const QString &title) {
+    combined.title = title;
+    if (combined.chart) combined.chart->setTitle(title);
+}
+
+/**
+ * Wykres jest aktywny, gdy jego widok istnieje, jest widoczny i okno nie jest zminimalizowane.
+ */
+bool ChartsManager::isVisibleOnScreen(const QChartView *view) {
+    return view && isShowing(view);
+}
+
+bool ChartsManager::isChartActive(ChartType type) const {
+    const auto it = charts.constFind(type);
+    return it != charts.constEnd() && isVisibleOnScreen(it->chartView);
+}
+
+int ChartsManager::createdChartCount() const {
+    int count = combined.chartView ? 1 : 0;
+    for (const ChartComponents &c : charts) {
+        if (c.chartView) ++count;
+    }
+    return count;
+}
+
+void ChartsManager::setHistorySource(HistorySource source) {
+    historySource = std::move(source);
+}
+
+/**
+ * Pokazanie widżetu-rodzica lub przywrócenie zminimalizowanego okna aktywuje odpowiednie wykresy.
+ */
+bool ChartsManager::eventFilter(QObject *watched, QEvent *event) {
+    const bool shown = event->type() == QEvent::Show;
+    const bool restored = event->type() == QEvent::WindowStateChange
+                          && watched->isWidgetType()
+                          && !static_cast<QWidget *>(watched)->isMinimized();
+    if (shown || restored)
+        scheduleActivation(watched);
+    return QObject::eventFilter(watched, event);
+}
+
+/**
+ * Aktywacja jest odkładana do pętli zdarzeń, aby nie dodawać widżetów w trakcie obsługi QEvent::Show.
+ */
+void ChartsManager::scheduleActivation(QObject *watched) {
+    const auto concerns = [watched](QLayout *layout) {
+        QWidget *host = hostWidget(layout);
+        return host && (host == watched || host->window() == watched);
+    };
+
+    for (const ChartComponents &c : std::as_const(charts)) {
+        if (!concerns(c.layout) || (c.chartView && !c.stale)) continue;
+        const ChartType type = c.type;
+        QMetaObject::invokeMethod(this, [this, type]() {
+            const auto it = charts.constFind(type);
+            if (it != charts.constEnd() && isShowing(hostWidget(it->layout)))
+                activateChart(type);
+        }, Qt::QueuedConnection);
+    }
+
+    if (concerns(combined.layout) && (!combined.chartView || combined.stale)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            if (isShowing(hostWidget(combined.layout)))
+                activateCombinedChart();
+        }, Qt::QueuedConnection);
+    }
 }
 
 /**
  * Punkt reprezentuje wartość parametru w danym czasie.
  * Jeśli aktualny czas przekracza zakres osi X, oś X jest przesuwana w prawo.
  * Stare punkty spoza aktualnego okna czasu są usuwane automatycznie.
+ * Dla niewidocznego wykresu zapamiętywany jest tylko czas — seria zostanie odtworzona
+ * z historii po ponownym pokazaniu (activateChart()). To samo dotyczy wykresu zbiorczego.
  */
 void ChartsManager::addPoint(ChartType type, qreal time, qreal value) {
+    TRACE_SCOPE("ChartsManager::addPoint");
     if (!charts.contains(type)) return;
 
     auto &c = charts[type];
-    c.series->append(time, value);
+    c.lastTime = time;
+    if (isVisibleOnScreen(c.chartView)) {
+        expandRange(c, value, value);
+        c.series->append(time, value);
+
+        // Jeśli czas przekracza 5s, przesuwaj oś X
+        if (time > c.xRange && !c.fixedX) {
+            c.axisX->setRange(time - c.xRange, time);
+        }
 
-    // Jeśli czas przekracza 5s, przesuwaj oś X
-    if (time > c.xRange) {
-        c.axisX->setRange(time - c.xRange, time);
+        removeOldPoints(c.series, time, c.xRange);
+    } else {
+        c.stale = true;
     }
 
-    removeOldPoints(c.series, time);
+    if (!combined.layout) return;
+    combined.lastTime = time;
+    if (!isVisibleOnScreen(combined.chartView)) {
+        combined.stale = true;
+        return;
+    }
+    QLineSeries *series = combined.series.value(type, nullptr);
+    if (!series) return;
+    series->append(time, normalized(c, value));
+    if (time > combined.xRange) {
+        combined.axisX->setRange(time - combined.xRange, time);
+    }
+    removeOldPoints(series, time, combined.xRange);
 }
 
 /**
- * Funkcja iteracyjnie usuwa najstarsze punkty z początku serii,
+ * Funkcja usuwa najstarsze punkty z początku serii,
  * tak aby na wykresie pozostawały tylko punkty w aktualnym oknie czasu
  * (np. ostatnie 5 sekund).
  */
 
-void ChartsManager::removeOldPoints(QLineSeries *series, qreal currentTime) {
-    // Usuwanie starych punktów spoza zakresu ostatnich 5 sekund
-    // Jeśli są jakiekolwiek punkty oraz wartość pierwszego punktu na osi X jest
-    // starsza niż ostatnie 5 sekund to go usuń. I tak w pętli do momentu pozbycia
-    // się punktów, które przekroczyły zadany czas, w tym przypadku 5 sekund.
-    while (!series->points().isEmpty() && series->points().first().x() < (currentTime - 5.0)) {
-        series->remove(0);
+void ChartsManager::removeOldPoints(QLineSeries *series, qreal currentTime, qreal window) {
+    TRACE_SCOPE("ChartsManager::removeOldPoints");
+    // Punkty są posortowane według czasu — liczymy te starsze niż okno (bez kopiowania
+    // listy przez points()) i usuwamy je jednym wywołaniem, a nie po jednym.
+    const qreal limit = currentTime - window;
+    const int total = series->count();
+    int stale = 0;
+    while (stale < total && series->at(stale).x() < limit) {
+        ++stale;
+    }
+    if (stale > 0) {
+        series->removePoints(0, stale);
     }
 }
 
@@ -103,14 +530,20 @@ void ChartsManager::removeOldPoints(QLineSeries *series, qreal currentTime) {
  * Funkcja pozwala na dynamiczną zmianę tytułu wykresu (np. po zmianie języka GUI).
  */
 void ChartsManager::setTitle(ChartType type, const QString &title) {
-    charts[type].chart->setTitle(title);
+    auto &c = charts[type];
+    c.title = title;
+    if (c.chart) c.chart->setTitle(title);
 }
 
 /**
  * Funkcja pozwala na dynamiczną zmianę nazwy serii (np. po zmianie języka GUI).
  */
 void ChartsManager::setSeriesName(ChartType type, const QString &name) {
-    charts[type].series->setName(name);
+    auto &c = charts[type];
+    c.seriesName = name;
+    if (c.series) c.series->setName(name);
+    if (QLineSeries *series = combined.series.value(type, nullptr))
+        series->setName(combinedSeriesName(c));
 }
 
 /**
@@ -118,5 +551,8 @@ void ChartsManager::setSeriesName(ChartType type, const QString &name) {
  */
 
 void ChartsManager::setXAxisTitle(ChartType type, const QString &title) {
-        charts[type].axisX->setTitleText(title);
+    auto &c = charts[type];
+    c.xLabel = title;
+    if (c.axisX) c.axisX->setTitleText(title);
+    if (combined.axisX) combined.axisX->setTitleText(title);
 }
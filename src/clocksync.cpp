@@ -0,0 +1,181 @@
+/**
+ * @file clocksync.cpp
+ * @brief Implementacja klasy ClockSync.
+ *
+ * Czasy w oknie przechowywane są względem pierwszej pary po resecie, a dopasowanie liczone
+ * na wartościach wycentrowanych — sumy kwadratów nie tracą precyzji nawet po wielu godzinach.
+ * Dopasowanie przeliczane jest raz na przedział (domyślnie co 100 ms czasu urządzenia),
+ * więc koszt na próbkę jest stały.
+ */
+
+#include "../inc/clocksync.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+/// Waga nowej próbki w wykładniczej wariancji opóźnień.
+constexpr double residualAlpha = 1.0 / 1024.0;
+}
+
+ClockSync::ClockSync(size_t window) : capacity(std::max(window, minDriftSamples)) {
+    points.reserve(capacity);
+}
+
+void ClockSync::reset() {
+    points.clear();
+    next = 0;
+    started = false;
+    locked = false;
+    intercept = 0.0;
+    slope = 1.0;
+    offset = 0.0;
+    jitter = 0.0;
+    residualMean = 0.0;
+    residualVariance = 0.0;
+    correctionUs = 0.0;
+    delayed = false;
+    lastMappedNs = std::numeric_limits<int64_t>::min();
+}
+
+void ClockSync::restart() {
+    const int64_t keepNs = lastMappedNs;
+    reset();
+    lastMappedNs = keepNs;
+    ++resyncs;
+}
+
+int64_t ClockSync::monotonic(int64_t ns) {
+    lastMappedNs = std::max(ns, lastMappedNs);
+    return lastMappedNs;
+}
+
+/**
+ * Przyrost znacznika liczony jest modulo 2^32, więc przepełnienie licznika urządzenia nie przerywa
+ * osi czasu; przyrost "ujemny" (jako int32) oznacza restart urządzenia.
+ *
+ * Opóźnienie odbioru jest zawsze dodatnie, więc próbka wyprzedzająca dopasowanie o więcej niż
+ * resetThresholdUs oznacza restart urządzenia (np. po przepełnieniu, gdy znacznik "skacze" do
+ * przodu). Duże dodatnie opóźnienie to zwykle przestój hosta — zaległe próbki przychodzą naraz,
+ * a ich znaczniki są poprawne — dlatego takie przedziały nie trafiają do okna, a estymacja zaczyna
+ * się od nowa dopiero, gdy opóźnienie utrzymuje się przez outlierConfirmUs (np. zegar urządzenia
+ * zatrzymany debuggerem).
+ */
+int64_t ClockSync::update(uint32_t deviceUs, int64_t hostNs) {
+    if (started && static_cast<int32_t>(deviceUs - lastRawUs) < 0)
+        restart();
+
+    if (!started) {
+        started = true;
+        originRawUs = deviceUs;
+        lastRawUs = deviceUs;
+        unwrappedUs = 0;
+        hostOriginNs = hostNs;
+        bucketBest = {0.0, 0.0};
+        bucketEndUs = bucketUs;
+    }
+
+    const uint32_t elapsedUs = deviceUs - lastRawUs;
+    unwrappedUs += elapsedUs;
+    lastRawUs = deviceUs;
+
+    const Point point{static_cast<double>(unwrappedUs), static_cast<double>(hostNs - hostOriginNs) / 1000.0};
+    if (locked) {
+        const double residualUs = point.hostUs - predict(point.deviceUs);
+        if (residualUs < -resetThresholdUs) {
+            restart();
+            return update(deviceUs, hostNs);
+        }
+        if (residualUs <= outlierUs) {
+            delayed = false;
+        } else if (!delayed) {
+            delayed = true;
+            delayedSinceNs = hostNs;
+        } else if (hostNs - delayedSinceNs > outlierConfirmUs * 1000) {
+            restart();
+            return update(deviceUs, hostNs);
+        }
+
+        // Wygaszanie poprzednich zmian dopasowania
+        const double maxStepUs = maxSlewPpm * 1e-6 * static_cast<double>(elapsedUs);
+        correctionUs -= std::clamp(correctionUs, -maxStepUs, maxStepUs);
+    }
+
+    // Zamknięcie przedziału: do okna trafia para o najmniejszym opóźnieniu (host - urządzenie),
+    // chyba że cały przedział był opóźniony przez przestój hosta
+    if (unwrappedUs >= bucketEndUs) {
+        if (!locked || bucketBest.hostUs - predict(bucketBest.deviceUs) <= outlierUs) {
+            if (points.size() < capacity) {
+                points.push_back(bucketBest);
+            } else {
+                points[next] = bucketBest;
+            }
+            next = (next + 1) % capacity;
+            const double previousUs = predict(point.deviceUs);
+            refit();
+            if (locked)
+                correctionUs += previousUs - predict(point.deviceUs);
+            locked = true;
+        }
+        bucketBest = point;
+        bucketEndUs = (unwrappedUs / bucketUs + 1) * bucketUs;
+    } else if (point.hostUs - point.deviceUs < bucketBest.hostUs - bucketBest.deviceUs) {
+        bucketBest = point;
+    }
+
+    if (!locked)
+        return monotonic(hostNs);
+
+    recordResidual(point.hostUs - predict(point.deviceUs));
+    const int64_t mappedNs = monotonic(toHostNs(unwrappedUs) + static_cast<int64_t>(std::llround(correctionUs * 1000.0)));
+    offset = static_cast<double>(mappedNs) / 1000.0
+             - (static_cast<double>(originRawUs) + static_cast<double>(unwrappedUs));
+    return mappedNs;
+}
+
+int64_t ClockSync::toHostNs(int64_t deviceUs) const {
+    return hostOriginNs + static_cast<int64_t>(std::llround(predict(static_cast<double>(deviceUs)) * 1000.0));
+}
+
+/**
+ * Dopóki okno zawiera mniej niż minDriftSamples par, nachylenie wynosi 1 (tylko przesunięcie).
+ * Opóźnienie nie może być mniejsze od minimalnego, więc prosta jest przesuwana tak, aby
+ * przechodziła przez najniższy punkt — czas próbki odpowiada odebraniu z najmniejszym
+ * zaobserwowanym opóźnieniem.
+ */
+void ClockSync::refit() {
+    const double n = static_cast<double>(points.size());
+
+    double meanDevice = 0.0, meanHost = 0.0;
+    for (const Point &p : points) {
+        meanDevice += p.deviceUs;
+        meanHost += p.hostUs;
+    }
+    meanDevice /= n;
+    meanHost /= n;
+
+    slope = 1.0;
+    if (points.size() >= minDriftSamples) {
+        double sxx = 0.0, sxy = 0.0;
+        for (const Point &p : points) {
+            const double dx = p.deviceUs - meanDevice;
+            sxx += dx * dx;
+            sxy += dx * (p.hostUs - meanHost);
+        }
+        if (sxx > 0.0)
+            slope = sxy / sxx;
+    }
+    intercept = meanHost - slope * meanDevice;
+
+    double minResidual = points.front().hostUs - predict(points.front().deviceUs);
+    for (const Point &p : points)
+        minResidual = std::min(minResidual, p.hostUs - predict(p.deviceUs));
+    intercept += minResidual;
+}
+
+void ClockSync::recordResidual(double residualUs) {
+    const double delta = residualUs - residualMean;
+    residualMean += residualAlpha * delta;
+    residualVariance = (1.0 - residualAlpha) * (residualVariance + residualAlpha * delta * delta);
+    jitter = std::sqrt(residualVariance);
+}
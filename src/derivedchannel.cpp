@@ -0,0 +1,394 @@
+/**
+ * @file derivedchannel.cpp
+ * @brief Implementacja kompilatora i interpretera wyrażeń kanałów pochodnych.
+ *
+ * Parser (zejście rekurencyjne) emituje instrukcje od razu w odwrotnej notacji polskiej.
+ * Operacja na samych stałych jest obliczana w czasie kompilacji. Interpreter wykonuje
+ * instrukcje na blokach DerivedExpression::blockSize wartości — stos przechowuje całe bloki.
+ * Liczby czytane są w locale "C" niezależnie od ustawień systemu.
+ */
+
+#include "../inc/derivedchannel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+namespace {
+
+using Op = DerivedExpression::Op;
+using Instruction = DerivedExpression::Instruction;
+
+/**
+ * Czy kod operacji jest operacją dwuargumentową.
+ */
+bool isBinary(Op op) {
+    return op >= Op::Add && op <= Op::Max;
+}
+
+/**
+ * Oblicza operację dla jednej pary argumentów (zwijanie stałych i interpreter używają tej samej definicji).
+ */
+inline float apply(Op op, float a, float b) {
+    switch (op) {
+    case Op::Add:  return a + b;
+    case Op::Sub:  return a - b;
+    case Op::Mul:  return a * b;
+    case Op::Div:  return a / b;
+    case Op::Pow:  return std::pow(a, b);
+    case Op::Min:  return std::min(a, b);
+    case Op::Max:  return std::max(a, b);
+    case Op::Neg:  return -a;
+    case Op::Abs:  return std::fabs(a);
+    case Op::Sqrt: return std::sqrt(a);
+    default:       break;
+    }
+    return 0.0f;
+}
+
+/**
+ * Wykonuje operację dwuargumentową na bloku: a[i] = a[i] op b[i].
+ */
+template <typename F>
+void binary(float *a, const float *b, size_t count, F f) {
+    for (size_t i = 0; i < count; ++i)
+        a[i] = f(a[i], b[i]);
+}
+
+/**
+ * Wykonuje operację jednoargumentową na bloku: a[i] = op a[i].
+ */
+template <typename F>
+void unary(float *a, size_t count, F f) {
+    for (size_t i = 0; i < count; ++i)
+        a[i] = f(a[i]);
+}
+
+/**
+ * Parser wyrażeń:
+ *
+ *     wyrażenie := składnik (('+' | '-') składnik)*
+ *     składnik  := czynnik (('*' | '/') czynnik)*
+ *     czynnik   := '-' czynnik | potęga
+ *     potęga    := atom ('^' czynnik)?
+ *     atom      := liczba | kanał | setpoint | funkcja '(' argumenty ')' | '(' wyrażenie ')'
+ */
+class Compiler
+{
+public:
+    explicit Compiler(const std::string &text) : text(text) {}
+
+    /**
+     * Kompiluje całe wyrażenie; zwraca false i opis błędu z pozycją znaku.
+     */
+    bool run(std::vector<Instruction> &code, std::vector<Channel> &channels, std::string &error) {
+        skipSpaces();
+        if (pos == text.size())
+            return fail("puste wyrażenie", error);
+        if (!expression() || !expectEnd())
+            return fail(message, error);
+        code = std::move(out);
+        channels = std::move(used);
+        return true;
+    }
+
+private:
+    bool fail(const std::string &what, std::string &error) {
+        error = what + " (znak " + std::to_string(pos + 1) + ")";
+        return false;
+    }
+
+    bool setError(const std::string &what) {
+        if (message.empty())
+            message = what;
+        return false;
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool expectEnd() {
+        skipSpaces();
+        return pos == text.size() || setError("nieoczekiwany znak '" + std::string(1, text[pos]) + "'");
+    }
+
+    bool expression() {
+        if (!term())
+            return false;
+        for (;;) {
+            if (accept('+')) {
+                if (!term() || !emit(Op::Add)) return false;
+            } else if (accept('-')) {
+                if (!term() || !emit(Op::Sub)) return false;
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool term() {
+        if (!factor())
+            return false;
+        for (;;) {
+            if (accept('*')) {
+                if (!factor() || !emit(Op::Mul)) return false;
+            } else if (accept('/')) {
+                if (!factor() || !emit(Op::Div)) return false;
+            } else {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Każde zagnieżdżenie (nawias, argument funkcji, '-' lub '^') przechodzi przez czynnik,
+     * więc tu ograniczana jest głębokość rekurencji — "((((..." nie przepełni stosu wywołań.
+     */
+    bool factor() {
+        if (nesting >= DerivedExpression::maxNestingDepth)
+            return setError("zbyt głębokie zagnieżdżenie wyrażenia");
+        ++nesting;
+        const bool ok = nestedFactor();
+        --nesting;
+        return ok;
+    }
+
+    bool nestedFactor() {
+        if (accept('-'))
+            return factor() && emit(Op::Neg);
+        if (!atom())
+            return false;
+        if (accept('^'))
+            return factor() && emit(Op::Pow);
+        return true;
+    }
+
+    bool atom() {
+        skipSpaces();
+        if (pos == text.size())
+            return setError("niekompletne wyrażenie");
+        if (accept('(')) {
+            if (!expression())
+                return false;
+            return accept(')') || setError("brak ')'");
+        }
+
+        const char c = text[pos];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+            return number();
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+            return name();
+        return setError("nieoczekiwany znak '" + std::string(1, c) + "'");
+    }
+
+    bool number() {
+        std::istringstream input(text.substr(pos));
+        input.imbue(std::locale::classic());
+        double value = 0.0;
+        input >> value;
+        if (input.fail() || !std::isfinite(value))
+            return setError("niepoprawna liczba");
+        pos = input.eof() ? text.size() : pos + static_cast<size_t>(input.tellg());
+        return push({Op::Constant, Channel::Count, static_cast<float>(value)});
+    }
+
+    bool name() {
+        const size_t begin = pos;
+        while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_'))
+            ++pos;
+        const std::string identifier = text.substr(begin, pos - begin);
+
+        static const struct { const char *name; Op op; int arity; } functions[] = {
+            {"abs", Op::Abs, 1}, {"sqrt", Op::Sqrt, 1}, {"min", Op::Min, 2}, {"max", Op::Max, 2},
+        };
+        for (const auto &function : functions) {
+            if (identifier != function.name)
+                continue;
+            if (!accept('('))
+                return setError("oczekiwano '(' po " + identifier);
+            for (int i = 0; i < function.arity; ++i) {
+                if (i > 0 && !accept(','))
+                    return setError(identifier + ": oczekiwano " + std::to_string(function.arity) + " argumentów");
+                if (!expression())
+                    return false;
+            }
+            return (accept(')') || setError("brak ')'")) && emit(function.op);
+        }
+
+        if (identifier == "setpoint")
+            return push({Op::Setpoint, Channel::Count, 0.0f});
+        Channel channel;
+        if (!channelFromName(identifier, channel))
+            return setError("nieznana nazwa '" + identifier + "'");
+        if (std::find(used.begin(), used.end(), channel) == used.end())
+            used.push_back(channel);
+        return push({Op::Load, channel, 0.0f});
+    }
+
+    bool push(const Instruction &instruction) {
+        out.push_back(instruction);
+        if (++depth > DerivedExpression::maxStackDepth)
+            return setError("zbyt złożone wyrażenie");
+        return true;
+    }
+
+    /**
+     * Dopisuje operację; jeśli wszystkie argumenty są stałymi, zastępuje je wynikiem.
+     */
+    bool emit(Op op) {
+        const size_t arity = isBinary(op) ? 2 : 1;
+        const bool constant = out.size() >= arity
+                              && std::all_of(out.end() - static_cast<std::ptrdiff_t>(arity), out.end(),
+                                             [](const Instruction &i) { return i.op == Op::Constant; });
+        if (constant) {
+            const float a = out[out.size() - arity].constant;
+            const float b = arity == 2 ? out.back().constant : 0.0f;
+            out.resize(out.size() - arity);
+            out.push_back({Op::Constant, Channel::Count, apply(op, a, b)});
+        } else {
+            out.push_back({op, Channel::Count, 0.0f});
+        }
+        depth -= static_cast<int>(arity) - 1;
+        return true;
+    }
+
+    const std::string &text;
+    size_t pos = 0;
+    int depth = 0;
+    int nesting = 0;
+    std::string message;
+    std::vector<Instruction> out;
+    std::vector<Channel> used;
+};
+
+} // namespace
+
+bool DerivedExpression::compile(const std::string &text, std::string &error) {
+    std::vector<Instruction> compiled;
+    std::vector<Channel> inputs;
+    if (!Compiler(text).run(compiled, inputs, error))
+        return false;
+    code = std::move(compiled);
+    channels = std::move(inputs);
+    source = text;
+    source.erase(0, source.find_first_not_of(" \t"));
+    source.erase(source.find_last_not_of(" \t") + 1);
+    return true;
+}
+
+/**
+ * Stos przechowuje bloki wartości; instrukcja Load kopiuje fragment kolumny, operacje działają
+ * na szczycie stosu w miejscu. Wybór instrukcji (switch) odbywa się raz na blok.
+ */
+void DerivedExpression::evaluate(const float *const columns[channelCount], size_t count, float setpoint,
+                                 float *out) const {
+    if (code.empty()) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    float stack[maxStackDepth][blockSize];
+    for (size_t offset = 0; offset < count; offset += blockSize) {
+        const size_t n = std::min(blockSize, count - offset);
+        int top = -1;
+        for (const Instruction &instruction : code) {
+            switch (instruction.op) {
+            case Op::Load:
+                ++top;
+                std::memcpy(stack[top], columns[static_cast<int>(instruction.channel)] + offset, n * sizeof(float));
+                break;
+            case Op::Setpoint:
+                ++top;
+                std::fill(stack[top], stack[top] + n, setpoint);
+                break;
+            case Op::Constant:
+                ++top;
+                std::fill(stack[top], stack[top] + n, instruction.constant);
+                break;
+            case Op::Add:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return a + b; }); --top; break;
+            case Op::Sub:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return a - b; }); --top; break;
+            case Op::Mul:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return a * b; }); --top; break;
+            case Op::Div:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return a / b; }); --top; break;
+            case Op::Pow:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return std::pow(a, b); }); --top; break;
+            case Op::Min:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return b < a ? b : a; }); --top; break;
+            case Op::Max:  binary(stack[top - 1], stack[top], n, [](float a, float b) { return a < b ? b : a; }); --top; break;
+            case Op::Neg:  unary(stack[top], n, [](float a) { return -a; }); break;
+            case Op::Abs:  unary(stack[top], n, [](float a) { return std::fabs(a); }); break;
+            case Op::Sqrt: unary(stack[top], n, [](float a) { return std::sqrt(a); }); break;
+            }
+        }
+        std::memcpy(out + offset, stack[0], n * sizeof(float));
+    }
+}
+
+/**
+ * Kopiowane są tylko kanały używane przez wyrażenie, blokami, aby kolumny mieściły się w pamięci podręcznej.
+ */
+void DerivedExpression::evaluate(const SerialData *samples, size_t count, float setpoint, float *out) const {
+    float buffers[channelCount][blockSize];
+    const float *columns[channelCount] = {};
+    for (Channel channel : channels)
+        columns[static_cast<int>(channel)] = buffers[static_cast<int>(channel)];
+
+    for (size_t offset = 0; offset < count; offset += blockSize) {
+        const size_t n = std::min(blockSize, count - offset);
+        for (Channel channel : channels)
+            gatherChannel(samples + offset, n, channel, buffers[static_cast<int>(channel)]);
+        evaluate(columns, n, setpoint, out + offset);
+    }
+}
+
+float DerivedExpression::evaluate(const SerialData &sample, float setpoint) const {
+    float value = 0.0f;
+    evaluate(&sample, 1, setpoint, &value);
+    return value;
+}
+
+/**
+ * Nazwa nie może przesłaniać kanału, funkcji ani zmiennej, aby definicje pozostały jednoznaczne.
+ */
+bool DerivedChannel::parse(const std::string &definition, std::string &error) {
+    const size_t separator = definition.find('=');
+    if (separator == std::string::npos) {
+        error = "oczekiwano <nazwa> = <wyrażenie>";
+        return false;
+    }
+
+    std::string identifier = definition.substr(0, separator);
+    identifier.erase(0, identifier.find_first_not_of(" \t"));
+    identifier.erase(identifier.find_last_not_of(" \t") + 1);
+    const bool valid = !identifier.empty()
+                       && !std::isdigit(static_cast<unsigned char>(identifier.front()))
+                       && std::all_of(identifier.begin(), identifier.end(), [](char c) {
+                              return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+                          });
+    Channel channel;
+    if (!valid || channelFromName(identifier, channel) || identifier == "setpoint" || identifier == "abs"
+        || identifier == "sqrt" || identifier == "min" || identifier == "max") {
+        error = "niepoprawna nazwa kanału pochodnego '" + identifier + "'";
+        return false;
+    }
+
+    DerivedExpression compiled;
+    if (!compiled.compile(definition.substr(separator + 1), error)) {
+        error = identifier + ": " + error;
+        return false;
+    }
+    name = identifier;
+    expression = std::move(compiled);
+    return true;
+}
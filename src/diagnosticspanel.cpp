@@ -0,0 +1,133 @@
+/**
+ * @file diagnosticspanel.cpp
+ * @brief Implementacja klasy DiagnosticsPanel.
+ */
+
+#include "../inc/diagnosticspanel.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+/// Okres odczytu dziennika [ms].
+constexpr int refreshIntervalMs = 250;
+/// Maksymalna liczba wierszy w podglądzie (starsze są usuwane).
+constexpr int maxViewLines = 5000;
+}
+
+/**
+ * Zakładka dziennika: pasek narzędzi (poziom, wstrzymanie, zapis), podgląd rekordów
+ * i tabela miejsc wywołania rozdzielone suwakiem.
+ */
+DiagnosticsPanel::DiagnosticsPanel(QWidget *parent)
+    : QDockWidget(tr("Diagnostyka"), parent), tabs(new QTabWidget(this)) {
+    setObjectName(QStringLiteral("diagnosticsPanel"));
+
+    auto *logPage = new QWidget;
+    auto *layout = new QVBoxLayout(logPage);
+    auto *toolbar = new QHBoxLayout;
+    levelFilter = new QComboBox(logPage);
+    for (LogLevel level : {LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error})
+        levelFilter->addItem(QString::fromLatin1(logLevelName(level)), static_cast<int>(level));
+    pauseBox = new QCheckBox(tr("Wstrzymaj"), logPage);
+    auto *saveButton = new QPushButton(tr("Zapisz..."), logPage);
+    toolbar->addWidget(levelFilter);
+    toolbar->addWidget(pauseBox);
+    toolbar->addStretch();
+    toolbar->addWidget(saveButton);
+    layout->addLayout(toolbar);
+
+    auto *splitter = new QSplitter(Qt::Vertical, logPage);
+    logView = new QPlainTextEdit(splitter);
+    logView->setReadOnly(true);
+    logView->setMaximumBlockCount(maxViewLines);
+    logView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    sitesTable = new QTableWidget(0, 5, splitter);
+    sitesTable->setHorizontalHeaderLabels({tr("Miejsce"), tr("Poziom"), tr("Zapisane"), tr("Pominięte"), tr("Komunikat")});
+    sitesTable->horizontalHeader()->setStretchLastSection(true);
+    sitesTable->verticalHeader()->setVisible(false);
+    sitesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(splitter);
+    tabs->addTab(logPage, tr("Dziennik"));
+    setWidget(tabs);
+
+    connect(saveButton, &QPushButton::clicked, this, &DiagnosticsPanel::saveLog);
+    refreshTimer.setInterval(refreshIntervalMs);
+    connect(&refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            refresh();
+            refreshTimer.start();
+        } else {
+            refreshTimer.stop();
+        }
+    });
+}
+
+void DiagnosticsPanel::addPage(QWidget *page, const QString &title) {
+    tabs->addTab(page, title);
+}
+
+/**
+ * Przy wstrzymaniu rekordy nie są odczytywane — po wznowieniu pojawią się, o ile nie zostały
+ * w międzyczasie nadpisane (wtedy wypisywana jest liczba utraconych rekordów).
+ */
+void DiagnosticsPanel::refresh() {
+    Log::flushSuppressed();
+    refreshSites();
+    if (pauseBox->isChecked())
+        return;
+
+    records.clear();
+    const uint64_t lost = Log::read(cursor, records);
+    if (lost > 0)
+        logView->appendPlainText(tr("… utracono %1 rekordów (nadpisane przed odczytem)").arg(lost));
+
+    const int minimum = levelFilter->currentData().toInt();
+    for (const LogRecord &record : records) {
+        if (static_cast<int>(record.site->level) >= minimum)
+            logView->appendPlainText(QString::fromStdString(Log::format(record)));
+    }
+}
+
+void DiagnosticsPanel::refreshSites() {
+    const std::vector<const LogSite *> sites = Log::sites();
+    sitesTable->setRowCount(static_cast<int>(sites.size()));
+    for (int row = 0; row < static_cast<int>(sites.size()); ++row) {
+        const LogSite *site = sites[static_cast<size_t>(row)];
+        const QString place = QStringLiteral("%1:%2").arg(QFileInfo(QString::fromUtf8(site->file)).fileName()).arg(site->line);
+        const quint64 suppressed = site->suppressedTotal.load(std::memory_order_relaxed)
+                                   + site->suppressed.load(std::memory_order_relaxed);
+        const QStringList cells = {place, QString::fromLatin1(logLevelName(site->level)),
+                                   QString::number(site->written.load(std::memory_order_relaxed)),
+                                   QString::number(suppressed), QString::fromUtf8(site->format)};
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = sitesTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                sitesTable->setItem(row, column, item);
+            }
+            item->setText(cells.at(column));
+        }
+    }
+}
+
+void DiagnosticsPanel::saveLog() {
+    const QString path = QFileDialog::getSaveFileName(this, tr("Zapisz dziennik"), QStringLiteral("wds_log.txt"),
+                                                      tr("Plik tekstowy (*.txt)"));
+    if (path.isEmpty())
+        return;
+    if (Log::dump(path.toStdString()))
+        LOG_INFO("Zapisano dziennik: {}", path.toUtf8());
+    else
+        LOG_ERROR("Nie udało się zapisać dziennika: {}", path.toUtf8());
+}
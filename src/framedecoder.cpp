@@ -0,0 +1,155 @@
+/**
+ * @file framedecoder.cpp
+ * @brief Implementacja klasy FrameDecoder.
+ *
+ * Format ramki telemetrii (32 bajty):
+ * - Start Byte (0xA5)
+ * - RPM (float), PWM (uint8), prąd, napięcie, moc, Kp, Ki, Kd (float)
+ * - tryb pracy (uint8)
+ * - Suma kontrolna (XOR bajtów 0-30)
+ *
+ * Ramka rozszerzona (36 bajtów) ma bajt startu 0xA6 i te same pola, po których następuje
+ * znacznik czasu urządzenia (uint32, µs, little-endian) w bajtach 31-34 i suma kontrolna
+ * (XOR bajtów 0-34). Oba rodzaje ramek mogą występować w jednym strumieniu, przeplatane
+ * z ramkami transferu blokowego 0xA7 (format: blocktransfer.cpp).
+ */
+
+#include "../inc/framedecoder.h"
+#include "../inc/logring.h"
+#include "../inc/trace.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+/**
+ * Funkcja dopisuje dane do bufora i dekoduje wszystkie pełne ramki, dopisując wyniki do wektora out.
+ * Bufor przeglądany jest indeksem, a przetworzone bajty usuwane są raz na porcję.
+ * Ramka z błędną sumą kontrolną odrzuca tylko swój bajt startu; poszukiwanie kolejnego startu
+ * zaczyna się od następnego bajtu. Bez synchronizacji ramka czeka na pierwszy bajt następnej
+ * ramki, który musi być bajtem startu (weryfikacja z wyprzedzeniem). W synchronizacji ramka
+ * z poprawną sumą jest przyjmowana bez tego sprawdzenia — uszkodzony start kolejnej ramki
+ * odrzuca tylko ją, a nie ramkę poprzednią.
+ * Długość ramki transferu blokowego odczytywana jest z jej nagłówka; niepoprawny nagłówek
+ * traktowany jest jak błąd sumy kontrolnej.
+ */
+int FrameDecoder::feed(const char *data, int size, QVector<SerialData> &out, std::vector<BlockFrame> *blocks) {
+    buffer.append(data, size);
+    const char *bytes = buffer.constData();
+    const int available = buffer.size();
+    int pos = 0;
+    int decoded = 0;
+
+    while (available - pos >= BlockTransfer::overhead) {
+        const char *start = std::find_if(bytes + pos, bytes + available, [](char byte) {
+            return isStartByte(static_cast<quint8>(byte));
+        });
+        const int skipped = static_cast<int>(start - (bytes + pos));
+        if (skipped > 0) {
+            counters.droppedBytes += static_cast<quint64>(skipped);
+            loseSync();
+            pos += skipped;
+        }
+        if (start == bytes + available)
+            break;
+
+        const bool block = static_cast<quint8>(bytes[pos]) == BlockTransfer::deviceStartByte;
+        const int length = block ? BlockTransfer::frameLength(bytes + pos, available - pos)
+                                 : frameSizeFor(static_cast<quint8>(bytes[pos]));
+        if (length == 0)
+            break;
+        const bool lookahead = !synced;
+        if (length > 0 && available - pos < length + (lookahead ? 1 : 0))
+            break;
+
+        SerialData sample;
+        BlockFrame frame;
+        const bool valid = length > 0 && (block ? BlockTransfer::parse(bytes + pos, length, frame)
+                                                : parseFrame(bytes + pos, length, sample));
+        if (!valid) {
+            ++counters.checksumErrors;
+            ++counters.droppedBytes;
+            loseSync();
+            ++pos;
+            continue;
+        }
+        if (lookahead && !isStartByte(static_cast<quint8>(bytes[pos + length]))) {
+            // Suma zgodna przypadkiem — po ramce znalezionej w trakcie wyszukiwania nie zaczyna się kolejna
+            ++counters.droppedBytes;
+            loseSync();
+            ++pos;
+            continue;
+        }
+
+        if (block) {
+            ++counters.blockFrames;
+            if (blocks)
+                blocks->push_back(std::move(frame));
+        } else {
+            out.append(sample);
+            ++counters.validFrames;
+            ++decoded;
+        }
+        synced = true;
+        pos += length;
+    }
+
+    buffer.remove(0, pos);
+    return decoded;
+}
+
+/**
+ * Komunikat zapisywany jest raz na utratę synchronizacji, a nie dla każdego odrzuconego bajtu.
+ */
+void FrameDecoder::loseSync() {
+    if (!synced)
+        return;
+    synced = false;
+    ++counters.resyncs;
+    LOG_WARNING("Utrata synchronizacji ramek (nr {}), wyszukiwanie kolejnego bajtu startu", counters.resyncs);
+}
+
+void FrameDecoder::reset() {
+    buffer.clear();
+    synced = false;
+}
+
+void FrameDecoder::resetStats() {
+    counters = DecoderStats();
+}
+
+/**
+ * Funkcja weryfikuje poprawność sumy kontrolnej (XOR) ramki oraz odczytuje z niej poszczególne pola:
+ * RPM, PWM, prąd, napięcie, moc, parametry PID, tryb pracy oraz — w ramce rozszerzonej —
+ * znacznik czasu urządzenia.
+ */
+bool FrameDecoder::parseFrame(const char *frame, int size, SerialData &data) {
+    TRACE_SCOPE("FrameDecoder::parseFrame");
+    if (size != frameSizeFor(static_cast<quint8>(frame[0])))
+        return false;
+
+    quint8 checksum = 0;
+    // Chechsum dla wszystkich oprócz ostatniego
+    for (int i = 0; i < size - 1; ++i) {
+        checksum ^= static_cast<quint8>(frame[i]);
+    }
+    // Sprawdzenie czy policzona suma zgadza się z otrzymaną sumą
+    if (checksum != static_cast<quint8>(frame[size - 1]))
+        return false;
+
+    // Parsowanie pól (zgodnie z kolejnością w buforze)
+    memcpy(&data.rpm, frame + 1, 4);
+    memcpy(&data.pwm, frame + 5, 1);
+    memcpy(&data.current, frame + 6, 4);
+    memcpy(&data.voltage, frame + 10, 4);
+    memcpy(&data.power, frame + 14, 4);
+    memcpy(&data.kp, frame + 18, 4);
+    memcpy(&data.ki, frame + 22, 4);
+    memcpy(&data.kd, frame + 26, 4);
+    memcpy(&data.mode, frame + 30, 1);
+
+    data.hasDeviceTime = size == extendedFrameSize;
+    if (data.hasDeviceTime)
+        data.deviceTimeUs = qFromLittleEndian<quint32>(frame + 31);
+
+    return true;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file gorilla.cpp
+ * @brief Implementacja kodowania Gorilla dla znaczników czasu i wartości float.
+ *
+ * Znaczniki czasu kodowane są jako różnica drugiego rzędu (delta-of-delta) z prefiksami:
+ * - '0'       -> dod = 0,
+ * - '10'      -> 7 bitów,
+ * - '110'     -> 9 bitów,
+ * - '1110'    -> 12 bitów,
+ * - '11110'   -> 32 bity,
+ * - '11111'   -> 64 bity.
+ *
+ * Wartości float kodowane są jako XOR z poprzednią wartością:
+ * - '0'  -> wartość bez zmian,
+ * - '10' -> znaczące bity mieszczą się w poprzednim oknie,
+ * - '11' -> nowe okno: 5 bitów zer wiodących, 5 bitów (długość - 1), znaczące bity.
+ */
+
+#include "../inc/gorilla.h"
+#include <cstring>
+
+namespace {
+
+/**
+ * Zwraca maskę z n najmłodszymi bitami ustawionymi na 1.
+ */
+inline uint64_t lowMask(int bits) {
+    return bits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+}
+
+/**
+ * Rozszerza znak liczby zapisanej na n bitach.
+ */
+inline int64_t signExtend(uint64_t value, int bits) {
+    if (bits >= 64)
+        return static_cast<int64_t>(value);
+    const uint64_t sign = uint64_t(1) << (bits - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+inline bool fits(int64_t value, int bits) {
+    const int64_t limit = int64_t(1) << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+} // namespace
+
+/**
+ * Bity są dopisywane od najstarszego; wartość może przekraczać granicę słowa 64-bitowego.
+ */
+void GorillaBitStream::write(uint64_t value, int count) {
+    if (count <= 0)
+        return;
+    value &= lowMask(count);
+
+    const int used = static_cast<int>(bits % 64);
+    if (used == 0)
+        words.push_back(0);
+
+    const int free = 64 - used;
+    if (count <= free) {
+        words.back() |= value << (free - count);
+    } else {
+        const int rest = count - free;
+        words.back() |= value >> rest;
+        words.push_back(value << (64 - rest));
+    }
+    bits += static_cast<uint64_t>(count);
+}
+
+void GorillaBitStream::clear() {
+    words.clear();
+    bits = 0;
+}
+
+/**
+ * Odczyt poza końcem strumienia zwraca zera.
+ */
+uint64_t GorillaBitReader::read(int count) {
+    if (count <= 0 || position >= stream.bits)
+        return 0;
+
+    const size_t index = static_cast<size_t>(position / 64);
+    const int used = static_cast<int>(position % 64);
+    const int available = 64 - used;
+    uint64_t value;
+
+    if (count <= available) {
+        value = (stream.words[index] >> (available - count)) & lowMask(count);
+    } else {
+        const int rest = count - available;
+        value = (stream.words[index] & lowMask(available)) << rest;
+        if (index + 1 < stream.words.size())
+            value |= stream.words[index + 1] >> (64 - rest);
+    }
+    position += static_cast<uint64_t>(count);
+    return value;
+}
+
+/**
+ * Pierwszy znacznik zapisywany jest w całości (64 bity), kolejne jako delta-of-delta.
+ */
+void GorillaTimestampEncoder::append(int64_t timestamp) {
+    if (count == 0) {
+        out.write(static_cast<uint64_t>(timestamp), 64);
+    } else {
+        const int64_t delta = timestamp - previous;
+        const int64_t dod = delta - previousDelta;
+
+        if (dod == 0) {
+            out.write(0b0, 1);
+        } else if (fits(dod, 7)) {
+            out.write(0b10, 2);
+            out.write(static_cast<uint64_t>(dod), 7);
+        } else if (fits(dod, 9)) {
+            out.write(0b110, 3);
+            out.write(static_cast<uint64_t>(dod), 9);
+        } else if (fits(dod, 12)) {
+            out.write(0b1110, 4);
+            out.write(static_cast<uint64_t>(dod), 12);
+        } else if (fits(dod, 32)) {
+            out.write(0b11110, 5);
+            out.write(static_cast<uint64_t>(dod), 32);
+        } else {
+            out.write(0b11111, 5);
+            out.write(static_cast<uint64_t>(dod), 64);
+        }
+        previousDelta = delta;
+    }
+    previous = timestamp;
+    ++count;
+}
+
+int64_t GorillaTimestampDecoder::next() {
+    if (count == 0) {
+        previous = static_cast<int64_t>(reader.read(64));
+    } else {
+        int64_t dod = 0;
+        if (reader.readBit()) {
+            int bits;
+            if (!reader.readBit())      bits = 7;
+            else if (!reader.readBit()) bits = 9;
+            else if (!reader.readBit()) bits = 12;
+            else if (!reader.readBit()) bits = 32;
+            else                        bits = 64;
+            dod = signExtend(reader.read(bits), bits);
+        }
+        previousDelta += dod;
+        previous += previousDelta;
+    }
+    ++count;
+    return previous;
+}
+
+/**
+ * Pierwsza wartość zapisywana jest w całości (32 bity), kolejne jako XOR z poprzednią.
+ */
+void GorillaFloatEncoder::append(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    if (count == 0) {
+        out.write(bits, 32);
+    } else {
+        const uint32_t x = bits ^ previous;
+        if (x == 0) {
+            out.write(0b0, 1);
+        } else {
+            int leading = __builtin_clz(x);
+            const int trailing = __builtin_ctz(x);
+            if (leading > 31)
+                leading = 31;
+
+            if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+                const int meaningful = 32 - previousLeading - previousTrailing;
+                out.write(0b10, 2);
+                out.write(x >> previousTrailing, meaningful);
+            } else {
+                const int meaningful = 32 - leading - trailing;
+                out.write(0b11, 2);
+                out.write(static_cast<uint64_t>(leading), 5);
+                out.write(static_cast<uint64_t>(meaningful - 1), 5);
+                out.write(x >> trailing, meaningful);
+                previousLeading = leading;
+                previousTrailing = trailing;
+            }
+        }
+    }
+    previous = bits;
+    ++count;
+}
+
+float GorillaFloatDecoder::next() {
+    if (count == 0) {
+        previous = static_cast<uint32_t>(reader.read(32));
+    } else if (reader.readBit()) {
+        if (reader.readBit()) {
+            leading = static_cast<int>(reader.read(5));
+            const int meaningful = static_cast<int>(reader.read(5)) + 1;
+            trailing = 32 - leading - meaningful;
+        }
+        const int meaningful = 32 - leading - trailing;
+        previous ^= static_cast<uint32_t>(reader.read(meaningful)) << trailing;
+    }
+    ++count;
+
+    float value;
+    std::memcpy(&value, &previous, sizeof(value));
+    return value;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file headless.cpp
+ * @brief Implementacja trybu pracy bez interfejsu graficznego.
+ *
+ * Na Linuksie port otwierany jest przez transport POSIX, aby polecenia profilu były
+ * zapisywane do portu bezpośrednio z wątku profilu, bez pośrednictwa pętli zdarzeń.
+ */
+
+#include "../inc/headless.h"
+#include "../inc/profilerunner.h"
+#include "../inc/serialreader.h"
+#include "../inc/sessionanalysis.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <thread>
+
+/**
+ * Odłączenie urządzenia przerywa profil (kod wyjścia 1). Podsumowanie jittera wypisywane jest zawsze.
+ */
+int runHeadlessProfile(const QString &portName, int baudRate, const QString &profilePath, const QString &logPath) {
+    SetpointProfile profile;
+    std::string error;
+    if (!profile.load(profilePath.toStdString(), error)) {
+        qCritical() << "Błąd profilu nastaw:" << QString::fromStdString(error);
+        return 1;
+    }
+
+    SerialReader reader;
+    QObject::connect(&reader, &SerialReader::errorOccurred, [](const QString &message) { qWarning() << message; });
+    if (PosixSerialTransport::isSupported())
+        reader.setBackend(SerialBackend::Posix);
+    reader.start(portName, baudRate);
+    if (!reader.isOpen())
+        return 1;
+
+    ProfileRunner runner;
+    QObject::connect(&reader, &SerialReader::portDisconnected, [&runner]() { runner.stop(); });
+
+    qInfo() << "Start profilu" << profilePath << "poleceń:" << profile.steps().size()
+            << "czas:" << profile.durationUs() / 1e6 << "s";
+    runner.start(
+        profile,
+        [&reader](const ProfileStep &step, ProfileRunner::WrittenCallback onWritten) {
+            reader.postCommand(static_cast<DataType>(step.type), step.value, std::move(onWritten));
+        },
+        [](bool completed) {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [completed]() {
+                QCoreApplication::exit(completed ? 0 : 1);
+            }, Qt::QueuedConnection);
+        });
+
+    const int result = QCoreApplication::exec();
+    runner.stop();
+    reader.stop();
+
+    qInfo().noquote() << QString::fromStdString(runner.jitterSummary());
+    if (!logPath.isEmpty() && !runner.writeLog(logPath.toStdString()))
+        qWarning() << "Nie udało się zapisać dziennika:" << logPath;
+    return result;
+}
+
+/**
+ * Tabela wypisywana jest jednym komunikatem, więc nie podlega limitowi dziennika dla
+ * kolejnych wierszy. Przepustowość liczona jest z łącznego rozmiaru plików i czasu całej analizy.
+ */
+int runBatchAnalysis(const QString &path, const QString &csvPath, int jobs) {
+    QStringList paths;
+    const QFileInfo info(path);
+    if (info.isDir()) {
+        const QDir dir(path);
+        for (const QString &name : dir.entryList({"*.wds", "*.bin", "*.raw"}, QDir::Files, QDir::Name))
+            paths << dir.filePath(name);
+    } else if (info.isFile()) {
+        paths << path;
+    }
+    if (paths.isEmpty()) {
+        qCritical() << "Brak nagrań do analizy:" << path;
+        return 2;
+    }
+
+    if (jobs <= 0)
+        jobs = static_cast<int>(qMax(1u, std::thread::hardware_concurrency()));
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<SessionKpi> kpis = analyzeSessions(paths, jobs);
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    qint64 bytes = 0;
+    bool ok = true;
+    for (const SessionKpi &kpi : kpis) {
+        bytes += kpi.bytes;
+        ok = ok && kpi.ok();
+    }
+    qInfo().noquote() << formatKpiTable(kpis);
+    qInfo() << "Przeanalizowano" << kpis.size() << "plików," << bytes / 1e6 << "MB w" << seconds << "s ("
+            << (seconds > 0.0 ? bytes / 1e6 / seconds : 0.0) << "MB/s, wątków:" << qMin(jobs, static_cast<int>(paths.size()))
+            << ")";
+
+    if (!csvPath.isEmpty() && !writeKpiCsv(csvPath, kpis)) {
+        qWarning() << "Nie udało się zapisać wskaźników:" << csvPath;
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
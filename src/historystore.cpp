@@ -0,0 +1,258 @@
+/**
+ * @file historystore.cpp
+ * @brief Implementacja klasy HistoryStore.
+ *
+ * Nowe próbki trafiają do nieskompresowanego ogona. Po zapełnieniu ogona (blockSize próbek)
+ * jest on kompresowany do bloku: czas metodą delta-of-delta, każdy kanał metodą XOR (Gorilla).
+ * Odczyt dekoduje wyłącznie bloki nachodzące na żądany przedział czasu. W trybie
+ * HistoryEncoding::Quantized kanały bloku zapisywane są przez QuantizedColumn, a odczyt
+ * kanału bloku to jedna zwektoryzowana pętla zamiast dekodowania bit po bicie.
+ * Bloki przechowywane są w std::deque, więc usuwanie najstarszych przez retencję nie
+ * przesuwa pozostałych.
+ */
+
+#include "../inc/historystore.h"
+#include <algorithm>
+#include <utility>
+
+/**
+ * Rozmiar bloku jest ograniczony od dołu, aby narzut nagłówka bloku był pomijalny.
+ */
+HistoryStore::HistoryStore(int blockSize, HistoryEncoding encoding)
+    : blockSize(qMax(16, blockSize)), mode(encoding) {
+    tail.reserve(this->blockSize);
+}
+
+/**
+ * Po zapełnieniu ogona jest on kompresowany do nowego bloku.
+ */
+void HistoryStore::append(qint64 timeUs, const SerialData &data) {
+    tail.append({timeUs, data});
+    if (tail.size() >= blockSize)
+        sealTail();
+}
+
+void HistoryStore::setRetention(qint64 maxAgeUs, qint64 maxBytes) {
+    retentionUs = qMax<qint64>(0, maxAgeUs);
+    retentionBytes = qMax<qint64>(0, maxBytes);
+    evictBlocks();
+}
+
+void HistoryStore::clear() {
+    blocks.clear();
+    tail.clear();
+    sealedSamples = 0;
+    sealedBytes = 0;
+    evicted = 0;
+    quantizationError.fill(0.0f);
+}
+
+qint64 HistoryStore::sampleCount() const {
+    return sealedSamples + tail.size();
+}
+
+/**
+ * Każdy kanał kodowany jest niezależnym strumieniem (lub kolumną), co pozwala dekodować
+ * pojedyncze kanały. Rozmiar bloku obejmuje nagłówek, koder kanałów tylko jego sposobu
+ * zapisu i zakodowane dane.
+ */
+void HistoryStore::sealTail() {
+    if (tail.isEmpty())
+        return;
+
+    Block block;
+    block.firstUs = tail.first().timeUs;
+    block.lastUs = tail.last().timeUs;
+    block.count = tail.size();
+
+    for (const HistorySample &sample : std::as_const(tail))
+        block.time.append(sample.timeUs);
+    qint64 bytes = static_cast<qint64>(block.time.stream().byteCount()) + static_cast<qint64>(sizeof(Block));
+    block.time.stream().shrink();
+
+    if (mode == HistoryEncoding::Quantized) {
+        QuantizedChannels &columns = block.channels.emplace<QuantizedChannels>(channelCount);
+        bytes += static_cast<qint64>(sizeof(QuantizedColumn) * channelCount);
+        std::vector<float> column(static_cast<size_t>(block.count));
+        for (int c = 0; c < channelCount; ++c) {
+            for (int i = 0; i < block.count; ++i)
+                column[i] = channelValue(tail[i].data, static_cast<Channel>(c));
+            QuantizedColumn &quantized = columns[c];
+            quantized.encode(column.data(), column.size(), resolution[c]);
+            quantized.shrink();
+            bytes += static_cast<qint64>(quantized.byteCount());
+            quantizationError[c] = qMax(quantizationError[c], quantized.maxError());
+        }
+    } else {
+        GorillaChannels &channels = block.channels.emplace<GorillaChannels>(channelCount);
+        bytes += static_cast<qint64>(sizeof(GorillaFloatEncoder) * channelCount);
+        for (const HistorySample &sample : std::as_const(tail)) {
+            for (int c = 0; c < channelCount; ++c)
+                channels[c].append(channelValue(sample.data, static_cast<Channel>(c)));
+        }
+        for (GorillaFloatEncoder &channel : channels) {
+            bytes += static_cast<qint64>(channel.stream().byteCount());
+            channel.stream().shrink();
+        }
+    }
+
+    block.bytes = bytes;
+    sealedSamples += block.count;
+    sealedBytes += bytes;
+    blocks.push_back(std::move(block));
+    tail.clear();
+    evictBlocks();
+}
+
+/**
+ * Wiek bloku liczony jest od jego ostatniej próbki, więc blok jest usuwany dopiero wtedy,
+ * gdy cały wypadł poza okno retencji.
+ */
+void HistoryStore::evictBlocks() {
+    while (blocks.size() > 1) {
+        const Block &oldest = blocks.front();
+        const bool tooOld = retentionUs > 0 && blocks.back().lastUs - oldest.lastUs > retentionUs;
+        const bool tooLarge = retentionBytes > 0 && sealedBytes > retentionBytes;
+        if (!tooOld && !tooLarge)
+            return;
+        sealedSamples -= oldest.count;
+        sealedBytes -= oldest.bytes;
+        evicted += oldest.count;
+        blocks.pop_front();
+    }
+}
+
+/**
+ * Bloki są przeszukiwane binarnie po czasie ostatniej próbki;
+ * dekodowany jest tylko strumień czasu i strumień wybranego kanału.
+ */
+QVector<QPointF> HistoryStore::channelPoints(Channel channel, qint64 fromUs, qint64 toUs) const {
+    QVector<QPointF> points;
+    const int c = static_cast<int>(channel);
+    std::vector<float> values;
+
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), fromUs,
+                               [](const Block &b, qint64 t) { return b.lastUs < t; });
+    for (; it != blocks.end() && it->firstUs <= toUs; ++it) {
+        GorillaTimestampDecoder time(it->time.stream());
+        decodeChannel(*it, c, values);
+        for (int i = 0; i < it->count; ++i) {
+            const qint64 t = time.next();
+            if (t >= fromUs && t <= toUs)
+                points.append(QPointF(t / 1e6, values[i]));
+        }
+    }
+
+    for (const HistorySample &sample : tail) {
+        if (sample.timeUs >= fromUs && sample.timeUs <= toUs)
+            points.append(QPointF(sample.timeUs / 1e6, channelValue(sample.data, channel)));
+    }
+    return points;
+}
+
+/**
+ * Jak channelPoints(), ale dla kilku kanałów naraz — strumienie wybranych kanałów dekodowane są
+ * równolegle z czasem, a wartości trafiają do osobnych kolumn (np. dla DerivedExpression).
+ */
+void HistoryStore::channelColumns(const std::vector<Channel> &selected, qint64 fromUs, qint64 toUs,
+                                  std::vector<qint64> &timesUs,
+                                  std::array<std::vector<float>, channelCount> &columns) const {
+    timesUs.clear();
+    for (std::vector<float> &column : columns)
+        column.clear();
+
+    std::vector<std::vector<float>> values(selected.size());
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), fromUs,
+                               [](const Block &b, qint64 t) { return b.lastUs < t; });
+    for (; it != blocks.end() && it->firstUs <= toUs; ++it) {
+        GorillaTimestampDecoder time(it->time.stream());
+        for (size_t k = 0; k < selected.size(); ++k)
+            decodeChannel(*it, static_cast<int>(selected[k]), values[k]);
+        for (int i = 0; i < it->count; ++i) {
+            const qint64 t = time.next();
+            if (t < fromUs || t > toUs)
+                continue;
+            timesUs.push_back(t);
+            for (size_t k = 0; k < selected.size(); ++k)
+                columns[static_cast<int>(selected[k])].push_back(values[k][i]);
+        }
+    }
+
+    for (const HistorySample &sample : tail) {
+        if (sample.timeUs < fromUs || sample.timeUs > toUs)
+            continue;
+        timesUs.push_back(sample.timeUs);
+        for (Channel channel : selected)
+            columns[static_cast<int>(channel)].push_back(channelValue(sample.data, channel));
+    }
+}
+
+QVector<HistorySample> HistoryStore::samples(qint64 fromUs, qint64 toUs) const {
+    QVector<HistorySample> out;
+
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), fromUs,
+                               [](const Block &b, qint64 t) { return b.lastUs < t; });
+    for (; it != blocks.end() && it->firstUs <= toUs; ++it)
+        decodeBlock(*it, fromUs, toUs, out);
+
+    for (const HistorySample &sample : tail) {
+        if (sample.timeUs >= fromUs && sample.timeUs <= toUs)
+            out.append(sample);
+    }
+    return out;
+}
+
+/**
+ * Kanały bloku dekodowane są kolumnami, a próbki składane z kolumn.
+ */
+void HistoryStore::decodeBlock(const Block &block, qint64 fromUs, qint64 toUs, QVector<HistorySample> &out) const {
+    GorillaTimestampDecoder time(block.time.stream());
+    std::array<std::vector<float>, channelCount> values;
+    for (int c = 0; c < channelCount; ++c)
+        decodeChannel(block, c, values[c]);
+
+    for (int i = 0; i < block.count; ++i) {
+        HistorySample sample;
+        sample.timeUs = time.next();
+        for (int c = 0; c < channelCount; ++c)
+            setChannelValue(sample.data, static_cast<Channel>(c), values[c][i]);
+        if (sample.timeUs >= fromUs && sample.timeUs <= toUs)
+            out.append(sample);
+    }
+}
+
+void HistoryStore::decodeChannel(const Block &block, int channel, std::vector<float> &out) {
+    out.resize(static_cast<size_t>(block.count));
+    if (const QuantizedChannels *quantized = std::get_if<QuantizedChannels>(&block.channels)) {
+        (*quantized)[channel].decode(out.data());
+        return;
+    }
+    GorillaFloatDecoder values(std::get<GorillaChannels>(block.channels)[channel].stream());
+    for (float &value : out)
+        value = values.next();
+}
+
+qint64 HistoryStore::compressedBytes() const {
+    return sealedBytes;
+}
+
+double HistoryStore::bytesPerSample() const {
+    return sealedSamples > 0 ? static_cast<double>(sealedBytes) / sealedSamples : 0.0;
+}
+
+const char *HistoryStore::encodingName(HistoryEncoding encoding) {
+    switch (encoding) {
+    case HistoryEncoding::Quantized: return "quantized";
+    default:                         return "gorilla";
+    }
+}
+
+bool HistoryStore::parseEncoding(const std::string &name, HistoryEncoding &encoding) {
+    for (HistoryEncoding candidate : {HistoryEncoding::Gorilla, HistoryEncoding::Quantized}) {
+        if (name == encodingName(candidate)) {
+            encoding = candidate;
+            return true;
+        }
+    }
+    return false;
+}
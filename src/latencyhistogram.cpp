@@ -0,0 +1,73 @@
+/**
+ * @file latencyhistogram.cpp
+ * @brief Implementacja klasy LatencyHistogram.
+ *
+ * Czasy 0-3 ns trafiają do kubełków liniowych, większe do kubełka wyznaczonego przez
+ * pozycję najstarszego bitu i dwa kolejne bity (4 podkubełki na oktawę).
+ */
+
+#include "../inc/latencyhistogram.h"
+
+void LatencyHistogram::record(int64_t ns) {
+    if (ns < 0)
+        ns = 0;
+    buckets[bucketIndex(static_cast<uint64_t>(ns))].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+
+    int64_t previous = maximum.load(std::memory_order_relaxed);
+    while (ns > previous && !maximum.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::meanNs() const {
+    const uint64_t n = count();
+    return n > 0 ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+/**
+ * Percentyl wyznaczany jest z sumy skumulowanej kubełków; wynik to górna granica kubełka,
+ * ograniczona od góry przez największy zarejestrowany czas.
+ */
+int64_t LatencyHistogram::percentileNs(double percentile) const {
+    const uint64_t n = count();
+    if (n == 0)
+        return 0;
+
+    const double target = percentile / 100.0 * static_cast<double>(n);
+    uint64_t cumulative = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        if (static_cast<double>(cumulative) >= target && cumulative > 0) {
+            const int64_t bound = bucketUpperBound(i);
+            return bound < maxNs() ? bound : maxNs();
+        }
+    }
+    return maxNs();
+}
+
+void LatencyHistogram::reset() {
+    for (auto &bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < subBuckets)
+        return static_cast<int>(ns);
+    const int msb = 63 - __builtin_clzll(ns);
+    const int sub = static_cast<int>((ns >> (msb - 2)) & (subBuckets - 1));
+    return (msb - 1) * subBuckets + sub;
+}
+
+int64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < subBuckets)
+        return index;
+    const int msb = index / subBuckets + 1;
+    const int sub = index % subBuckets;
+    if (msb >= 62)
+        return INT64_MAX;
+    return static_cast<int64_t>(((uint64_t(subBuckets) + sub + 1) << (msb - 2)) - 1);
+}
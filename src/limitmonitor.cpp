@@ -0,0 +1,264 @@
+/**
+ * @file limitmonitor.cpp
+ * @brief Implementacja reguł alarmowych i klasy LimitMonitor.
+ *
+ * Sprawdzenie partii to jedna pętla po próbkach i regułach bez alokacji (poza rozpoczęciem
+ * rekordu alarmu), dzięki czemu może być wykonywane w wątku odbioru dla każdej ramki.
+ * Liczby czytane i zapisywane są w locale "C" niezależnie od ustawień systemu.
+ */
+
+#include "../inc/limitmonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <locale>
+#include <sstream>
+
+namespace {
+/// Maksymalna liczba ukończonych rekordów oczekujących na odbiór (starsze są odrzucane).
+constexpr size_t maxCompleted = 32;
+
+/**
+ * Czyta liczbę w locale "C"; cały tekst musi być liczbą.
+ */
+bool toNumber(const std::string &text, double &value) {
+    std::istringstream input(text);
+    input.imbue(std::locale::classic());
+    input >> value;
+    return !input.fail() && input.eof() && std::isfinite(value);
+}
+}
+
+/**
+ * Spacje są pomijane; opis znormalizowany zawiera warunek i flagi w stałej kolejności.
+ */
+bool LimitRule::parse(const std::string &spec, std::string &error) {
+    std::string compact = spec;
+    compact.erase(std::remove_if(compact.begin(), compact.end(), [](char c) { return c == ' ' || c == '\t'; }),
+                  compact.end());
+
+    std::vector<std::string> fields;
+    std::istringstream input(compact);
+    for (std::string field; std::getline(input, field, ':');)
+        fields.push_back(field);
+    if (fields.empty() || fields.front().empty()) {
+        error = "pusta reguła";
+        return false;
+    }
+
+    LimitRule rule;
+    std::string condition = fields.front();
+    const bool rate = condition.rfind("d(", 0) == 0;
+    const size_t op = condition.find_first_of("<>", rate ? condition.find(')') : 0);
+    if (op == std::string::npos || (rate && condition.find(')') == std::string::npos)) {
+        error = "oczekiwano <kanał>><wartość>, <kanał><<wartość> lub d(<kanał>)><wartość>: '" + spec + "'";
+        return false;
+    }
+
+    const std::string name = rate ? condition.substr(2, condition.find(')') - 2) : condition.substr(0, op);
+    if (!channelFromName(name, rule.channel)) {
+        error = "nieznany kanał '" + name + "'";
+        return false;
+    }
+    if (rate && condition[op] != '>') {
+        error = "szybkość zmian obsługuje tylko próg górny (d(<kanał>)><wartość>)";
+        return false;
+    }
+    rule.kind = rate ? Kind::RateAbove : (condition[op] == '>' ? Kind::Above : Kind::Below);
+
+    double threshold = 0.0;
+    if (!toNumber(condition.substr(op + 1), threshold)) {
+        error = "niepoprawny próg w '" + spec + "'";
+        return false;
+    }
+    rule.threshold = static_cast<float>(threshold);
+
+    for (size_t i = 1; i < fields.size(); ++i) {
+        double hold = 0.0;
+        if (fields[i] == "stop") {
+            rule.emergencyStop = true;
+        } else if (fields[i].rfind("n=", 0) == 0 && toNumber(fields[i].substr(2), hold) && hold >= 1 && hold <= 1000) {
+            rule.holdSamples = static_cast<int>(hold);
+        } else {
+            error = "nieznana flaga '" + fields[i] + "' (dozwolone: stop, n=<N>)";
+            return false;
+        }
+    }
+
+    rule.text = condition;
+    if (rule.emergencyStop)
+        rule.text += ":stop";
+    if (rule.holdSamples > 1)
+        rule.text += ":n=" + std::to_string(rule.holdSamples);
+    *this = rule;
+    return true;
+}
+
+/**
+ * Czasy zdarzenia zapisywane są jako komentarze, a próbki — jako kolumny w kolejności kanałów,
+ * z czasem względem próbki wyzwalającej.
+ */
+bool AlarmRecord::writeCsv(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out.imbue(std::locale::classic());
+
+    out << "# rule," << rule << '\n'
+        << "# value," << value << '\n'
+        << "# emergency_stop," << (emergencyStop ? 1 : 0) << '\n';
+    if (detectedNs > 0)
+        out << "# arrival_to_detect_us," << static_cast<double>(detectedNs - arrivalNs) / 1000.0 << '\n';
+    if (commandNs > 0) {
+        out << "# detect_to_command_us," << static_cast<double>(commandNs - detectedNs) / 1000.0 << '\n'
+            << "# arrival_to_command_us," << static_cast<double>(commandNs - arrivalNs) / 1000.0 << '\n';
+    }
+
+    out << "t_us";
+    for (int c = 0; c < channelCount; ++c)
+        out << ',' << channelName(static_cast<Channel>(c));
+    out << '\n';
+    for (const SerialData &sample : samples) {
+        out << sample.timeUs - sampleTimeUs;
+        for (int c = 0; c < channelCount; ++c)
+            out << ',' << channelValue(sample, static_cast<Channel>(c));
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+LimitMonitor::LimitMonitor(size_t preSamples, size_t postSamples)
+    : preSamples(preSamples), postSamples(postSamples) {}
+
+bool LimitMonitor::setRules(const std::vector<std::string> &specs, std::string &error) {
+    std::vector<LimitRule> parsed;
+    for (const std::string &spec : specs) {
+        LimitRule rule;
+        if (!rule.parse(spec, error))
+            return false;
+        parsed.push_back(rule);
+    }
+    limits = std::move(parsed);
+    states.assign(limits.size(), RuleState());
+    return true;
+}
+
+/**
+ * Szybkość zmian liczona jest z dwóch kolejnych próbek i ich czasów SerialData::timeUs.
+ */
+bool LimitMonitor::evaluate(const LimitRule &rule, RuleState &state, const SerialData &sample, float &value) const {
+    const float current = channelValue(sample, rule.channel);
+    switch (rule.kind) {
+    case LimitRule::Kind::Above:
+        value = current;
+        return current > rule.threshold;
+    case LimitRule::Kind::Below:
+        value = current;
+        return current < rule.threshold;
+    case LimitRule::Kind::RateAbove:
+        break;
+    }
+
+    if (!state.hasPrevious) {
+        state.previous = current;
+        state.previousUs = sample.timeUs;
+        state.hasPrevious = true;
+        return false;
+    }
+    value = (current - state.previous) * 1e6f / static_cast<float>(sample.timeUs - state.previousUs);
+    state.previous = current;
+    state.previousUs = sample.timeUs;
+    return std::fabs(value) > rule.threshold;
+}
+
+/**
+ * Każda próbka trafia najpierw do rekordów zbierających próbki po wcześniejszych zdarzeniach,
+ * potem do historii, a następnie sprawdzane są reguły. Nowy rekord zawiera historię
+ * (z próbką wyzwalającą na końcu). Dla reguł szybkości zmian próbki o tym samym czasie
+ * (jedna porcja bez znaczników urządzenia) są pomijane.
+ */
+size_t LimitMonitor::check(const SerialData *samples, size_t count, int64_t arrivalNs, std::vector<LimitEvent> &events) {
+    events.clear();
+    size_t finished = 0;
+    for (Pending &p : pending)
+        p.fresh = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        const SerialData &sample = samples[i];
+        for (Pending &p : pending) {
+            if (p.remaining > 0) {
+                p.record.samples.push_back(sample);
+                --p.remaining;
+            }
+        }
+        recent.push_back(sample);
+        if (recent.size() > preSamples + 1)
+            recent.pop_front();
+
+        for (size_t r = 0; r < limits.size(); ++r) {
+            const LimitRule &rule = limits[r];
+            RuleState &state = states[r];
+            if (rule.kind == LimitRule::Kind::RateAbove && state.hasPrevious && sample.timeUs <= state.previousUs)
+                continue;
+            float value = 0.0f;
+            if (!evaluate(rule, state, sample, value)) {
+                state.hits = 0;
+                state.fired = false;
+                continue;
+            }
+            if (state.fired || ++state.hits < rule.holdSamples)
+                continue;
+            state.fired = true;
+            events.push_back({r, i, value, rule.emergencyStop});
+
+            Pending p;
+            p.record.rule = rule.text;
+            p.record.value = value;
+            p.record.emergencyStop = rule.emergencyStop;
+            p.record.sampleTimeUs = sample.timeUs;
+            p.record.arrivalNs = arrivalNs;
+            p.record.samples.reserve(recent.size() + postSamples);
+            p.record.samples.assign(recent.begin(), recent.end());
+            p.record.triggerIndex = recent.size() - 1;
+            p.remaining = postSamples;
+            pending.push_back(std::move(p));
+        }
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->remaining > 0 || it->fresh) {
+            ++it;
+            continue;
+        }
+        completed.push_back(std::move(it->record));
+        if (completed.size() > maxCompleted)
+            completed.pop_front();
+        it = pending.erase(it);
+        ++finished;
+    }
+    return finished;
+}
+
+void LimitMonitor::markReaction(int64_t detectedNs, int64_t commandNs) {
+    for (Pending &p : pending) {
+        if (!p.fresh)
+            continue;
+        p.record.detectedNs = detectedNs;
+        p.record.commandNs = p.record.emergencyStop ? commandNs : 0;
+    }
+}
+
+bool LimitMonitor::takeCompleted(AlarmRecord &record) {
+    if (completed.empty())
+        return false;
+    record = std::move(completed.front());
+    completed.pop_front();
+    return true;
+}
+
+void LimitMonitor::reset() {
+    states.assign(limits.size(), RuleState());
+    recent.clear();
+    pending.clear();
+}
@@ -0,0 +1,314 @@
+/**
+ * @file logring.cpp
+ * @brief Implementacja dziennika w pamięci.
+ *
+ * Bufor to tablica capacity gniazd (numer sekwencji + rekord) zaalokowana przy starcie.
+ * Piszący rezerwuje numer rekordu licznikiem atomowym, oznacza gniazdo jako zapisywane
+ * (nieparzysty numer sekwencji), wypełnia rekord i publikuje go (numer parzysty).
+ * Czytający kopiuje rekord i odrzuca go, jeśli numer sekwencji zmienił się w trakcie kopiowania.
+ */
+
+#include "../inc/logring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <locale>
+#include <memory>
+#include <sstream>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+namespace {
+
+/// Długość okna limitu komunikatów [ns].
+constexpr int64_t rateWindowNs = 1000000000;
+/// Maska indeksu gniazda.
+constexpr uint64_t slotMask = Log::capacity - 1;
+static_assert((Log::capacity & slotMask) == 0, "Pojemność dziennika musi być potęgą dwójki");
+
+struct Slot {
+    std::atomic<uint64_t> sequence{0}; ///< 2n+1 = rekord n w trakcie zapisu, 2n+2 = rekord n gotowy.
+    LogRecord record;
+};
+
+const std::unique_ptr<Slot[]> slots(new Slot[Log::capacity]);
+std::atomic<uint64_t> head{0};
+std::atomic<uint32_t> rateLimit{20};
+std::atomic<LogSite *> siteList{nullptr};
+std::atomic<uint16_t> nextThreadId{1};
+const int64_t processStartNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch()).count();
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Zegar do okien limitu: wystarczy rozdzielczość rzędu milisekund, a na Linuksie
+ * CLOCK_MONOTONIC_COARSE jest kilkukrotnie tańszy od zegara pełnej rozdzielczości.
+ */
+int64_t coarseNowNs() {
+#ifdef __linux__
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+    return nowNs();
+#endif
+}
+
+uint16_t threadId() {
+    thread_local const uint16_t id = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+/**
+ * Dopisuje miejsce do listy przy pierwszym komunikacie (lista tylko rośnie).
+ */
+void registerSite(LogSite &site) {
+    if (site.registered.load(std::memory_order_relaxed) || site.registered.exchange(true))
+        return;
+    LogSite *first = siteList.load(std::memory_order_relaxed);
+    do {
+        site.next = first;
+    } while (!siteList.compare_exchange_weak(first, &site, std::memory_order_release, std::memory_order_relaxed));
+}
+
+/**
+ * Rezerwuje kolejny rekord i oznacza jego gniazdo jako zapisywane.
+ */
+LogRecord *reserve() {
+    const uint64_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[ticket & slotMask];
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return &slot.record;
+}
+
+const char *baseName(const char *path) {
+    const char *name = path;
+    for (const char *c = path; *c; ++c) {
+        if (*c == '/' || *c == '\\')
+            name = c + 1;
+    }
+    return name;
+}
+
+} // namespace
+
+std::atomic<uint8_t> Log::minimumLevel{static_cast<uint8_t>(LogLevel::Debug)};
+
+const char *logLevelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warning: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    case LogLevel::Off: break;
+    }
+    return "-";
+}
+
+void LogRecord::add(const char *value, size_t length) {
+    if (argCount >= maxArgs || textUsed >= textSize)
+        return;
+    const size_t room = static_cast<size_t>(textSize - textUsed - 1);
+    const size_t copied = std::min(length, room);
+    std::memcpy(text + textUsed, value, copied);
+    text[textUsed + copied] = '\0';
+    args[argCount].type = LogArg::Type::Text;
+    args[argCount++].offset = textUsed;
+    textUsed = static_cast<uint8_t>(textUsed + copied + 1);
+}
+
+void Log::setLevel(LogLevel level) {
+    minimumLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+void Log::setRateLimit(uint32_t perSecond) {
+    rateLimit.store(perSecond, std::memory_order_relaxed);
+}
+
+int64_t Log::startNs() {
+    return processStartNs;
+}
+
+/**
+ * Okno limitu zaczyna się od pierwszego komunikatu po upływie poprzedniego; przy równoczesnych
+ * zapisach z kilku wątków limit jest przybliżony (może zostać przekroczony o liczbę wątków).
+ * Pominięcie komunikatu to odczyt zegara zgrubnego i jedna operacja atomowa.
+ */
+LogRecord *Log::begin(LogSite &site) {
+    registerSite(site);
+
+    const uint32_t limit = rateLimit.load(std::memory_order_relaxed);
+    if (limit > 0) {
+        const int64_t now = coarseNowNs();
+        int64_t windowStart = site.windowStartNs.load(std::memory_order_relaxed);
+        if (now - windowStart >= rateWindowNs) {
+            if (site.windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+                site.windowCount.store(0, std::memory_order_relaxed);
+        } else if (site.windowCount.load(std::memory_order_relaxed) >= limit) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        site.windowCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    site.written.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t suppressed = site.suppressed.load(std::memory_order_relaxed);
+    if (suppressed > 0) {
+        suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        site.suppressedTotal.fetch_add(suppressed, std::memory_order_relaxed);
+    }
+
+    LogRecord *record = reserve();
+    record->timeNs = nowNs();
+    record->site = &site;
+    record->suppressed = suppressed;
+    record->threadId = threadId();
+    record->argCount = 0;
+    record->textUsed = 0;
+    record->summary = false;
+    return record;
+}
+
+/**
+ * Numer gniazda wyznaczany jest z adresu rekordu, a numer rekordu — z sekwencji ustawionej w reserve().
+ */
+void Log::commit(LogRecord *record) {
+    Slot &slot = slots[static_cast<size_t>(reinterpret_cast<const char *>(record) - reinterpret_cast<const char *>(&slots[0].record))
+                       / sizeof(Slot)];
+    slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * Rekord jeszcze zapisywany kończy odczyt (zostanie odczytany następnym razem);
+ * rekordy nadpisane w trakcie odczytu są liczone jako utracone.
+ */
+uint64_t Log::read(uint64_t &cursor, std::vector<LogRecord> &out, size_t maxRecords) {
+    const uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t lost = 0;
+    if (end - cursor > capacity) {
+        lost = end - capacity - cursor;
+        cursor = end - capacity;
+    }
+
+    for (size_t taken = 0; cursor < end && taken < maxRecords; ++cursor) {
+        const Slot &slot = slots[cursor & slotMask];
+        const uint64_t ready = 2 * cursor + 2;
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before < ready)
+            break;
+        if (before == ready) {
+            const LogRecord copy = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                out.push_back(copy);
+                ++taken;
+                continue;
+            }
+        }
+        ++lost;
+    }
+    return lost;
+}
+
+/**
+ * Wywoływane okresowo przez odczytującego (panel diagnostyczny), aby komunikaty pominięte
+ * w ostatnim oknie nie czekały na kolejny komunikat z tego samego miejsca.
+ */
+void Log::flushSuppressed() {
+    const int64_t now = coarseNowNs();
+    for (LogSite *site = siteList.load(std::memory_order_acquire); site; site = site->next) {
+        if (site->suppressed.load(std::memory_order_relaxed) == 0
+            || now - site->windowStartNs.load(std::memory_order_relaxed) < rateWindowNs)
+            continue;
+        const uint32_t count = site->suppressed.exchange(0, std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+        site->suppressedTotal.fetch_add(count, std::memory_order_relaxed);
+        LogRecord *record = reserve();
+        record->timeNs = nowNs();
+        record->site = site;
+        record->suppressed = count;
+        record->threadId = threadId();
+        record->argCount = 0;
+        record->textUsed = 0;
+        record->summary = true;
+        commit(record);
+    }
+}
+
+std::vector<const LogSite *> Log::sites() {
+    std::vector<const LogSite *> list;
+    for (const LogSite *site = siteList.load(std::memory_order_acquire); site; site = site->next)
+        list.push_back(site);
+    std::reverse(list.begin(), list.end());
+    return list;
+}
+
+/**
+ * Argumenty podstawiane są w miejsce kolejnych "{}" szablonu; nadmiarowe dopisywane są na końcu.
+ * Liczby formatowane są w locale "C".
+ */
+std::string Log::format(const LogRecord &record) {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out.setf(std::ios::fixed);
+    out.precision(6);
+    out << '[' << static_cast<double>(record.timeNs - processStartNs) / 1e9 << "] ";
+    out.unsetf(std::ios::fixed);
+    out.precision(6);
+
+    const LogSite *site = record.site;
+    out << logLevelName(site->level) << ' ' << baseName(site->file) << ':' << site->line << ' ';
+    if (record.summary) {
+        out << "pominięto " << record.suppressed << " komunikatów: " << site->format;
+        return out.str();
+    }
+
+    const auto writeArg = [&](const LogArg &arg) {
+        switch (arg.type) {
+        case LogArg::Type::Int: out << arg.i; break;
+        case LogArg::Type::Double: out << arg.d; break;
+        case LogArg::Type::Text: out << (record.text + arg.offset); break;
+        }
+    };
+
+    int next = 0;
+    for (const char *c = site->format; *c; ++c) {
+        if (c[0] == '{' && c[1] == '}') {
+            if (next < record.argCount)
+                writeArg(record.args[next++]);
+            ++c;
+        } else {
+            out << *c;
+        }
+    }
+    for (; next < record.argCount; ++next) {
+        out << ' ';
+        writeArg(record.args[next]);
+    }
+    if (record.suppressed > 0)
+        out << " (pominięto " << record.suppressed << ")";
+    return out.str();
+}
+
+bool Log::dump(const std::string &path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    uint64_t cursor = 0;
+    std::vector<LogRecord> records;
+    const uint64_t lost = read(cursor, records);
+    if (lost > 0)
+        out << "# utracono " << lost << " najstarszych rekordów\n";
+    for (const LogRecord &record : records)
+        out << format(record) << '\n';
+    return static_cast<bool>(out);
+}
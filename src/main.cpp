@@ -12,30 +12,337 @@
  *   - umożliwia wizualizację parametrów pracy silnika (RPM, prąd, napięcie, moc, PWM),
  *   - pozwala sterować pracą silnika (Start/Stop, tryb ręczny/automatyczny, PID).
  *
+ * Opcja wiersza poleceń --trace <plik> włącza nagrywanie śladu wykonania od startu programu
+ * i zapisuje go do podanego pliku (format Chrome trace-event) po zamknięciu okna.
+ * Opcje --metrics-port <port> i --metrics-socket <ścieżka> uruchamiają eksporter metryk
+ * w formacie Prometheus (localhost / gniazdo lokalne), a --shm udostępnia telemetrię innym
+ * procesom przez pamięć współdzieloną (klient: tools/wds_shm_client). Opcja --filter <kanał>=<opis>
+ * ustawia łańcuch filtrów kanału (np. current=median:5,ema:0.2), a --derived <nazwa>=<wyrażenie>
+ * definiuje kanał pochodny z własnym wykresem (np. moc_el=voltage*current/1000). Opcja
+ * --limit <reguła> dodaje regułę alarmową sprawdzaną dla każdej ramki (np. current>900:stop).
+ * Opcja --record <plik.wds> nagrywa odbierane próbki do pliku sesji od startu programu,
+ * a --view <plik.wds> (powtarzalna) otwiera przeglądarkę sesji z podanymi nagraniami.
+ * Opcje --drop-policy <oldest|newest|decimate>, --queue-frames <n> i --read-buffer <bajty>
+ * ustalają, co dzieje się z danymi, gdy GUI nie nadąża: politykę usuwania nadmiaru, pojemność
+ * kolejki próbek do wyświetlania i limit bufora odczytu portu (domyślnie oldest, 4096 próbek, 64 KiB).
+ * Polityka dotyczy tylko wyświetlania — historia i nagranie sesji dostają wszystkie próbki.
+ * Opcje --history-minutes <min> i --history-mb <MiB> ograniczają historię pomiarów w pamięci
+ * (domyślnie 60 min i 256 MiB; najstarsze bloki są usuwane).
+ *
+ * Z opcją --headless program działa bez okna (QCoreApplication): --profile <plik> --port <port>
+ * [--baud <Bd>] [--profile-log <plik.csv>] wykonuje profil nastaw i kończy działanie.
+ * Opcja --analyze <katalog> (również bez --headless) analizuje wsadowo nagrania z katalogu
+ * i wypisuje tabelę wskaźników; [--analyze-out <plik.csv>] zapisuje je do CSV, a [--jobs <n>]
+ * ustala liczbę wątków (domyślnie liczba rdzeni).
+ *
+ * Komunikaty qDebug()/qWarning() trafiają również do dziennika w pamięci (Log, panel
+ * Diagnostyka) i podlegają jego limitowi liczonemu osobno dla każdego miejsca wywołania — zalew
+ * komunikatów nie zalewa konsoli. Komunikat qFatal() nie jest ograniczany.
+ *
+ * Po pokazaniu okna w dzienniku zapisywany jest czas od startu procesu do pierwszego obiegu
+ * pętli zdarzeń z widocznym oknem (czas do pierwszego okna).
+ *
  * Program kończy działanie, gdy użytkownik zamknie główne okno aplikacji.
  *
  * @see MainWindow
  */
 
 #include "../inc/mainwindow.h"
+#include "../inc/headless.h"
+#include "../inc/logring.h"
+#include "../inc/trace.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QLocale>
 #include <QTranslator>
 #include <QDebug>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/**
+ * Rodzaj aplikacji trzeba wybrać przed utworzeniem parsera opcji, dlatego --headless
+ * sprawdzany jest bezpośrednio w argv.
+ */
+static bool hasArgument(int argc, char *argv[], const char *name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+#ifdef WDS_LOG
+/// Poprzednia procedura obsługi komunikatów Qt (wypisywanie na konsolę).
+static QtMessageHandler consoleHandler = nullptr;
+
+/**
+ * Miejsce komunikatu Qt: klucz (plik, wiersz, poziom) i miejsce dziennika z limitem.
+ * Nazwa pliku jest kopiowana — kontekst może pochodzić z biblioteki wyładowanej przed końcem procesu.
+ */
+struct QtLogSite {
+    QtLogSite(const char *file, int line, LogLevel level)
+        : name(copyName(file)), line(line), level(level),
+          site(*file ? name.get() : __FILE__, *file ? line : __LINE__, level, "{}") {}
+
+    static std::unique_ptr<char[]> copyName(const char *file) {
+        std::unique_ptr<char[]> copy(new char[std::strlen(file) + 1]);
+        std::strcpy(copy.get(), file);
+        return copy;
+    }
+
+    std::unique_ptr<char[]> name; ///< Plik źródłowy ("" bez kontekstu).
+    int line;                     ///< Wiersz.
+    LogLevel level;               ///< Poziom komunikatu.
+    LogSite site;                 ///< Miejsce dziennika.
+};
+
+/// Liczba pozycji tablicy miejsc komunikatów Qt (potęga dwójki).
+static constexpr size_t qtSiteCount = 256;
+static constexpr size_t qtSiteMask = qtSiteCount - 1;
+static_assert((qtSiteCount & qtSiteMask) == 0, "Liczba miejsc komunikatów Qt musi być potęgą dwójki");
+
+/// Miejsca komunikatów Qt, adresowanie otwarte po skrócie (plik, wiersz, poziom).
+static std::atomic<QtLogSite *> qtSites[qtSiteCount];
+
+/**
+ * Zwraca miejsce dziennika dla komunikatu Qt. Limit liczony jest osobno dla każdego miejsca
+ * wywołania qDebug()/qWarning() (plik, wiersz, poziom), tak jak dla makr LOG_*; bez kontekstu
+ * (QT_NO_MESSAGELOGCONTEXT) wszystkie komunikaty danego poziomu dzielą jedno miejsce.
+ * Wyszukiwanie nie blokuje: skrót FNV-1a wskazuje pozycję w stałej tablicy, kolizje rozwiązywane
+ * są liniowo, a nowe miejsce wstawiane przez compare_exchange. Po zapełnieniu tablicy komunikaty
+ * danego poziomu dzielą jedno miejsce zapasowe.
+ * Miejsca nie są zwalniane — lista Log::sites() wskazuje na nie do końca procesu.
+ */
+static LogSite &qtLogSite(const QMessageLogContext &context, LogLevel level) {
+    static LogSite overflow[] = {{__FILE__, __LINE__, LogLevel::Debug, "{}"},
+                                 {__FILE__, __LINE__, LogLevel::Info, "{}"},
+                                 {__FILE__, __LINE__, LogLevel::Warning, "{}"},
+                                 {__FILE__, __LINE__, LogLevel::Error, "{}"}};
+    const char *file = context.file ? context.file : "";
+    const int line = context.file ? context.line : 0;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const char *c = file; *c; ++c)
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    hash = (hash ^ static_cast<uint32_t>(line)) * 1099511628211ull;
+    hash = (hash ^ static_cast<uint8_t>(level)) * 1099511628211ull;
+
+    std::unique_ptr<QtLogSite> created;
+    for (size_t probe = 0; probe < qtSiteCount; ++probe) {
+        std::atomic<QtLogSite *> &slot = qtSites[(hash + probe) & qtSiteMask];
+        QtLogSite *site = slot.load(std::memory_order_acquire);
+        if (!site) {
+            if (!created)
+                created = std::make_unique<QtLogSite>(file, line, level);
+            if (slot.compare_exchange_strong(site, created.get(), std::memory_order_acq_rel,
+                                             std::memory_order_acquire))
+                return created.release()->site;
+        }
+        if (site->line == line && site->level == level && std::strcmp(site->name.get(), file) == 0)
+            return site->site;
+    }
+    return overflow[static_cast<int>(level)];
+}
+
+/**
+ * Przekazuje komunikat Qt do dziennika w pamięci; na konsolę trafia tylko wtedy,
+ * gdy nie został pominięty przez limit. Komunikaty qCritical() i qFatal() trafiają na konsolę zawsze.
+ */
+static void logMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message) {
+    const LogLevel level = type == QtDebugMsg ? LogLevel::Debug
+                           : type == QtInfoMsg ? LogLevel::Info
+                           : type == QtWarningMsg ? LogLevel::Warning
+                                                  : LogLevel::Error;
+    if (!Log::isEnabled(level)) {
+        consoleHandler(type, context, message);
+        return;
+    }
+    const bool written = Log::write(qtLogSite(context, level), message.toUtf8());
+    if (written || type == QtCriticalMsg || type == QtFatalMsg)
+        consoleHandler(type, context, message);
+}
+#endif
 
 int main(int argc, char *argv[]) {
-    QApplication a(argc, argv);
+#ifdef WDS_LOG
+    consoleHandler = qInstallMessageHandler(logMessageHandler);
+#endif
+    QElapsedTimer startup;
+    startup.start();
+    const bool headless = hasArgument(argc, argv, "--headless") || hasArgument(argc, argv, "--analyze");
+    std::unique_ptr<QCoreApplication> app(headless ? new QCoreApplication(argc, argv)
+                                                   : new QApplication(argc, argv));
     QTranslator translator;
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption traceOption(QStringLiteral("trace"),
+                                         QObject::tr("Nagrywa ślad wykonania i zapisuje go do <plik> przy wyjściu."),
+                                         QObject::tr("plik"));
+    parser.addOption(traceOption);
+    const QCommandLineOption metricsPortOption(QStringLiteral("metrics-port"),
+                                               QObject::tr("Udostępnia metryki Prometheus na 127.0.0.1:<port>."),
+                                               QObject::tr("port"));
+    parser.addOption(metricsPortOption);
+    const QCommandLineOption metricsSocketOption(QStringLiteral("metrics-socket"),
+                                                 QObject::tr("Udostępnia metryki Prometheus przez gniazdo lokalne <ścieżka>."),
+                                                 QObject::tr("ścieżka"));
+    parser.addOption(metricsSocketOption);
+    const QCommandLineOption shmOption(QStringLiteral("shm"),
+                                       QObject::tr("Udostępnia telemetrię innym procesom przez pamięć współdzieloną."));
+    parser.addOption(shmOption);
+    const QCommandLineOption filterOption(QStringLiteral("filter"),
+                                          QObject::tr("Filtr kanału, np. current=median:5,ema:0.2 (opcję można powtórzyć)."),
+                                          QObject::tr("kanał=opis"));
+    parser.addOption(filterOption);
+    const QCommandLineOption derivedOption(QStringLiteral("derived"),
+                                           QObject::tr("Kanał pochodny, np. moc_el=voltage*current/1000 (opcję można powtórzyć)."),
+                                           QObject::tr("nazwa=wyrażenie"));
+    parser.addOption(derivedOption);
+    const QCommandLineOption limitOption(QStringLiteral("limit"),
+                                         QObject::tr("Reguła alarmowa, np. current>900:stop (opcję można powtórzyć)."),
+                                         QObject::tr("reguła"));
+    parser.addOption(limitOption);
+    const QCommandLineOption recordOption(QStringLiteral("record"),
+                                          QObject::tr("Nagrywa odbierane próbki do pliku sesji <plik.wds>."),
+                                          QObject::tr("plik"));
+    parser.addOption(recordOption);
+    const QCommandLineOption viewOption(QStringLiteral("view"),
+                                        QObject::tr("Otwiera nagranie sesji w przeglądarce (opcję można powtórzyć)."),
+                                        QObject::tr("plik"));
+    parser.addOption(viewOption);
+    const QCommandLineOption dropPolicyOption(QStringLiteral("drop-policy"),
+                                              QObject::tr("Polityka przy przeciążeniu GUI: oldest, newest lub decimate."),
+                                              QObject::tr("polityka"), QStringLiteral("oldest"));
+    parser.addOption(dropPolicyOption);
+    const QCommandLineOption queueFramesOption(QStringLiteral("queue-frames"),
+                                               QObject::tr("Pojemność kolejki próbek do wyświetlania."), QObject::tr("n"));
+    parser.addOption(queueFramesOption);
+    const QCommandLineOption readBufferOption(QStringLiteral("read-buffer"),
+                                              QObject::tr("Limit bufora odczytu portu (0 = bez limitu)."),
+                                              QObject::tr("bajty"));
+    parser.addOption(readBufferOption);
+    const QCommandLineOption historyOption(QStringLiteral("history-encoding"),
+                                           QObject::tr("Zapis historii pomiarów: gorilla (bezstratnie) lub quantized (int16/int8)."),
+                                           QObject::tr("zapis"), QStringLiteral("gorilla"));
+    parser.addOption(historyOption);
+    const QCommandLineOption sensorLsbOption(QStringLiteral("sensor-lsb"),
+                                             QObject::tr("Rozdzielczość czujnika dla zapisu quantized, np. voltage=0.004 (opcję można powtórzyć)."),
+                                             QObject::tr("kanał=LSB"));
+    parser.addOption(sensorLsbOption);
+    const QCommandLineOption historyMinutesOption(QStringLiteral("history-minutes"),
+                                                  QObject::tr("Retencja historii pomiarów w minutach (0 = bez limitu)."),
+                                                  QObject::tr("min"), QString::number(MainWindow::defaultHistoryMinutes));
+    parser.addOption(historyMinutesOption);
+    const QCommandLineOption historyMegabytesOption(QStringLiteral("history-mb"),
+                                                    QObject::tr("Limit rozmiaru historii pomiarów w MiB (0 = bez limitu)."),
+                                                    QObject::tr("MiB"), QString::number(MainWindow::defaultHistoryMegabytes));
+    parser.addOption(historyMegabytesOption);
+    const QCommandLineOption headlessOption(QStringLiteral("headless"),
+                                            QObject::tr("Praca bez okna (wymaga --profile i --port)."));
+    parser.addOption(headlessOption);
+    const QCommandLineOption profileOption(QStringLiteral("profile"),
+                                           QObject::tr("Plik profilu nastaw do wykonania."), QObject::tr("plik"));
+    parser.addOption(profileOption);
+    const QCommandLineOption profileLogOption(QStringLiteral("profile-log"),
+                                              QObject::tr("Dziennik wykonania profilu (CSV)."), QObject::tr("plik"));
+    parser.addOption(profileLogOption);
+    const QCommandLineOption portOption(QStringLiteral("port"),
+                                        QObject::tr("Port szeregowy (tryb --headless)."), QObject::tr("port"));
+    parser.addOption(portOption);
+    const QCommandLineOption baudOption(QStringLiteral("baud"),
+                                        QObject::tr("Prędkość transmisji (tryb --headless)."), QObject::tr("Bd"),
+                                        QStringLiteral("115200"));
+    parser.addOption(baudOption);
+    const QCommandLineOption analyzeOption(QStringLiteral("analyze"),
+                                           QObject::tr("Analizuje wsadowo nagrania z <katalog> (bez okna)."),
+                                           QObject::tr("katalog"));
+    parser.addOption(analyzeOption);
+    const QCommandLineOption analyzeOutOption(QStringLiteral("analyze-out"),
+                                              QObject::tr("Zapisuje wskaźniki analizy wsadowej do pliku CSV."),
+                                              QObject::tr("plik"));
+    parser.addOption(analyzeOutOption);
+    const QCommandLineOption jobsOption(QStringLiteral("jobs"),
+                                        QObject::tr("Liczba wątków analizy wsadowej (0 = liczba rdzeni)."),
+                                        QObject::tr("n"), QStringLiteral("0"));
+    parser.addOption(jobsOption);
+    parser.process(*app);
+
+    const QString tracePath = parser.value(traceOption);
+    Trace::setThreadName(headless ? "główny" : "GUI");
+    if (!tracePath.isEmpty())
+        Trace::setEnabled(true);
+
+    const auto writeTrace = [&tracePath]() {
+        if (tracePath.isEmpty())
+            return;
+        if (Trace::writeChromeJson(tracePath.toStdString()))
+            qDebug() << "Zapisano ślad wykonania:" << tracePath;
+        else
+            qDebug() << "Nie udało się zapisać śladu wykonania:" << tracePath;
+    };
+
+    if (parser.isSet(analyzeOption)) {
+        const int result = runBatchAnalysis(parser.value(analyzeOption), parser.value(analyzeOutOption),
+                                            parser.value(jobsOption).toInt());
+        writeTrace();
+        return result;
+    }
+
+    if (headless) {
+        if (!parser.isSet(profileOption) || !parser.isSet(portOption)) {
+            qCritical() << "Tryb --headless wymaga opcji --profile i --port";
+            return 2;
+        }
+        const int result = runHeadlessProfile(parser.value(portOption), parser.value(baudOption).toInt(),
+                                              parser.value(profileOption), parser.value(profileLogOption));
+        writeTrace();
+        return result;
+    }
+
     if (translator.load("../../i18n/wds_motor_en_US.qm")) {
         qDebug() << "Translator loaded";
-        a.installTranslator(&translator);
+        app->installTranslator(&translator);
     } else {
         qDebug() << "Failed to load translator";
     }
 
     MainWindow w;
     w.setWindowTitle(QObject::tr("Sterowanie silnikiem"));
+    if (parser.isSet(metricsPortOption) || parser.isSet(metricsSocketOption)) {
+        const quint16 metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+        if (!w.startMetricsExporter(metricsPort, parser.value(metricsSocketOption)))
+            qDebug() << "Nie udało się uruchomić eksportera metryk";
+    }
+    if (parser.isSet(shmOption))
+        w.enableSharedMemory();
+    for (const QString &assignment : parser.values(filterOption))
+        w.setChannelFilter(assignment);
+    if (parser.isSet(derivedOption))
+        w.setDerivedChannels(parser.values(derivedOption));
+    if (parser.isSet(limitOption))
+        w.setLimitRules(parser.values(limitOption));
+    if (parser.isSet(dropPolicyOption) || parser.isSet(queueFramesOption) || parser.isSet(readBufferOption))
+        w.setBackpressure(parser.value(dropPolicyOption), parser.value(queueFramesOption).toInt(),
+                          parser.isSet(readBufferOption) ? parser.value(readBufferOption).toLongLong() : -1);
+    if (parser.isSet(historyOption) || parser.isSet(sensorLsbOption))
+        w.setHistoryEncoding(parser.value(historyOption), parser.values(sensorLsbOption));
+    if (parser.isSet(historyMinutesOption) || parser.isSet(historyMegabytesOption))
+        w.setHistoryRetention(parser.value(historyMinutesOption).toInt(), parser.value(historyMegabytesOption).toInt());
+    if (parser.isSet(recordOption))
+        w.startSessionRecording(parser.value(recordOption));
     w.show();
-    return a.exec();
+    if (parser.isSet(viewOption))
+        w.openSessionViewer(parser.values(viewOption));
+    QTimer::singleShot(0, [&startup]() {
+        qDebug() << "Czas do pierwszego okna:" << startup.elapsed() << "ms";
+    });
+    const int result = app->exec();
+
+    writeTrace();
+    return result;
 }
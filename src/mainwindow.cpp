@@ -9,6 +9,23 @@
 
 #include "../inc/mainwindow.h"
 #include "../ui/ui_mainwindow.h"
+#include "../inc/logring.h"
+#include "../inc/sessionviewer.h"
+#include "../inc/stallpanel.h"
+#include "../inc/trace.h"
+#include <QDateTime>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QStandardPaths>
+#include <array>
+#include <cmath>
+#include <iterator>
 
 /**
  * @brief Konstruktor klasy MainWindow.
@@ -21,12 +38,14 @@
  */
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow),
-    serialReader(new SerialReader(this)), charts(new ChartsManager(this)){
+    serialReader(new SerialReader(this)), charts(new ChartsManager(this)),
+    portWatcher(new PortWatcher(this)){
     ui->setupUi(this);
 
     connectSignals();
 
-    refreshSerialPortList();
+    // Enumeracja portów odbywa się w tle; lista wypełni się po pierwszym skanowaniu
+    portWatcher->start();
 
     configureInitialMode();
 
@@ -38,7 +57,33 @@ MainWindow::MainWindow(QWidget *parent)
 
     setupTimers();
 
+    // Panel diagnostyczny (dziennik w pamięci) — domyślnie ukryty, włączany z menu Narzędzia
+    diagnostics = new DiagnosticsPanel(this);
+    addDockWidget(Qt::BottomDockWidgetArea, diagnostics);
+    diagnostics->hide();
+    ui->menuNarzedzia->addSeparator();
+    ui->menuNarzedzia->addAction(diagnostics->toggleViewAction());
+
+    // Strażnik pętli zdarzeń GUI — uruchamiany po wejściu do pętli, aby start programu
+    // nie był liczony jako zablokowanie
+    stallWatchdog = new StallWatchdog(this);
+    diagnostics->addPage(new StallPanel(stallWatchdog), tr("Pętla GUI"));
+    QTimer::singleShot(0, stallWatchdog, [this]() { stallWatchdog->start(); });
+
+    // Identyfikacja obiektu w tle: polecenia z dziennika SerialReader i próbki z magistrali,
+    // wynik przekazywany do wątku GUI tylko do wyświetlenia
+    plantPanel = new PlantPanel;
+    diagnostics->addPage(plantPanel, tr("Identyfikacja"));
+    connect(plantPanel, &PlantPanel::applyGainsRequested, this, &MainWindow::applySuggestedGains);
+    plantAnalysis.start(serialReader->dataBus(), serialReader->commandLog(), [this](const PlantEstimate &estimate) {
+        QMetaObject::invokeMethod(plantPanel, [this, estimate]() { plantPanel->showEstimate(estimate); }, Qt::QueuedConnection);
+    });
+
+    // Historia nie rośnie bez ograniczeń podczas długiej pracy
+    setHistoryRetention(defaultHistoryMinutes, defaultHistoryMegabytes);
+
     elapsed.start();
+    timelineOriginUs = PosixSerialTransport::monotonicNs() / 1000;
 }
 
 /**
@@ -47,20 +92,69 @@ MainWindow::MainWindow(QWidget *parent)
  * Zatrzymuje komunikację szeregowa i zwalnia zasoby GUI.
  */
 MainWindow::~MainWindow() {
+    // Zamykanie nie jest zablokowaniem pętli zdarzeń
+    stallWatchdog->stop();
+    // Eksporter, profil i identyfikacja korzystają z SerialReader, więc są zatrzymywane jako pierwsze
+    delete metricsExporter;
+    profileRunner.stop();
+    plantAnalysis.stop();
     // Zamknięcie portu szeregowego i zwolnienie pamięci interfejsu
     serialReader->stop();
+    serialReader->dataBus().unsubscribe(sampleSubscription);
+    serialReader->displayBus().unsubscribe(displaySubscription);
+    stopSessionRecording();
     delete ui;
 }
 
 /**
- * Zapisuje dane w polu latestData, dane te są wykorzystywane do aktualizacji GUI i wykresów.
+ * Zaznacza akcję w menu, co uruchamia publikowanie przez SerialReader::setSharedMemoryEnabled().
+ */
+void MainWindow::enableSharedMemory() {
+    ui->actionSharedMemory->setChecked(true);
+}
+
+/**
+ * Eksporter działa we własnym wątku i odczytuje wyłącznie liczniki SerialReader::metrics(),
+ * więc odpytywanie nie dotyka okna ani wykresów.
+ */
+bool MainWindow::startMetricsExporter(quint16 tcpPort, const QString &socketPath) {
+    if (!metricsExporter)
+        metricsExporter = new MetricsExporter(serialReader->metrics(), this);
+
+    bool ok = true;
+    if (tcpPort > 0)
+        ok = metricsExporter->listenTcp(tcpPort) && ok;
+    if (!socketPath.isEmpty())
+        ok = metricsExporter->listenLocal(socketPath) && ok;
+    return ok;
+}
+
+/**
+ * Dopisuje wszystkie próbki do historii (obie wersje) i nagrania sesji — magistrala dataBus()
+ * jest bezstratna, więc polityka kolejki wyświetlania nie usuwa próbek z historii ani z nagrania.
+ */
+void MainWindow::handleSampleBatch(const SamplePair *samples, size_t count) {
+    const bool recording = sessionWriter.isOpen();
+    for (size_t i = 0; i < count; ++i) {
+        const SerialData &data = samples[i].raw;
+        const SerialData &filtered = samples[i].filtered;
+        // Czas próbki z SerialReader (znacznik urządzenia po synchronizacji zegarów lub czas odebrania)
+        history.append(data.timeUs - timelineOriginUs, data);
+        filteredHistory.append(filtered.timeUs - timelineOriginUs, filtered);
+        if (recording)
+            sessionWriter.append(data.timeUs, data);
+    }
+}
+
+/**
+ * Zapisuje ostatnią próbkę porcji w polu latestData, dane te są wykorzystywane do aktualizacji GUI i wykresów.
+ * GUI i wykresy pokazują wartości przefiltrowane.
  */
-void MainWindow::handleNewSerialData(const SerialData &data) {
-    // qDebug() << "RPM:" << data.rpm << "PWM:" << data.pwm
-    //          << "Current:" << data.current << "Voltage:" << data.voltage
-    //          << "Power:" << data.power << "Kp:" << data.kp << "Ki:" << data.ki
-    //          << "Kd:" << data.kd << "Mode:" << data.mode;
-    latestData = data;
+void MainWindow::handleDisplayBatch(const SamplePair *samples, size_t count) {
+    if (count > 0) {
+        latestData = samples[count - 1].filtered;
+        telemetryReceived = true;
+    }
 }
 
 /**
@@ -99,6 +193,7 @@ void MainWindow::setLabelsColors() const{
  * Dodaje nowe punkty do wykresów (PWM, RPM, prąd, napięcie, moc) z aktualnym czasem.
  */
 void MainWindow::updateCharts() const{
+    TRACE_SCOPE("MainWindow::updateCharts");
     // Aktualizacja wykresów
     qreal t = elapsed.elapsed() / 1000.0;
 
@@ -108,12 +203,20 @@ void MainWindow::updateCharts() const{
     charts->addPoint(ChartType::Voltage, t, latestData.voltage);
     charts->addPoint(ChartType::Power, t, latestData.power);
 
+    // Kanały pochodne — wartości niezdefiniowane (np. dzielenie przez zero) są pomijane
+    for (size_t i = 0; i < derivedChannels.size(); ++i) {
+        const float value = derivedChannels[i].expression.evaluate(latestData, static_cast<float>(targetRpm));
+        if (std::isfinite(value))
+            charts->addPoint(derivedChartType(static_cast<int>(i)), t, value);
+    }
+
 }
 
 /**
  * Wyświetla aktualne wartości parametrów pracy silnika i parametrów PID.
  */
 void MainWindow::updateGUI() const{
+    TRACE_SCOPE("MainWindow::updateGUI");
     // Ustawienie wartości w GUI
     ui->lineEditRPMValue->setText(QString::number(latestData.rpm, 'f', 0));
     ui->lineEditCurrentValue->setText(QString::number(latestData.current, 'f', 2));
@@ -130,6 +233,10 @@ void MainWindow::updateGUI() const{
  * Przełącza stan pracy silnika i wysyła odpowiednie polecenie do mikrokontrolera.
  */
 void MainWindow::on_buttonStartStop_clicked() {
+    if (!isMotorRunning && serialReader->isEmergencyStopped()) {
+        qDebug() << "Zatrzymanie awaryjne aktywne — najpierw skasuj blokadę";
+        return;
+    }
     isMotorRunning = !isMotorRunning;
     ui->pushButtonStartStop->setText(isMotorRunning ? "STOP" : "START");
 
@@ -188,6 +295,7 @@ void MainWindow::on_buttonSetRPM_clicked() {
     bool ok;
     int rpm = ui->spinBoxTargetRPM->value();
     serialReader->sendData(DataType::RPM, rpm);
+    targetRpm = rpm;
     qDebug()<< "Wartość rpm: "<< rpm;
     ui->spinBoxTargetRPM->clear();
 }
@@ -205,9 +313,15 @@ void MainWindow::on_ConnectPortClicked(){
             return;
         }
 
-        // Próbujemy się połączyć
+        // Próbujemy się połączyć z wybraną prędkością (lub wykryć ją automatycznie)
+        const QString baudText = ui->comboBoxBaudRates->currentText();
+        const bool autoBaud = baudText == QLatin1String("Auto");
         serialReader->stop();
-        serialReader->start(selectedPort);
+        if (autoBaud) {
+            serialReader->startAutoBaud(selectedPort);
+        } else {
+            serialReader->start(selectedPort, baudText.toInt());
+        }
         if (!serialReader->isOpen()) {
             qDebug() << "Nie udało się połączyć z portem: " << selectedPort;
             ui->label_8->setText(tr("nie połączono"));
@@ -215,14 +329,16 @@ void MainWindow::on_ConnectPortClicked(){
             return;
         }
 
-        // Zaktualizuj GUI
-        currentPortName = selectedPort;
-        currentBaudRate = ui->comboBoxBaudRates->currentText().toInt();
-        ui->label_8->setText(tr("połączono"));
-        ui->label_8->setStyleSheet("color: green; font-weight: bold;");
-        ui->pushButtonConnectPort->setText(tr("Rozłącz"));
+        // Nowe połączenie to nowa sesja — historia poprzedniej nie miesza się z bieżącą
+        // (ponowne połączenie po odłączeniu urządzenia, reconnectDevice(), historię zachowuje)
+        history.clear();
+        filteredHistory.clear();
 
-        isPortConnected = true;
+        // Zaktualizuj GUI
+        if (!autoBaud) {
+            currentBaudRate = baudText.toInt();
+        }
+        markConnected(selectedPort);
 
     } else {
         handlePortDisconnected();
@@ -230,24 +346,576 @@ void MainWindow::on_ConnectPortClicked(){
 }
 
 /**
- * Odświeża listę dostępnych portów szeregowych.Funkcja czyści zawartość comboBoxSelectPort i dodaje tylko porty,
- * których nazwa zawiera jedno z poniższych wyrażeń:
- * - "ttyUSB",
- * - "ttyACM",
- * - "COM.
+ * Zapisuje wykrytą prędkość i ustawia ją w liście wyboru, aby kolejne połączenie jej używało.
+ */
+void MainWindow::handleBaudRateDetected(int baudRate) {
+    currentBaudRate = baudRate;
+    ui->comboBoxBaudRates->setCurrentText(QString::number(baudRate));
+    qDebug() << "Wykryto prędkość transmisji:" << baudRate;
+}
+
+/**
+ * Zapamiętuje port (wraz z numerem seryjnym i VID:PID, jeśli są znane) do ponownego połączenia
+ * i aktualizuje GUI.
+ */
+void MainWindow::markConnected(const QString &portName) {
+    currentPortName = portName;
+    connectedDevice = availablePorts.value(portName);
+    connectedDevice.systemLocation = portName;
+    reconnectPending = false;
+    telemetryReceived = false;
+
+    ui->label_8->setText(tr("połączono"));
+    ui->label_8->setStyleSheet("color: green; font-weight: bold;");
+    ui->pushButtonConnectPort->setText(tr("Rozłącz"));
+
+    isPortConnected = true;
+    serialReader->metrics().setConnected(true);
+}
+
+/**
+ * Zleca ponowną enumerację portów obserwatorowi działającemu w tle.
+ * Lista w comboBoxSelectPort jest aktualizowana przyrostowo przez handlePortAdded()/handlePortRemoved().
  */
 void MainWindow::refreshSerialPortList() {
-    ui->comboBoxSelectPort->clear();
-    const auto ports = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &info : ports) {
+    portWatcher->rescan();
+}
+
+/**
+ * Dodaje port do listy wyboru. Jeśli oczekujemy na ponowne podłączenie i jest to to samo
+ * urządzenie (numer seryjny, VID:PID), od razu nawiązuje połączenie.
+ */
+void MainWindow::handlePortAdded(const PortDescriptor &port) {
+    availablePorts.insert(port.systemLocation, port);
+    if (ui->comboBoxSelectPort->findText(port.systemLocation) < 0) {
+        ui->comboBoxSelectPort->addItem(port.systemLocation);
+    }
+
+    if (reconnectPending && port.sameDevice(connectedDevice)) {
+        reconnectDevice(port, 0);
+    }
+}
+
+/**
+ * Usuwa port z listy wyboru.
+ */
+void MainWindow::handlePortRemoved(const QString &systemLocation) {
+    availablePorts.remove(systemLocation);
+    const int index = ui->comboBoxSelectPort->findText(systemLocation);
+    if (index >= 0) {
+        ui->comboBoxSelectPort->removeItem(index);
+    }
+}
+
+/**
+ * Plik można otworzyć w chrome://tracing lub ui.perfetto.dev. Nagrywanie nie jest przerywane.
+ */
+void MainWindow::saveTrace() {
+    const QString path = QFileDialog::getSaveFileName(this, tr("Zapisz ślad wykonania"),
+                                                      QStringLiteral("wds_trace.json"),
+                                                      tr("Ślad Chrome (*.json)"));
+    if (path.isEmpty())
+        return;
+    if (Trace::writeChromeJson(path.toStdString()))
+        qDebug() << "Zapisano ślad wykonania:" << path;
+    else
+        qDebug() << "Nie udało się zapisać śladu wykonania:" << path;
+}
+
+/**
+ * Okno zawiera pole opisu łańcucha dla każdego kanału pomiarowego. Niepoprawne opisy są zgłaszane
+ * w dzienniku, a filtr danego kanału pozostaje bez zmian.
+ */
+void MainWindow::editFilters() {
+    const Channel channels[] = {Channel::Rpm, Channel::Pwm, Channel::Current, Channel::Voltage, Channel::Power};
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Filtry sygnałów"));
+    auto *layout = new QFormLayout(&dialog);
+    auto *hint = new QLabel(tr("Stopnie oddzielone przecinkami: median:<N>, ema:<alfa>, "
+                               "butter:<fc>:<fs>, kalman:<q>:<r>. Puste pole — bez filtrowania."), &dialog);
+    hint->setWordWrap(true);
+    layout->addRow(hint);
+
+    QLineEdit *edits[std::size(channels)];
+    for (size_t i = 0; i < std::size(channels); ++i) {
+        edits[i] = new QLineEdit(serialReader->channelFilter(channels[i]), &dialog);
+        layout->addRow(QString::fromLatin1(channelName(channels[i])), edits[i]);
+    }
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    for (size_t i = 0; i < std::size(channels); ++i) {
+        const QString spec = edits[i]->text().trimmed();
+        if (spec == serialReader->channelFilter(channels[i]))
+            continue;
+        QString error;
+        if (!serialReader->setChannelFilter(channels[i], spec, &error))
+            qDebug() << "Filtr kanału" << channelName(channels[i]) << ":" << error;
+    }
+}
+
+/**
+ * Nazwy kanałów jak w channelName(); opis łańcucha jak w signalfilter.h.
+ */
+bool MainWindow::setChannelFilter(const QString &assignment) {
+    const int separator = assignment.indexOf('=');
+    Channel channel;
+    if (separator < 0 || !channelFromName(assignment.left(separator).trimmed().toStdString(), channel)) {
+        qDebug() << "Niepoprawne przypisanie filtra (oczekiwano <kanał>=<opis>):" << assignment;
+        return false;
+    }
+    QString error;
+    if (!serialReader->setChannelFilter(channel, assignment.mid(separator + 1).trimmed(), &error)) {
+        qDebug() << "Filtr kanału" << channelName(channel) << ":" << error;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Okno zawiera pole tekstowe z jedną definicją kanału w wierszu. Błędy są zgłaszane w dzienniku,
+ * a przy błędzie dotychczasowe kanały pozostają bez zmian.
+ */
+void MainWindow::editDerivedChannels() {
+    QStringList definitions;
+    for (const DerivedChannel &channel : derivedChannels)
+        definitions << QString::fromStdString(channel.definition());
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Kanały pochodne"));
+    auto *layout = new QVBoxLayout(&dialog);
+    auto *hint = new QLabel(tr("Jeden kanał w wierszu: <nazwa> = <wyrażenie>. Dostępne: kanały (rpm, pwm, "
+                               "current, voltage, power, kp, ki, kd, mode), setpoint, + - * / ^, "
+                               "abs(), sqrt(), min(), max(). Np. moc_el = voltage * current / 1000"), &dialog);
+    hint->setWordWrap(true);
+    layout->addWidget(hint);
+    auto *edit = new QPlainTextEdit(definitions.join('\n'), &dialog);
+    layout->addWidget(edit);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QStringList edited;
+    for (const QString &line : edit->toPlainText().split('\n')) {
+        if (!line.trimmed().isEmpty())
+            edited << line.trimmed();
+    }
+    setDerivedChannels(edited);
+}
+
+/**
+ * Definicje kompilowane są przed usunięciem poprzednich kanałów. Każdy kanał dostaje własny wykres
+ * z osią Y dopasowywaną do wartości; koszt obliczenia jest mierzony na partii kopii ostatniej
+ * próbki i zapisywany w dzienniku.
+ */
+bool MainWindow::setDerivedChannels(const QStringList &definitions) {
+    std::vector<DerivedChannel> compiled;
+    for (const QString &definition : definitions) {
+        DerivedChannel channel;
+        std::string error;
+        if (!channel.parse(definition.toStdString(), error)) {
+            qDebug() << "Kanał pochodny:" << QString::fromStdString(error);
+            return false;
+        }
+        compiled.push_back(std::move(channel));
+    }
+
+    for (size_t i = 0; i < derivedChannels.size(); ++i)
+        charts->removeChart(derivedChartType(static_cast<int>(i)));
+    qDeleteAll(derivedChartHosts);
+    derivedChartHosts.clear();
+    derivedChannels = std::move(compiled);
+
+    const std::vector<SerialData> batch(16384, latestData);
+    std::vector<float> values(batch.size());
+    for (size_t i = 0; i < derivedChannels.size(); ++i) {
+        const DerivedChannel &channel = derivedChannels[i];
+        const QString name = QString::fromStdString(channel.name);
+
+        auto *host = new QWidget(ui->widgetDerivedGraphs);
+        host->setLayout(new QVBoxLayout);
+        ui->widgetDerivedGraphs->layout()->addWidget(host);
+        derivedChartHosts << host;
+        const ChartType type = derivedChartType(static_cast<int>(i));
+        charts->setupChart(type, host->layout(), name, name, 1.0f, 5, true);
+        charts->setAutoRange(type, true);
+
+        QElapsedTimer timer;
+        timer.start();
+        channel.expression.evaluate(batch.data(), batch.size(), static_cast<float>(targetRpm), values.data());
+        qDebug() << "Kanał pochodny" << name << "=" << QString::fromStdString(channel.expression.text()) << ":"
+                 << channel.expression.instructionCount() << "instrukcji,"
+                 << static_cast<double>(timer.nsecsElapsed()) / batch.size() << "ns/próbkę";
+    }
+    ui->widgetDerivedGraphs->setVisible(!derivedChannels.empty());
+    return true;
+}
+
+/**
+ * Okno zawiera pole tekstowe z jedną regułą w wierszu. Błędy są zgłaszane w dzienniku,
+ * a przy błędzie dotychczasowe reguły pozostają bez zmian.
+ */
+void MainWindow::editLimits() {
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Limity alarmowe"));
+    auto *layout = new QVBoxLayout(&dialog);
+    auto *hint = new QLabel(tr("Jedna reguła w wierszu: <kanał>><wartość>, <kanał><<wartość> lub "
+                               "d(<kanał>)><wartość> [1/s], z flagami :stop (zatrzymanie awaryjne) "
+                               "i :n=<N> (N kolejnych próbek). Np. current>900:stop"), &dialog);
+    hint->setWordWrap(true);
+    layout->addWidget(hint);
+    auto *edit = new QPlainTextEdit(serialReader->limitRules().join('\n'), &dialog);
+    layout->addWidget(edit);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    setLimitRules(edit->toPlainText().split('\n'));
+}
+
+bool MainWindow::setLimitRules(const QStringList &specs) {
+    QString error;
+    if (!serialReader->setLimitRules(specs, &error)) {
+        qDebug() << "Limit alarmowy:" << error;
+        return false;
+    }
+    qDebug() << "Limity alarmowe:" << serialReader->limitRules();
+    return true;
+}
+
+bool MainWindow::setBackpressure(const QString &policy, int queueFrames, qint64 readBufferBytes) {
+    BackpressurePolicy parsed;
+    if (!SampleQueue::parsePolicy(policy.toStdString(), parsed)) {
+        qDebug() << "Nieznana polityka przeciążenia:" << policy << "(oldest, newest, decimate)";
+        return false;
+    }
+    serialReader->setBackpressurePolicy(parsed);
+    if (queueFrames > 0)
+        serialReader->setDeliveryQueueSize(static_cast<size_t>(queueFrames));
+    if (readBufferBytes >= 0)
+        serialReader->setReadBufferSize(readBufferBytes);
+    qDebug() << "Polityka przeciążenia:" << policy << "kolejka" << queueFrames << "próbek, bufor odczytu" << readBufferBytes << "B";
+    return true;
+}
+
+/**
+ * Historia surowa i po filtrach używają tego samego zapisu; błąd kwantyzacji kanałów jest
+ * raportowany przy rozłączeniu (handlePortDisconnected()).
+ */
+bool MainWindow::setHistoryEncoding(const QString &encoding, const QStringList &resolutions) {
+    HistoryEncoding parsed;
+    if (!HistoryStore::parseEncoding(encoding.toStdString(), parsed)) {
+        qDebug() << "Nieznany zapis historii:" << encoding << "(gorilla, quantized)";
+        return false;
+    }
+    std::vector<std::pair<Channel, float>> lsb;
+    for (const QString &assignment : resolutions) {
+        const int separator = assignment.indexOf('=');
+        Channel channel;
+        bool ok = false;
+        const float value = separator < 0 ? 0.0f : assignment.mid(separator + 1).trimmed().toFloat(&ok);
+        if (!ok || value < 0.0f || !channelFromName(assignment.left(separator).trimmed().toStdString(), channel)) {
+            qDebug() << "Niepoprawna rozdzielczość czujnika (oczekiwano <kanał>=<LSB>):" << assignment;
+            return false;
+        }
+        lsb.emplace_back(channel, value);
+    }
+    for (HistoryStore *store : {&history, &filteredHistory}) {
+        store->setEncoding(parsed);
+        for (const auto &[channel, value] : lsb)
+            store->setResolution(channel, value);
+    }
+    qDebug() << "Zapis historii:" << encoding << resolutions;
+    return true;
+}
+
+/**
+ * Przy 1 kHz i zapisie Gorilla blok 1024 próbek zajmuje kilkanaście KiB, więc domyślna
+ * retencja (defaultHistoryMinutes, defaultHistoryMegabytes) to rząd kilkuset MiB na obie historie.
+ */
+void MainWindow::setHistoryRetention(int minutes, int megabytes) {
+    for (HistoryStore *store : {&history, &filteredHistory})
+        store->setRetention(qMax(0, minutes) * 60 * qint64(1000000), qMax(0, megabytes) * qint64(1024 * 1024));
+    qDebug() << "Retencja historii:" << minutes << "min," << megabytes << "MiB";
+}
+
+/**
+ * Silnik został już zatrzymany w wątku odbioru — tutaj jedynie stan GUI jest uzgadniany
+ * z urządzeniem, a profil nastaw przerywany, aby nie wysłał kolejnych poleceń.
+ */
+void MainWindow::handleLimitExceeded(const QString &rule, float value, bool emergencyStop, qint64 reactionNs) {
+    LOG_WARNING("Przekroczony limit {}, wartość {}", rule.toUtf8(), value);
+    if (!emergencyStop)
+        return;
+
+    qDebug() << "Zatrzymanie awaryjne wysłane po" << reactionNs / 1000.0 << "us od odebrania danych";
+    profileRunner.stop();
+    isMotorRunning = false;
+    ui->pushButtonStartStop->setText("START");
+    {
+        const QSignalBlocker blocker(ui->SliderPWMManual);
+        ui->SliderPWMManual->setValue(0);
+    }
+    ui->label_8->setText(tr("ZATRZYMANIE AWARYJNE"));
+    ui->label_8->setStyleSheet("color: red; font-weight: bold;");
+    ui->actionClearEmergencyStop->setEnabled(true);
+}
+
+/**
+ * Pliki trafiają do katalogu alarms w danych aplikacji; nazwa zawiera czas zapisu.
+ */
+void MainWindow::saveAlarmRecords() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/alarms";
+    QDir().mkpath(dir);
+    int index = 0;
+    for (const AlarmRecord &record : serialReader->takeAlarmRecords()) {
+        const QString path = QString("%1/alarm_%2_%3.csv")
+                                 .arg(dir, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+                                 .arg(index++);
+        if (!record.writeCsv(path.toStdString())) {
+            qDebug() << "Nie udało się zapisać rekordu alarmu:" << path;
+            continue;
+        }
+        qDebug() << "Rekord alarmu" << QString::fromStdString(record.rule) << "zapisany:" << path
+                 << "wykrycie" << (record.detectedNs - record.arrivalNs) / 1000.0 << "us, polecenie"
+                 << (record.commandNs > 0 ? (record.commandNs - record.detectedNs) / 1000.0 : 0.0) << "us";
+    }
+    const LatencyHistogram &latency = serialReader->emergencyStopLatency();
+    if (latency.count() > 0)
+        qDebug() << "Wykrycie -> zatrzymanie: śr." << latency.meanNs() / 1000.0 << "us, p99"
+                 << latency.percentileNs(99) / 1000.0 << "us, maks." << latency.maxNs() / 1000.0 << "us";
+}
+
+void MainWindow::clearEmergencyStop() {
+    serialReader->clearEmergencyStop();
+    ui->actionClearEmergencyStop->setEnabled(false);
+    ui->label_8->setText(isPortConnected ? tr("połączono") : tr("nie połączono"));
+    ui->label_8->setStyleSheet(isPortConnected ? "color: green; font-weight: bold;" : "color: red; font-weight: bold;");
+}
+
+/**
+ * Plik trafia do katalogu sessions w danych aplikacji; nazwa zawiera czas rozpoczęcia.
+ */
+void MainWindow::setSessionRecording(bool enabled) {
+    if (!enabled) {
+        stopSessionRecording();
+        return;
+    }
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/sessions";
+    QDir().mkpath(dir);
+    const QString path = QString("%1/session_%2.wds").arg(dir, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    if (!startSessionRecording(path)) {
+        const QSignalBlocker blocker(ui->actionRecordSession);
+        ui->actionRecordSession->setChecked(false);
+    }
+}
+
+/**
+ * Nagrywane są dane surowe (przed filtrami kanałów); statystyki łącza w stopce pliku
+ * obejmują tylko czas nagrania.
+ */
+bool MainWindow::startSessionRecording(const QString &path) {
+    stopSessionRecording();
+    if (!sessionWriter.open(path)) {
+        qDebug() << "Nie udało się utworzyć pliku sesji" << path << ":" << sessionWriter.errorString();
+        return false;
+    }
+    const TelemetryMetrics &metrics = serialReader->metrics();
+    recordingLinkStart = {metrics.frames(), metrics.checksumErrors(), metrics.droppedBytes()};
+    const QSignalBlocker blocker(ui->actionRecordSession);
+    ui->actionRecordSession->setChecked(true);
+    qDebug() << "Nagrywanie sesji:" << path;
+    return true;
+}
+
+void MainWindow::stopSessionRecording() {
+    if (!sessionWriter.isOpen())
+        return;
+    const TelemetryMetrics &metrics = serialReader->metrics();
+    sessionWriter.setLinkStats({metrics.frames() - recordingLinkStart.frames,
+                                metrics.checksumErrors() - recordingLinkStart.checksumErrors,
+                                metrics.droppedBytes() - recordingLinkStart.droppedBytes});
+    const QString path = sessionWriter.fileName();
+    const qint64 samples = sessionWriter.sampleCount();
+    if (sessionWriter.close())
+        qDebug() << "Zapisano nagranie sesji" << path << "próbek:" << samples;
+    else
+        qDebug() << "Błąd zapisu nagrania sesji" << path << ":" << sessionWriter.errorString();
+    const QSignalBlocker blocker(ui->actionRecordSession);
+    ui->actionRecordSession->setChecked(false);
+}
+
+/**
+ * Każde wywołanie otwiera osobne okno (usuwane po zamknięciu).
+ */
+void MainWindow::openSessionViewer(const QStringList &paths) {
+    auto *viewer = new SessionViewer(this);
+    for (const QString &path : paths)
+        viewer->openSession(path);
+    viewer->show();
+}
+
+/**
+ * Polecenia wysyłane są z wątku profilu przez SerialReader::postCommand(); zakończenie
+ * jest przekazywane do wątku GUI.
+ */
+void MainWindow::runProfile() {
+    if (!isPortConnected) {
+        qDebug() << "Profil nastaw wymaga połączenia z urządzeniem";
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(this, tr("Uruchom profil nastaw"), QString(),
+                                                      tr("Profil nastaw (*.txt *.profile);;Wszystkie pliki (*)"));
+    if (path.isEmpty())
+        return;
+
+    SetpointProfile profile;
+    std::string error;
+    if (!profile.load(path.toStdString(), error)) {
+        qDebug() << "Błąd profilu nastaw:" << QString::fromStdString(error);
+        return;
+    }
+
+    profilePath = path;
+    ui->actionStopProfile->setEnabled(true);
+    qDebug() << "Start profilu" << path << "poleceń:" << profile.steps().size()
+             << "czas:" << profile.durationUs() / 1e6 << "s";
+    profileRunner.start(
+        profile,
+        [this](const ProfileStep &step, ProfileRunner::WrittenCallback onWritten) {
+            serialReader->postCommand(static_cast<DataType>(step.type), step.value, std::move(onWritten));
+        },
+        [this](bool completed) {
+            QMetaObject::invokeMethod(this, [this, completed]() { handleProfileFinished(completed); }, Qt::QueuedConnection);
+        });
+}
+
+void MainWindow::stopProfile() {
+    profileRunner.stop();
+}
+
+/**
+ * Dziennik wykonania zapisywany jest obok pliku profilu z rozszerzeniem .log.csv. Wywołanie stop()
+ * dołącza zakończony wątek profilu i zamyka jego deskryptory. Polecenie, które w tej chwili czeka
+ * jeszcze w kolejce wątku portu, ma w dzienniku puste pole written_us.
+ */
+void MainWindow::handleProfileFinished(bool completed) {
+    if (profileRunner.isRunning())
+        return;
+    profileRunner.stop();
+    ui->actionStopProfile->setEnabled(false);
+    qDebug() << (completed ? "Profil zakończony:" : "Profil przerwany:")
+             << QString::fromStdString(profileRunner.jitterSummary());
+
+    const QString logPath = profilePath + ".log.csv";
+    if (profileRunner.writeLog(logPath.toStdString()))
+        qDebug() << "Dziennik profilu:" << logPath;
+}
+
+/**
+ * Wywoływana po nagłym odłączeniu urządzenia (ResourceError). Zapamiętuje prędkość, tryb
+ * i nastawy, resetuje GUI jak przy rozłączeniu i czeka na ponowne pojawienie się urządzenia.
+ */
+void MainWindow::handleDeviceLost() {
+    savedSession.baudRate = currentBaudRate;
+    savedSession.manualMode = isManualMode;
+    savedSession.motorRunning = isMotorRunning;
+    savedSession.pwmPercent = ui->SliderPWMManual->value();
+    savedSession.targetRpm = targetRpm;
+    savedSession.kp = latestData.kp;
+    savedSession.ki = latestData.ki;
+    savedSession.kd = latestData.kd;
+    savedSession.gainsKnown = telemetryReceived;
+
+    handlePortDisconnected();
+
+    reconnectPending = true;
+    reconnectTimer.start();
+    ui->label_8->setText(tr("oczekiwanie na urządzenie"));
+    ui->label_8->setStyleSheet("color: orange; font-weight: bold;");
+
+    // Urządzenie może wrócić pod tą samą ścieżką przed kolejnym skanowaniem
+    handlePortRemoved(connectedDevice.systemLocation);
+    portWatcher->forgetPort(connectedDevice.systemLocation);
+}
 
-        // Filtrowanie: pokaż tylko porty zawierające "USB" lub "COM"
-        QString name = info.systemLocation();
+/**
+ * Węzeł /dev może pojawić się przed nadaniem uprawnień przez udev, dlatego nieudane
+ * otwarcie portu jest ponawiane kilka razy co reconnectRetryMs.
+ * Po połączeniu przywracane są zapamiętane ustawienia i raportowany jest czas ponownego połączenia.
+ */
+void MainWindow::reconnectDevice(const PortDescriptor &port, int attempt) {
+    constexpr int reconnectRetries = 5;
+    constexpr int reconnectRetryMs = 200;
+
+    if (!reconnectPending || isPortConnected)
+        return;
 
-        if (name.contains("ttyUSB") || name.contains("ttyACM") || name.contains("COM")) {
-            ui->comboBoxSelectPort->addItem(info.systemLocation());
+    serialReader->stop();
+    serialReader->start(port.systemLocation, savedSession.baudRate);
+    if (!serialReader->isOpen()) {
+        if (attempt + 1 < reconnectRetries) {
+            QTimer::singleShot(reconnectRetryMs, this, [this, port, attempt]() { reconnectDevice(port, attempt + 1); });
         }
+        return;
+    }
+
+    ui->comboBoxSelectPort->setCurrentText(port.systemLocation);
+    markConnected(port.systemLocation);
+    restoreSession();
+    serialReader->metrics().addReconnect();
+
+    const qint64 reconnectMs = reconnectTimer.elapsed();
+    qDebug() << "Ponowne połączenie z" << port.systemLocation << "po" << reconnectMs << "ms";
+    ui->label_8->setText(tr("połączono ponownie (%1 ms)").arg(reconnectMs));
+}
+
+/**
+ * Przywraca tryb pracy, nastawy PWM/RPM oraz parametry PID sprzed odłączenia.
+ * Po handlePortDisconnected() GUI jest w trybie ręcznym z zatrzymanym silnikiem i tak pozostaje:
+ * stan urządzenia po utracie łącza jest nieznany, więc wysyłane jest zatrzymanie, a silnik
+ * uruchamia dopiero użytkownik przyciskiem START. Nastawy PID wysyłane są przed wartościami
+ * zadanymi i tylko wtedy, gdy pochodzą z telemetrii (również wartości zerowe).
+ */
+void MainWindow::restoreSession() {
+    serialReader->sendData(DataType::start_stop, 0.0f);
+
+    if (!savedSession.manualMode) {
+        on_buttonToggleMode_clicked();
     }
+
+    if (savedSession.gainsKnown) {
+        serialReader->sendData(DataType::Kp, savedSession.kp);
+        serialReader->sendData(DataType::Ki, savedSession.ki);
+        serialReader->sendData(DataType::Kd, savedSession.kd);
+    }
+
+    if (savedSession.manualMode) {
+        ui->SliderPWMManual->setValue(savedSession.pwmPercent);
+    } else if (savedSession.targetRpm > 0) {
+        serialReader->sendData(DataType::RPM, savedSession.targetRpm);
+        targetRpm = savedSession.targetRpm;
+    }
+
+    if (savedSession.motorRunning)
+        LOG_WARNING("Silnik pracował przed odłączeniem urządzenia — pozostaje zatrzymany, uruchom go przyciskiem START");
 }
 
 /**
@@ -264,6 +932,8 @@ void MainWindow::refreshSerialPortList() {
  */
 void MainWindow::handlePortDisconnected() {
     isPortConnected = false;
+    serialReader->metrics().setConnected(false);
+    reconnectPending = false;
     ui->label_8->setText(tr("nie połączono"));
     ui->label_8->setStyleSheet("color: red; font-weight: bold;");
     ui->pushButtonConnectPort->setText(tr("Połącz"));
@@ -284,6 +954,19 @@ void MainWindow::handlePortDisconnected() {
     ui->widgetSetrpermin->setVisible(false);    
     ui->SliderPWMManual->setValue(0);
     serialReader->stop();
+
+    qDebug().noquote() << serialReader->latencySummary();
+    qDebug() << "Historia:" << history.sampleCount() << "próbek,"
+             << history.bytesPerSample() << "B/próbkę w blokach skompresowanych"
+             << "(" << HistoryStore::encodingName(history.encoding()) << "), usunięto przez retencję"
+             << history.evictedSamples();
+    if (history.encoding() == HistoryEncoding::Quantized) {
+        for (int c = 0; c < channelCount; ++c) {
+            const Channel channel = static_cast<Channel>(c);
+            if (history.maxQuantizationError(channel) > 0.0f)
+                qDebug() << "  maks. błąd kwantyzacji" << channelName(channel) << ":" << history.maxQuantizationError(channel);
+        }
+    }
 }
 
 /**
@@ -311,19 +994,43 @@ void MainWindow::on_buttonSavePID_clicked() {
     }
 }
 
+/**
+ * Nastawy trafiają tylko do pól edycji — wysyła je dopiero przycisk zapisu (on_buttonSavePID_clicked()),
+ * więc użytkownik może je poprawić przed wysłaniem.
+ */
+void MainWindow::applySuggestedGains(double kp, double ki, double kd) {
+    ui->editKp->setText(QString::number(kp, 'f', 4));
+    ui->editKi->setText(QString::number(ki, 'f', 4));
+    ui->editKd->setText(QString::number(kd, 'f', 4));
+    LOG_INFO("Wpisano nastawy z identyfikacji obiektu: Kp {}, Ki {}, Kd {}", kp, ki, kd);
+}
+
 /**
  * Funkcja łączy sygnały interfejsu użytkownika (przyciski, suwaki, akcje menu) z odpowiednimi slotami
  * obsługującymi logikę aplikacji. Umożliwia również obsługę komunikacji z mikrokontrolerem (odbiór danych,
  * obsługa błędów, obsługa rozłączenia portu). Funkcja wywoływana jest podczas inicjalizacji MainWindow.
  */
 void MainWindow::connectSignals(){
-    connect(serialReader, &SerialReader::newDataReceived, this, &MainWindow::handleNewSerialData);
+    // Próbki porcjami z magistral (funkcja zwrotna w wątku GUI, jedna na porcję): wszystkie do historii
+    // i nagrania, a po polityce kolejki do wyświetlania
+    sampleSubscription = serialReader->dataBus().subscribe(
+        [this](const SamplePair *samples, size_t count, uint64_t) { handleSampleBatch(samples, count); });
+    displaySubscription = serialReader->displayBus().subscribe(
+        [this](const SamplePair *samples, size_t count, uint64_t) { handleDisplayBatch(samples, count); });
 
     // Obsługa błędów komunikacji szeregowej
     connect(serialReader, &SerialReader::errorOccurred, this, &MainWindow::handleSerialError);
 
     // Obsługa błedu przerwania połączenia
-    connect(serialReader, &SerialReader::portDisconnected, this, &MainWindow::handlePortDisconnected);
+    connect(serialReader, &SerialReader::portDisconnected, this, &MainWindow::handleDeviceLost);
+
+    // Przyrostowa aktualizacja listy portów z obserwatora działającego w tle
+    connect(portWatcher, &PortWatcher::portAdded, this, &MainWindow::handlePortAdded);
+    connect(portWatcher, &PortWatcher::portRemoved, this, &MainWindow::handlePortRemoved);
+
+    // Wynik automatycznego wykrywania prędkości transmisji
+    connect(serialReader, &SerialReader::baudRateDetected, this, &MainWindow::handleBaudRateDetected);
+    connect(serialReader, &SerialReader::baudRateDetectionFailed, this, &MainWindow::handlePortDisconnected);
 
 
     // Obsługa zmiany wartości suwaka PWM
@@ -344,6 +1051,60 @@ void MainWindow::connectSignals(){
     connect(ui->actionPolski, &QAction::triggered, this, &MainWindow::switchToPolish);
     connect(ui->actionAngielski, &QAction::triggered, this, &MainWindow::switchToEnglish);
 
+    // Wybór transportu POSIX (epoll, ASYNC_LOW_LATENCY) — obowiązuje od następnego połączenia
+    ui->actionLowLatencyBackend->setVisible(PosixSerialTransport::isSupported());
+    connect(ui->actionLowLatencyBackend, &QAction::toggled, this, [this](bool enabled) {
+        serialReader->setBackend(enabled ? SerialBackend::Posix : SerialBackend::QtSerialPort);
+    });
+
+    // Publikowanie próbek innym procesom i odbiór ich poleceń (ShmTelemetryWriter)
+    ui->actionSharedMemory->setVisible(ShmTelemetryWriter::isSupported());
+    connect(ui->actionSharedMemory, &QAction::toggled, this, [this](bool enabled) {
+        if (!serialReader->setSharedMemoryEnabled(enabled)) {
+            const QSignalBlocker blocker(ui->actionSharedMemory);
+            ui->actionSharedMemory->setChecked(false);
+        }
+    });
+
+    // Wybór wykresów i trybu zbiorczego — ukryte wykresy nie są aktualizowane (ChartsManager)
+    for (QAction *action : {ui->actionCombinedChart, ui->actionShowPWMChart, ui->actionShowRPMChart,
+                            ui->actionShowVoltageChart, ui->actionShowCurrentChart, ui->actionShowPowerChart})
+        connect(action, &QAction::toggled, this, &MainWindow::updateChartVisibility);
+
+    // Łańcuchy filtrów kanałów (SerialReader::setChannelFilter())
+    connect(ui->actionSignalFilters, &QAction::triggered, this, &MainWindow::editFilters);
+    // Kanały pochodne (DerivedExpression) z własnymi wykresami
+    connect(ui->actionDerivedChannels, &QAction::triggered, this, &MainWindow::editDerivedChannels);
+
+    // Limity alarmowe sprawdzane w wątku odbioru; zatrzymanie awaryjne wysyła SerialReader
+    connect(ui->actionLimits, &QAction::triggered, this, &MainWindow::editLimits);
+    connect(ui->actionClearEmergencyStop, &QAction::triggered, this, &MainWindow::clearEmergencyStop);
+    ui->actionClearEmergencyStop->setEnabled(false);
+    connect(serialReader, &SerialReader::limitExceeded, this, &MainWindow::handleLimitExceeded);
+    connect(serialReader, &SerialReader::alarmRecorded, this, &MainWindow::saveAlarmRecords);
+
+    // Profil nastaw wykonywany w osobnym wątku
+    ui->actionStopProfile->setEnabled(false);
+    connect(ui->actionRunProfile, &QAction::triggered, this, &MainWindow::runProfile);
+    connect(ui->actionStopProfile, &QAction::triggered, this, &MainWindow::stopProfile);
+
+    connect(ui->actionRecordSession, &QAction::toggled, this, &MainWindow::setSessionRecording);
+    connect(ui->actionSessionViewer, &QAction::triggered, this, [this]() { openSessionViewer(); });
+
+    // Nagrywanie i zapis śladu wykonania (dostępne tylko w buildzie z WDS_TRACE)
+#ifdef WDS_TRACE
+    ui->actionTraceRecording->setChecked(Trace::isEnabled());
+    connect(ui->actionTraceRecording, &QAction::toggled, this, [](bool enabled) {
+        if (enabled)
+            Trace::clear();
+        Trace::setEnabled(enabled);
+    });
+    connect(ui->actionSaveTrace, &QAction::triggered, this, &MainWindow::saveTrace);
+#else
+    ui->actionTraceRecording->setVisible(false);
+    ui->actionSaveTrace->setVisible(false);
+#endif
+
 }
 
 /**
@@ -377,16 +1138,95 @@ void MainWindow::setupValidators() {
 
 /**
  * Ustawia zakresy, kolory, tytuły wykresów dla parametrów: PWM, RPM, napięcie, prąd, moc.
+ * Wykresy wstrzymane podczas ukrycia odtwarzane są z historii pomiarów (HistoryStore),
+ * w tej samej skali co w updateCharts().
  */
 void MainWindow::setupCharts() {
+    charts->setHistorySource([this](ChartType type, qreal fromSeconds, qreal toSeconds) {
+        if (type >= ChartType::Derived)
+            return derivedHistory(static_cast<int>(type) - static_cast<int>(ChartType::Derived), fromSeconds, toSeconds);
+        Channel channel = Channel::Rpm;
+        switch (type) {
+        case ChartType::PWM:     channel = Channel::Pwm; break;
+        case ChartType::RPM:     channel = Channel::Rpm; break;
+        case ChartType::Voltage: channel = Channel::Voltage; break;
+        case ChartType::Current: channel = Channel::Current; break;
+        case ChartType::Power:   channel = Channel::Power; break;
+        case ChartType::Derived: break;
+        }
+        QVector<QPointF> points = filteredHistory.channelPoints(channel, static_cast<qint64>(fromSeconds * 1e6),
+                                                        static_cast<qint64>(toSeconds * 1e6));
+        if (type == ChartType::PWM) {
+            for (QPointF &p : points)
+                p.setY(p.y() / 2.55);
+        }
+        return points;
+    });
     charts->setupChart(ChartType::PWM, ui->widgetPWMGraph->layout(), "PWM", "PWM [%]", 110, 5, false);
     charts->setupChart(ChartType::RPM, ui->widgetRPMGraph->layout(), "RPM", "obr/min", 600, 5, false);
     charts->setupChart(ChartType::Voltage, ui->widgetVoltageGraph->layout(), tr("Napięcie"), "V", 8.5, 5, false);
     charts->setupChart(ChartType::Current, ui->widgetCurrentGraph->layout(), tr("Prąd"), "mA", 800, 5, false);
     charts->setupChart(ChartType::Power, ui->widgetPowerGraph->layout(), tr("Moc"), "mW", 5500, 5, false);
+    charts->setupCombinedChart(ui->widgetCombinedGraph->layout(), tr("Wszystkie kanały"));
+    ui->widgetDerivedGraphs->setVisible(false);
+    updateChartVisibility();
 
 }
 
+/**
+ * Wyrażenie obliczane jest partiami na kolumnach wartości odczytanych z historii przefiltrowanej —
+ * dekodowane są tylko kanały używane przez wyrażenie. Setpoint przyjmuje bieżącą wartość zadaną.
+ */
+QVector<QPointF> MainWindow::derivedHistory(int index, qreal fromSeconds, qreal toSeconds) const {
+    QVector<QPointF> points;
+    if (index < 0 || index >= static_cast<int>(derivedChannels.size()))
+        return points;
+
+    const DerivedExpression &expression = derivedChannels[static_cast<size_t>(index)].expression;
+    std::vector<qint64> timesUs;
+    std::array<std::vector<float>, channelCount> columns;
+    filteredHistory.channelColumns(expression.inputs(), static_cast<qint64>(fromSeconds * 1e6),
+                                   static_cast<qint64>(toSeconds * 1e6), timesUs, columns);
+
+    const float *inputs[channelCount] = {};
+    for (int c = 0; c < channelCount; ++c)
+        inputs[c] = columns[c].data();
+    std::vector<float> values(timesUs.size());
+    expression.evaluate(inputs, values.size(), static_cast<float>(targetRpm), values.data());
+
+    points.reserve(static_cast<int>(values.size()));
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (std::isfinite(values[i]))
+            points.append(QPointF(timesUs[i] / 1e6, values[i]));
+    }
+    return points;
+}
+
+/**
+ * W trybie zbiorczym wykresy pojedyncze są ukryte (i przez to wstrzymane), a akcje kanałów
+ * pokazują/ukrywają serie na wykresie zbiorczym.
+ */
+void MainWindow::updateChartVisibility() {
+    const bool combinedMode = ui->actionCombinedChart->isChecked();
+    const struct {
+        ChartType type;
+        QAction *action;
+        QWidget *host;
+    } channels[] = {
+        {ChartType::PWM, ui->actionShowPWMChart, ui->widgetPWMGraph},
+        {ChartType::RPM, ui->actionShowRPMChart, ui->widgetRPMGraph},
+        {ChartType::Voltage, ui->actionShowVoltageChart, ui->widgetVoltageGraph},
+        {ChartType::Current, ui->actionShowCurrentChart, ui->widgetCurrentGraph},
+        {ChartType::Power, ui->actionShowPowerChart, ui->widgetPowerGraph},
+    };
+    for (const auto &channel : channels) {
+        const bool enabled = channel.action->isChecked();
+        channel.host->setVisible(enabled && !combinedMode);
+        charts->setCombinedSeriesVisible(channel.type, enabled);
+    }
+    ui->widgetCombinedGraph->setVisible(combinedMode);
+}
+
 /**
  * Timery:
  * - updateChartsTimer -> odświeża wykresy co 10 ms,
@@ -408,13 +1248,17 @@ void MainWindow::setupTimers() {
  * Ładuje plik tłumaczenia wds_motor_pl.qm i odświeża GUI.
  */
 void MainWindow::switchToPolish() {
+    TRACE_SCOPE("MainWindow::switchToPolish");
     qApp->removeTranslator(&translator);
     if (translator.load("../../i18n/wds_motor_pl.qm")) {
         qApp->installTranslator(&translator);
     } else {
         qDebug() << "Failed to load Polish translation!";
     }
-    ui->retranslateUi(this); // odświeżenie GUI
+    {
+        TRACE_SCOPE("Ui::retranslateUi");
+        ui->retranslateUi(this); // odświeżenie GUI
+    }
     this->setWindowTitle(tr("Sterowanie silnikiem"));
     retranslateCharts();
     ui->pushButtonToggleMode->setText(isManualMode ? tr("Tryb: Ręczny") : tr("Tryb: Automatyczny"));
@@ -425,13 +1269,17 @@ void MainWindow::switchToPolish() {
  * Ładuje plik tłumaczenia wds_motor_en_US.qm i odświeża GUI.
  */
 void MainWindow::switchToEnglish() {
+    TRACE_SCOPE("MainWindow::switchToEnglish");
     qApp->removeTranslator(&translator);
     if (translator.load("../../i18n/wds_motor_en_US.qm")) {
         qApp->installTranslator(&translator);
     } else {
         qDebug() << "Failed to load English translation!";
     }
-    ui->retranslateUi(this); // odświeżenie GUI
+    {
+        TRACE_SCOPE("Ui::retranslateUi");
+        ui->retranslateUi(this); // odświeżenie GUI
+    }
     this->setWindowTitle(tr("Sterowanie silnikiem"));
     retranslateCharts();
     ui->pushButtonToggleMode->setText(isManualMode ? tr("Tryb: Ręczny") : tr("Tryb: Automatyczny"));
@@ -456,4 +1304,5 @@ void MainWindow::retranslateCharts() {
 
     charts->setXAxisTitle(ChartType::RPM, tr("Czas [s]"));
     charts->setXAxisTitle(ChartType::PWM, tr("Czas [s]"));
+    charts->setCombinedTitle(tr("Wszystkie kanały"));
 }
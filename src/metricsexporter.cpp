@@ -0,0 +1,156 @@
+/**
+ * @file metricsexporter.cpp
+ * @brief Implementacja klasy MetricsExporter.
+ *
+ * Serwery QTcpServer/QLocalServer i gniazda klientów tworzone są w wątku eksportera
+ * (kontekst obiektu worker). Odpowiedź jest generowana z atomowych liczników TelemetryMetrics,
+ * więc jej koszt jest stały i niezależny od długości sesji.
+ */
+
+#include "../inc/metricsexporter.h"
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+namespace {
+/// Maksymalny czas oczekiwania na nagłówek żądania [ms].
+constexpr int requestTimeoutMs = 2000;
+/// Maksymalny rozmiar nagłówka żądania [B].
+constexpr int maxRequestBytes = 8192;
+}
+
+MetricsExporter::MetricsExporter(const TelemetryMetrics &metrics, QObject *parent)
+    : QObject{parent}, metrics(metrics) {}
+
+/**
+ * Serwery (i gniazda klientów) są dziećmi obiektu worker i usuwane są w wątku eksportera,
+ * po czym wątek jest zatrzymywany.
+ */
+MetricsExporter::~MetricsExporter() {
+    if (worker) {
+        QMetaObject::invokeMethod(worker, [this]() { qDeleteAll(worker->children()); }, Qt::BlockingQueuedConnection);
+        thread.quit();
+        thread.wait();
+        delete worker;
+    }
+}
+
+void MetricsExporter::ensureThread() {
+    if (worker)
+        return;
+
+    worker = new QObject;
+    worker->moveToThread(&thread);
+    thread.setObjectName("MetricsExporter");
+    thread.start();
+}
+
+/**
+ * Nasłuchiwanie tylko na 127.0.0.1 — metryki nie są udostępniane w sieci bez pośrednika.
+ */
+bool MetricsExporter::listenTcp(quint16 port) {
+    ensureThread();
+    bool ok = false;
+    QMetaObject::invokeMethod(worker, [this, port, &ok]() {
+        auto *server = new QTcpServer(worker);
+        if (!server->listen(QHostAddress::LocalHost, port)) {
+            qDebug() << "Eksporter metryk: nie można nasłuchiwać na porcie" << port << server->errorString();
+            delete server;
+            return;
+        }
+        connect(server, &QTcpServer::newConnection, worker, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection())
+                serveClient(socket);
+        });
+        ok = true;
+    }, Qt::BlockingQueuedConnection);
+
+    if (ok)
+        qDebug() << "Eksporter metryk: http://127.0.0.1:" + QString::number(port) + "/metrics";
+    return ok;
+}
+
+/**
+ * Dostęp do gniazda ograniczony jest do bieżącego użytkownika.
+ */
+bool MetricsExporter::listenLocal(const QString &path) {
+    ensureThread();
+    bool ok = false;
+    QMetaObject::invokeMethod(worker, [this, path, &ok]() {
+        QLocalServer::removeServer(path);
+        auto *server = new QLocalServer(worker);
+        server->setSocketOptions(QLocalServer::UserAccessOption);
+        if (!server->listen(path)) {
+            qDebug() << "Eksporter metryk: nie można utworzyć gniazda" << path << server->errorString();
+            delete server;
+            return;
+        }
+        connect(server, &QLocalServer::newConnection, worker, [this, server]() {
+            while (QLocalSocket *socket = server->nextPendingConnection())
+                serveClient(socket);
+        });
+        ok = true;
+    }, Qt::BlockingQueuedConnection);
+
+    if (ok)
+        qDebug() << "Eksporter metryk: gniazdo" << path;
+    return ok;
+}
+
+/**
+ * Obsługiwane jest minimalne HTTP: GET /metrics (lub /) zwraca metryki, inne ścieżki 404.
+ * Połączenie jest zamykane po odpowiedzi (HTTP/1.0). Klient, który nie wyśle nagłówka
+ * w ciągu requestTimeoutMs, jest rozłączany.
+ */
+void MetricsExporter::serveClient(QIODevice *socket) {
+    auto *request = new QByteArray;
+    auto *timeout = new QTimer(socket);
+    timeout->setSingleShot(true);
+    connect(timeout, &QTimer::timeout, socket, [socket]() { socket->close(); socket->deleteLater(); });
+    connect(socket, &QObject::destroyed, [request]() { delete request; });
+
+    auto respond = [this, socket, request, timeout]() {
+        request->append(socket->readAll());
+        if (!request->contains("\r\n\r\n") && !request->contains("\n\n")) {
+            if (request->size() > maxRequestBytes) {
+                socket->close();
+                socket->deleteLater();
+            }
+            return;
+        }
+        timeout->stop();
+        disconnect(socket, &QIODevice::readyRead, socket, nullptr);
+
+        const QList<QByteArray> requestLine = request->left(request->indexOf('\n')).trimmed().split(' ');
+        const QByteArray path = requestLine.size() >= 2 ? requestLine.at(1) : QByteArray();
+        QByteArray status = "200 OK";
+        QByteArray body;
+        if (requestLine.value(0) != "GET") {
+            status = "405 Method Not Allowed";
+        } else if (path == "/metrics" || path == "/") {
+            body = QByteArray::fromStdString(metrics.renderPrometheus());
+        } else {
+            status = "404 Not Found";
+        }
+
+        QByteArray response = "HTTP/1.0 " + status + "\r\n"
+                              "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n" + body;
+        socket->write(response);
+        connect(socket, &QIODevice::bytesWritten, socket, [socket]() {
+            if (socket->bytesToWrite() == 0) {
+                socket->close();
+                socket->deleteLater();
+            }
+        });
+    };
+
+    connect(socket, &QIODevice::readyRead, socket, respond);
+    timeout->start(requestTimeoutMs);
+    if (socket->bytesAvailable() > 0)
+        respond();
+}
@@ -0,0 +1,148 @@
+/**
+ * @file plantanalysisworker.cpp
+ * @brief Implementacja klasy PlantAnalysisWorker.
+ *
+ * Wątek analizy działa z normalnym priorytetem i nie korzysta z blokad SerialReader — jedynym
+ * punktem wspólnym są blokady magistral w DataBus::read().
+ */
+
+#include "../inc/plantanalysisworker.h"
+#include "../inc/trace.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+/// Typ polecenia PWM (DataType::PWM w serialreader.h).
+constexpr uint8_t pwmCommand = 0x01;
+/// Typ polecenia zadanej prędkości (DataType::RPM w serialreader.h).
+constexpr uint8_t rpmCommand = 0x02;
+/// Typ polecenia uruchomienia/zatrzymania silnika (DataType::start_stop w serialreader.h).
+constexpr uint8_t startStopCommand = 0x07;
+}
+
+PlantAnalysisWorker::~PlantAnalysisWorker() {
+    stop();
+}
+
+/**
+ * Próbki subskrybowane są od najstarszej dostępnej, a polecenia — od początku dziennika,
+ * aby pierwsza analiza obejmowała zmiany wejścia sprzed startu wątku.
+ */
+void PlantAnalysisWorker::start(DataBus<SamplePair> &samples, DataBus<CommandSample> &commands, ResultCallback onResult,
+                                const PlantIdentifierConfig &config, int periodMs) {
+    stop();
+
+    sampleBus = &samples;
+    commandBus = &commands;
+    resultCallback = std::move(onResult);
+    identifier = PlantIdentifier(config);
+    inputKnown = false;
+    lastPwm = CommandSample();
+    lastSetpoint = CommandSample();
+    lastStartStop = CommandSample();
+    samplesRead = 0;
+    analysedRevision = 0;
+    period = periodMs > 0 ? periodMs : defaultPeriodMs;
+    sampleSubscription = sampleBus->subscribe(DataBus<SamplePair>::Callback(), true);
+    commandSubscription = commandBus->subscribe(DataBus<CommandSample>::Callback(), true);
+
+    running = true;
+    worker = std::thread(&PlantAnalysisWorker::run, this);
+}
+
+void PlantAnalysisWorker::stop() {
+    {
+        const std::lock_guard<std::mutex> guard(wakeMutex);
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable())
+        worker.join();
+    if (sampleBus)
+        sampleBus->unsubscribe(sampleSubscription);
+    if (commandBus)
+        commandBus->unsubscribe(commandSubscription);
+    sampleBus = nullptr;
+    commandBus = nullptr;
+}
+
+/**
+ * Analiza wykonywana jest tylko wtedy, gdy od poprzedniej przybyły nowe komórki siatki,
+ * więc przy braku danych (port zamknięty) wątek jedynie odczytuje puste magistrale.
+ */
+void PlantAnalysisWorker::run() {
+    Trace::setThreadName("identyfikacja obiektu");
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (running) {
+        wake.wait_for(lock, std::chrono::milliseconds(period), [this]() { return !running; });
+        if (!running)
+            break;
+        lock.unlock();
+
+        if (collect()) {
+            TRACE_SCOPE("PlantAnalysisWorker::identify");
+            PlantEstimate estimate;
+            const auto start = std::chrono::steady_clock::now();
+            estimate.model = identifier.identify();
+            estimate.analysisMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            estimate.samples = samplesRead;
+            estimate.overruns = sampleBus->stats(sampleSubscription).overruns;
+            if (resultCallback)
+                resultCallback(estimate);
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * Polecenia odczytywane są przed próbkami, więc polecenie wysłane przed próbką jest już
+ * w identyfikatorze, gdy próbka zamyka komórkę; spóźnione polecenia PlantIdentifier i tak
+ * wstawia według czasu. Zatrzymanie silnika (start_stop = 0, także awaryjne) jest wejściem 0,
+ * a uruchomienie przywraca ostatnią nastawę; nastawy zmienione przy zatrzymanym silniku
+ * wchodzą do identyfikatora dopiero z uruchomieniem.
+ */
+bool PlantAnalysisWorker::collect() {
+    commandBus->read(commandSubscription, commandBatch);
+    for (const CommandSample &command : commandBatch) {
+        if (command.type == pwmCommand) {
+            lastPwm = command;
+            if (inputKnown && identifier.input() == PlantInput::Pwm && !isStopped())
+                identifier.addCommand(command.timeUs, command.value);
+        } else if (command.type == rpmCommand) {
+            lastSetpoint = command;
+            if (inputKnown && identifier.input() == PlantInput::Setpoint && !isStopped())
+                identifier.addCommand(command.timeUs, command.value);
+        } else if (command.type == startStopCommand) {
+            lastStartStop = command;
+            const CommandSample &last = identifier.input() == PlantInput::Pwm ? lastPwm : lastSetpoint;
+            if (inputKnown && (isStopped() || last.timeUs != 0))
+                identifier.addCommand(command.timeUs, isStopped() ? 0.0f : last.value);
+        }
+    }
+
+    sampleBus->read(sampleSubscription, sampleBatch);
+    samplesRead += sampleBatch.size();
+    for (const SamplePair &sample : sampleBatch) {
+        const PlantInput input = sample.raw.mode == 1 ? PlantInput::Setpoint : PlantInput::Pwm;
+        if (!inputKnown || input != identifier.input())
+            switchInput(input);
+        identifier.addMeasurement(sample.raw.timeUs, sample.raw.rpm);
+    }
+
+    if (identifier.revision() == analysedRevision)
+        return false;
+    analysedRevision = identifier.revision();
+    return true;
+}
+
+void PlantAnalysisWorker::switchInput(PlantInput input) {
+    identifier.reset(input);
+    inputKnown = true;
+    analysedRevision = 0;
+    const CommandSample &last = input == PlantInput::Pwm ? lastPwm : lastSetpoint;
+    if (isStopped())
+        identifier.addCommand(lastStartStop.timeUs, 0.0f);
+    else if (last.timeUs != 0)
+        identifier.addCommand(std::max(last.timeUs, lastStartStop.timeUs), last.value);
+}
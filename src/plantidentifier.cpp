@@ -0,0 +1,520 @@
+/**
+ * @file plantidentifier.cpp
+ * @brief Implementacja klasy PlantIdentifier.
+ *
+ * Wszystkie sumy równań normalnych liczone są w tym samym zakresie próbek dla każdego
+ * opóźnienia (k = D..N-2, D — największe opóźnienie), więc błędy resztowe różnych opóźnień
+ * są porównywalne. Sumy niezależne od opóźnienia liczone są bezpośrednio, sumy wejścia —
+ * z sum prefiksowych, a iloczyny wejścia i wyjścia — wprost dla małych okien, a powyżej
+ * progu directCostRatio z dwóch korelacji przez FFT (jedna transformata dwóch sygnałów).
+ * Dopasowanie błędu wyjścia kosztuje O(N) na iterację i jest wykonywane tylko dla kilkunastu
+ * opóźnień.
+ */
+
+#include "../inc/plantidentifier.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace {
+/// Najmniejsza liczba równań dopasowania (próbek siatki po odjęciu opóźnienia).
+constexpr size_t minEquations = 50;
+/// Najmniejsze dopasowanie symulacji modelu uznawane za wiarygodne [%].
+constexpr double minFitPercent = 50.0;
+/**
+ * Próg wyboru sum wprost: liczone są wprost, gdy (D+1)·E ≤ directCostRatio·S·log2 S
+ * (D — największe opóźnienie, E — liczba równań, S — rozmiar FFT). Przy stosunku 10–14 oba
+ * sposoby kosztują tyle samo w granicach szumu pomiaru, przy 20 korelacja przez FFT jest już
+ * prawie dwa razy szybsza (pomiar: tools/wds_plant_ident_sim). Domyślne okno 60 s co 10 ms
+ * (stosunek 11) liczone jest wprost, siatka 1 ms — przez FFT.
+ */
+constexpr double directCostRatio = 14.0;
+
+/**
+ * Iteracyjna FFT radix-2 w miejscu na osobnych tablicach części rzeczywistej i urojonej
+ * (rozmiar potęgą dwójki, czynniki obrotu z tablicy); inverse — transformata odwrotna bez
+ * dzielenia przez rozmiar. Mnożenie zapisane wprost omija wolne std::complex::operator*
+ * (sprawdzanie NaN/nieskończoności bez -ffast-math).
+ */
+void fft(std::vector<double> &re, std::vector<double> &im, bool inverse) {
+    const size_t n = re.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    const double pi = std::acos(-1.0);
+    std::vector<double> cosTable(n / 2);
+    std::vector<double> sinTable(n / 2);
+    for (size_t k = 0; k < n / 2; ++k) {
+        const double angle = 2.0 * pi * static_cast<double>(k) / static_cast<double>(n);
+        cosTable[k] = std::cos(angle);
+        sinTable[k] = inverse ? std::sin(angle) : -std::sin(angle);
+    }
+    for (size_t length = 2; length <= n; length <<= 1) {
+        const size_t half = length / 2;
+        const size_t stride = n / length;
+        for (size_t start = 0; start < n; start += length) {
+            for (size_t k = 0; k < half; ++k) {
+                const double wr = cosTable[k * stride];
+                const double wi = sinTable[k * stride];
+                const size_t even = start + k;
+                const size_t odd = even + half;
+                const double oddRe = re[odd] * wr - im[odd] * wi;
+                const double oddIm = re[odd] * wi + im[odd] * wr;
+                re[odd] = re[even] - oddRe;
+                im[odd] = im[even] - oddIm;
+                re[even] += oddRe;
+                im[even] += oddIm;
+            }
+        }
+    }
+}
+
+/**
+ * Korelacje x z dwoma sygnałami naraz: first + i·second w jednej transformacie, a ponieważ
+ * korelacja jest liniowa, a sygnały rzeczywiste, część rzeczywista wyniku to korelacja z first,
+ * a urojona — z second (trzy FFT zamiast sześciu).
+ */
+void correlatePair(const std::vector<double> &x, const std::vector<double> &first, const std::vector<double> &second,
+                   size_t maxLag, std::vector<double> &outFirst, std::vector<double> &outSecond) {
+    const size_t n = x.size();
+    size_t size = 2;
+    while (size < n + maxLag + 1)
+        size <<= 1;
+    std::vector<double> xRe(size, 0.0), xIm(size, 0.0), re(size, 0.0), im(size, 0.0);
+    std::copy(x.begin(), x.end(), xRe.begin());
+    std::copy(first.begin(), first.begin() + static_cast<std::ptrdiff_t>(std::min(n, first.size())), re.begin());
+    std::copy(second.begin(), second.begin() + static_cast<std::ptrdiff_t>(std::min(n, second.size())), im.begin());
+    fft(xRe, xIm, false);
+    fft(re, im, false);
+    for (size_t i = 0; i < size; ++i) {
+        // conj(X)·Z
+        const double r = xRe[i] * re[i] + xIm[i] * im[i];
+        const double j = xRe[i] * im[i] - xIm[i] * re[i];
+        re[i] = r;
+        im[i] = j;
+    }
+    fft(re, im, true);
+    outFirst.assign(maxLag + 1, 0.0);
+    outSecond.assign(maxLag + 1, 0.0);
+    for (size_t lag = 0; lag <= maxLag; ++lag) {
+        outFirst[lag] = re[lag] / static_cast<double>(size);
+        outSecond[lag] = im[lag] / static_cast<double>(size);
+    }
+}
+
+/**
+ * Te same sumy co correlatePair() dla y[k] i y[k+1] (k = maxDelay..n-2), liczone wprost dla
+ * każdego opóźnienia — O(N·D). Cztery sumy częściowe na iloczyn przerywają zależność kolejnych
+ * dodawań, więc pętla nie czeka na wynik poprzedniego dodawania.
+ */
+void directPair(const std::vector<double> &u, const std::vector<double> &y, size_t maxDelay, std::vector<double> &uy,
+                std::vector<double> &uy1) {
+    const size_t equations = y.size() - 1 - maxDelay;
+    const double *yk = y.data() + maxDelay;
+    uy.assign(maxDelay + 1, 0.0);
+    uy1.assign(maxDelay + 1, 0.0);
+    for (size_t d = 0; d <= maxDelay; ++d) {
+        const double *x = u.data() + (maxDelay - d);
+        double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+        size_t j = 0;
+        for (; j + 4 <= equations; j += 4) {
+            a0 += x[j] * yk[j];
+            b0 += x[j] * yk[j + 1];
+            a1 += x[j + 1] * yk[j + 1];
+            b1 += x[j + 1] * yk[j + 2];
+            a2 += x[j + 2] * yk[j + 2];
+            b2 += x[j + 2] * yk[j + 3];
+            a3 += x[j + 3] * yk[j + 3];
+            b3 += x[j + 3] * yk[j + 4];
+        }
+        for (; j < equations; ++j) {
+            a0 += x[j] * yk[j];
+            b0 += x[j] * yk[j + 1];
+        }
+        uy[d] = (a0 + a1) + (a2 + a3);
+        uy1[d] = (b0 + b1) + (b2 + b3);
+    }
+}
+
+/**
+ * Czy sumy wejścia i wyjścia liczyć wprost (directPair()) zamiast przez FFT (correlatePair()).
+ */
+bool preferDirect(size_t n, size_t maxDelay) {
+    size_t size = 2;
+    while (size < n + maxDelay + 1)
+        size <<= 1;
+    const double direct = static_cast<double>(maxDelay + 1) * static_cast<double>(n - 1 - maxDelay);
+    return direct <= directCostRatio * static_cast<double>(size) * std::log2(static_cast<double>(size));
+}
+
+/**
+ * Rozwiązuje układ 3x3 eliminacją Gaussa z wyborem elementu głównego.
+ * @return false dla układu osobliwego.
+ */
+bool solve3(double a[3][3], double b[3], double x[3]) {
+    for (int column = 0; column < 3; ++column) {
+        int pivot = column;
+        for (int row = column + 1; row < 3; ++row) {
+            if (std::fabs(a[row][column]) > std::fabs(a[pivot][column]))
+                pivot = row;
+        }
+        if (std::fabs(a[pivot][column]) < 1e-12)
+            return false;
+        std::swap(a[pivot], a[column]);
+        std::swap(b[pivot], b[column]);
+        for (int row = column + 1; row < 3; ++row) {
+            const double factor = a[row][column] / a[column][column];
+            for (int k = column; k < 3; ++k)
+                a[row][k] -= factor * a[column][k];
+            b[row] -= factor * b[column];
+        }
+    }
+    for (int row = 2; row >= 0; --row) {
+        double sum = b[row];
+        for (int k = row + 1; k < 3; ++k)
+            sum -= a[row][k] * x[k];
+        x[row] = sum / a[row][row];
+    }
+    return true;
+}
+/**
+ * Suma kwadratów błędu symulacji ŷ[k+1] = a·ŷ[k] + b·u[k-d] + c od ŷ[start] = y[start].
+ */
+double simulationError(const std::vector<double> &u, const std::vector<double> &y, size_t start, size_t delay,
+                       const double theta[3]) {
+    double simulated = y[start];
+    double error = 0.0;
+    for (size_t k = start; k + 1 < y.size(); ++k) {
+        simulated = theta[0] * simulated + theta[1] * u[k - delay] + theta[2];
+        error += (y[k + 1] - simulated) * (y[k + 1] - simulated);
+    }
+    return error;
+}
+
+/**
+ * Kilka kroków Gaussa-Newtona dla błędu symulacji (pochodne ŷ po a, b, c liczone rekurencyjnie
+ * razem z symulacją). Krok jest połowiony, dopóki nie zmniejsza błędu i zachowuje 0 < a < 1.
+ */
+void refineOutputError(const std::vector<double> &u, const std::vector<double> &y, size_t start, size_t delay,
+                       double theta[3]) {
+    constexpr int iterations = 8;
+    double error = simulationError(u, y, start, delay, theta);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        double normal[3][3] = {};
+        double gradient[3] = {};
+        double simulated = y[start];
+        double sa = 0.0, sb = 0.0, sc = 0.0;
+        for (size_t k = start; k + 1 < y.size(); ++k) {
+            sa = simulated + theta[0] * sa;
+            sb = u[k - delay] + theta[0] * sb;
+            sc = 1.0 + theta[0] * sc;
+            simulated = theta[0] * simulated + theta[1] * u[k - delay] + theta[2];
+            const double sensitivity[3] = {sa, sb, sc};
+            const double residual = y[k + 1] - simulated;
+            for (int i = 0; i < 3; ++i) {
+                gradient[i] += sensitivity[i] * residual;
+                for (int j = 0; j < 3; ++j)
+                    normal[i][j] += sensitivity[i] * sensitivity[j];
+            }
+        }
+        double step[3];
+        if (!solve3(normal, gradient, step))
+            return;
+        bool improved = false;
+        for (double scale = 1.0; scale > 1e-3 && !improved; scale /= 2.0) {
+            const double candidate[3] = {theta[0] + scale * step[0], theta[1] + scale * step[1], theta[2] + scale * step[2]};
+            if (!(candidate[0] > 0.0 && candidate[0] < 1.0))
+                continue;
+            const double candidateError = simulationError(u, y, start, delay, candidate);
+            if (candidateError < error) {
+                std::copy(candidate, candidate + 3, theta);
+                improved = error - candidateError > 1e-9 * error;
+                error = candidateError;
+                if (!improved)
+                    return;
+            }
+        }
+        if (!improved)
+            return;
+    }
+}
+}
+
+PlantIdentifier::PlantIdentifier(const PlantIdentifierConfig &config) : config(config) {
+    cellUs = std::max<int64_t>(1000, static_cast<int64_t>(std::llround(config.sampleS * 1e6)));
+    windowCells = std::max<size_t>(minEquations * 2, static_cast<size_t>(config.windowS * 1e6 / static_cast<double>(cellUs)));
+}
+
+void PlantIdentifier::reset(PlantInput input) {
+    source = input;
+    cells.clear();
+    frontIndex = 0;
+    openIndex = -1;
+    openSum = 0.0;
+    openCount = 0;
+    closedCells = 0;
+    commands.clear();
+}
+
+void PlantIdentifier::addCommand(int64_t timeUs, float value) {
+    if (!std::isfinite(value))
+        return;
+    const auto position = std::upper_bound(commands.begin(), commands.end(), timeUs,
+                                           [](int64_t time, const std::pair<int64_t, float> &command) { return time < command.first; });
+    commands.insert(position, {timeUs, value});
+}
+
+/**
+ * Pomiar spóźniony względem bieżącej komórki (np. po korekcie ClockSync) trafia do bieżącej komórki.
+ */
+void PlantIdentifier::addMeasurement(int64_t timeUs, float output) {
+    if (!std::isfinite(output))
+        return;
+    const int64_t index = timeUs / cellUs;
+    if (openIndex < 0) {
+        openIndex = index;
+        frontIndex = index;
+    } else if (index > openIndex) {
+        closeCells(index);
+    }
+    openSum += output;
+    ++openCount;
+}
+
+/**
+ * Przerwa dłuższa od okna usuwa całą siatkę. Po przycięciu okna usuwane są polecenia sprzed
+ * jego początku, z wyjątkiem ostatniego (wartość wejścia na początku okna).
+ */
+void PlantIdentifier::closeCells(int64_t index) {
+    const float value = openCount > 0 ? static_cast<float>(openSum / openCount) : (cells.empty() ? 0.0f : cells.back());
+    if (index - openIndex > static_cast<int64_t>(windowCells)) {
+        cells.clear();
+        frontIndex = index;
+    } else {
+        for (int64_t i = openIndex; i < index; ++i)
+            cells.push_back(value);
+        closedCells += static_cast<uint64_t>(index - openIndex);
+    }
+    openIndex = index;
+    openSum = 0.0;
+    openCount = 0;
+
+    while (cells.size() > windowCells) {
+        cells.pop_front();
+        ++frontIndex;
+    }
+    const int64_t windowStartUs = frontIndex * cellUs;
+    size_t stale = 0;
+    while (stale + 1 < commands.size() && commands[stale + 1].first <= windowStartUs)
+        ++stale;
+    if (stale > 0)
+        commands.erase(commands.begin(), commands.begin() + static_cast<std::ptrdiff_t>(stale));
+}
+
+double PlantIdentifier::commandAt(int64_t timeUs) const {
+    const auto position = std::upper_bound(commands.begin(), commands.end(), timeUs,
+                                           [](int64_t time, const std::pair<int64_t, float> &command) { return time < command.first; });
+    if (position == commands.begin())
+        return std::numeric_limits<double>::quiet_NaN();
+    return std::prev(position)->second;
+}
+
+/**
+ * Wejście komórki j to wartość polecenia na końcu komórki: pomiary są średnimi komórek
+ * (czas środka komórki), więc krok y[j] -> y[j+1] obejmuje wejście z przedziału wokół
+ * końca komórki j. Opóźnienie wybierane jest jako minimum błędu resztowego ARX wśród
+ * opóźnień z 0 < a < 1, a jakość modelu oceniana jest symulacją (błąd wyjścia, nie równania).
+ */
+PlantModel PlantIdentifier::identify() const {
+    PlantModel model;
+    model.input = source;
+    const double ts = static_cast<double>(cellUs) / 1e6;
+
+    if (commands.empty()) {
+        model.reason = "brak poleceń dla bieżącego wejścia";
+        return model;
+    }
+    size_t first = 0;
+    while (first < cells.size() && std::isnan(commandAt((frontIndex + static_cast<int64_t>(first) + 1) * cellUs)))
+        ++first;
+    const size_t n = cells.size() - first;
+    model.windowS = static_cast<double>(n) * ts;
+    if (n < minEquations + 2) {
+        model.reason = "za mało danych po pierwszym poleceniu";
+        return model;
+    }
+
+    std::vector<double> u(n);
+    std::vector<double> y(n);
+    double meanU = 0.0;
+    double meanY = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+        u[j] = commandAt((frontIndex + static_cast<int64_t>(first + j) + 1) * cellUs);
+        y[j] = cells[first + j];
+        if (j > 0 && std::fabs(u[j] - u[j - 1]) >= config.minStep)
+            ++model.steps;
+        meanU += u[j];
+        meanY += y[j];
+    }
+    if (model.steps == 0) {
+        model.reason = "brak zmian wejścia w oknie";
+        return model;
+    }
+    meanU /= static_cast<double>(n);
+    meanY /= static_cast<double>(n);
+    for (size_t j = 0; j < n; ++j) {
+        u[j] -= meanU;
+        y[j] -= meanY;
+    }
+
+    const size_t maxDelay = std::min(static_cast<size_t>(std::llround(config.maxDeadTimeS / ts)), n - 2 - minEquations);
+    const size_t equations = n - 1 - maxDelay;
+
+    // Sumy niezależne od opóźnienia (k = maxDelay..n-2)
+    double syy = 0.0, sy = 0.0, sy1y = 0.0, sy1 = 0.0, sy1y1 = 0.0;
+    std::vector<double> current(n, 0.0);
+    std::vector<double> next(n, 0.0);
+    for (size_t k = maxDelay; k + 1 < n; ++k) {
+        syy += y[k] * y[k];
+        sy += y[k];
+        sy1y += y[k + 1] * y[k];
+        sy1 += y[k + 1];
+        sy1y1 += y[k + 1] * y[k + 1];
+        current[k] = y[k];
+        next[k] = y[k + 1];
+    }
+    // Sumy prefiksowe wejścia: Σ u[k-d] dla k = maxDelay..n-2 to sumy u[maxDelay-d .. n-2-d]
+    std::vector<double> prefix(n + 1, 0.0);
+    std::vector<double> prefixSquares(n + 1, 0.0);
+    for (size_t j = 0; j < n; ++j) {
+        prefix[j + 1] = prefix[j] + u[j];
+        prefixSquares[j + 1] = prefixSquares[j] + u[j] * u[j];
+    }
+    // Σ u[k-d]·y[k] i Σ u[k-d]·y[k+1] dla wszystkich d naraz
+    std::vector<double> uy;
+    std::vector<double> uy1;
+    if (preferDirect(n, maxDelay))
+        directPair(u, y, maxDelay, uy, uy1);
+    else
+        correlatePair(u, current, next, maxDelay, uy, uy1);
+
+    // Model ARX dla każdego opóźnienia; arxError = +inf dla opóźnień bez stabilnego modelu
+    std::vector<std::array<double, 3>> arx(maxDelay + 1);
+    std::vector<double> arxError(maxDelay + 1, std::numeric_limits<double>::infinity());
+    size_t arxDelay = 0;
+    for (size_t d = 0; d <= maxDelay; ++d) {
+        const double su = prefix[n - 1 - d] - prefix[maxDelay - d];
+        const double suu = prefixSquares[n - 1 - d] - prefixSquares[maxDelay - d];
+        double normal[3][3] = {{syy, uy[d], sy}, {uy[d], suu, su}, {sy, su, static_cast<double>(equations)}};
+        double rhs[3] = {sy1y, uy1[d], sy1};
+        const double target[3] = {sy1y, uy1[d], sy1};
+        double *theta = arx[d].data();
+        if (!solve3(normal, rhs, theta))
+            continue;
+        if (!(theta[0] > 0.0 && theta[0] < 1.0) || theta[1] == 0.0)
+            continue;
+        arxError[d] = sy1y1 - (theta[0] * target[0] + theta[1] * target[1] + theta[2] * target[2]);
+        if (arxError[d] < arxError[arxDelay])
+            arxDelay = d;
+    }
+    if (!std::isfinite(arxError[arxDelay])) {
+        model.reason = "brak stabilnego modelu pierwszego rzędu";
+        return model;
+    }
+
+    // Opóźnienie i parametry z dopasowania błędu wyjścia (Gaussa-Newtona) startującego z ARX —
+    // przy szumie pomiaru ARX zaniża stałą czasową i zawyża opóźnienie, więc opóźnienia
+    // 0..arxDelay+2 przeszukiwane są od siatki zgrubnej do kroku 1
+    const size_t upper = std::min(maxDelay, arxDelay + 2);
+    std::vector<double> outputError(upper + 1, -1.0);
+    std::vector<std::array<double, 3>> refined(upper + 1);
+    double bestError = std::numeric_limits<double>::infinity();
+    size_t bestDelay = arxDelay;
+    auto evaluate = [&](size_t d) {
+        if (d > upper || outputError[d] >= 0.0)
+            return;
+        outputError[d] = std::numeric_limits<double>::infinity();
+        if (!std::isfinite(arxError[d]))
+            return;
+        refined[d] = arx[d];
+        refineOutputError(u, y, maxDelay, d, refined[d].data());
+        outputError[d] = simulationError(u, y, maxDelay, d, refined[d].data());
+        if (outputError[d] < bestError) {
+            bestError = outputError[d];
+            bestDelay = d;
+        }
+    };
+    size_t stride = std::max<size_t>(1, upper / 8);
+    for (size_t d = 0; d <= upper; d += stride)
+        evaluate(d);
+    evaluate(upper);
+    evaluate(arxDelay);
+    while (stride > 1) {
+        stride = (stride + 1) / 2;
+        const size_t center = bestDelay;
+        evaluate(center >= stride ? center - stride : 0);
+        evaluate(center + stride);
+    }
+    if (!std::isfinite(bestError)) {
+        model.reason = "brak stabilnego modelu pierwszego rzędu";
+        return model;
+    }
+    const double *best = refined[bestDelay].data();
+
+    const double a = best[0];
+    const double b = best[1];
+    model.gain = b / (1.0 - a);
+    model.timeConstantS = -ts / std::log(a);
+    model.deadTimeS = static_cast<double>(bestDelay) * ts;
+
+    double measuredMean = 0.0;
+    for (size_t k = maxDelay + 1; k < n; ++k)
+        measuredMean += y[k];
+    measuredMean /= static_cast<double>(n - 1 - maxDelay);
+    double spread = 0.0;
+    for (size_t k = maxDelay + 1; k < n; ++k)
+        spread += (y[k] - measuredMean) * (y[k] - measuredMean);
+    model.fitPercent = spread > 0.0 ? 100.0 * (1.0 - std::sqrt(bestError / spread)) : 0.0;
+    model.valid = model.fitPercent >= minFitPercent;
+    if (!model.valid)
+        model.reason = "słabe dopasowanie modelu";
+    return model;
+}
+
+/**
+ * Reguła IMC-PID dla FOPDT z przybliżeniem Padé opóźnienia; dla pętli zamkniętej (wejście —
+ * zadane RPM) model opisuje regulator razem z obiektem, więc nastawy nie są wyznaczane.
+ */
+PidSuggestion PlantIdentifier::suggestPid(const PlantModel &model, double lambdaS) {
+    PidSuggestion pid;
+    if (!model.valid || model.input != PlantInput::Pwm || model.gain == 0.0 || model.timeConstantS <= 0.0)
+        return pid;
+    const double t = model.timeConstantS;
+    const double theta = model.deadTimeS;
+    pid.lambdaS = lambdaS > 0.0 ? lambdaS : std::max(theta, t / 5.0);
+    pid.kp = (2.0 * t + theta) / (model.gain * (2.0 * pid.lambdaS + theta));
+    pid.ki = pid.kp / (t + theta / 2.0);
+    pid.kd = pid.kp * t * theta / (2.0 * t + theta);
+    pid.valid = true;
+    return pid;
+}
+
+/**
+ * Sygnały uzupełniane są zerami do potęgi dwójki nie mniejszej niż N + maxLag, więc korelacja
+ * kołowa jest równa liniowej dla przesunięć 0..maxLag.
+ */
+std::vector<double> PlantIdentifier::crossCorrelation(const std::vector<double> &x, const std::vector<double> &y, size_t maxLag) {
+    std::vector<double> result;
+    std::vector<double> unused;
+    correlatePair(x, y, std::vector<double>(), maxLag, result, unused);
+    return result;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file plantpanel.cpp
+ * @brief Implementacja klasy PlantPanel.
+ */
+
+#include "../inc/plantpanel.h"
+#include <QDoubleSpinBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+/**
+ * Układ: stan analizy, parametry modelu, wybór λ i nastawy z przyciskiem wpisania do pól PID.
+ */
+PlantPanel::PlantPanel(QWidget *parent) : QWidget(parent) {
+    statusLabel = new QLabel(tr("Oczekiwanie na dane"), this);
+    modelLabel = new QLabel(this);
+    modelLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    lambdaBox = new QDoubleSpinBox(this);
+    lambdaBox->setRange(0.0, 60.0);
+    lambdaBox->setDecimals(3);
+    lambdaBox->setSingleStep(0.01);
+    lambdaBox->setSuffix(" s");
+    lambdaBox->setSpecialValueText(tr("automatycznie"));
+    gainsLabel = new QLabel(this);
+    gainsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    applyButton = new QPushButton(tr("Wpisz do pól PID"), this);
+    applyButton->setEnabled(false);
+
+    auto *form = new QHBoxLayout;
+    form->addWidget(new QLabel(tr("Stała czasowa pętli zamkniętej λ:"), this));
+    form->addWidget(lambdaBox);
+    form->addStretch();
+    form->addWidget(applyButton);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(statusLabel);
+    layout->addWidget(new QLabel(tr("Model K·e^(-θs)/(T·s + 1):"), this));
+    layout->addWidget(modelLabel);
+    layout->addLayout(form);
+    layout->addWidget(gainsLabel);
+    layout->addStretch();
+
+    connect(lambdaBox, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &PlantPanel::updateSuggestion);
+    connect(applyButton, &QPushButton::clicked, this, [this]() {
+        if (suggestion.valid)
+            emit applyGainsRequested(suggestion.kp, suggestion.ki, suggestion.kd);
+    });
+    updateSuggestion();
+}
+
+void PlantPanel::showEstimate(const PlantEstimate &estimate) {
+    model = estimate.model;
+    statusLabel->setText(tr("Wejście: %1, okno %2 s, zmian wejścia: %3, analiza %4 ms, próbek %5 (pominięto %6)")
+                             .arg(model.input == PlantInput::Pwm ? tr("PWM (pętla otwarta)") : tr("zadane RPM (pętla zamknięta)"))
+                             .arg(model.windowS, 0, 'f', 1)
+                             .arg(model.steps)
+                             .arg(estimate.analysisMs, 0, 'f', 2)
+                             .arg(estimate.samples)
+                             .arg(estimate.overruns));
+    if (model.valid) {
+        modelLabel->setText(tr("K = %1 obr/min na jednostkę wejścia, T = %2 s, θ = %3 s, dopasowanie %4 %")
+                                .arg(model.gain, 0, 'f', 3)
+                                .arg(model.timeConstantS, 0, 'f', 3)
+                                .arg(model.deadTimeS, 0, 'f', 3)
+                                .arg(model.fitPercent, 0, 'f', 1));
+    } else {
+        modelLabel->setText(tr("Brak modelu: %1").arg(QString::fromStdString(model.reason)));
+    }
+    updateSuggestion();
+}
+
+/**
+ * Pola PID przyjmują tylko wartości nieujemne (walidator okna głównego), więc nastawy
+ * z ujemnym wzmocnieniem obiektu są pokazywane, ale nie można ich wpisać.
+ */
+void PlantPanel::updateSuggestion() {
+    suggestion = PlantIdentifier::suggestPid(model, lambdaBox->value());
+    if (suggestion.valid) {
+        gainsLabel->setText(tr("Nastawy IMC (λ = %1 s): Kp = %2, Ki = %3 1/s, Kd = %4 s")
+                                .arg(suggestion.lambdaS, 0, 'f', 3)
+                                .arg(suggestion.kp, 0, 'f', 4)
+                                .arg(suggestion.ki, 0, 'f', 4)
+                                .arg(suggestion.kd, 0, 'f', 4));
+    } else if (model.valid && model.input == PlantInput::Setpoint) {
+        gainsLabel->setText(tr("Nastawy wyznaczane są z danych trybu ręcznego (skoki PWM) — w trybie automatycznym "
+                               "model opisuje pętlę zamkniętą"));
+    } else {
+        gainsLabel->setText(tr("Nastawy: brak (potrzebne skoki PWM w trybie ręcznym)"));
+    }
+    applyButton->setEnabled(suggestion.valid && suggestion.kp >= 0.0 && suggestion.ki >= 0.0 && suggestion.kd >= 0.0);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file portwatcher.cpp
+ * @brief Implementacja klasy PortWatcher.
+ *
+ * Wszystkie operacje na liście portów, gnieździe netlink i timerach wykonywane są
+ * w wątku obserwatora (kontekst obiektu worker). Sygnały portAdded()/portRemoved()
+ * trafiają do GUI jako połączenia kolejkowane.
+ */
+
+#include "../inc/portwatcher.h"
+#include <QDebug>
+#include <QSerialPortInfo>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+/// Interwał odpytywania listy portów, gdy netlink jest niedostępny [ms].
+constexpr int pollIntervalMs = 1000;
+/// Opóźnienie enumeracji po zdarzeniu uevent (czas na utworzenie węzła /dev przez udev) [ms].
+constexpr int debounceMs = 150;
+}
+
+/**
+ * Numer seryjny i VID:PID mają pierwszeństwo; ścieżka portu jest porównywana tylko dla
+ * urządzeń bez identyfikatorów USB.
+ */
+bool PortDescriptor::sameDevice(const PortDescriptor &other) const {
+    if (hasIds && other.hasIds) {
+        if (vendorId != other.vendorId || productId != other.productId)
+            return false;
+        if (!serialNumber.isEmpty() || !other.serialNumber.isEmpty())
+            return serialNumber == other.serialNumber;
+        return true;
+    }
+    return systemLocation == other.systemLocation;
+}
+
+/**
+ * Rejestruje typ PortDescriptor, aby mógł być przekazywany między wątkami.
+ */
+PortWatcher::PortWatcher(QObject *parent) : QObject{parent} {
+    qRegisterMetaType<PortDescriptor>("PortDescriptor");
+}
+
+/**
+ * Zamknięcie gniazda odbywa się w wątku obserwatora, po czym wątek jest zatrzymywany.
+ */
+PortWatcher::~PortWatcher() {
+    if (worker) {
+        QMetaObject::invokeMethod(worker, [this]() { teardownMonitor(); }, Qt::BlockingQueuedConnection);
+        thread.quit();
+        thread.wait();
+        delete worker;
+    }
+}
+
+void PortWatcher::start() {
+    if (worker)
+        return;
+
+    worker = new QObject;
+    worker->moveToThread(&thread);
+    thread.setObjectName("PortWatcher");
+    thread.start();
+
+    QMetaObject::invokeMethod(worker, [this]() {
+        setupMonitor();
+        scan();
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * Filtrowanie: pokazywane są tylko porty zawierające "ttyUSB", "ttyACM" lub "COM".
+ */
+bool PortWatcher::isSupportedPort(const QString &systemLocation) {
+    return systemLocation.contains("ttyUSB") || systemLocation.contains("ttyACM") || systemLocation.contains("COM");
+}
+
+void PortWatcher::rescan() {
+    if (!worker)
+        return;
+    QMetaObject::invokeMethod(worker, [this]() { scan(); }, Qt::QueuedConnection);
+}
+
+void PortWatcher::forgetPort(const QString &systemLocation) {
+    if (!worker)
+        return;
+    QMetaObject::invokeMethod(worker, [this, systemLocation]() {
+        knownPorts.remove(systemLocation);
+        scan();
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * Na Linuksie otwierane jest gniazdo NETLINK_KOBJECT_UEVENT (grupa zdarzeń jądra).
+ * Jeśli się nie uda, lista portów jest odpytywana co pollIntervalMs.
+ */
+void PortWatcher::setupMonitor() {
+    debounceTimer = new QTimer(worker);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(debounceMs);
+    QObject::connect(debounceTimer, &QTimer::timeout, worker, [this]() { scan(); });
+
+#ifdef Q_OS_LINUX
+    netlinkFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (netlinkFd >= 0) {
+        sockaddr_nl address = {};
+        address.nl_family = AF_NETLINK;
+        address.nl_groups = 1; // zdarzenia jądra
+        if (bind(netlinkFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+            notifier = new QSocketNotifier(netlinkFd, QSocketNotifier::Read, worker);
+            QObject::connect(notifier, &QSocketNotifier::activated, worker, [this]() { readUevents(); });
+            return;
+        }
+        ::close(netlinkFd);
+        netlinkFd = -1;
+    }
+    qDebug() << "Netlink niedostępny, odpytywanie listy portów co" << pollIntervalMs << "ms";
+#endif
+
+    pollTimer = new QTimer(worker);
+    pollTimer->setInterval(pollIntervalMs);
+    QObject::connect(pollTimer, &QTimer::timeout, worker, [this]() { scan(); });
+    pollTimer->start();
+}
+
+void PortWatcher::teardownMonitor() {
+    delete notifier;
+    notifier = nullptr;
+    delete debounceTimer;
+    debounceTimer = nullptr;
+    delete pollTimer;
+    pollTimer = nullptr;
+#ifdef Q_OS_LINUX
+    if (netlinkFd >= 0) {
+        ::close(netlinkFd);
+        netlinkFd = -1;
+    }
+#endif
+}
+
+/**
+ * Komunikat uevent ma postać "ACTION@DEVPATH\0KLUCZ=WARTOŚĆ\0...".
+ * Enumeracja planowana jest tylko dla zdarzeń add/remove w podsystemie tty.
+ */
+void PortWatcher::readUevents() {
+#ifdef Q_OS_LINUX
+    char message[4096];
+    bool relevant = false;
+
+    for (;;) {
+        const ssize_t length = recv(netlinkFd, message, sizeof(message) - 1, 0);
+        if (length <= 0)
+            break;
+        message[length] = '\0';
+
+        bool tty = false;
+        bool addOrRemove = false;
+        for (ssize_t i = 0; i < length;) {
+            const QLatin1String field(message + i);
+            if (field == QLatin1String("SUBSYSTEM=tty"))
+                tty = true;
+            else if (field == QLatin1String("ACTION=add") || field == QLatin1String("ACTION=remove"))
+                addOrRemove = true;
+            i += field.size() + 1;
+        }
+        relevant = relevant || (tty && addOrRemove);
+    }
+
+    if (relevant)
+        debounceTimer->start();
+#endif
+}
+
+/**
+ * Porównuje aktualną listę portów z poprzednią i emituje tylko różnice.
+ */
+void PortWatcher::scan() {
+    QMap<QString, PortDescriptor> current;
+    const auto ports = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : ports) {
+        if (!isSupportedPort(info.systemLocation()))
+            continue;
+
+        PortDescriptor port;
+        port.systemLocation = info.systemLocation();
+        port.serialNumber = info.serialNumber();
+        port.description = info.description();
+        port.hasIds = info.hasVendorIdentifier() && info.hasProductIdentifier();
+        port.vendorId = info.vendorIdentifier();
+        port.productId = info.productIdentifier();
+        current.insert(port.systemLocation, port);
+    }
+
+    for (auto it = knownPorts.cbegin(); it != knownPorts.cend(); ++it) {
+        if (!current.contains(it.key()))
+            emit portRemoved(it.key());
+    }
+    for (auto it = current.cbegin(); it != current.cend(); ++it) {
+        if (!knownPorts.contains(it.key()))
+            emit portAdded(it.value());
+    }
+    knownPorts = current;
+}
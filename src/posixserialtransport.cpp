@@ -0,0 +1,262 @@
+/**
+ * @file posixserialtransport.cpp
+ * @brief Implementacja klasy PosixSerialTransport.
+ *
+ * Port otwierany jest w trybie nieblokującym i ustawiany w tryb surowy (cfmakeraw).
+ * VMIN ustawione na długość ramki przy VTIME = 0 powoduje, że epoll zgłasza gotowość
+ * dopiero po odebraniu całej ramki, co ogranicza liczbę wybudzeń wątku. Prędkość
+ * ustawiana jest przez termios2/BOTHER (serialtermios.h), więc działa dla dowolnej wartości.
+ */
+
+#include "../inc/posixserialtransport.h"
+#include "../inc/serialtermios.h"
+#include "../inc/trace.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+PosixSerialTransport::~PosixSerialTransport() {
+    close();
+}
+
+bool PosixSerialTransport::isSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * steady_clock na Linuksie odpowiada CLOCK_MONOTONIC; funkcja jest dostępna na wszystkich platformach,
+ * aby ścieżka QSerialPort mogła używać tego samego zegara do pomiaru opóźnień.
+ */
+int64_t PosixSerialTransport::monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Kolejność: open -> termios (tryb surowy, VMIN/VTIME) -> BOTHER -> ASYNC_LOW_LATENCY -> epoll -> wątek.
+ * Brak obsługi ASYNC_LOW_LATENCY przez sterownik nie jest błędem (np. CDC-ACM).
+ */
+bool PosixSerialTransport::open(const std::string &path, int baudRate, int minBytes, DataCallback onData, ErrorCallback onError) {
+#ifdef __linux__
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        lastError = std::strerror(errno);
+        return false;
+    }
+
+    termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        lastError = std::strerror(errno);
+        close();
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tio.c_cc[VMIN] = static_cast<cc_t>(minBytes < 1 ? 1 : (minBytes > 255 ? 255 : minBytes));
+    tio.c_cc[VTIME] = 0;
+    cfsetspeed(&tio, B115200);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        lastError = std::strerror(errno);
+        close();
+        return false;
+    }
+
+    if (!setCustomBaudRate(fd, baudRate)) {
+        lastError = "nieobsługiwana prędkość transmisji";
+        close();
+        return false;
+    }
+
+    serial_struct serialInfo;
+    lowLatency = false;
+    if (ioctl(fd, TIOCGSERIAL, &serialInfo) == 0) {
+        serialInfo.flags |= ASYNC_LOW_LATENCY;
+        lowLatency = ioctl(fd, TIOCSSERIAL, &serialInfo) == 0;
+    }
+    tcflush(fd, TCIFLUSH);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        lastError = std::strerror(errno);
+        close();
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    dataCallback = std::move(onData);
+    errorCallback = std::move(onError);
+    running = true;
+    reader = std::thread(&PosixSerialTransport::run, this);
+    return true;
+#else
+    (void)path; (void)baudRate; (void)minBytes; (void)onData; (void)onError;
+    lastError = "transport POSIX dostępny tylko na Linuksie";
+    return false;
+#endif
+}
+
+/**
+ * Wątek odczytu jest wybudzany przez eventfd i dołączany przed zamknięciem deskryptorów.
+ */
+void PosixSerialTransport::close() {
+#ifdef __linux__
+    if (reader.joinable()) {
+        running = false;
+        const uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) {
+            // Wątek i tak zakończy się po kolejnym zdarzeniu na porcie
+        }
+        if (reader.get_id() == std::this_thread::get_id())
+            reader.detach();
+        else
+            reader.join();
+    }
+    if (fd >= 0)
+        ::close(fd);
+    if (epollFd >= 0)
+        ::close(epollFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+#endif
+    fd = -1;
+    epollFd = -1;
+    wakeFd = -1;
+}
+
+/**
+ * Zapis pilny czekający na writeMutex ma pierwszeństwo — zwykły zapis ustępuje mu przed blokadą.
+ */
+bool PosixSerialTransport::write(const char *data, int size) {
+    while (urgentWriters.load() > 0)
+        std::this_thread::yield();
+    const std::lock_guard<std::mutex> lock(writeMutex);
+    return writeLocked(data, size, true);
+}
+
+/**
+ * Pierwsze tcflush() zwalnia miejsce w buforze, więc zapis trzymający writeMutex szybko
+ * się kończy (lub przerywa, widząc urgentWriters); drugie odrzuca to, co zdążył jeszcze dopisać.
+ */
+bool PosixSerialTransport::writeUrgent(const char *data, int size) {
+#ifdef __linux__
+    urgentWriters.fetch_add(1);
+    if (fd >= 0)
+        tcflush(fd, TCOFLUSH);
+    const std::lock_guard<std::mutex> lock(writeMutex);
+    urgentWriters.fetch_sub(1);
+    if (fd >= 0)
+        tcflush(fd, TCOFLUSH);
+    return writeLocked(data, size, false);
+#else
+    (void)data; (void)size;
+    return false;
+#endif
+}
+
+/**
+ * Zapis nieblokujący; przy zapełnionym buforze nadawczym czeka na gotowość portu (maks. 20 ms,
+ * w odcinkach 1 ms, aby zapis pilny nie czekał na koniec oczekiwania).
+ */
+bool PosixSerialTransport::writeLocked(const char *data, int size, bool interruptible) {
+#ifdef __linux__
+    int written = 0;
+    int waitedMs = 0;
+    while (fd >= 0 && written < size) {
+        if (interruptible && urgentWriters.load() > 0)
+            break;
+        const ssize_t n = ::write(fd, data + written, static_cast<size_t>(size - written));
+        if (n > 0) {
+            written += static_cast<int>(n);
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            pollfd pfd = {fd, POLLOUT, 0};
+            const int ready = poll(&pfd, 1, 1);
+            if ((ready < 0 && errno != EINTR) || (ready == 0 && ++waitedMs >= 20))
+                break;
+        } else {
+            break;
+        }
+    }
+    return written == size;
+#else
+    (void)data; (void)size; (void)interruptible;
+    return false;
+#endif
+}
+
+/**
+ * Czas odbioru mierzony jest zaraz po wybudzeniu z epoll_wait, przed odczytem danych.
+ * EPOLLHUP/EPOLLERR lub odczyt zwracający 0/EIO oznaczają odłączenie urządzenia.
+ */
+void PosixSerialTransport::run() {
+#ifdef __linux__
+    char chunk[4096];
+    epoll_event events[2];
+    Trace::setThreadName("odczyt portu (epoll)");
+
+    while (running) {
+        const int ready = epoll_wait(epollFd, events, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        const int64_t arrivalNs = monotonicNs();
+
+        for (int i = 0; i < ready && running; ++i) {
+            if (events[i].data.fd == wakeFd)
+                continue;
+
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                running = false;
+                if (errorCallback)
+                    errorCallback("urządzenie zostało odłączone");
+                return;
+            }
+
+            for (;;) {
+                const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+                if (n > 0) {
+                    if (dataCallback)
+                        dataCallback(chunk, static_cast<int>(n), arrivalNs);
+                    continue;
+                }
+                if (n < 0 && errno == EAGAIN)
+                    break;
+                if (n < 0 && errno == EINTR)
+                    continue;
+                running = false;
+                if (errorCallback)
+                    errorCallback(n == 0 ? "urządzenie zostało odłączone" : std::strerror(errno));
+                return;
+            }
+        }
+    }
+#endif
+}
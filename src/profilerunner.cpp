@@ -0,0 +1,233 @@
+/**
+ * @file profilerunner.cpp
+ * @brief Implementacja klasy ProfileRunner.
+ *
+ * Wątek profilu próbuje uzyskać priorytet czasu rzeczywistego (SCHED_FIFO); brak uprawnień
+ * nie jest błędem — timerfd z bezwzględnym terminem zapewnia na zwykłym jądrze Linuksa
+ * spóźnienia rzędu dziesiątek mikrosekund przy nieobciążonym systemie.
+ */
+
+#include "../inc/profilerunner.h"
+#include "../inc/trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <locale>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+/// Opóźnienie pierwszego terminu względem wywołania start() (czas na uruchomienie wątku) [ns].
+constexpr int64_t startLeadNs = 2000000;
+/// Maksymalny czas pojedynczego uśpienia w trybie bez timerfd (sprawdzanie przerwania) [ns].
+constexpr int64_t fallbackSliceNs = 10000000;
+
+int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+ProfileRunner::~ProfileRunner() {
+    stop();
+}
+
+void ProfileRunner::start(const SetpointProfile &profile, SendCallback onSend, FinishedCallback onFinished) {
+    stop();
+
+    steps = profile.steps();
+    wokeNs.assign(steps.size(), 0);
+    lateness.reset();
+    // Nowy obiekt — spóźnione zgłoszenia zapisu z poprzedniego wykonania trafiają do starego
+    writes = std::make_shared<WriteLog>();
+    writes->writtenNs.assign(steps.size(), 0);
+    sendCallback = std::move(onSend);
+    finishedCallback = std::move(onFinished);
+
+#ifdef __linux__
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+    running = true;
+    startNs = monotonicNs() + startLeadNs;
+    worker = std::thread(&ProfileRunner::run, this);
+}
+
+/**
+ * Wątek jest wybudzany przez eventfd. Wywołanie z wątku profilu (np. z FinishedCallback) nie może
+ * czekać na siebie, więc tylko przerywa pętlę; wątek pozostaje dołączalny, a deskryptory otwarte
+ * do kolejnego stop() z innego wątku (także z start() i destruktora).
+ */
+void ProfileRunner::stop() {
+    running = false;
+#ifdef __linux__
+    if (wakeFd >= 0) {
+        const uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) {
+            // Wątek zakończy się najpóźniej przy najbliższym terminie
+        }
+    }
+#endif
+    if (worker.joinable()) {
+        if (worker.get_id() == std::this_thread::get_id())
+            return;
+        worker.join();
+    }
+#ifdef __linux__
+    if (timerFd >= 0)
+        ::close(timerFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+#endif
+    timerFd = -1;
+    wakeFd = -1;
+}
+
+/**
+ * Spóźnienie wybudzenia mierzone jest tuż przed przekazaniem polecenia do SendCallback. Czas zapisu
+ * do portu zgłasza wysyłający przez WrittenCallback — przy QSerialPort dopiero po obsłużeniu
+ * polecenia w pętli zdarzeń wątku portu, więc różnica obu czasów to opóźnienie kolejkowania.
+ */
+void ProfileRunner::run() {
+    Trace::setThreadName("profil nastaw");
+#ifdef __linux__
+    sched_param param = {};
+    param.sched_priority = 10;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+
+    bool completed = true;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const int64_t deadlineNs = startNs + steps[i].timeUs * 1000;
+        if (!waitUntil(deadlineNs)) {
+            completed = false;
+            break;
+        }
+        const int64_t nowNs = monotonicNs();
+        wokeNs[i] = nowNs;
+        lateness.record(nowNs - deadlineNs);
+        if (sendCallback) {
+            std::shared_ptr<WriteLog> log = writes;
+            sendCallback(steps[i], [log, i, deadlineNs, nowNs](int64_t writtenNs) {
+                {
+                    std::lock_guard<std::mutex> lock(log->mutex);
+                    if (log->writtenNs[i] != 0)
+                        return;
+                    log->writtenNs[i] = writtenNs;
+                }
+                log->lateness.record(writtenNs - deadlineNs);
+                log->queue.record(writtenNs - nowNs);
+            });
+        }
+    }
+
+    running = false;
+    if (finishedCallback)
+        finishedCallback(completed);
+}
+
+bool ProfileRunner::waitUntil(int64_t deadlineNs) {
+    if (!running)
+        return false;
+#ifdef __linux__
+    if (timerFd >= 0 && wakeFd >= 0) {
+        itimerspec spec = {};
+        spec.it_value.tv_sec = deadlineNs / 1000000000;
+        spec.it_value.tv_nsec = deadlineNs % 1000000000;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+            spec.it_value.tv_nsec = 1;
+        timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+        pollfd fds[2] = {{timerFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        while (running) {
+            if (poll(fds, 2, -1) < 0)
+                continue;
+            if (fds[1].revents & POLLIN)
+                return false;
+            if (fds[0].revents & POLLIN) {
+                uint64_t expirations = 0;
+                if (::read(timerFd, &expirations, sizeof(expirations)) < 0) {
+                    // Licznik wygaśnięć nie jest potrzebny
+                }
+                return running;
+            }
+        }
+        return false;
+    }
+#endif
+    while (running) {
+        const int64_t remaining = deadlineNs - monotonicNs();
+        if (remaining <= 0)
+            return true;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(remaining < fallbackSliceNs ? remaining : fallbackSliceNs));
+    }
+    return false;
+}
+
+namespace {
+void appendHistogram(std::ostringstream &out, const char *label, const LatencyHistogram &histogram) {
+    out << label << " śr. " << histogram.meanNs() / 1000.0
+        << " µs, p50 " << static_cast<double>(histogram.percentileNs(50)) / 1000.0
+        << " µs, p99 " << static_cast<double>(histogram.percentileNs(99)) / 1000.0
+        << " µs, maks. " << static_cast<double>(histogram.maxNs()) / 1000.0 << " µs";
+}
+} // namespace
+
+std::string ProfileRunner::jitterSummary() const {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    out << "poleceń: " << lateness.count() << ", zapisanych: " << writes->lateness.count() << "; ";
+    appendHistogram(out, "spóźnienie zapisu", writes->lateness);
+    out << "; ";
+    appendHistogram(out, "spóźnienie wybudzenia", lateness);
+    out << "; ";
+    appendHistogram(out, "kolejkowanie", writes->queue);
+    return out.str();
+}
+
+/**
+ * Czasy w dzienniku liczone są od startu profilu [µs]; puste pola oznaczają polecenie niewysłane
+ * (woke_us) lub niezapisane do portu (written_us).
+ */
+bool ProfileRunner::writeLog(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out.imbue(std::locale::classic());
+
+    std::vector<int64_t> writtenNs;
+    {
+        std::lock_guard<std::mutex> lock(writes->mutex);
+        writtenNs = writes->writtenNs;
+    }
+
+    const auto appendTime = [&](int64_t ns, size_t i) {
+        if (ns != 0) {
+            const int64_t sinceStartNs = ns - startNs;
+            out << sinceStartNs / 1000 << ',' << static_cast<double>(sinceStartNs - steps[i].timeUs * 1000) / 1000.0;
+        } else {
+            out << ',';
+        }
+    };
+
+    out << "index,deadline_us,woke_us,wake_lateness_us,written_us,write_lateness_us,type,value\n";
+    for (size_t i = 0; i < steps.size(); ++i) {
+        out << i << ',' << steps[i].timeUs << ',';
+        appendTime(wokeNs[i], i);
+        out << ',';
+        appendTime(i < writtenNs.size() ? writtenNs[i] : 0, i);
+        out << ',' << static_cast<int>(steps[i].type) << ',' << steps[i].value << '\n';
+    }
+    return static_cast<bool>(out);
+}
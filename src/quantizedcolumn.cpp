@@ -0,0 +1,167 @@
+/**
+ * @file quantizedcolumn.cpp
+ * @brief Implementacja klasy QuantizedColumn.
+ *
+ * Obliczenia zakresu i kroku wykonywane są w double, a odczyt w float tym samym kodem
+ * (dequantize()), którym błąd jest mierzony przy kodowaniu.
+ */
+
+#include "../inc/quantizedcolumn.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double levelSpan = 65534.0;      ///< Liczba przedziałów int16 (symetrycznie -32767..32767).
+constexpr double narrowSpan = 253.0;       ///< Zakres bloku [kroki] zapisywany w int8 (z zapasem na siatkę LSB).
+constexpr double exactInteger = 16777216.0; ///< 2^24 — największa liczba całkowita dokładna w float.
+
+/**
+ * Zapisuje poziom w kolumnie int16 lub int8 (z obcięciem do zakresu typu).
+ */
+void store(std::vector<int16_t> &levels, std::vector<int8_t> &narrow, size_t i, double q) {
+    if (!narrow.empty())
+        narrow[i] = static_cast<int8_t>(std::clamp(q, -127.0, 127.0));
+    else
+        levels[i] = static_cast<int16_t>(std::clamp(q, -32767.0, 32767.0));
+}
+
+/**
+ * Pętla wewnętrzna o stałej długości jest wektoryzowana także przy -O2 (GCC 12+ wektoryzuje
+ * wtedy tylko pętle bez reszty); pozostałe elementy przeliczane są pojedynczo.
+ */
+template <typename Level>
+void dequantizeLevels(const Level *in, size_t count, float offset, float step, float *out) {
+    constexpr size_t lanes = 16;
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        for (size_t k = 0; k < lanes; ++k)
+            out[i + k] = offset + step * static_cast<float>(in[i + k]);
+    }
+    for (; i < count; ++i)
+        out[i] = offset + step * static_cast<float>(in[i]);
+}
+}
+
+/**
+ * Kolejność sprawdzeń: pusta lub stała kolumna, wartości nieskończone (bez kwantyzacji),
+ * liczby całkowite mieszczące się w 65536 poziomach (krok 1), a w pozostałych przypadkach
+ * krok z zakresu bloku, nie mniejszy od rozdzielczości czujnika. Błąd mierzony jest przez
+ * zdekodowanie kolumny.
+ */
+void QuantizedColumn::encode(const float *values, size_t count, float resolution) {
+    this->count = count;
+    kind = Mode::Constant;
+    offset = 0.0f;
+    scale = 0.0f;
+    error = 0.0f;
+    levels.clear();
+    narrow.clear();
+    raw.clear();
+    if (count == 0)
+        return;
+
+    bool finite = true;
+    bool integral = true;
+    float low = values[0];
+    float high = values[0];
+    for (size_t i = 0; i < count; ++i) {
+        const float v = values[i];
+        finite = finite && std::isfinite(v);
+        integral = integral && std::nearbyint(v) == v;
+        low = std::min(low, v);
+        high = std::max(high, v);
+    }
+
+    if (!finite) {
+        kind = Mode::Raw;
+        raw.assign(values, values + count);
+        return;
+    }
+    if (low == high) {
+        offset = low;
+        return;
+    }
+
+    const double range = static_cast<double>(high) - low;
+    if (integral && range <= levelSpan + 1.0 && std::fabs(low) < exactInteger && std::fabs(high) < exactInteger) {
+        kind = Mode::Integer;
+        scale = 1.0f;
+        if (range <= 255.0) {
+            narrow.resize(count);
+            offset = low + 128.0f;
+            for (size_t i = 0; i < count; ++i)
+                narrow[i] = static_cast<int8_t>(values[i] - offset);
+        } else {
+            levels.resize(count);
+            offset = low + 32768.0f;
+            for (size_t i = 0; i < count; ++i)
+                levels[i] = static_cast<int16_t>(values[i] - offset);
+        }
+        return;
+    }
+
+    kind = Mode::Scaled;
+    double mid = (static_cast<double>(low) + high) / 2.0;
+    double step = range / levelSpan;
+    if (resolution > 0.0f && step < resolution) {
+        step = resolution;
+        mid = std::nearbyint(mid / step) * step;
+    }
+    if (range / step <= narrowSpan)
+        narrow.resize(count);
+    else
+        levels.resize(count);
+    offset = static_cast<float>(mid);
+    scale = static_cast<float>(step);
+    for (size_t i = 0; i < count; ++i)
+        store(levels, narrow, i, std::nearbyint((values[i] - static_cast<double>(offset)) / scale));
+
+    std::vector<float> decoded(count);
+    decode(decoded.data());
+    for (size_t i = 0; i < count; ++i)
+        error = std::max(error, std::fabs(decoded[i] - values[i]));
+}
+
+void QuantizedColumn::decode(float *out) const {
+    switch (kind) {
+    case Mode::Constant:
+        std::fill(out, out + count, offset);
+        break;
+    case Mode::Integer:
+    case Mode::Scaled:
+        if (!narrow.empty())
+            dequantize(narrow.data(), count, offset, scale, out);
+        else
+            dequantize(levels.data(), count, offset, scale, out);
+        break;
+    case Mode::Raw:
+        std::copy(raw.begin(), raw.end(), out);
+        break;
+    }
+}
+
+int QuantizedColumn::bytesPerValue() const {
+    if (!raw.empty())
+        return static_cast<int>(sizeof(float));
+    if (!levels.empty())
+        return static_cast<int>(sizeof(int16_t));
+    return narrow.empty() ? 0 : static_cast<int>(sizeof(int8_t));
+}
+
+uint64_t QuantizedColumn::byteCount() const {
+    return levels.size() * sizeof(int16_t) + narrow.size() * sizeof(int8_t) + raw.size() * sizeof(float);
+}
+
+void QuantizedColumn::shrink() {
+    levels.shrink_to_fit();
+    narrow.shrink_to_fit();
+    raw.shrink_to_fit();
+}
+
+void QuantizedColumn::dequantize(const int16_t *in, size_t count, float offset, float step, float *out) {
+    dequantizeLevels(in, count, offset, step, out);
+}
+
+void QuantizedColumn::dequantize(const int8_t *in, size_t count, float offset, float step, float *out) {
+    dequantizeLevels(in, count, offset, step, out);
+}
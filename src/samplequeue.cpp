@@ -0,0 +1,145 @@
+/**
+ * @file samplequeue.cpp
+ * @brief Implementacja klasy SampleQueue.
+ *
+ * Kolejka jest wektorem próbek od najstarszej; odbiorca zabiera całą zawartość zamianą
+ * wektorów, więc w ustalonym stanie nie ma alokacji. Usuwanie nadmiaru odbywa się raz
+ * na porcję, a nie dla każdej próbki.
+ */
+
+#include "../inc/samplequeue.h"
+#include <algorithm>
+
+SampleQueue::SampleQueue(size_t capacity, BackpressurePolicy policy)
+    : limit(std::max<size_t>(capacity, 2)), mode(policy) {
+    items.reserve(std::min(limit, defaultCapacity));
+}
+
+void SampleQueue::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> guard(lock);
+    limit = std::max<size_t>(capacity, 2);
+    trim();
+}
+
+size_t SampleQueue::capacity() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return limit;
+}
+
+void SampleQueue::setPolicy(BackpressurePolicy policy) {
+    std::lock_guard<std::mutex> guard(lock);
+    mode = policy;
+}
+
+BackpressurePolicy SampleQueue::policy() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return mode;
+}
+
+/**
+ * Przy DropOldest z porcji większej niż pojemność dopisywana jest tylko jej najnowsza część,
+ * przy DropNewest — tylko tyle, ile mieści się w kolejce. Decimate dopisuje całą porcję
+ * i zmniejsza rozdzielczość całej kolejki (kolejka chwilowo mieści pojemność plus jedną porcję).
+ */
+bool SampleQueue::push(const SerialData *raw, const SerialData *filtered, size_t count) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (count == 0)
+        return false;
+    counters.pushed += count;
+    if (items.size() + count > limit)
+        ++counters.overflows;
+
+    size_t first = 0;
+    size_t last = count;
+    if (mode == BackpressurePolicy::DropOldest) {
+        first = count > limit ? count - limit : 0;
+        const size_t excess = items.size() + (count - first) > limit ? items.size() + (count - first) - limit : 0;
+        items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(excess));
+        counters.droppedFrames += first + excess;
+    } else if (mode == BackpressurePolicy::DropNewest) {
+        last = std::min(count, limit - std::min(limit, items.size()));
+        counters.droppedFrames += count - last;
+    }
+    for (size_t i = first; i < last; ++i)
+        items.push_back({raw[i], filtered[i]});
+    if (mode == BackpressurePolicy::Decimate)
+        trim();
+
+    counters.maxDepth = std::max(counters.maxDepth, items.size());
+    const bool notify = !notified && !items.empty();
+    notified = notified || notify;
+    return notify;
+}
+
+size_t SampleQueue::take(std::vector<SamplePair> &out) {
+    out.clear();
+    std::lock_guard<std::mutex> guard(lock);
+    out.swap(items);
+    notified = false;
+    counters.delivered += out.size();
+    return out.size();
+}
+
+size_t SampleQueue::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return items.size();
+}
+
+void SampleQueue::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    items.clear();
+    notified = false;
+}
+
+BackpressureStats SampleQueue::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return counters;
+}
+
+void SampleQueue::resetStats() {
+    std::lock_guard<std::mutex> guard(lock);
+    counters = BackpressureStats();
+}
+
+/**
+ * Decymacja zostawia co drugą próbkę licząc od najnowszej (najnowsza zawsze zostaje)
+ * i powtarza się, dopóki kolejka nie mieści się w pojemności.
+ */
+void SampleQueue::trim() {
+    if (items.size() <= limit)
+        return;
+    const size_t before = items.size();
+    if (mode == BackpressurePolicy::DropOldest) {
+        items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(before - limit));
+    } else if (mode == BackpressurePolicy::DropNewest) {
+        items.resize(limit);
+    } else {
+        while (items.size() > limit) {
+            const size_t n = items.size();
+            size_t kept = 0;
+            for (size_t i = (n - 1) % 2; i < n; i += 2)
+                items[kept++] = items[i];
+            items.resize(kept);
+        }
+    }
+    counters.droppedFrames += before - items.size();
+}
+
+const char *SampleQueue::policyName(BackpressurePolicy policy) {
+    switch (policy) {
+    case BackpressurePolicy::DropNewest: return "newest";
+    case BackpressurePolicy::Decimate:   return "decimate";
+    default:                             return "oldest";
+    }
+}
+
+bool SampleQueue::parsePolicy(const std::string &name, BackpressurePolicy &policy) {
+    for (BackpressurePolicy candidate : {BackpressurePolicy::DropOldest, BackpressurePolicy::DropNewest,
+                                         BackpressurePolicy::Decimate}) {
+        if (name == policyName(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
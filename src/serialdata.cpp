@@ -0,0 +1,95 @@
+/**
+ * @file serialdata.cpp
+ * @brief Implementacja funkcji dostępu do kanałów struktury SerialData.
+ */
+
+#include "../inc/serialdata.h"
+
+namespace {
+/**
+ * Kopiuje pole Field partii próbek do ciągłej tablicy.
+ */
+template <typename T, T SerialData::*Field>
+void gather(const SerialData *samples, size_t count, float *out) {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = static_cast<float>(samples[i].*Field);
+}
+}
+
+/**
+ * Pola typu uint8_t (PWM, tryb) są zwracane jako float bez skalowania.
+ */
+float channelValue(const SerialData &data, Channel channel) {
+    switch (channel) {
+    case Channel::Rpm:     return data.rpm;
+    case Channel::Pwm:     return data.pwm;
+    case Channel::Current: return data.current;
+    case Channel::Voltage: return data.voltage;
+    case Channel::Power:   return data.power;
+    case Channel::Kp:      return data.kp;
+    case Channel::Ki:      return data.ki;
+    case Channel::Kd:      return data.kd;
+    case Channel::Mode:    return data.mode;
+    case Channel::Count:   break;
+    }
+    return 0.0f;
+}
+
+/**
+ * Pola typu uint8_t (PWM, tryb) są rzutowane z wartości float.
+ */
+void setChannelValue(SerialData &data, Channel channel, float value) {
+    switch (channel) {
+    case Channel::Rpm:     data.rpm = value; break;
+    case Channel::Pwm:     data.pwm = static_cast<uint8_t>(value); break;
+    case Channel::Current: data.current = value; break;
+    case Channel::Voltage: data.voltage = value; break;
+    case Channel::Power:   data.power = value; break;
+    case Channel::Kp:      data.kp = value; break;
+    case Channel::Ki:      data.ki = value; break;
+    case Channel::Kd:      data.kd = value; break;
+    case Channel::Mode:    data.mode = static_cast<uint8_t>(value); break;
+    case Channel::Count:   break;
+    }
+}
+
+void gatherChannel(const SerialData *samples, size_t count, Channel channel, float *out) {
+    switch (channel) {
+    case Channel::Rpm:     gather<float, &SerialData::rpm>(samples, count, out); break;
+    case Channel::Pwm:     gather<uint8_t, &SerialData::pwm>(samples, count, out); break;
+    case Channel::Current: gather<float, &SerialData::current>(samples, count, out); break;
+    case Channel::Voltage: gather<float, &SerialData::voltage>(samples, count, out); break;
+    case Channel::Power:   gather<float, &SerialData::power>(samples, count, out); break;
+    case Channel::Kp:      gather<float, &SerialData::kp>(samples, count, out); break;
+    case Channel::Ki:      gather<float, &SerialData::ki>(samples, count, out); break;
+    case Channel::Kd:      gather<float, &SerialData::kd>(samples, count, out); break;
+    case Channel::Mode:    gather<uint8_t, &SerialData::mode>(samples, count, out); break;
+    case Channel::Count:   break;
+    }
+}
+
+const char *channelName(Channel channel) {
+    switch (channel) {
+    case Channel::Rpm:     return "rpm";
+    case Channel::Pwm:     return "pwm";
+    case Channel::Current: return "current";
+    case Channel::Voltage: return "voltage";
+    case Channel::Power:   return "power";
+    case Channel::Kp:      return "kp";
+    case Channel::Ki:      return "ki";
+    case Channel::Kd:      return "kd";
+    case Channel::Mode:    return "mode";
+    case Channel::Count:   break;
+    }
+    return "";
+}
+
+bool channelFromName(const std::string &name, Channel &channel) {
+    for (int i = 0; i < channelCount; ++i) {
+        if (name == channelName(static_cast<Channel>(i))) {
+            channel = static_cast<Channel>(i);
+            return true;
+        }
+    }
+    return false;
+}
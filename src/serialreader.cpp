@@ -8,121 +8,879 @@
  */
 
 #include "../inc/serialreader.h"
+#include "../inc/logring.h"
+#include "../inc/serialtermios.h"
+#include "../inc/trace.h"
 #include <QDebug>
+#include <QThread>
 #include <QtEndian>
+#include <algorithm>
+#include <utility>
+
+namespace {
+/// Czas zbierania ramek dla jednej prędkości podczas automatycznego wykrywania [ms].
+constexpr int baudProbeWindowMs = 300;
+/// Minimalna liczba poprawnych ramek, aby prędkość została uznana za poprawną.
+constexpr quint64 baudProbeMinFrames = 3;
+/// Liczba poprawnych ramek bez błędów, po której prędkość jest przyjmowana od razu.
+constexpr quint64 baudProbeLockFrames = 20;
+/// Interwał odbioru poleceń z pamięci współdzielonej [ms].
+constexpr int shmCommandPollMs = 10;
+/// Interwał sprawdzania czasu oczekiwania transferu blokowego [ms].
+constexpr int blockPollMs = 5;
+}
 
 /**
  * Inicjalizuje obiekt QSerialPort, ustawia tryb komunikacji i podłącza obsługę błędów.
+ * QSerialPort i timery przenoszone są do wątku portu, więc ich sygnały obsługiwane są
+ * w tym wątku (kontekst ioContext), a nie w pętli zdarzeń GUI.
  */
 SerialReader::SerialReader(QObject *parent) : QObject(parent) {
-    // Po otrzymaniu nowych danych wywołuje funkcję handleReadyRead()
-    connect(&serial, &QSerialPort::readyRead, this, &SerialReader::handleReadyRead);
+    // Po otrzymaniu nowych danych wywołuje funkcję handleReadyRead() w wątku portu
+    connect(&serial, &QSerialPort::readyRead, &ioContext, [this]() { handleReadyRead(); });
+
+    // Odłączenie urządzenia obsługiwane jest w wątku GUI (sygnały dla MainWindow, zamknięcie portu)
+    connect(&serial, &QSerialPort::errorOccurred, &ioContext, [this](QSerialPort::SerialPortError error) {
+        QMetaObject::invokeMethod(this, [this, error]() { handleError(error); }, Qt::QueuedConnection);
+    });
+
+    // SerialData przekazywane jest między wątkami przy transporcie POSIX
+    qRegisterMetaType<SerialData>("SerialData");
+
+    // Metryki dostają histogram nigdy niezerowany — podsumowanie Prometheus musi rosnąć monotonicznie
+    telemetry.setParseLatency(&parseLatencyTotalNs);
+
+    // Koniec kroku automatycznego wykrywania prędkości
+    baudProbeTimer.setSingleShot(true);
+    connect(&baudProbeTimer, &QTimer::timeout, &ioContext, [this]() { finishBaudProbeStep(); });
+
+    shmCommandTimer.setInterval(shmCommandPollMs);
+    connect(&shmCommandTimer, &QTimer::timeout, this, &SerialReader::processSharedCommands);
+
+    blockTimer.setInterval(blockPollMs);
+    connect(&blockTimer, &QTimer::timeout, &ioContext, [this]() { pollBlockTransfer(); });
 
-    // Jeśli pojawi się jakikolwiek bląd z połączenie wywołaj handleError
-    connect(&serial, &QSerialPort::errorOccurred, this, &SerialReader::handleError);
+    connect(&ioThread, &QThread::started, &ioContext, []() { Trace::setThreadName("port szeregowy (Qt)"); });
+    for (QObject *object : {static_cast<QObject *>(&ioContext), static_cast<QObject *>(&serial),
+                            static_cast<QObject *>(&baudProbeTimer), static_cast<QObject *>(&blockTimer)})
+        object->moveToThread(&ioThread);
+    ioThread.start();
+}
 
+/**
+ * Obiekty wątku portu wracają do wątku właściciela, aby zostały zniszczone w tym samym wątku co SerialReader.
+ */
+SerialReader::~SerialReader() {
+    runOnIoThread([this]() {
+        stop();
+        for (QObject *object : {static_cast<QObject *>(&serial), static_cast<QObject *>(&baudProbeTimer),
+                                static_cast<QObject *>(&blockTimer), static_cast<QObject *>(&ioContext)})
+            object->moveToThread(thread());
+    });
+    ioThread.quit();
+    ioThread.wait();
 }
 
 /**
- * Otwiera wskazany port szeregowy i ustawia zadaną prędkość transmisji.
- * W przypadku błędu emisja sygnału errorOccurred().
+ * Otwiera wskazany port szeregowy wybranym sposobem dostępu i ustawia zadaną prędkość transmisji.
+ * W przypadku błędu emisja sygnału errorOccurred(). Stan odbioru zmieniany jest w wątku portu.
  */
 void SerialReader::start(const QString &portName, int baudRate) {
+    if (QThread::currentThread() != &ioThread) {
+        runOnIoThread([this, portName, baudRate]() { start(portName, baudRate); });
+        return;
+    }
+    baudProbing = false;
+    baudProbeTimer.stop();
+    decoder.reset();
+    parseLatencyNs.reset();
+    arrivalIntervalNs.reset();
+    deliveryLatencyNs.reset();
+    lastArrivalNs = 0;
+    clockSync.reset();
+    {
+        const std::lock_guard<std::mutex> lock(filtersMutex);
+        filters.reset();
+    }
+    {
+        const std::lock_guard<std::mutex> lock(limitsMutex);
+        limits.reset();
+    }
+
+    if (activeBackend == SerialBackend::Posix && PosixSerialTransport::isSupported()) {
+        openPosixPort(portName, baudRate);
+    } else {
+        openQtPort(portName, baudRate);
+    }
+}
+
+/**
+ * Prędkości powyżej 115200 Bd ustawiane są po otwarciu portu (na Linuksie przez termios2/BOTHER).
+ */
+void SerialReader::openQtPort(const QString &portName, int baudRate) {
     serial.setPortName(portName);
-    serial.setBaudRate(baudRate);
+    serial.setBaudRate(qMin(baudRate, static_cast<int>(QSerialPort::Baud115200)));
     serial.setDataBits(QSerialPort::Data8);
     serial.setParity(QSerialPort::NoParity);
     serial.setStopBits(QSerialPort::OneStop);
     serial.setFlowControl(QSerialPort::NoFlowControl);
 
+    serial.setReadBufferSize(readBufferBytes);
     if (!serial.open(QIODevice::ReadWrite)) {
         emit errorOccurred("Nie udało się otworzyć portu: " + serial.errorString());
         return;
     }
 
-    buffer.clear();
+    if (!applyBaudRate(baudRate)) {
+        emit errorOccurred("Nieobsługiwana prędkość transmisji: " + QString::number(baudRate));
+        serial.close();
+        return;
+    }
+    serialOpen = true;
+}
+
+/**
+ * Dane z wątku odczytu trafiają bezpośrednio do dekodera ramek (processChunk()),
+ * a publikacja próbek (deliverSamples()) jest kolejkowana do wątku GUI. Błąd portu (odłączenie)
+ * przekazywany jest do handleError() w wątku GUI.
+ */
+void SerialReader::openPosixPort(const QString &portName, int baudRate) {
+    const bool opened = posix.open(
+        portName.toStdString(), baudRate, FrameDecoder::frameSize,
+        [this](const char *data, int size, int64_t arrivalNs) { processChunk(data, size, arrivalNs); },
+        [this](const std::string &) {
+            QMetaObject::invokeMethod(this, [this]() { handleError(QSerialPort::ResourceError); }, Qt::QueuedConnection);
+        });
+
+    if (!opened) {
+        emit errorOccurred("Nie udało się otworzyć portu: " + QString::fromStdString(posix.errorString()));
+        return;
+    }
+    linkBaudRate = baudRate;
+    qDebug() << "Transport POSIX:" << portName << baudRate << "Bd, ASYNC_LOW_LATENCY:" << posix.lowLatencyEnabled();
+}
+
+void SerialReader::setBackend(SerialBackend backend) {
+    activeBackend = backend;
+}
+
+void SerialReader::setReadBufferSize(qint64 bytes) {
+    readBufferBytes = qMax<qint64>(bytes, 0);
+}
+
+/**
+ * Port otwierany jest z prędkością 115200 Bd, a następnie dla każdej prędkości z listy
+ * zbierane są ramki przez baudProbeWindowMs. Wybierana jest prędkość z największą liczbą
+ * poprawnych ramek (bajt startu 0xA5 i zgodna suma kontrolna).
+ * Wykrywanie zawsze korzysta z QSerialPort; przy transporcie POSIX port jest po wykryciu
+ * otwierany ponownie przez start().
+ */
+void SerialReader::startAutoBaud(const QString &portName, const QList<int> &candidates) {
+    if (QThread::currentThread() != &ioThread) {
+        runOnIoThread([this, portName, candidates]() { startAutoBaud(portName, candidates); });
+        return;
+    }
+    stop();
+    openQtPort(portName, QSerialPort::Baud115200);
+    if (!serial.isOpen())
+        return;
+
+    baudProbeRates = candidates.isEmpty() ? autoBaudCandidates() : candidates;
+    baudProbeCurrent = 0;
+    baudProbeBest = 0;
+    baudProbeBestScore = 0;
+    baudProbing = true;
+    finishBaudProbeStep();
+}
+
+/**
+ * Najpierw sprawdzane są wysokie prędkości — przy zbyt niskiej prędkości odbiornik
+ * rzadziej trafia na przypadkowo poprawną ramkę.
+ */
+QList<int> SerialReader::autoBaudCandidates() {
+    return {3000000, 2000000, 1500000, 1000000, 921600, 460800, 230400,
+            115200, 57600, 38400, 19200, 9600};
+}
+
+/**
+ * Ocenia prędkość sprawdzaną w zakończonym kroku i ustawia kolejną.
+ * Po sprawdzeniu wszystkich prędkości (lub po pewnym dopasowaniu) port zostaje
+ * przełączony na najlepszą prędkość i emitowany jest sygnał baudRateDetected().
+ */
+void SerialReader::finishBaudProbeStep() {
+    if (!baudProbing)
+        return;
+
+    if (baudProbeCurrent > 0) {
+        const DecoderStats &stats = decoder.stats();
+        const bool plausible = stats.validFrames >= baudProbeMinFrames
+                               && stats.validFrames > 4 * stats.checksumErrors;
+        if (plausible && stats.validFrames > baudProbeBestScore) {
+            baudProbeBest = baudProbeCurrent;
+            baudProbeBestScore = stats.validFrames;
+        }
+        qDebug() << "Prędkość" << baudProbeCurrent << "Bd: ramek" << stats.validFrames
+                 << "błędów" << stats.checksumErrors;
+
+        if (stats.validFrames >= baudProbeLockFrames && stats.checksumErrors == 0)
+            baudProbeRates.clear();
+    }
+
+    while (!baudProbeRates.isEmpty()) {
+        baudProbeCurrent = baudProbeRates.takeFirst();
+        if (!applyBaudRate(baudProbeCurrent))
+            continue;
+        serial.clear(QSerialPort::Input);
+        decoder.reset();
+        decoder.resetStats();
+        baudProbeTimer.start(baudProbeWindowMs);
+        return;
+    }
+
+    baudProbing = false;
+    baudProbeCurrent = 0;
+    decoder.reset();
+    decoder.resetStats();
+
+    if (baudProbeBest > 0 && activeBackend == SerialBackend::Posix) {
+        const QString portName = serial.portName();
+        serialOpen = false;
+        serial.close();
+        start(portName, baudProbeBest);
+        if (isOpen())
+            emit baudRateDetected(baudProbeBest);
+        else
+            emit baudRateDetectionFailed();
+    } else if (baudProbeBest > 0 && applyBaudRate(baudProbeBest)) {
+        serial.clear(QSerialPort::Input);
+        emit baudRateDetected(baudProbeBest);
+    } else {
+        stop();
+        emit errorOccurred("Nie wykryto prędkości transmisji");
+        emit baudRateDetectionFailed();
+    }
+}
+
+/**
+ * Na Linuksie prędkości powyżej 115200 Bd ustawiane są przez termios2/BOTHER,
+ * co działa również dla wartości bez stałej Bxxx (CH340, CP210x, FTDI).
+ * Jeśli sterownik nie obsługuje BOTHER, używana jest standardowa ścieżka QSerialPort.
+ */
+bool SerialReader::applyBaudRate(int baudRate) {
+    bool applied = false;
+#ifdef Q_OS_LINUX
+    applied = baudRate > QSerialPort::Baud115200 && setCustomBaudRate(static_cast<int>(serial.handle()), baudRate);
+#endif
+    applied = applied || serial.setBaudRate(baudRate);
+    if (applied)
+        linkBaudRate = baudRate;
+    return applied;
 }
 
 /**
  * Jeśli port jest otwarty, zostaje zamknięty i jest czyszczony bufor odbiorczy.
  */
 void SerialReader::stop() {
+    if (QThread::currentThread() != &ioThread) {
+        runOnIoThread([this]() { stop(); });
+        return;
+    }
+    abortBlockTransfer();
+    baudProbing = false;
+    baudProbeTimer.stop();
+    serialOpen = false;
     if (serial.isOpen())
         serial.close();
+    posix.close();
+    decoder.reset();
+    deliveryQueue.clear();
+    recordQueue.clear();
 }
 
 /**
- * Funkcja odczytuje dostępne dane z portu i składa je w buforze.
- * Jeśli w buforze znajduje się poprawna ramka (pełne frameSize),
- * próbuje ją sparsować i emituje sygnał newDataReceived().
+ * Funkcja odczytuje dostępne dane z portu i przekazuje je do dekodera ramek.
+ * Poprawne ramki trafiają porcjami do kolejek dostarczania i magistral dataBus() i displayBus().
+ * Podczas wykrywania prędkości ramki są jedynie zliczane.
+ * Porcja równa limitowi bufora oznacza, że QSerialPort wstrzymał czytanie z systemu
+ * (dane mogły zostać utracone w sterowniku) — zdarzenie jest liczone w metrykach.
+ * Funkcja działa w wątku portu. Czas odebrania mierzony jest dopiero po obsłużeniu zdarzenia przez
+ * pętlę tego wątku, więc parseLatency() nie obejmuje oczekiwania w pętli — dla porównania
+ * z transportem POSIX służy deliveryLatency().
  */
 void SerialReader::handleReadyRead() {
-    // Dodanie do buffera dane z seriala
-    buffer.append(serial.readAll());
-
-    while (buffer.size() >= frameSize) {
-        int startIndex = buffer.indexOf(static_cast<char>(0xA5));
-        if (startIndex == -1) {
-            qDebug() << "Nie znaleziono bajtu startu (0xA5), czyszczenie buforu";
-            buffer.clear();
-            return;
+    TRACE_SCOPE("SerialReader::handleReadyRead");
+    const qint64 arrivalNs = PosixSerialTransport::monotonicNs();
+    const QByteArray chunk = serial.readAll();
+    if (readBufferBytes > 0 && chunk.size() >= readBufferBytes)
+        telemetry.addReadBufferFull();
+    processChunk(chunk.constData(), chunk.size(), arrivalNs);
+}
+
+/**
+ * Czas parsowania mierzony jest od chwili odebrania porcji do zdekodowania zawartych w niej ramek,
+ * tym samym zegarem dla obu sposobów dostępu. Opóźnienie dostarczenia (deliveryLatency()) liczone
+ * jest od czasu nadania ze znacznika urządzenia, więc obejmuje też drogę przed odebraniem porcji.
+ * Liczniki metryk aktualizowane są przyrostami statystyk dekodera z danej porcji.
+ * Ramki ze znacznikiem czasu urządzenia otrzymują czas z ClockSync, pozostałe — czas odebrania porcji.
+ * Reguły alarmowe sprawdzane są na wartościach surowych przed filtrami i przed ramkami transferu
+ * blokowego (potwierdzenia, bloki odczytu), aby zatrzymanie awaryjne nie czekało na resztę
+ * przetwarzania ani na zapis kolejnych bloków.
+ * Cała porcja przechodzi przez filtry kanałów naraz; wartości surowe i przefiltrowane trafiają
+ * do dwóch kolejek: bezstratnej (dataBus() — historia, nagrywanie) i ograniczonej do wyświetlania
+ * (displayBus()). Z wątku odczytu do wątku GUI wysyłane jest jedno zdarzenie na wszystkie próbki
+ * zebrane od ostatniego dostarczenia, więc zablokowana pętla zdarzeń nie gromadzi zaległych
+ * sygnałów — po jej odblokowaniu do wyświetlenia trafia najwyżej pojemność kolejki (zgodnie
+ * z polityką BackpressurePolicy), a do dataBus() cała zaległość.
+ */
+void SerialReader::processChunk(const char *data, int size, qint64 arrivalNs) {
+    TRACE_SCOPE("SerialReader::processChunk");
+    const DecoderStats before = decoder.stats();
+    decoded.clear();
+    blockFrames.clear();
+    decoder.feed(data, size, decoded, &blockFrames);
+    if (baudProbing)
+        return;
+
+    const DecoderStats &after = decoder.stats();
+    telemetry.recordChunk(static_cast<uint64_t>(size), after.validFrames - before.validFrames,
+                          after.checksumErrors - before.checksumErrors, after.droppedBytes - before.droppedBytes,
+                          decoded.isEmpty() ? nullptr : &decoded.constLast(), arrivalNs);
+    if (decoded.isEmpty()) {
+        if (!blockFrames.empty())
+            handleBlockFrames();
+        return;
+    }
+
+    bool deviceTimed = false;
+    for (SerialData &sample : decoded) {
+        if (sample.hasDeviceTime) {
+            sample.timeUs = clockSync.update(sample.deviceTimeUs, arrivalNs) / 1000;
+            deviceTimed = true;
+        } else {
+            sample.timeUs = arrivalNs / 1000;
         }
+    }
+    if (deviceTimed)
+        telemetry.setClockSync(clockSync.isLocked(), clockSync.offsetUs(), clockSync.driftPpm(),
+                               clockSync.jitterUs(), clockSync.resyncCount());
+
+    if (limitsActive.load(std::memory_order_relaxed))
+        checkLimits(arrivalNs);
+    if (!blockFrames.empty())
+        handleBlockFrames();
 
-        if (startIndex > 0) {
-            qDebug() << "Usunięcie bajtów przed startem:" << buffer.left(startIndex).toHex(' ');
-            buffer.remove(0, startIndex);
+    filtered.resize(decoded.size());
+    {
+        TRACE_SCOPE("SerialReader::filters");
+        const std::lock_guard<std::mutex> lock(filtersMutex);
+        filters.process(decoded.constData(), filtered.data(), static_cast<size_t>(decoded.size()));
+    }
+
+    const qint64 parsedNs = PosixSerialTransport::monotonicNs();
+    for (int i = 0; i < decoded.size(); ++i) {
+        parseLatencyNs.record(parsedNs - arrivalNs);
+        parseLatencyTotalNs.record(parsedNs - arrivalNs);
+    }
+    if (deviceTimed && clockSync.isLocked()) {
+        for (const SerialData &sample : std::as_const(decoded)) {
+            if (sample.hasDeviceTime)
+                deliveryLatencyNs.record(parsedNs - sample.timeUs * 1000);
         }
+    }
+    if (lastArrivalNs > 0)
+        arrivalIntervalNs.record(arrivalNs - lastArrivalNs);
+    lastArrivalNs = arrivalNs;
+
+    if (shmPublishing.load(std::memory_order_relaxed)) {
+        for (const SerialData &sample : std::as_const(decoded))
+            shm.publish(sample.timeUs, sample);
+    }
+
+    const size_t count = static_cast<size_t>(decoded.size());
+    const bool recordNotify = recordQueue.push(decoded.constData(), filtered.constData(), count);
+    const bool notify = deliveryQueue.push(decoded.constData(), filtered.constData(), count) || recordNotify;
+    if (notify)
+        QMetaObject::invokeMethod(this, &SerialReader::deliverSamples, Qt::QueuedConnection);
+}
+
+/**
+ * Próbki usunięte przez politykę kolejki od poprzedniego dostarczenia są dodawane do metryk
+ * i raz na porcję zgłaszane w dzienniku (z ograniczeniem częstotliwości logring.h).
+ * Cała porcja publikowana jest w magistrali jednym wywołaniem — subskrybenci dostają ją
+ * w całości zamiast osobnego sygnału dla każdej próbki. Zaległość większa od pojemności dataBus()
+ * publikowana jest w kilku porcjach, aby subskrybenci z funkcją zwrotną nie tracili próbek.
+ */
+void SerialReader::deliverSamples() {
+    TRACE_SCOPE("SerialReader::deliverSamples");
+    recordQueue.take(delivering);
+    for (size_t first = 0; first < delivering.size(); first += sampleBus.capacity()) {
+        sampleBus.publish(delivering.data() + first, std::min(delivering.size() - first, sampleBus.capacity()));
+        sampleBus.dispatch();
+    }
+
+    deliveryQueue.take(delivering);
+
+    const BackpressureStats stats = deliveryQueue.stats();
+    if (stats.droppedFrames > deliveryDropsReported) {
+        const uint64_t dropped = stats.droppedFrames - deliveryDropsReported;
+        deliveryDropsReported = stats.droppedFrames;
+        telemetry.addDeliveryDrops(dropped);
+        LOG_WARNING("Odbiorca nie nadąża — usunięto {} próbek (polityka: {})", dropped,
+                    SampleQueue::policyName(deliveryQueue.policy()));
+    }
 
-        if (buffer.size() < frameSize) {
-            qDebug() << "Czekanie na resztę danych, jest" << buffer.size() << "z" << frameSize;
+    displaySampleBus.publish(delivering.data(), delivering.size());
+    displaySampleBus.dispatch();
+}
+
+/**
+ * Pod blokadą reguł sprawdzane są tylko próbki i zbierane zdarzenia. Zatrzymanie awaryjne
+ * wysyłane jest od razu w wątku odbioru, ale już po jej zwolnieniu — zapis i opróżnianie bufora
+ * portu nie blokują setLimitRules() ani limitRules() wywoływanych z GUI. Czasy reakcji
+ * uzupełniane są w rekordach alarmów pod blokadą ponownie. Sygnały emitowane są na końcu,
+ * bez blokady (odbiorca może sięgnąć po reguły).
+ */
+void SerialReader::checkLimits(qint64 arrivalNs) {
+    TRACE_SCOPE("SerialReader::limits");
+    struct Notice {
+        QString rule;
+        float value;
+        bool stop;
+    };
+    QVector<Notice> notices;
+    size_t finished = 0;
+    bool stopNeeded = false;
+    qint64 detectedNs = 0;
+    {
+        const std::lock_guard<std::mutex> lock(limitsMutex);
+        finished = limits.check(decoded.constData(), static_cast<size_t>(decoded.size()), arrivalNs, limitEvents);
+        if (limitEvents.empty() && finished == 0)
             return;
+
+        detectedNs = PosixSerialTransport::monotonicNs();
+        for (const LimitEvent &event : limitEvents) {
+            stopNeeded = stopNeeded || event.emergencyStop;
+            notices.append({QString::fromStdString(limits.rules()[event.rule].text), event.value, event.emergencyStop});
+            telemetry.addLimitAlarm(event.emergencyStop);
         }
+    }
+
+    qint64 commandNs = 0;
+    qint64 reactionNs = 0;
+    if (stopNeeded) {
+        emergencyStop();
+        commandNs = PosixSerialTransport::monotonicNs();
+        reactionNs = commandNs - arrivalNs;
+        emergencyLatencyNs.record(reactionNs);
+    }
+    if (!notices.isEmpty()) {
+        const std::lock_guard<std::mutex> lock(limitsMutex);
+        limits.markReaction(detectedNs, commandNs);
+    }
 
-        QByteArray frame = buffer.left(frameSize);
-        buffer.remove(0, frameSize);
+    for (const Notice &notice : std::as_const(notices))
+        emit limitExceeded(notice.rule, notice.value, notice.stop, notice.stop ? reactionNs : 0);
+    if (finished > 0)
+        emit alarmRecorded();
+}
 
-        // qDebug() << "Znalaziono pełną ramkę:" << frame.toHex(' ').toUpper();
+/**
+ * Ramki zatrzymania budowane są raz. Kolejność: blokada (flushBlockTransfer() nie zapisuje już
+ * ramek transferu), przerwanie transferu blokowego, odrzucenie bufora nadawczego i dopiero wtedy
+ * zapis. Transport POSIX zapisuje z bieżącego wątku przez writeUrgent(); QSerialPort — w wątku
+ * portu (clear(Output) odrzuca też bajty w sterowniku, na Uniksie przez tcflush(TCOFLUSH)).
+ * Jeśli blockMutex trzyma inny wątek (zapis bloku w toku), zatrzymanie na niego nie czeka —
+ * writeUrgent() przerywa ten zapis, a transfer kończy z błędem flushBlockTransfer().
+ * Ramka BlockAbort wysyłana jest po ramkach zatrzymania.
+ */
+void SerialReader::emergencyStop() {
+    static const QByteArray frames = encodeCommand(start_stop, 0.0f) + encodeCommand(PWM, 0.0f);
+    if (!posix.isOpen() && serialOpen && QThread::currentThread() != &ioThread) {
+        runOnIoThread([this]() { emergencyStop(); });
+        return;
+    }
+    emergencyLatched = true;
+    telemetry.setEmergencyStopped(true);
 
-        SerialData data;
-        if (parseFrame(frame, data)) {
-            emit newDataReceived(data);
-        } else {
-            qDebug() << "Błąd parsowania lub checksum!";
+    std::string abortFrame;
+    BlockNotice notice;
+    {
+        const std::unique_lock<std::mutex> lock(blockMutex, std::try_to_lock);
+        if (lock.owns_lock() && blockTransfer.isActive()) {
+            blockTransfer.abort(PosixSerialTransport::monotonicNs(), abortFrame, "Transfer przerwany zatrzymaniem awaryjnym");
+            notice = flushBlockTransfer(std::string());
         }
     }
+
+    if (posix.isOpen()) {
+        posix.writeUrgent(frames.constData(), frames.size());
+    } else if (serialOpen) {
+        serial.clear(QSerialPort::Output);
+        serial.write(frames);
+        serial.flush();
+    } else {
+        return;
+    }
+    logCommands(frames);
+    if (!abortFrame.empty())
+        writeRaw(abortFrame.data(), static_cast<int>(abortFrame.size()));
+    emitBlockNotice(notice);
+}
+
+void SerialReader::clearEmergencyStop() {
+    emergencyLatched = false;
+    telemetry.setEmergencyStopped(false);
+    qDebug() << "Zdjęto blokadę zatrzymania awaryjnego";
 }
 
 /**
- * Funkcja weryfikuje poprawność sumy kontrolnej (XOR) ramki oraz odczytuje z niej poszczególne pola:
- * RPM, PWM, prąd, napięcie, moc, parametry PID oraz tryb pracy.
+ * Zatrzymanie, zerowe wypełnienie i zmiany nastaw PID są dozwolone mimo blokady.
  */
-bool SerialReader::parseFrame(const QByteArray &frame, SerialData &data) {
-    if (frame.size() != frameSize)
+bool SerialReader::isBlockedByEmergencyStop(DataType type, float value) const {
+    if (!emergencyLatched.load(std::memory_order_relaxed))
         return false;
+    return (type == start_stop || type == PWM || type == RPM) && value != 0.0f;
+}
 
-    quint8 checksum = 0;
-    // Chechsum dla wszystkich oprócz ostatniego
-    for (int i = 0; i < frameSize - 1; ++i) {
-        checksum ^= static_cast<quint8>(frame[i]);
+/**
+ * Stan reguł (zliczanie kolejnych próbek, szybkość zmian) zaczyna się od nowa.
+ */
+bool SerialReader::setLimitRules(const QStringList &specs, QString *error) {
+    std::vector<std::string> rules;
+    for (const QString &spec : specs) {
+        if (!spec.trimmed().isEmpty())
+            rules.push_back(spec.trimmed().toStdString());
+    }
+
+    std::string message;
+    bool ok;
+    {
+        const std::lock_guard<std::mutex> lock(limitsMutex);
+        ok = limits.setRules(rules, message);
+        if (ok) {
+            limits.reset();
+            limitsActive = !rules.empty();
+        }
+    }
+    if (!ok && error)
+        *error = QString::fromStdString(message);
+    return ok;
+}
+
+QStringList SerialReader::limitRules() const {
+    const std::lock_guard<std::mutex> lock(limitsMutex);
+    QStringList specs;
+    for (const LimitRule &rule : limits.rules())
+        specs.append(QString::fromStdString(rule.text));
+    return specs;
+}
+
+std::vector<AlarmRecord> SerialReader::takeAlarmRecords() {
+    const std::lock_guard<std::mutex> lock(limitsMutex);
+    std::vector<AlarmRecord> records;
+    AlarmRecord record;
+    while (limits.takeCompleted(record))
+        records.push_back(std::move(record));
+    return records;
+}
+
+/**
+ * Blokada jest trzymana przez wątek odczytu tylko na czas filtrowania jednej porcji danych.
+ */
+bool SerialReader::setChannelFilter(Channel channel, const QString &spec, QString *error) {
+    std::string message;
+    bool ok;
+    {
+        const std::lock_guard<std::mutex> lock(filtersMutex);
+        ok = filters.setFilter(channel, spec.toStdString(), message);
     }
-    // Sprawdzenie czy policzona suma zgadza się z otrzymaną sumą
-    if (checksum != static_cast<quint8>(frame[frameSize - 1]))
+    if (!ok && error)
+        *error = QString::fromStdString(message);
+    return ok;
+}
+
+QString SerialReader::channelFilter(Channel channel) const {
+    const std::lock_guard<std::mutex> lock(filtersMutex);
+    return QString::fromStdString(filters.filter(channel));
+}
+
+/**
+ * Segment nie jest zamykany przy wyłączeniu, bo wątek odczytu (transport POSIX) może
+ * właśnie publikować próbkę — wyłączenie jedynie wstrzymuje publikowanie.
+ */
+bool SerialReader::setSharedMemoryEnabled(bool enabled, const QString &name) {
+    if (!enabled) {
+        shmPublishing = false;
+        shmCommandTimer.stop();
+        return true;
+    }
+
+    if (!shm.isOpen() && !shm.open(name.toStdString())) {
+        emit errorOccurred("Nie udało się utworzyć pamięci współdzielonej: " + QString::fromStdString(shm.errorString()));
         return false;
+    }
+    shmPublishing = true;
+    shmCommandTimer.start();
+    qDebug() << "Telemetria udostępniana w pamięci współdzielonej:" << name;
+    return true;
+}
 
-    // Parsowanie pól (zgodnie z kolejnością w buforze)
-    memcpy(&data.rpm, frame.constBegin() + 1, 4);
-    memcpy(&data.pwm, frame.constBegin() + 5, 4);
-    memcpy(&data.current, frame.constBegin() + 6, 4);
-    memcpy(&data.voltage, frame.constBegin() + 10, 4);
-    memcpy(&data.power, frame.constBegin() + 14, 4);
-    memcpy(&data.kp, frame.constBegin() + 18, 4);
-    memcpy(&data.ki, frame.constBegin() + 22, 4);
-    memcpy(&data.kd, frame.constBegin() + 26, 4);
-    memcpy(&data.mode, frame.constBegin() + 30, 1);
+/**
+ * Polecenia o nieznanym typie są odrzucane; pozostałe trafiają do sendData() w kolejności wstawienia.
+ */
+void SerialReader::processSharedCommands() {
+    ShmCommand command;
+    while (shm.takeCommand(command)) {
+        if (command.type < DataType::PWM || command.type > DataType::start_stop) {
+            LOG_WARNING("Odrzucono polecenie z pamięci współdzielonej, typ: {}", command.type);
+            continue;
+        }
+        sendData(static_cast<DataType>(command.type), command.value);
+    }
+}
 
+/**
+ * Potwierdzenia obsługiwane są od razu w wątku odbioru, więc kolejne bloki wysyłane są bez
+ * czekania na pętlę zdarzeń GUI.
+ */
+void SerialReader::handleBlockFrames() {
+    TRACE_SCOPE("SerialReader::blockFrames");
+    BlockNotice notice;
+    {
+        const std::lock_guard<std::mutex> lock(blockMutex);
+        const qint64 nowNs = PosixSerialTransport::monotonicNs();
+        std::string out;
+        for (const BlockFrame &frame : blockFrames)
+            blockTransfer.handleFrame(frame, nowNs, out);
+        notice = flushBlockTransfer(out);
+    }
+    emitBlockNotice(notice);
+}
+
+/**
+ * Jeśli przepustowość łącza nie została podana, wyznaczana jest z prędkości portu (10 bitów na bajt).
+ */
+bool SerialReader::startBlockUpload(quint8 region, const QByteArray &data, BlockTransferOptions options) {
+    if (QThread::currentThread() != &ioThread) {
+        bool started = false;
+        runOnIoThread([&]() { started = startBlockUpload(region, data, options); });
+        return started;
+    }
+    if (!isOpen()) {
+        LOG_WARNING("Port nie jest otwarty!");
+        return false;
+    }
+    if (emergencyLatched.load(std::memory_order_relaxed)) {
+        LOG_WARNING("Transfer blokowy zablokowany przez zatrzymanie awaryjne");
+        return false;
+    }
+    if (options.linkBytesPerSecond <= 0.0)
+        options.linkBytesPerSecond = linkBaudRate.load(std::memory_order_relaxed) / 10.0;
+
+    BlockNotice notice;
+    {
+        const std::lock_guard<std::mutex> lock(blockMutex);
+        const auto *bytes = reinterpret_cast<const uint8_t *>(data.constData());
+        std::string out;
+        if (!blockTransfer.startUpload(region, std::vector<uint8_t>(bytes, bytes + data.size()), options,
+                                       PosixSerialTransport::monotonicNs(), out)) {
+            LOG_WARNING("Nie rozpoczęto zapisu bloku: {}", blockTransfer.error());
+            return false;
+        }
+        blockProgressReported = -1;
+        blockFinishPending = true;
+        notice = flushBlockTransfer(out);
+    }
+    blockTimer.start();
+    emitBlockNotice(notice);
     return true;
 }
 
+bool SerialReader::startBlockDownload(quint8 region, quint32 offset, quint32 size, BlockTransferOptions options) {
+    if (QThread::currentThread() != &ioThread) {
+        bool started = false;
+        runOnIoThread([&]() { started = startBlockDownload(region, offset, size, options); });
+        return started;
+    }
+    if (!isOpen()) {
+        LOG_WARNING("Port nie jest otwarty!");
+        return false;
+    }
+    if (emergencyLatched.load(std::memory_order_relaxed)) {
+        LOG_WARNING("Transfer blokowy zablokowany przez zatrzymanie awaryjne");
+        return false;
+    }
+    if (options.linkBytesPerSecond <= 0.0)
+        options.linkBytesPerSecond = linkBaudRate.load(std::memory_order_relaxed) / 10.0;
+
+    BlockNotice notice;
+    {
+        const std::lock_guard<std::mutex> lock(blockMutex);
+        std::string out;
+        if (!blockTransfer.startDownload(region, offset, size, options, PosixSerialTransport::monotonicNs(), out)) {
+            LOG_WARNING("Nie rozpoczęto odczytu bloku: {}", blockTransfer.error());
+            return false;
+        }
+        blockProgressReported = -1;
+        blockFinishPending = true;
+        notice = flushBlockTransfer(out);
+    }
+    blockTimer.start();
+    emitBlockNotice(notice);
+    return true;
+}
+
+void SerialReader::abortBlockTransfer() {
+    if (QThread::currentThread() != &ioThread) {
+        runOnIoThread([this]() { abortBlockTransfer(); });
+        return;
+    }
+    BlockNotice notice;
+    {
+        const std::lock_guard<std::mutex> lock(blockMutex);
+        std::string out;
+        blockTransfer.abort(PosixSerialTransport::monotonicNs(), out);
+        notice = flushBlockTransfer(out);
+    }
+    emitBlockNotice(notice);
+}
+
+bool SerialReader::isBlockTransferActive() const {
+    const std::lock_guard<std::mutex> lock(blockMutex);
+    return blockTransfer.isActive();
+}
+
+/**
+ * Timer zatrzymuje się sam po zakończeniu transferu (zakończenie może nastąpić w wątku odczytu).
+ */
+void SerialReader::pollBlockTransfer() {
+    BlockNotice notice;
+    bool active;
+    {
+        const std::lock_guard<std::mutex> lock(blockMutex);
+        std::string out;
+        blockTransfer.poll(PosixSerialTransport::monotonicNs(), out);
+        notice = flushBlockTransfer(out);
+        active = blockTransfer.isActive();
+    }
+    if (!active)
+        blockTimer.stop();
+    emitBlockNotice(notice);
+}
+
+/**
+ * Bajty zapisywane są jeszcze pod blokadą, aby ramki z wątku portu (ponowienia) i z wątku odbioru
+ * POSIX (kolejne bloki) nie przeplatały się. Po niepełnym zapisie urządzenie odrzuci uciętą ramkę
+ * (CRC), więc transfer jest przerywany z błędem zamiast czekać na przekroczenia czasu.
+ * Podczas zatrzymania awaryjnego ramki transferu nie są zapisywane — BlockAbort wysyła
+ * emergencyStop(). Postęp zgłaszany jest co 1% transferu.
+ */
+SerialReader::BlockNotice SerialReader::flushBlockTransfer(const std::string &out) {
+    if (!out.empty()) {
+        const bool stopped = emergencyLatched.load(std::memory_order_relaxed);
+        if ((stopped || !writeRaw(out.data(), static_cast<int>(out.size()))) && blockTransfer.isActive()) {
+            std::string abortFrame;
+            blockTransfer.abort(PosixSerialTransport::monotonicNs(), abortFrame,
+                                stopped ? "Transfer przerwany zatrzymaniem awaryjnym"
+                                        : "Niepełny zapis ramek transferu do portu");
+            if (!stopped)
+                writeRaw(abortFrame.data(), static_cast<int>(abortFrame.size()));
+        }
+    }
+
+    BlockNotice notice;
+    if (!blockFinishPending)
+        return notice;
+    const qint64 done = static_cast<qint64>(blockTransfer.bytesDone());
+    const qint64 total = static_cast<qint64>(blockTransfer.bytesTotal());
+    if (blockProgressReported < 0 || done - blockProgressReported >= qMax<qint64>(1, total / 100)
+        || (done == total && done != blockProgressReported)) {
+        notice.progress = true;
+        notice.done = done;
+        notice.total = total;
+        blockProgressReported = done;
+    }
+    const BlockTransfer::State state = blockTransfer.state();
+    if (state == BlockTransfer::State::Done || state == BlockTransfer::State::Failed) {
+        blockFinishPending = false;
+        notice.finished = true;
+        notice.ok = state == BlockTransfer::State::Done;
+        const std::vector<uint8_t> &data = blockTransfer.data();
+        notice.data = QByteArray(reinterpret_cast<const char *>(data.data()), static_cast<int>(data.size()));
+        notice.error = QString::fromStdString(blockTransfer.error());
+    }
+    return notice;
+}
+
+void SerialReader::emitBlockNotice(const BlockNotice &notice) {
+    if (notice.progress)
+        emit blockTransferProgress(notice.done, notice.total);
+    if (!notice.finished)
+        return;
+    if (notice.ok)
+        qDebug() << "Transfer blokowy zakończony:" << blockTransferSummary();
+    else
+        LOG_WARNING("Transfer blokowy nieudany: {}", notice.error.toUtf8());
+    emit blockTransferFinished(notice.ok, notice.data, notice.error);
+}
+
+/**
+ * Przepustowość łącza to prędkość / 10 (bit startu, 8 bitów danych, bit stopu).
+ */
+QString SerialReader::blockTransferSummary() const {
+    const std::lock_guard<std::mutex> lock(blockMutex);
+    const BlockTransferStats &stats = blockTransfer.stats();
+    const double rate = stats.throughput(PosixSerialTransport::monotonicNs());
+    const double link = linkBaudRate.load(std::memory_order_relaxed) / 10.0;
+    return QString("%1 %2 z %3 B: %4 kB/s, łącze %5 kB/s (%6%), ramek %7, ponowień %8, przekroczeń czasu %9")
+        .arg(blockTransfer.isUpload() ? "zapis" : "odczyt")
+        .arg(static_cast<qint64>(blockTransfer.bytesDone()))
+        .arg(static_cast<qint64>(blockTransfer.bytesTotal()))
+        .arg(rate / 1000.0, 0, 'f', 1)
+        .arg(link / 1000.0, 0, 'f', 1)
+        .arg(link > 0.0 ? 100.0 * rate / link : 0.0, 0, 'f', 1)
+        .arg(stats.blocksSent)
+        .arg(stats.retransmits)
+        .arg(stats.timeouts);
+}
+
+bool SerialReader::writeRaw(const char *data, int size) {
+    if (posix.isOpen())
+        return posix.write(data, size);
+    if (serialOpen)
+        return serial.write(data, size) == size;
+    return false;
+}
+
+/**
+ * Wartości podawane są w mikrosekundach.
+ */
+QString SerialReader::latencySummary() const {
+    const auto us = [](double ns) { return QString::number(ns / 1000.0, 'f', 1); };
+    const BackpressureStats queue = deliveryQueue.stats();
+    const BackpressureStats record = recordQueue.stats();
+    const DataBusStats bus = sampleBus.totals();
+    const QString delivery = deliveryLatencyNs.count() == 0
+        ? QString("urządzenie->ramka: brak znaczników urządzenia")
+        : QString("urządzenie->ramka (ponad minimum) śr. %1 us, p50 %2 us, p99 %3 us, maks. %4 us")
+              .arg(us(deliveryLatencyNs.meanNs()), us(deliveryLatencyNs.percentileNs(50)),
+                   us(deliveryLatencyNs.percentileNs(99)), us(deliveryLatencyNs.maxNs()));
+    return QString("%1: %2; odbiór->ramka śr. %3 us, p99 %4 us, maks. %5 us; odstęp porcji śr. %6 us, p99 %7 us (%8 ramek); "
+                   "kolejka wyświetlania maks. %9 próbek, usunięto %10 (%11); kolejka bezstratna maks. %12 próbek; "
+                   "magistrala: %13 subskr., %14 porcji, pominięto %15")
+        .arg(activeBackend == SerialBackend::Posix ? "POSIX" : "QSerialPort", delivery)
+        .arg(us(parseLatencyNs.meanNs()), us(parseLatencyNs.percentileNs(99)), us(parseLatencyNs.maxNs()),
+             us(arrivalIntervalNs.meanNs()), us(arrivalIntervalNs.percentileNs(99)))
+        .arg(parseLatencyNs.count())
+        .arg(queue.maxDepth)
+        .arg(queue.droppedFrames)
+        .arg(SampleQueue::policyName(deliveryQueue.policy()))
+        .arg(record.maxDepth)
+        .arg(sampleBus.subscriberCount())
+        .arg(sampleBus.publishedBatches())
+        .arg(bus.overruns);
+}
+
 /**
  * Funkcja automatycznie składa ramkę i wysyła ją przez port szeregowy.
  * Ramka ma następujący format:
@@ -130,13 +888,44 @@ bool SerialReader::parseFrame(const QByteArray &frame, SerialData &data) {
  * - Typ danych (DataType)
  * - Wartość typu float (4 bajty)
  * - Suma kontrolna (XOR)
+ * Przy QSerialPort zapis wykonywany jest w wątku portu.
  */
-void SerialReader::sendData(DataType type, float value) {
-    if (!serial.isOpen()) {
-        qDebug() << "Port nie jest otwarty!";
-        return;
+bool SerialReader::sendData(DataType type, float value) {
+    if (serialOpen && QThread::currentThread() != &ioThread) {
+        bool written = false;
+        runOnIoThread([&]() { written = sendData(type, value); });
+        return written;
+    }
+    if (!isOpen()) {
+        LOG_WARNING("Port nie jest otwarty!");
+        return false;
+    }
+    if (isBlockedByEmergencyStop(type, value)) {
+        LOG_WARNING("Zatrzymanie awaryjne aktywne — odrzucono polecenie typu {} o wartości {}", type, value);
+        return false;
+    }
+
+    const QByteArray frame = encodeCommand(type, value);
+
+    if (posix.isOpen()) {
+        if (!posix.write(frame.constData(), frame.size()))
+            return false;
+        logCommands(frame);
+        return true;
     }
 
+    if (serial.write(frame) != frame.size())
+        return false;
+    // Wymuś opróżnienie bufora
+    serial.flush();
+    logCommands(frame);
+    return true;
+}
+
+/**
+ * Ramka polecenia: bajt startu 0xB5, typ, wartość float, suma kontrolna XOR bajtów 0-5.
+ */
+QByteArray SerialReader::encodeCommand(DataType type, float value) {
     QByteArray frame;
     frame.resize(7); // 1 start + 1 typ + 4 bajty float + 1 checksum
 
@@ -145,7 +934,7 @@ void SerialReader::sendData(DataType type, float value) {
     memcpy(frame.begin(), &startByte, sizeof(quint8));
     // Typ danych (enum)
     memcpy(frame.begin() + 1, &type, sizeof(quint8));
-    // Jeśli wartość to PWM trzeba ją rzutować
+    // Jeśli wartość to PWM trzeba ją rzutować
     if (type == PWM) {
         value = static_cast<uint8_t>(value);
     }
@@ -162,16 +951,53 @@ void SerialReader::sendData(DataType type, float value) {
         checksum ^= static_cast<quint8>(frame[i]);
     }
     memcpy(frame.begin() + 6, &checksum, sizeof(quint8));
+    return frame;
+}
 
-    serial.write(frame);
-    // Wymuś opróżnienie bufora
-    serial.flush();
+/**
+ * Transport POSIX pozwala pisać z dowolnego wątku, więc polecenie trafia do portu od razu.
+ * QSerialPort może być używany tylko w wątku portu — wtedy polecenie jest kolejkowane do jego
+ * pętli zdarzeń (bez czekania na pętlę GUI).
+ */
+void SerialReader::postCommand(DataType type, float value, std::function<void(int64_t)> onWritten) {
+    if (isBlockedByEmergencyStop(type, value)) {
+        LOG_WARNING("Zatrzymanie awaryjne aktywne — odrzucono polecenie typu {} o wartości {}", type, value);
+        return;
+    }
+    if (posix.isOpen()) {
+        const QByteArray frame = encodeCommand(type, value);
+        if (!posix.write(frame.constData(), frame.size()))
+            return;
+        if (onWritten)
+            onWritten(PosixSerialTransport::monotonicNs());
+        logCommands(frame);
+        return;
+    }
+    QMetaObject::invokeMethod(&ioContext, [this, type, value, onWritten = std::move(onWritten)]() {
+        if (sendData(type, value) && onWritten)
+            onWritten(PosixSerialTransport::monotonicNs());
+    }, Qt::QueuedConnection);
+}
 
-    // qDebug() << "Wysłano ramkę:" << frame.toHex(' ').toUpper();
+/**
+ * Typ i wartość odczytywane są z gotowych ramek, więc dziennik zawiera wartości po rzutowaniu
+ * w encodeCommand() (np. PWM obcięte do liczby całkowitej). DataBus::publish() działa pod blokadą,
+ * dlatego wywołanie jest bezpieczne z wątku profilu i wątku odbioru (zatrzymanie awaryjne).
+ */
+void SerialReader::logCommands(const QByteArray &frames) {
+    constexpr int frameSize = 7;
+    const int64_t timeUs = PosixSerialTransport::monotonicNs() / 1000;
+    for (int offset = 0; offset + frameSize <= frames.size(); offset += frameSize) {
+        CommandSample command;
+        command.timeUs = timeUs;
+        command.type = static_cast<uint8_t>(frames.at(offset + 1));
+        memcpy(&command.value, frames.constData() + offset + 2, sizeof(float));
+        commandBus.publish(&command, 1);
+    }
 }
 
 bool SerialReader::isOpen() const {
-    return serial.isOpen();
+    return serialOpen || posix.isOpen();
 }
 
 /**
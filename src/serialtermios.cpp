@@ -0,0 +1,59 @@
+/**
+ * @file serialtermios.cpp
+ * @brief Implementacja ustawień portu przez termios2/BOTHER.
+ *
+ * Plik celowo nie dołącza <termios.h> — struktura termios2 z <asm/termbits.h>
+ * koliduje z definicjami glibc, dlatego kod znajduje się w osobnej jednostce kompilacji.
+ */
+
+#include "../inc/serialtermios.h"
+
+#ifdef __linux__
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+/**
+ * Czyści maskę CBAUD, ustawia BOTHER i podaje prędkość wprost w polach c_ispeed/c_ospeed.
+ * Po zapisie prędkość jest odczytywana ponownie, bo część sterowników zaokrągla ją po cichu.
+ */
+bool setCustomBaudRate(int fd, int baudRate) {
+    if (fd < 0 || baudRate <= 0)
+        return false;
+
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) < 0)
+        return false;
+
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_cflag &= ~(CBAUD << IBSHIFT);
+    tio.c_cflag |= BOTHER << IBSHIFT;
+    tio.c_ispeed = static_cast<speed_t>(baudRate);
+    tio.c_ospeed = static_cast<speed_t>(baudRate);
+
+    if (ioctl(fd, TCSETS2, &tio) < 0)
+        return false;
+
+    // Dopuszczalna odchyłka 2% (dzielniki zegara przejściówek USB)
+    const int actual = actualBaudRate(fd);
+    return actual > 0 && actual >= baudRate * 98 / 100 && actual <= baudRate * 102 / 100;
+}
+
+int actualBaudRate(int fd) {
+    struct termios2 tio;
+    if (fd < 0 || ioctl(fd, TCGETS2, &tio) < 0)
+        return -1;
+    return static_cast<int>(tio.c_ospeed);
+}
+
+#else
+
+bool setCustomBaudRate(int, int) {
+    return false;
+}
+
+int actualBaudRate(int) {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @file sessionanalysis.cpp
+ * @brief Implementacja wsadowej analizy nagranych sesji.
+ *
+ * Liczby w tabeli i pliku CSV formatowane są w locale "C".
+ */
+
+#include "../inc/sessionanalysis.h"
+#include "../inc/framedecoder.h"
+#include "../inc/sessionfile.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace {
+/// Rozmiar porcji surowego zapisu podawanej dekoderowi [B].
+constexpr qint64 rawChunkSize = 1 << 20;
+
+/**
+ * Czy plik jest nagraniem sesji (.wds); pozostałe traktowane są jako surowy zapis strumienia.
+ */
+bool isSessionFile(const QString &path) {
+    return path.endsWith(".wds", Qt::CaseInsensitive);
+}
+
+/**
+ * Przebieg po blokach nagrania .wds; liczniki łącza pochodzą ze stopki pliku.
+ */
+void analyzeRecording(const QString &path, const AnalysisOptions &options, SessionKpi &kpi) {
+    SessionFile session;
+    if (!session.open(path)) {
+        kpi.error = session.errorString();
+        return;
+    }
+    SessionAnalyzer analyzer(options);
+    for (int b = 0; b < session.blockCount(); ++b) {
+        const SessionBlockData block = session.blockData(b);
+        const float *rpm = block.columns[static_cast<int>(Channel::Rpm)];
+        const float *pwm = block.columns[static_cast<int>(Channel::Pwm)];
+        const float *current = block.columns[static_cast<int>(Channel::Current)];
+        const float *power = block.columns[static_cast<int>(Channel::Power)];
+        const float *mode = block.columns[static_cast<int>(Channel::Mode)];
+        for (int i = 0; i < block.count; ++i)
+            analyzer.add(block.timeUs[i], rpm[i], pwm[i], current[i], power[i], mode[i]);
+    }
+    analyzer.finish(kpi);
+    kpi.frames = session.linkStats().frames;
+    kpi.checksumErrors = session.linkStats().checksumErrors;
+    kpi.droppedBytes = session.linkStats().droppedBytes;
+}
+
+/**
+ * Surowy zapis czytany jest porcjami i dekodowany przez FrameDecoder. Czas próbki pochodzi
+ * ze znacznika urządzenia (32-bitowy licznik µs, rozwijany przy przepełnieniu), a dla ramek
+ * bez znacznika — z numeru próbki i rawSamplePeriodUs.
+ */
+void analyzeCapture(const QString &path, const AnalysisOptions &options, SessionKpi &kpi) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        kpi.error = file.errorString();
+        return;
+    }
+    kpi.raw = true;
+    SessionAnalyzer analyzer(options);
+    FrameDecoder decoder;
+    QVector<SerialData> frames;
+    QByteArray chunk;
+    int64_t timeUs = 0;
+    quint32 lastDeviceUs = 0;
+    bool haveDeviceTime = false;
+
+    while (!file.atEnd()) {
+        chunk = file.read(rawChunkSize);
+        if (chunk.isEmpty())
+            break;
+        frames.clear();
+        decoder.feed(chunk.constData(), chunk.size(), frames);
+        for (const SerialData &data : frames) {
+            if (data.hasDeviceTime) {
+                if (haveDeviceTime)
+                    timeUs += static_cast<quint32>(data.deviceTimeUs - lastDeviceUs);
+                lastDeviceUs = data.deviceTimeUs;
+                haveDeviceTime = true;
+            } else if (analyzer.hasSamples()) {
+                timeUs += options.rawSamplePeriodUs;
+            }
+            analyzer.add(timeUs, data.rpm, data.pwm, data.current, data.power, data.mode);
+        }
+    }
+    if (file.error() != QFileDevice::NoError) {
+        kpi.error = file.errorString();
+        return;
+    }
+    analyzer.finish(kpi);
+    kpi.frames = decoder.stats().validFrames;
+    kpi.checksumErrors = decoder.stats().checksumErrors;
+    kpi.droppedBytes = decoder.stats().droppedBytes;
+}
+
+/**
+ * Liczba w locale "C" z podaną liczbą miejsc po przecinku.
+ */
+QString number(double value, int precision) {
+    return QString::number(value, 'f', precision);
+}
+}
+
+SessionAnalyzer::SessionAnalyzer(const AnalysisOptions &options) : options(options) {
+}
+
+/**
+ * Skok PWM w trybie ręcznym zamyka poprzedni skok i rozpoczyna zbieranie nowego; zbieranie
+ * kończy się też po maxSettlingS, więc pamięć jest ograniczona niezależnie od długości nagrania.
+ */
+void SessionAnalyzer::add(int64_t timeUs, float rpm, float pwm, float current, float power, float mode) {
+    if (samples == 0) {
+        firstUs = timeUs;
+    } else {
+        const int64_t dt = timeUs - lastUs;
+        if (dt > 0 && dt <= static_cast<int64_t>(options.maxGapS * 1e6))
+            energyMilliJ += 0.5 * (lastPower + power) * dt * 1e-6;
+        if (mode == 0.0f && std::fabs(pwm - lastPwm) >= options.pwmStepThreshold) {
+            closeStep();
+            inStep = true;
+            stepUs = timeUs;
+        }
+    }
+    ++samples;
+    lastUs = timeUs;
+    lastPower = power;
+    lastPwm = pwm;
+    currentSum += current;
+    rpmSum += rpm;
+    peakCurrent = std::max(peakCurrent, current);
+    peakRpm = std::max(peakRpm, rpm);
+
+    if (inStep) {
+        stepTimes.push_back(timeUs);
+        stepRpm.push_back(rpm);
+        if (timeUs - stepUs >= static_cast<int64_t>(options.maxSettlingS * 1e6))
+            closeStep();
+    }
+}
+
+/**
+ * Skoki krótsze niż dwa okna wartości ustalonej są pomijane — wartość ustalona nie byłaby
+ * wiarygodna. Skok, po którym RPM wychodzi poza pasmo jeszcze w ostatniej próbce, liczony
+ * jest jako nieustalony.
+ */
+void SessionAnalyzer::closeStep() {
+    if (!inStep)
+        return;
+    inStep = false;
+    const int64_t holdUs = static_cast<int64_t>(options.settleHoldS * 1e6);
+    if (stepTimes.size() >= 2 && stepTimes.back() - stepUs >= 2 * holdUs) {
+        const int64_t holdFrom = stepTimes.back() - holdUs;
+        double sum = 0.0;
+        int count = 0;
+        for (size_t i = stepTimes.size(); i-- > 0 && stepTimes[i] >= holdFrom;) {
+            sum += stepRpm[i];
+            ++count;
+        }
+        const double finalRpm = sum / count;
+        const double band = std::max(options.settleBand * std::fabs(finalRpm), options.settleBandMinRpm);
+
+        size_t last = stepRpm.size();
+        for (size_t i = stepRpm.size(); i-- > 0;) {
+            if (std::fabs(stepRpm[i] - finalRpm) > band) {
+                last = i;
+                break;
+            }
+        }
+        ++steps;
+        if (last + 1 == stepRpm.size()) {
+            ++unsettled;
+        } else {
+            const int64_t settledUs = last == stepRpm.size() ? stepTimes.front() : stepTimes[last + 1];
+            const double settling = (settledUs - stepUs) / 1e6;
+            settlingSum += settling;
+            settlingMax = std::max(settlingMax, settling);
+        }
+    }
+    stepTimes.clear();
+    stepRpm.clear();
+}
+
+void SessionAnalyzer::finish(SessionKpi &kpi) {
+    closeStep();
+    kpi.samples = samples;
+    kpi.durationS = samples > 0 ? (lastUs - firstUs) / 1e6 : 0.0;
+    kpi.meanCurrent = samples > 0 ? currentSum / samples : 0.0;
+    kpi.peakCurrent = peakCurrent;
+    kpi.meanRpm = samples > 0 ? rpmSum / samples : 0.0;
+    kpi.peakRpm = peakRpm;
+    kpi.steps = steps;
+    kpi.unsettledSteps = unsettled;
+    kpi.meanSettlingS = steps > unsettled ? settlingSum / (steps - unsettled) : 0.0;
+    kpi.maxSettlingS = settlingMax;
+    kpi.energyJ = energyMilliJ / 1000.0;
+}
+
+SessionKpi analyzeSessionFile(const QString &path, const AnalysisOptions &options) {
+    QElapsedTimer timer;
+    timer.start();
+    SessionKpi kpi;
+    kpi.path = path;
+    kpi.bytes = QFileInfo(path).size();
+    if (isSessionFile(path))
+        analyzeRecording(path, options, kpi);
+    else
+        analyzeCapture(path, options, kpi);
+    kpi.analysisMs = timer.nsecsElapsed() / 1e6;
+    return kpi;
+}
+
+/**
+ * Wątki pobierają kolejne pliki ze wspólnego licznika, zaczynając od największych — czas całości
+ * jest wtedy bliski czasowi najdłuższego pliku, a nie sumie plików przydzielonych jednemu wątkowi.
+ * Każdy wątek zapisuje tylko swoje pozycje wyniku.
+ */
+QVector<SessionKpi> analyzeSessions(const QStringList &paths, int jobs, const AnalysisOptions &options) {
+    QVector<SessionKpi> results(paths.size());
+    if (paths.isEmpty())
+        return results;
+
+    std::vector<std::pair<qint64, int>> order;
+    order.reserve(paths.size());
+    for (int i = 0; i < paths.size(); ++i)
+        order.emplace_back(QFileInfo(paths[i]).size(), i);
+    std::stable_sort(order.begin(), order.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    if (jobs <= 0)
+        jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    jobs = std::min(jobs, static_cast<int>(paths.size()));
+
+    SessionKpi *out = results.data();
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t n = next.fetch_add(1, std::memory_order_relaxed); n < order.size();
+             n = next.fetch_add(1, std::memory_order_relaxed)) {
+            const int i = order[n].second;
+            out[i] = analyzeSessionFile(paths[i], options);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs - 1);
+    for (int t = 1; t < jobs; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread &thread : threads)
+        thread.join();
+    return results;
+}
+
+/**
+ * Wiersz sumaryczny zawiera łączną liczbę próbek, czas, energię i liczniki łącza;
+ * pliki z błędem wypisywane są z opisem błędu zamiast wskaźników.
+ */
+QString formatKpiTable(const QVector<SessionKpi> &kpis) {
+    int failed = 0;
+    for (const SessionKpi &kpi : kpis)
+        failed += kpi.ok() ? 0 : 1;
+    const QString totalLabel = QString("Razem (%1 plików, błędy: %2)").arg(kpis.size()).arg(failed);
+    int nameWidth = static_cast<int>(totalLabel.size());
+    for (const SessionKpi &kpi : kpis)
+        nameWidth = std::max(nameWidth, static_cast<int>(QFileInfo(kpi.path).fileName().size()));
+
+    auto row = [nameWidth](const QString &name, const QStringList &cells) {
+        QString line = name.leftJustified(nameWidth);
+        for (const QString &cell : cells)
+            line += "  " + cell.rightJustified(10);
+        return line + '\n';
+    };
+
+    QString table = row("Plik", {"Próbki", "Czas [s]", "Iśr [mA]", "Imax [mA]", "RPMśr", "RPMmax", "Skoki",
+                                 "Tust [s]", "Tmax [s]", "E [J]", "Błędy CRC", "CRC [%]"});
+    SessionKpi total;
+    for (const SessionKpi &kpi : kpis) {
+        const QString name = QFileInfo(kpi.path).fileName();
+        if (!kpi.ok()) {
+            table += name.leftJustified(nameWidth) + "  BŁĄD: " + kpi.error + '\n';
+            continue;
+        }
+        const QString steps = kpi.unsettledSteps > 0 ? QString("%1/%2").arg(kpi.steps - kpi.unsettledSteps).arg(kpi.steps)
+                                                     : QString::number(kpi.steps);
+        table += row(name, {QString::number(kpi.samples), number(kpi.durationS, 1), number(kpi.meanCurrent, 1),
+                            number(kpi.peakCurrent, 1), number(kpi.meanRpm, 0), number(kpi.peakRpm, 0), steps,
+                            number(kpi.meanSettlingS, 3), number(kpi.maxSettlingS, 3), number(kpi.energyJ, 1),
+                            QString::number(kpi.checksumErrors), number(kpi.checksumErrorRate() * 100.0, 3)});
+        total.samples += kpi.samples;
+        total.durationS += kpi.durationS;
+        total.energyJ += kpi.energyJ;
+        total.frames += kpi.frames;
+        total.checksumErrors += kpi.checksumErrors;
+        total.peakCurrent = std::max(total.peakCurrent, kpi.peakCurrent);
+        total.peakRpm = std::max(total.peakRpm, kpi.peakRpm);
+    }
+    table += row(totalLabel,
+                 {QString::number(total.samples), number(total.durationS, 1), QString(), number(total.peakCurrent, 1),
+                  QString(), number(total.peakRpm, 0), QString(), QString(), QString(), number(total.energyJ, 1),
+                  QString::number(total.checksumErrors), number(total.checksumErrorRate() * 100.0, 3)});
+    return table;
+}
+
+bool writeKpiCsv(const QString &path, const QVector<SessionKpi> &kpis) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    QString csv = "file,format,error,bytes,samples,duration_s,mean_current_ma,peak_current_ma,mean_rpm,peak_rpm,"
+                  "steps,unsettled_steps,mean_settling_s,max_settling_s,energy_j,frames,checksum_errors,"
+                  "dropped_bytes,checksum_error_rate,analysis_ms\n";
+    for (const SessionKpi &kpi : kpis) {
+        QString error = kpi.error;
+        error.replace('"', "\"\"");
+        csv += QStringList{QString("\"%1\"").arg(QString(kpi.path).replace('"', "\"\"")),
+                           kpi.raw ? "raw" : "wds",
+                           QString("\"%1\"").arg(error),
+                           QString::number(kpi.bytes),
+                           QString::number(kpi.samples),
+                           number(kpi.durationS, 3),
+                           number(kpi.meanCurrent, 3),
+                           number(kpi.peakCurrent, 3),
+                           number(kpi.meanRpm, 2),
+                           number(kpi.peakRpm, 2),
+                           QString::number(kpi.steps),
+                           QString::number(kpi.unsettledSteps),
+                           number(kpi.meanSettlingS, 4),
+                           number(kpi.maxSettlingS, 4),
+                           number(kpi.energyJ, 3),
+                           QString::number(kpi.frames),
+                           QString::number(kpi.checksumErrors),
+                           QString::number(kpi.droppedBytes),
+                           QString::number(kpi.checksumErrorRate(), 'g', 6),
+                           number(kpi.analysisMs, 2)}
+                   .join(',')
+               + '\n';
+    }
+    return file.write(csv.toUtf8()) >= 0;
+}
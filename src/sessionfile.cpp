@@ -0,0 +1,436 @@
+/**
+ * @file sessionfile.cpp
+ * @brief Implementacja klas SessionWriter i SessionFile.
+ *
+ * Układ pliku (wszystkie części wyrównane do 8 bajtów):
+ * - nagłówek (64 B): znacznik "WDSSESS1", wersja, liczba kanałów, rozmiar bloku, czas rozpoczęcia,
+ * - bloki: nagłówek bloku (24 B), czasy int64[count], kanały float[count] w kolejności Channel,
+ * - indeks: SessionBlockInfo[liczba bloków],
+ * - stopka (64 B): znacznik "WDSINDX1", położenie indeksu, liczba bloków i próbek, statystyki łącza.
+ */
+
+#include "../inc/sessionfile.h"
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+/// Wersja formatu pliku.
+constexpr uint32_t formatVersion = 1;
+/// Znacznik nagłówka bloku ("WDSB").
+constexpr uint32_t blockMagic = 0x42534457;
+constexpr char headerMagic[8] = {'W', 'D', 'S', 'S', 'E', 'S', 'S', '1'};
+constexpr char footerMagic[8] = {'W', 'D', 'S', 'I', 'N', 'D', 'X', '1'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t blockSamples;
+    uint32_t reserved;
+    int64_t startMs;
+    char padding[32];
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t count;
+    int64_t firstUs;
+    int64_t lastUs;
+};
+
+struct FileFooter {
+    char magic[8];
+    uint64_t indexOffset;
+    uint64_t blockCount;
+    uint64_t sampleCount;
+    uint64_t frames;
+    uint64_t checksumErrors;
+    uint64_t droppedBytes;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 64 && sizeof(FileFooter) == 64, "Nieoczekiwany rozmiar nagłówka lub stopki");
+static_assert(sizeof(BlockHeader) == 24, "Nieoczekiwany rozmiar nagłówka bloku");
+static_assert(sizeof(SessionBlockInfo) % 8 == 0, "Wpis indeksu musi zachować wyrównanie");
+
+/**
+ * Rozmiar bloku o count próbkach (z wyrównaniem do 8 bajtów).
+ */
+qint64 blockBytes(qint64 count) {
+    const qint64 bytes = static_cast<qint64>(sizeof(BlockHeader)) + count * static_cast<qint64>(sizeof(int64_t))
+                         + count * channelCount * static_cast<qint64>(sizeof(float));
+    return (bytes + 7) & ~qint64(7);
+}
+
+/**
+ * Minimum i maksimum kolumny z pominięciem wartości nieskończonych i NaN (NaN, gdy brak skończonych).
+ */
+void columnRange(const float *values, int count, float &minimum, float &maximum) {
+    minimum = std::numeric_limits<float>::infinity();
+    maximum = -std::numeric_limits<float>::infinity();
+    for (int i = 0; i < count; ++i) {
+        if (!std::isfinite(values[i])) continue;
+        minimum = std::min(minimum, values[i]);
+        maximum = std::max(maximum, values[i]);
+    }
+    if (minimum > maximum)
+        minimum = maximum = std::numeric_limits<float>::quiet_NaN();
+}
+
+/**
+ * Obwiednia minimum/maksimum w przedziałach czasu o stałej szerokości. Z każdego przedziału
+ * wychodzą najwyżej dwa punkty w kolejności czasu ich wystąpienia.
+ */
+class Envelope
+{
+public:
+    Envelope(QVector<QPointF> &out, qint64 fromUs, double bucketUs) : out(out), fromUs(fromUs), bucketUs(bucketUs) {}
+
+    int bucketOf(qint64 timeUs) const { return static_cast<int>(static_cast<double>(timeUs - fromUs) / bucketUs); }
+
+    void add(qint64 timeUs, float value) {
+        if (!std::isfinite(value)) return;
+        const int b = bucketOf(timeUs);
+        if (b != bucket) {
+            flush();
+            bucket = b;
+            minT = maxT = timeUs;
+            minV = maxV = value;
+            return;
+        }
+        if (value < minV) { minV = value; minT = timeUs; }
+        if (value > maxV) { maxV = value; maxT = timeUs; }
+    }
+
+    void flush() {
+        if (bucket < 0) return;
+        if (minV == maxV) {
+            out.append(QPointF(minT / 1e6, minV));
+        } else if (minT <= maxT) {
+            out.append(QPointF(minT / 1e6, minV));
+            out.append(QPointF(maxT / 1e6, maxV));
+        } else {
+            out.append(QPointF(maxT / 1e6, maxV));
+            out.append(QPointF(minT / 1e6, minV));
+        }
+        bucket = -1;
+    }
+
+private:
+    QVector<QPointF> &out;
+    qint64 fromUs;
+    double bucketUs;
+    int bucket = -1;
+    qint64 minT = 0, maxT = 0;
+    float minV = 0.0f, maxV = 0.0f;
+};
+}
+
+SessionWriter::~SessionWriter() {
+    if (file.isOpen())
+        close();
+}
+
+/**
+ * Bufory bloku są rezerwowane raz; dopisywanie próbki nie alokuje pamięci.
+ */
+bool SessionWriter::open(const QString &path, int blockSamples) {
+    if (file.isOpen())
+        close();
+
+    this->blockSamples = std::max(16, blockSamples);
+    times.clear();
+    times.reserve(static_cast<size_t>(this->blockSamples));
+    for (std::vector<float> &column : columns) {
+        column.clear();
+        column.reserve(static_cast<size_t>(this->blockSamples));
+    }
+    index.clear();
+    link = SessionLinkStats();
+    samples = 0;
+    lastUs = 0;
+    failed = false;
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    FileHeader header = {};
+    std::memcpy(header.magic, headerMagic, sizeof(header.magic));
+    header.version = formatVersion;
+    header.channels = channelCount;
+    header.blockSamples = static_cast<uint32_t>(this->blockSamples);
+    header.startMs = QDateTime::currentMSecsSinceEpoch();
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Czas jest zapisywany względem pierwszej próbki i nie może się cofać (wymaga tego indeks).
+ */
+void SessionWriter::append(qint64 timeUs, const SerialData &data) {
+    if (!file.isOpen())
+        return;
+    if (samples == 0)
+        originUs = timeUs;
+    lastUs = std::max<int64_t>(lastUs, timeUs - originUs);
+
+    times.push_back(lastUs);
+    for (int c = 0; c < channelCount; ++c)
+        columns[c].push_back(channelValue(data, static_cast<Channel>(c)));
+    ++samples;
+    if (static_cast<int>(times.size()) >= blockSamples)
+        flushBlock();
+}
+
+/**
+ * Podsumowanie kanałów liczone jest przy zapisie, więc czytelnik nie musi przeglądać próbek.
+ */
+void SessionWriter::flushBlock() {
+    if (times.empty())
+        return;
+
+    const int count = static_cast<int>(times.size());
+    SessionBlockInfo info;
+    info.offset = static_cast<uint64_t>(file.pos());
+    info.count = static_cast<uint32_t>(count);
+    info.firstUs = times.front();
+    info.lastUs = times.back();
+    for (int c = 0; c < channelCount; ++c)
+        columnRange(columns[c].data(), count, info.minimum[c], info.maximum[c]);
+
+    const BlockHeader header = {blockMagic, info.count, info.firstUs, info.lastUs};
+    qint64 written = file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    written += file.write(reinterpret_cast<const char *>(times.data()), count * static_cast<qint64>(sizeof(int64_t)));
+    for (const std::vector<float> &column : columns)
+        written += file.write(reinterpret_cast<const char *>(column.data()), count * static_cast<qint64>(sizeof(float)));
+    const qint64 padding = blockBytes(count) - written;
+    if (padding > 0) {
+        const char zeros[8] = {};
+        written += file.write(zeros, padding);
+    }
+    if (written != blockBytes(count))
+        failed = true;
+
+    index.push_back(info);
+    times.clear();
+    for (std::vector<float> &column : columns)
+        column.clear();
+}
+
+/**
+ * Indeks i stopka zapisywane są dopiero przy zamknięciu; plik przerwanego nagrania
+ * (bez stopki) nadal da się otworzyć — SessionFile odbuduje indeks z nagłówków bloków.
+ */
+bool SessionWriter::close() {
+    if (!file.isOpen())
+        return false;
+
+    flushBlock();
+    FileFooter footer = {};
+    std::memcpy(footer.magic, footerMagic, sizeof(footer.magic));
+    footer.indexOffset = static_cast<uint64_t>(file.pos());
+    footer.blockCount = index.size();
+    footer.sampleCount = static_cast<uint64_t>(samples);
+    footer.frames = link.frames;
+    footer.checksumErrors = link.checksumErrors;
+    footer.droppedBytes = link.droppedBytes;
+
+    const qint64 indexBytes = static_cast<qint64>(index.size() * sizeof(SessionBlockInfo));
+    if (file.write(reinterpret_cast<const char *>(index.data()), indexBytes) != indexBytes
+        || file.write(reinterpret_cast<const char *>(&footer), sizeof(footer)) != sizeof(footer))
+        failed = true;
+    if (!file.flush())
+        failed = true;
+    file.close();
+    return !failed;
+}
+
+/**
+ * Otwarcie to mapowanie pliku i sprawdzenie nagłówka, stopki oraz wpisów indeksu
+ * (bez dotykania bloków próbek), więc jego czas nie zależy od długości nagrania.
+ */
+bool SessionFile::open(const QString &path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    size = file.size();
+    if (size < static_cast<qint64>(sizeof(FileHeader))) {
+        error = QStringLiteral("Plik jest za krótki");
+        close();
+        return false;
+    }
+    base = file.map(0, size);
+    if (!base) {
+        error = file.errorString();
+        close();
+        return false;
+    }
+
+    const FileHeader *header = reinterpret_cast<const FileHeader *>(base);
+    if (std::memcmp(header->magic, headerMagic, sizeof(headerMagic)) != 0 || header->version != formatVersion
+        || header->channels != static_cast<uint32_t>(channelCount)) {
+        error = QStringLiteral("Nieobsługiwany format pliku sesji");
+        close();
+        return false;
+    }
+    startMs = header->startMs;
+
+    const qint64 footerOffset = size - static_cast<qint64>(sizeof(FileFooter));
+    const FileFooter *footer = footerOffset >= static_cast<qint64>(sizeof(FileHeader))
+                                   ? reinterpret_cast<const FileFooter *>(base + footerOffset) : nullptr;
+    if (footer && std::memcmp(footer->magic, footerMagic, sizeof(footerMagic)) == 0
+        && footer->indexOffset % 8 == 0 && footer->indexOffset >= sizeof(FileHeader)
+        && footer->blockCount <= static_cast<uint64_t>(std::numeric_limits<int>::max())
+        && footer->indexOffset + footer->blockCount * sizeof(SessionBlockInfo) == static_cast<uint64_t>(footerOffset)) {
+        index = reinterpret_cast<const SessionBlockInfo *>(base + footer->indexOffset);
+        blocks = static_cast<int>(footer->blockCount);
+        qint64 total = 0;
+        bool valid = true;
+        for (int b = 0; b < blocks && valid; ++b) {
+            const SessionBlockInfo &info = index[b];
+            valid = info.offset >= sizeof(FileHeader)
+                    && info.offset + static_cast<uint64_t>(blockBytes(info.count)) <= footer->indexOffset
+                    && (b == 0 || info.firstUs >= index[b - 1].lastUs);
+            total += info.count;
+        }
+        if (valid && total == static_cast<qint64>(footer->sampleCount)) {
+            samples = total;
+            link = {footer->frames, footer->checksumErrors, footer->droppedBytes};
+            storedIndex = true;
+            return true;
+        }
+    }
+
+    rebuildIndex(size);
+    return true;
+}
+
+/**
+ * Bloki odczytywane są kolejno do pierwszego niepełnego lub uszkodzonego; podsumowania kanałów
+ * liczone są od nowa, co wymaga przejrzenia całego pliku.
+ */
+void SessionFile::rebuildIndex(qint64 dataEnd) {
+    qDebug() << "Plik sesji bez indeksu, odbudowa:" << file.fileName();
+    rebuiltIndex.clear();
+    samples = 0;
+    const FileHeader *header = reinterpret_cast<const FileHeader *>(base);
+    qint64 offset = sizeof(FileHeader);
+    while (offset + static_cast<qint64>(sizeof(BlockHeader)) <= dataEnd) {
+        const BlockHeader *block = reinterpret_cast<const BlockHeader *>(base + offset);
+        if (block->magic != blockMagic || block->count == 0 || block->count > header->blockSamples
+            || offset + blockBytes(block->count) > dataEnd
+            || (!rebuiltIndex.empty() && block->firstUs < rebuiltIndex.back().lastUs))
+            break;
+
+        SessionBlockInfo info;
+        info.offset = static_cast<uint64_t>(offset);
+        info.count = block->count;
+        info.firstUs = block->firstUs;
+        info.lastUs = block->lastUs;
+        const float *columns = reinterpret_cast<const float *>(base + offset + sizeof(BlockHeader)
+                                                               + block->count * sizeof(int64_t));
+        for (int c = 0; c < channelCount; ++c)
+            columnRange(columns + static_cast<size_t>(c) * block->count, static_cast<int>(block->count),
+                        info.minimum[c], info.maximum[c]);
+        rebuiltIndex.push_back(info);
+        samples += block->count;
+        offset += blockBytes(block->count);
+    }
+    index = rebuiltIndex.data();
+    blocks = static_cast<int>(rebuiltIndex.size());
+}
+
+void SessionFile::close() {
+    if (base)
+        file.unmap(const_cast<uchar *>(base));
+    file.close();
+    base = nullptr;
+    size = 0;
+    index = nullptr;
+    rebuiltIndex.clear();
+    blocks = 0;
+    samples = 0;
+    startMs = 0;
+    link = SessionLinkStats();
+    storedIndex = false;
+    error.clear();
+}
+
+SessionBlockData SessionFile::blockData(int block) const {
+    const SessionBlockInfo &info = index[block];
+    const uchar *start = base + info.offset + sizeof(BlockHeader);
+    SessionBlockData data;
+    data.count = static_cast<int>(info.count);
+    data.timeUs = reinterpret_cast<const int64_t *>(start);
+    const float *column = reinterpret_cast<const float *>(start + info.count * sizeof(int64_t));
+    for (int c = 0; c < channelCount; ++c)
+        data.columns[c] = column + static_cast<size_t>(c) * info.count;
+    return data;
+}
+
+int SessionFile::findBlock(qint64 timeUs) const {
+    const SessionBlockInfo *end = index + blocks;
+    return static_cast<int>(std::lower_bound(index, end, timeUs,
+                                             [](const SessionBlockInfo &info, qint64 t) { return info.lastUs < t; })
+                            - index);
+}
+
+/**
+ * Blok nie dłuższy niż przedział obwiedni trafia w całości do przedziału swojego środka — przy
+ * przeglądzie całego długiego nagrania wynik składany jest więc wyłącznie z indeksu, a bloki
+ * próbek (poza dwoma skrajnymi) nie są w ogóle odczytywane.
+ */
+QVector<QPointF> SessionFile::channelPoints(Channel channel, qint64 fromUs, qint64 toUs, int maxPoints) const {
+    QVector<QPointF> points;
+    if (toUs < fromUs || blocks == 0)
+        return points;
+
+    const int c = static_cast<int>(channel);
+    const int first = findBlock(fromUs);
+    int last = first;
+    qint64 total = 0;
+    while (last < blocks && index[last].firstUs <= toUs)
+        total += index[last++].count;
+
+    if (total <= maxPoints) {
+        points.reserve(static_cast<int>(total));
+        for (int b = first; b < last; ++b) {
+            const SessionBlockData data = blockData(b);
+            int i = static_cast<int>(std::lower_bound(data.timeUs, data.timeUs + data.count, fromUs) - data.timeUs);
+            for (; i < data.count && data.timeUs[i] <= toUs; ++i)
+                points.append(QPointF(data.timeUs[i] / 1e6, data.columns[c][i]));
+        }
+        return points;
+    }
+
+    const int buckets = std::max(1, maxPoints / 2);
+    const double bucketUs = static_cast<double>(toUs - fromUs + 1) / buckets;
+    Envelope envelope(points, fromUs, bucketUs);
+    points.reserve(2 * buckets);
+    for (int b = first; b < last; ++b) {
+        const SessionBlockInfo &info = index[b];
+        if (info.firstUs >= fromUs && info.lastUs <= toUs && info.lastUs - info.firstUs <= bucketUs) {
+            const qint64 middle = info.firstUs + (info.lastUs - info.firstUs) / 2;
+            envelope.add(middle, info.minimum[c]);
+            envelope.add(middle, info.maximum[c]);
+            continue;
+        }
+        const SessionBlockData data = blockData(b);
+        int i = static_cast<int>(std::lower_bound(data.timeUs, data.timeUs + data.count, fromUs) - data.timeUs);
+        for (; i < data.count && data.timeUs[i] <= toUs; ++i)
+            envelope.add(data.timeUs[i], data.columns[c][i]);
+    }
+    envelope.flush();
+    return points;
+}
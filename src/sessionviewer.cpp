@@ -0,0 +1,273 @@
+/**
+ * @file sessionviewer.cpp
+ * @brief Implementacja klasy SessionViewer.
+ */
+
+#include "../inc/sessionviewer.h"
+#include <QComboBox>
+#include <QDateTime>
+#include <QDebug>
+#include <QDoubleSpinBox>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSlider>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+namespace {
+/// Maksymalna liczba punktów serii jednego nagrania (obwiednia min/maks powyżej).
+constexpr int maxSeriesPoints = 2000;
+/// Rozdzielczość suwaka położenia (promile długości najdłuższego nagrania).
+constexpr int sliderSteps = 1000;
+
+/**
+ * Typ wykresu ChartsManager odpowiadający kanałowi.
+ */
+ChartType chartTypeOf(Channel channel) {
+    switch (channel) {
+    case Channel::Pwm:     return ChartType::PWM;
+    case Channel::Voltage: return ChartType::Voltage;
+    case Channel::Current: return ChartType::Current;
+    case Channel::Power:   return ChartType::Power;
+    default:               return ChartType::RPM;
+    }
+}
+}
+
+/**
+ * Okno składa się z paska narzędzi, listy nagrań oraz wykresów przeglądu i szczegółowego
+ * rozdzielonych suwakiem; wykresy tworzy ChartsManager przy pierwszym pokazaniu okna.
+ */
+SessionViewer::SessionViewer(QWidget *parent)
+    : QWidget(parent, Qt::Window), overviewCharts(new ChartsManager(this)), detailCharts(new ChartsManager(this)) {
+    setWindowTitle(tr("Przeglądarka sesji"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(1100, 750);
+
+    auto *openButton = new QPushButton(tr("Otwórz..."), this);
+    auto *closeButton = new QPushButton(tr("Zamknij nagranie"), this);
+    channelBox = new QComboBox(this);
+    channelBox->addItem("RPM", static_cast<int>(Channel::Rpm));
+    channelBox->addItem("PWM", static_cast<int>(Channel::Pwm));
+    channelBox->addItem(tr("Prąd"), static_cast<int>(Channel::Current));
+    channelBox->addItem(tr("Napięcie"), static_cast<int>(Channel::Voltage));
+    channelBox->addItem(tr("Moc"), static_cast<int>(Channel::Power));
+    positionBox = new QDoubleSpinBox(this);
+    positionBox->setDecimals(3);
+    positionBox->setSuffix(" s");
+    positionBox->setRange(0.0, 0.0);
+    windowBox = new QDoubleSpinBox(this);
+    windowBox->setDecimals(3);
+    windowBox->setSuffix(" s");
+    windowBox->setRange(0.001, 1e6);
+    windowBox->setValue(5.0);
+
+    auto *toolbar = new QHBoxLayout;
+    toolbar->addWidget(openButton);
+    toolbar->addWidget(closeButton);
+    toolbar->addSpacing(20);
+    toolbar->addWidget(new QLabel(tr("Kanał:"), this));
+    toolbar->addWidget(channelBox);
+    toolbar->addWidget(new QLabel(tr("Od:"), this));
+    toolbar->addWidget(positionBox);
+    toolbar->addWidget(new QLabel(tr("Okno:"), this));
+    toolbar->addWidget(windowBox);
+    toolbar->addStretch();
+
+    sessionList = new QListWidget(this);
+    sessionList->setMaximumHeight(110);
+    auto *overviewPanel = new QWidget;
+    auto *overviewLayout = new QVBoxLayout(overviewPanel);
+    overviewLayout->setContentsMargins(0, 0, 0, 0);
+    overviewHost = new QWidget(overviewPanel);
+    overviewHost->setLayout(new QVBoxLayout);
+    overviewHost->layout()->setContentsMargins(0, 0, 0, 0);
+    positionSlider = new QSlider(Qt::Horizontal, overviewPanel);
+    positionSlider->setRange(0, sliderSteps);
+    overviewLayout->addWidget(overviewHost, 1);
+    overviewLayout->addWidget(positionSlider);
+    detailHost = new QWidget;
+    detailHost->setLayout(new QVBoxLayout);
+    detailHost->layout()->setContentsMargins(0, 0, 0, 0);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(overviewPanel);
+    splitter->addWidget(detailHost);
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 2);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(toolbar);
+    layout->addWidget(sessionList);
+    layout->addWidget(splitter);
+
+    setupCharts(shownType);
+
+    connect(openButton, &QPushButton::clicked, this, &SessionViewer::openFiles);
+    connect(closeButton, &QPushButton::clicked, this, &SessionViewer::closeSelected);
+    connect(channelBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &SessionViewer::changeChannel);
+    connect(positionBox, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &SessionViewer::updateDetail);
+    connect(windowBox, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &SessionViewer::updateDetail);
+    connect(positionSlider, &QSlider::valueChanged, this, &SessionViewer::handleSliderMoved);
+    connect(sessionList, &QListWidget::itemChanged, this, &SessionViewer::handleItemChanged);
+}
+
+/**
+ * Czas otwarcia (mapowanie i sprawdzenie indeksu) pokazywany jest na liście nagrań.
+ */
+bool SessionViewer::openSession(const QString &path) {
+    auto session = std::make_unique<SessionFile>();
+    QElapsedTimer timer;
+    timer.start();
+    if (!session->open(path)) {
+        qDebug() << "Nie udało się otworzyć nagrania" << path << ":" << session->errorString();
+        return false;
+    }
+    const double openMs = timer.nsecsElapsed() / 1e6;
+
+    QString text = tr("%1 — %2, %3 s, %4 próbek, otwarcie %5 ms")
+                       .arg(QFileInfo(path).fileName(),
+                            QDateTime::fromMSecsSinceEpoch(session->startMsSinceEpoch()).toString("yyyy-MM-dd HH:mm:ss"))
+                       .arg(session->durationUs() / 1e6, 0, 'f', 1)
+                       .arg(session->sampleCount())
+                       .arg(openMs, 0, 'f', 2);
+    if (!session->hasStoredIndex())
+        text += tr(" (indeks odbudowany)");
+    auto *item = new QListWidgetItem(text);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+    item->setForeground(ChartsManager::overlayColor(static_cast<int>(sessions.size())));
+    {
+        const QSignalBlocker blocker(sessionList);
+        sessionList->addItem(item);
+    }
+    sessions.push_back(std::move(session));
+
+    positionBox->setRange(0.0, longestDuration());
+    updateOverview();
+    updateDetail();
+    return true;
+}
+
+void SessionViewer::openFiles() {
+    const QStringList paths = QFileDialog::getOpenFileNames(this, tr("Otwórz nagrania"), QString(),
+                                                            tr("Nagranie sesji (*.wds);;Wszystkie pliki (*)"));
+    for (const QString &path : paths)
+        openSession(path);
+}
+
+/**
+ * Numery serii nakładanych odpowiadają pozycjom na liście, więc po usunięciu nagrania
+ * serie są tworzone od nowa.
+ */
+void SessionViewer::closeSelected() {
+    const int row = sessionList->currentRow();
+    if (row < 0 || row >= static_cast<int>(sessions.size()))
+        return;
+    {
+        const QSignalBlocker blocker(sessionList);
+        delete sessionList->takeItem(row);
+        for (int i = 0; i < sessionList->count(); ++i)
+            sessionList->item(i)->setForeground(ChartsManager::overlayColor(i));
+    }
+    sessions.erase(sessions.begin() + row);
+    overviewCharts->clearOverlays(shownType);
+    detailCharts->clearOverlays(shownType);
+    positionBox->setRange(0.0, longestDuration());
+    updateOverview();
+    updateDetail();
+}
+
+void SessionViewer::changeChannel() {
+    overviewCharts->removeChart(shownType);
+    detailCharts->removeChart(shownType);
+    setupCharts(chartTypeOf(currentChannel()));
+    updateOverview();
+    updateDetail();
+}
+
+void SessionViewer::setupCharts(ChartType type) {
+    shownType = type;
+    const QString title = channelBox->currentText();
+    QString unit;
+    switch (type) {
+    case ChartType::PWM:     unit = "PWM [%]"; break;
+    case ChartType::Voltage: unit = "V"; break;
+    case ChartType::Current: unit = "mA"; break;
+    case ChartType::Power:   unit = "mW"; break;
+    default:                 unit = "obr/min"; break;
+    }
+    overviewCharts->setupChart(type, overviewHost->layout(), tr("%1 — całe nagrania").arg(title), unit, 1.0f, 5, true);
+    detailCharts->setupChart(type, detailHost->layout(), title, unit, 1.0f, 5, true);
+    overviewCharts->setAutoRange(type, true);
+    detailCharts->setAutoRange(type, true);
+}
+
+Channel SessionViewer::currentChannel() const {
+    return static_cast<Channel>(channelBox->currentData().toInt());
+}
+
+qreal SessionViewer::longestDuration() const {
+    qint64 longest = 0;
+    for (const auto &session : sessions)
+        longest = qMax(longest, session->durationUs());
+    return longest / 1e6;
+}
+
+QVector<QPointF> SessionViewer::sessionPoints(const SessionFile &session, qreal from, qreal to) const {
+    QVector<QPointF> points = session.channelPoints(currentChannel(), static_cast<qint64>(from * 1e6),
+                                                    static_cast<qint64>(to * 1e6), maxSeriesPoints);
+    if (shownType == ChartType::PWM) {
+        for (QPointF &p : points)
+            p.setY(p.y() / 2.55);
+    }
+    return points;
+}
+
+/**
+ * Obwiednia całego nagrania powstaje z podsumowań bloków w indeksie, więc jej koszt
+ * zależy od liczby bloków, a nie próbek.
+ */
+void SessionViewer::updateOverview() {
+    const qreal duration = longestDuration();
+    overviewCharts->setXRange(shownType, 0.0, qMax(duration, 1.0));
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        const SessionFile &session = *sessions[i];
+        const bool visible = sessionList->item(static_cast<int>(i))->checkState() == Qt::Checked;
+        overviewCharts->setOverlay(shownType, static_cast<int>(i), QFileInfo(session.fileName()).fileName(),
+                                   visible ? sessionPoints(session, 0.0, session.durationUs() / 1e6) : QVector<QPointF>());
+    }
+}
+
+/**
+ * Okno szczegółowe to wyszukiwanie binarne w indeksie i odczyt tylko bloków nachodzących na okno.
+ */
+void SessionViewer::updateDetail() {
+    const qreal from = positionBox->value();
+    const qreal to = from + windowBox->value();
+    detailCharts->setXRange(shownType, from, to);
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        const SessionFile &session = *sessions[i];
+        const bool visible = sessionList->item(static_cast<int>(i))->checkState() == Qt::Checked;
+        detailCharts->setOverlay(shownType, static_cast<int>(i), QFileInfo(session.fileName()).fileName(),
+                                 visible ? sessionPoints(session, from, to) : QVector<QPointF>());
+    }
+
+    const QSignalBlocker blocker(positionSlider);
+    const qreal duration = longestDuration();
+    positionSlider->setValue(duration > 0.0 ? qRound(from / duration * sliderSteps) : 0);
+}
+
+void SessionViewer::handleSliderMoved(int value) {
+    positionBox->setValue(longestDuration() * value / sliderSteps);
+}
+
+void SessionViewer::handleItemChanged(QListWidgetItem *) {
+    updateOverview();
+    updateDetail();
+}
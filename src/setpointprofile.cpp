@@ -0,0 +1,153 @@
+/**
+ * @file setpointprofile.cpp
+ * @brief Implementacja klasy SetpointProfile.
+ *
+ * Rampy i sinusoidy są rozwijane przy wczytaniu do pojedynczych poleceń, dzięki czemu wątek
+ * wykonujący profil (ProfileRunner) nie wykonuje żadnych obliczeń między kolejnymi terminami.
+ * Liczby są czytane w locale "C" niezależnie od ustawień systemu.
+ */
+
+#include "../inc/setpointprofile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <locale>
+#include <sstream>
+
+namespace {
+
+/// Maksymalna liczba poleceń po rozwinięciu ramp i sinusoid.
+constexpr size_t maxProfileSteps = 1000000;
+/// Najmniejszy krok rampy/sinusoidy — rozdzielczość terminów profilu [s].
+constexpr double minStepSeconds = 1e-6;
+/// Największy czas polecenia (zakres bez przepełnienia przy zamianie na µs) [s].
+constexpr double maxTimeSeconds = 1e9;
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * Zamienia nazwę kanału na typ polecenia (wartości DataType) i skalę wartości.
+ */
+bool channelType(const std::string &name, uint8_t &type, float &scale) {
+    scale = 1.0f;
+    if (name == "pwm") { type = 0x01; scale = 2.55f; return true; }
+    if (name == "rpm") { type = 0x02; return true; }
+    if (name == "kp") { type = 0x03; return true; }
+    if (name == "ki") { type = 0x04; return true; }
+    if (name == "kd") { type = 0x05; return true; }
+    if (name == "mode") { type = 0x06; return true; }
+    if (name == "start") { type = 0x07; return true; }
+    return false;
+}
+
+int64_t secondsToUs(double seconds) {
+    return static_cast<int64_t>(std::llround(seconds * 1e6));
+}
+
+} // namespace
+
+/**
+ * Dla rampy i sinusoidy generowane są polecenia w chwilach t0, t0 + krok, ..., włącznie z t1.
+ */
+bool SetpointProfile::parse(const std::string &text, std::string &error) {
+    std::vector<ProfileStep> parsed;
+    std::istringstream input(text);
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream fields(line);
+        fields.imbue(std::locale::classic());
+        std::string first;
+        if (!(fields >> first))
+            continue;
+
+        const auto fail = [&](const std::string &reason) {
+            error = "linia " + std::to_string(lineNumber) + ": " + reason;
+            return false;
+        };
+
+        std::string channel;
+        uint8_t type = 0;
+        float scale = 1.0f;
+
+        if (first == "ramp" || first == "sine") {
+            const bool sine = first == "sine";
+            double t0 = 0, t1 = 0, a = 0, b = 0, frequency = 0, step = 0;
+            fields >> t0 >> t1 >> channel >> a >> b;
+            if (sine)
+                fields >> frequency;
+            fields >> step;
+            if (fields.fail())
+                return fail(sine ? "oczekiwano: sine <t0> <t1> <kanał> <środek> <amplituda> <f> <krok>"
+                                 : "oczekiwano: ramp <t0> <t1> <kanał> <v0> <v1> <krok>");
+            if (!channelType(channel, type, scale))
+                return fail("nieznany kanał '" + channel + "'");
+            if (!std::isfinite(a) || !std::isfinite(b) || !std::isfinite(frequency))
+                return fail("wartości muszą być skończone");
+            if (!(t0 >= 0 && t0 <= t1 && t1 <= maxTimeSeconds))
+                return fail("wymagane 0 <= t0 <= t1 <= " + std::to_string(static_cast<int64_t>(maxTimeSeconds)) + " s");
+            if (!(step >= minStepSeconds))
+                return fail("krok musi wynosić co najmniej 1 µs");
+
+            // Liczba poleceń sprawdzana jako double — rzutowanie dopiero w dopuszczalnym zakresie
+            const double steps = std::floor((t1 - t0) / step + 1e-9) + 1.0;
+            if (steps > static_cast<double>(maxProfileSteps - parsed.size()))
+                return fail("zbyt wiele poleceń po rozwinięciu");
+            const auto count = static_cast<size_t>(steps);
+            for (size_t i = 0; i < count; ++i) {
+                const double t = t0 + static_cast<double>(i) * step;
+                double value;
+                if (sine)
+                    value = a + b * std::sin(2.0 * pi * frequency * (t - t0));
+                else
+                    value = t1 > t0 ? a + (b - a) * (t - t0) / (t1 - t0) : b;
+                parsed.push_back({secondsToUs(t), type, static_cast<float>(value * scale)});
+            }
+            continue;
+        }
+
+        std::istringstream timeField(first);
+        timeField.imbue(std::locale::classic());
+        double t = 0, value = 0;
+        timeField >> t;
+        fields >> channel >> value;
+        if (timeField.fail() || fields.fail())
+            return fail("oczekiwano: <t> <kanał> <wartość>");
+        if (!channelType(channel, type, scale))
+            return fail("nieznany kanał '" + channel + "'");
+        if (!std::isfinite(value))
+            return fail("wartość musi być skończona");
+        if (!(t >= 0 && t <= maxTimeSeconds))
+            return fail("czas musi mieścić się w zakresie 0-" + std::to_string(static_cast<int64_t>(maxTimeSeconds)) + " s");
+        if (parsed.size() + 1 > maxProfileSteps)
+            return fail("zbyt wiele poleceń");
+        parsed.push_back({secondsToUs(t), type, static_cast<float>(value * scale)});
+    }
+
+    if (parsed.empty()) {
+        error = "profil nie zawiera poleceń";
+        return false;
+    }
+
+    std::stable_sort(parsed.begin(), parsed.end(),
+                     [](const ProfileStep &a, const ProfileStep &b) { return a.timeUs < b.timeUs; });
+    profileSteps = std::move(parsed);
+    return true;
+}
+
+bool SetpointProfile::load(const std::string &path, std::string &error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "nie można otworzyć pliku " + path;
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return parse(content.str(), error);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file shmtelemetry.cpp
+ * @brief Implementacja klas ShmTelemetryWriter i ShmTelemetryReader.
+ *
+ * Protokół gniazda próbek (seqlock): zapis ustawia nieparzysty numer sekwencji, kopiuje dane
+ * i ustawia 2*(index+1). Czytelnik kopiuje dane tylko wtedy, gdy numer przed i po kopiowaniu
+ * jest równy oczekiwanemu; większy numer oznacza, że gniazdo zostało już nadpisane.
+ */
+
+#include "../inc/shmtelemetry.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WDS_HAVE_POSIX_SHM 1
+#endif
+
+namespace {
+constexpr uint64_t sampleMask = shmSampleCapacity - 1;
+constexpr uint64_t commandMask = shmCommandCapacity - 1;
+static_assert((shmSampleCapacity & sampleMask) == 0, "Pojemność bufora próbek musi być potęgą dwójki");
+static_assert((shmCommandCapacity & commandMask) == 0, "Pojemność kolejki poleceń musi być potęgą dwójki");
+
+#ifdef WDS_HAVE_POSIX_SHM
+/**
+ * Otwiera i mapuje segment; przy create = true ustawia jego rozmiar.
+ */
+ShmLayout *mapSegment(const std::string &name, bool create, std::string &error) {
+    const int fd = shm_open(name.c_str(), create ? (O_CREAT | O_RDWR) : O_RDWR, 0660);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+
+    struct stat info;
+    if (create && ftruncate(fd, sizeof(ShmLayout)) < 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return nullptr;
+    }
+    if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(ShmLayout)) {
+        error = "segment ma nieprawidłowy rozmiar";
+        ::close(fd);
+        return nullptr;
+    }
+
+    void *memory = mmap(nullptr, sizeof(ShmLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    return static_cast<ShmLayout *>(memory);
+}
+#endif
+} // namespace
+
+ShmTelemetryWriter::~ShmTelemetryWriter() {
+    close();
+}
+
+bool ShmTelemetryWriter::isSupported() {
+#ifdef WDS_HAVE_POSIX_SHM
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Segment pozostały po poprzednim uruchomieniu jest przejmowany i inicjalizowany od nowa.
+ * Zwiększenie numeru sesji informuje dołączonych czytelników o konieczności ponownej synchronizacji.
+ */
+bool ShmTelemetryWriter::open(const std::string &name) {
+#ifdef WDS_HAVE_POSIX_SHM
+    close();
+    layout = mapSegment(name, true, lastError);
+    if (!layout)
+        return false;
+    segmentName = name;
+
+    layout->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    layout->version = shmLayoutVersion;
+    layout->sampleCapacity = shmSampleCapacity;
+    layout->commandCapacity = shmCommandCapacity;
+    layout->published.store(0, std::memory_order_relaxed);
+    for (auto &slot : layout->samples)
+        slot.sequence.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < shmCommandCapacity; ++i)
+        layout->commands[i].sequence.store(i, std::memory_order_relaxed);
+    layout->commandWrite.store(0, std::memory_order_relaxed);
+    layout->commandRead.store(0, std::memory_order_relaxed);
+    layout->session.fetch_add(1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    layout->magic = shmMagic;
+    return true;
+#else
+    (void)name;
+    lastError = "pamięć współdzielona POSIX jest niedostępna na tej platformie";
+    return false;
+#endif
+}
+
+void ShmTelemetryWriter::close() {
+#ifdef WDS_HAVE_POSIX_SHM
+    if (layout) {
+        munmap(layout, sizeof(ShmLayout));
+        shm_unlink(segmentName.c_str());
+    }
+#endif
+    layout = nullptr;
+}
+
+void ShmTelemetryWriter::publish(int64_t timeUs, const SerialData &data) {
+    if (!layout)
+        return;
+
+    const uint64_t index = layout->published.load(std::memory_order_relaxed);
+    ShmLayout::SampleSlot &slot = layout->samples[index & sampleMask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timeUs = timeUs;
+    slot.data = data;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    layout->published.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * Jedyny konsument kolejki — wywoływać tylko z jednego wątku.
+ */
+bool ShmTelemetryWriter::takeCommand(ShmCommand &command) {
+    if (!layout)
+        return false;
+
+    const uint64_t position = layout->commandRead.load(std::memory_order_relaxed);
+    ShmLayout::CommandSlot &slot = layout->commands[position & commandMask];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+
+    command = slot.command;
+    slot.sequence.store(position + shmCommandCapacity, std::memory_order_release);
+    layout->commandRead.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+ShmTelemetryReader::~ShmTelemetryReader() {
+    close();
+}
+
+bool ShmTelemetryReader::open(const std::string &name) {
+#ifdef WDS_HAVE_POSIX_SHM
+    close();
+    layout = mapSegment(name, false, lastError);
+    if (!layout)
+        return false;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (layout->magic != shmMagic || layout->version != shmLayoutVersion
+        || layout->sampleCapacity != shmSampleCapacity || layout->commandCapacity != shmCommandCapacity) {
+        lastError = "niezgodna wersja lub niezainicjalizowany segment";
+        close();
+        return false;
+    }
+    session = layout->session.load(std::memory_order_acquire);
+    next = layout->published.load(std::memory_order_acquire);
+    lost = 0;
+    return true;
+#else
+    (void)name;
+    lastError = "pamięć współdzielona POSIX jest niedostępna na tej platformie";
+    return false;
+#endif
+}
+
+void ShmTelemetryReader::close() {
+#ifdef WDS_HAVE_POSIX_SHM
+    if (layout)
+        munmap(layout, sizeof(ShmLayout));
+#endif
+    layout = nullptr;
+}
+
+/**
+ * Po ponownym otwarciu segmentu przez aplikację (nowa sesja) odczyt zaczyna się od najnowszej próbki.
+ * Czytelnik, który został wyprzedzony o więcej niż pojemność bufora, przeskakuje do najstarszej
+ * dostępnej próbki, a różnicę dolicza do lostSamples().
+ */
+size_t ShmTelemetryReader::read(ShmSample *out, size_t maxSamples) {
+    if (!layout)
+        return 0;
+
+    const uint64_t currentSession = layout->session.load(std::memory_order_acquire);
+    if (currentSession != session) {
+        session = currentSession;
+        next = layout->published.load(std::memory_order_acquire);
+    }
+
+    const uint64_t published = layout->published.load(std::memory_order_acquire);
+    if (published < next)
+        next = published;
+    if (published - next > shmSampleCapacity) {
+        lost += published - next - shmSampleCapacity;
+        next = published - shmSampleCapacity;
+    }
+
+    size_t count = 0;
+    while (next < published && count < maxSamples) {
+        const ShmLayout::SampleSlot &slot = layout->samples[next & sampleMask];
+        const uint64_t expected = 2 * next + 2;
+
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before < expected)
+            break;
+
+        ShmSample sample;
+        sample.index = next;
+        sample.timeUs = slot.timeUs;
+        std::memcpy(&sample.data, &slot.data, sizeof(SerialData));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+        ++next;
+        if (before != expected || after != expected) {
+            ++lost;
+            continue;
+        }
+        out[count++] = sample;
+    }
+    return count;
+}
+
+/**
+ * Wstawienie polecenia rezerwuje gniazdo operacją CAS na commandWrite, więc wielu klientów
+ * może wysyłać polecenia jednocześnie.
+ */
+bool ShmTelemetryReader::sendCommand(uint8_t type, float value) {
+    if (!layout)
+        return false;
+
+    uint64_t position = layout->commandWrite.load(std::memory_order_relaxed);
+    ShmLayout::CommandSlot *slot = nullptr;
+    for (;;) {
+        slot = &layout->commands[position & commandMask];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+        if (difference == 0) {
+            if (layout->commandWrite.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            lastError = "kolejka poleceń jest pełna";
+            return false;
+        } else {
+            position = layout->commandWrite.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->command.type = type;
+    slot->command.value = value;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
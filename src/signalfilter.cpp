@@ -0,0 +1,364 @@
+/**
+ * @file signalfilter.cpp
+ * @brief Implementacja stopni filtra, klasy FilterChain i klasy ChannelFilterBank.
+ *
+ * Filtry rekurencyjne (EMA, Butterworth, Kalman) są z natury szeregowe w czasie, dlatego
+ * pętle stopni są krótkie, bez rozgałęzień i bez wywołań na próbkę, a stan trzymany jest
+ * w zmiennych lokalnych na czas bloku. Kopiowanie kanału do ciągłej tablicy i z powrotem
+ * (z wybranym polem SerialData ustalonym raz na blok) kompilator wektoryzuje.
+ * Parametry czytane są w locale "C" niezależnie od ustawień systemu.
+ */
+
+#include "../inc/signalfilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <sstream>
+#include <type_traits>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * Mediana krocząca: bufor cykliczny okna i posortowana kopia aktualizowana wstawieniem
+ * (koszt O(N) na próbkę dla N <= 31, bez alokacji).
+ */
+class MedianStage : public FilterStage
+{
+public:
+    explicit MedianStage(size_t window) : ring(window), sorted() { sorted.reserve(window); }
+
+    void process(float *samples, size_t count) override {
+        const size_t window = ring.size();
+        for (size_t i = 0; i < count; ++i) {
+            const float in = samples[i];
+            if (sorted.size() == window) {
+                const float out = ring[head];
+                sorted.erase(std::lower_bound(sorted.begin(), sorted.end(), out));
+            }
+            ring[head] = in;
+            head = head + 1 == window ? 0 : head + 1;
+            sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), in), in);
+            samples[i] = sorted[sorted.size() / 2];
+        }
+    }
+
+    void reset() override {
+        sorted.clear();
+        head = 0;
+    }
+
+private:
+    std::vector<float> ring;   ///< Ostatnie próbki (bufor cykliczny).
+    std::vector<float> sorted; ///< Próbki okna posortowane rosnąco.
+    size_t head = 0;           ///< Pozycja najstarszej próbki w ring.
+};
+
+/**
+ * Średnia wykładnicza y += alfa * (x - y); pierwsza próbka inicjalizuje stan.
+ */
+class EmaStage : public FilterStage
+{
+public:
+    explicit EmaStage(float alpha) : alpha(alpha) {}
+
+    void process(float *samples, size_t count) override {
+        if (count == 0)
+            return;
+        if (!initialized) {
+            state = samples[0];
+            initialized = true;
+        }
+        float y = state;
+        for (size_t i = 0; i < count; ++i) {
+            y += alpha * (samples[i] - y);
+            samples[i] = y;
+        }
+        state = y;
+    }
+
+    void reset() override { initialized = false; }
+
+private:
+    float alpha;              ///< Współczynnik wygładzania.
+    float state = 0.0f;       ///< Ostatnia wartość wyjściowa.
+    bool initialized = false; ///< Czy stan został zainicjalizowany.
+};
+
+/**
+ * Dolnoprzepustowy Butterworth 2. rzędu (transformacja biliniowa), postać transponowana II.
+ * Stan inicjalizowany jest stanem ustalonym dla pierwszej próbki, bez stanu przejściowego od zera.
+ */
+class ButterworthStage : public FilterStage
+{
+public:
+    ButterworthStage(double cutoffHz, double sampleHz) {
+        const double k = std::tan(pi * cutoffHz / sampleHz);
+        const double q = 1.0 / std::sqrt(2.0);
+        const double norm = 1.0 / (1.0 + k / q + k * k);
+        b0 = k * k * norm;
+        b1 = 2.0 * b0;
+        b2 = b0;
+        a1 = 2.0 * (k * k - 1.0) * norm;
+        a2 = (1.0 - k / q + k * k) * norm;
+    }
+
+    void process(float *samples, size_t count) override {
+        if (count == 0)
+            return;
+        if (!initialized) {
+            const double x0 = samples[0];
+            z1 = (1.0 - b0) * x0;
+            z2 = (b2 - a2) * x0;
+            initialized = true;
+        }
+        double s1 = z1, s2 = z2;
+        for (size_t i = 0; i < count; ++i) {
+            const double x = samples[i];
+            const double y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            samples[i] = static_cast<float>(y);
+        }
+        z1 = s1;
+        z2 = s2;
+    }
+
+    void reset() override { initialized = false; }
+
+private:
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0; ///< Współczynniki licznika.
+    double a1 = 0.0, a2 = 0.0;           ///< Współczynniki mianownika (a0 = 1).
+    double z1 = 0.0, z2 = 0.0;           ///< Stan filtra.
+    bool initialized = false;            ///< Czy stan został zainicjalizowany.
+};
+
+/**
+ * Skalarny filtr Kalmana dla modelu błądzenia losowego: predykcja P += q, korekta ze wzmocnieniem
+ * K = P / (P + r). Pierwsza próbka inicjalizuje estymatę (P = r).
+ */
+class KalmanStage : public FilterStage
+{
+public:
+    KalmanStage(float processNoise, float measurementNoise) : q(processNoise), r(measurementNoise) {}
+
+    void process(float *samples, size_t count) override {
+        if (count == 0)
+            return;
+        if (!initialized) {
+            estimate = samples[0];
+            variance = r;
+            initialized = true;
+        }
+        float x = estimate, p = variance;
+        for (size_t i = 0; i < count; ++i) {
+            p += q;
+            const float gain = p / (p + r);
+            x += gain * (samples[i] - x);
+            p *= 1.0f - gain;
+            samples[i] = x;
+        }
+        estimate = x;
+        variance = p;
+    }
+
+    void reset() override { initialized = false; }
+
+private:
+    float q;                  ///< Wariancja szumu procesu.
+    float r;                  ///< Wariancja szumu pomiaru.
+    float estimate = 0.0f;    ///< Estymata wartości.
+    float variance = 0.0f;    ///< Wariancja estymaty.
+    bool initialized = false; ///< Czy stan został zainicjalizowany.
+};
+
+/**
+ * Dzieli tekst według separatora (bez pustych elementów na końcach).
+ */
+std::vector<std::string> split(const std::string &text, char separator) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream input(text);
+    while (std::getline(input, part, separator)) {
+        part.erase(0, part.find_first_not_of(" \t"));
+        part.erase(part.find_last_not_of(" \t") + 1);
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+/**
+ * Czyta liczbę w locale "C"; cały tekst musi być liczbą.
+ */
+bool toNumber(const std::string &text, double &value) {
+    std::istringstream input(text);
+    input.imbue(std::locale::classic());
+    input >> value;
+    return !input.fail() && input.eof() && std::isfinite(value);
+}
+
+/**
+ * Tworzy stopień z opisu "<nazwa>:<parametr>[:<parametr>]".
+ */
+std::unique_ptr<FilterStage> makeStage(const std::string &text, std::string &error) {
+    const std::vector<std::string> fields = split(text, ':');
+    const std::string &name = fields.front();
+    std::vector<double> params;
+    for (size_t i = 1; i < fields.size(); ++i) {
+        double value = 0.0;
+        if (!toNumber(fields[i], value)) {
+            error = "niepoprawna liczba '" + fields[i] + "' w '" + text + "'";
+            return nullptr;
+        }
+        params.push_back(value);
+    }
+
+    if (name == "median") {
+        if (params.size() != 1 || params[0] < 3 || params[0] > 31 || std::fmod(params[0], 2.0) != 1.0) {
+            error = "oczekiwano: median:<N>, N nieparzyste 3-31";
+            return nullptr;
+        }
+        return std::make_unique<MedianStage>(static_cast<size_t>(params[0]));
+    }
+    if (name == "ema") {
+        if (params.size() != 1 || params[0] <= 0.0 || params[0] > 1.0) {
+            error = "oczekiwano: ema:<alfa>, 0 < alfa <= 1";
+            return nullptr;
+        }
+        return std::make_unique<EmaStage>(static_cast<float>(params[0]));
+    }
+    if (name == "butter") {
+        if (params.size() != 2 || params[0] <= 0.0 || params[1] <= 2.0 * params[0]) {
+            error = "oczekiwano: butter:<fc>:<fs>, 0 < fc < fs/2";
+            return nullptr;
+        }
+        return std::make_unique<ButterworthStage>(params[0], params[1]);
+    }
+    if (name == "kalman") {
+        if (params.size() != 2 || params[0] <= 0.0 || params[1] <= 0.0) {
+            error = "oczekiwano: kalman:<q>:<r>, q > 0, r > 0";
+            return nullptr;
+        }
+        return std::make_unique<KalmanStage>(static_cast<float>(params[0]), static_cast<float>(params[1]));
+    }
+    error = "nieznany filtr '" + name + "'";
+    return nullptr;
+}
+
+/**
+ * Wpisuje przefiltrowane wartości do pola Field (pola uint8_t są zaokrąglane i ograniczane do 0-255).
+ */
+template <typename T, T SerialData::*Field>
+void scatter(const float *values, SerialData *out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if constexpr (std::is_same<T, uint8_t>::value)
+            out[i].*Field = static_cast<uint8_t>(std::clamp(values[i] + 0.5f, 0.0f, 255.0f));
+        else
+            out[i].*Field = values[i];
+    }
+}
+
+/**
+ * Wybiera pole kanału raz na blok i wywołuje operację dla tego pola.
+ */
+template <template <typename T, T SerialData::*Field> class Op, typename... Args>
+void forChannel(Channel channel, Args... args) {
+    switch (channel) {
+    case Channel::Rpm:     Op<float, &SerialData::rpm>::run(args...); break;
+    case Channel::Pwm:     Op<uint8_t, &SerialData::pwm>::run(args...); break;
+    case Channel::Current: Op<float, &SerialData::current>::run(args...); break;
+    case Channel::Voltage: Op<float, &SerialData::voltage>::run(args...); break;
+    case Channel::Power:   Op<float, &SerialData::power>::run(args...); break;
+    case Channel::Kp:      Op<float, &SerialData::kp>::run(args...); break;
+    case Channel::Ki:      Op<float, &SerialData::ki>::run(args...); break;
+    case Channel::Kd:      Op<float, &SerialData::kd>::run(args...); break;
+    case Channel::Mode:    Op<uint8_t, &SerialData::mode>::run(args...); break;
+    case Channel::Count:   break;
+    }
+}
+
+template <typename T, T SerialData::*Field>
+struct Scatter {
+    static void run(const float *values, SerialData *out, size_t count) { scatter<T, Field>(values, out, count); }
+};
+
+} // namespace
+
+/**
+ * Opis jest normalizowany (bez spacji), aby można go było porównać i wyświetlić.
+ */
+bool FilterChain::parse(const std::string &spec, std::string &error) {
+    std::vector<std::unique_ptr<FilterStage>> parsed;
+    std::string normalized;
+    for (const std::string &stage : split(spec, ',')) {
+        if (stage.empty()) {
+            if (spec.find_first_not_of(" \t") == std::string::npos)
+                break;
+            error = "pusty stopień filtra";
+            return false;
+        }
+        std::unique_ptr<FilterStage> filter = makeStage(stage, error);
+        if (!filter)
+            return false;
+        parsed.push_back(std::move(filter));
+        std::string compact = stage;
+        compact.erase(std::remove_if(compact.begin(), compact.end(), [](char c) { return c == ' ' || c == '\t'; }),
+                      compact.end());
+        normalized += (normalized.empty() ? "" : ",") + compact;
+    }
+    stages = std::move(parsed);
+    text = normalized;
+    return true;
+}
+
+void FilterChain::process(float *samples, size_t count) {
+    for (const auto &stage : stages)
+        stage->process(samples, count);
+}
+
+void FilterChain::reset() {
+    for (const auto &stage : stages)
+        stage->reset();
+}
+
+bool ChannelFilterBank::setFilter(Channel channel, const std::string &spec, std::string &error) {
+    if (channel == Channel::Count) {
+        error = "niepoprawny kanał";
+        return false;
+    }
+    return chains[static_cast<int>(channel)].parse(spec, error);
+}
+
+bool ChannelFilterBank::active() const {
+    return std::any_of(std::begin(chains), std::end(chains), [](const FilterChain &chain) { return !chain.empty(); });
+}
+
+/**
+ * Każdy filtrowany kanał przetwarzany jest osobno na całej partii: kopiowanie do bufora,
+ * łańcuch stopni, wpisanie wyniku. Przy partii z jednej porcji danych łańcuch stanu
+ * filtrów przechodzi płynnie z porcji na porcję.
+ */
+void ChannelFilterBank::process(const SerialData *in, SerialData *out, size_t count) {
+    if (out != in)
+        std::copy(in, in + count, out);
+    if (count == 0)
+        return;
+    if (scratch.size() < count)
+        scratch.resize(count);
+
+    for (int c = 0; c < channelCount; ++c) {
+        if (chains[c].empty())
+            continue;
+        const auto channel = static_cast<Channel>(c);
+        gatherChannel(in, count, channel, scratch.data());
+        chains[c].process(scratch.data(), count);
+        forChannel<Scatter>(channel, static_cast<const float *>(scratch.data()), out, count);
+    }
+}
+
+void ChannelFilterBank::reset() {
+    for (FilterChain &chain : chains)
+        chain.reset();
+}
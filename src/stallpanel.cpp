@@ -0,0 +1,152 @@
+/**
+ * @file stallpanel.cpp
+ * @brief Implementacja klasy StallPanel.
+ */
+
+#include "../inc/stallpanel.h"
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QSplitter>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+/// Okres odświeżania zakładki [ms].
+constexpr int refreshIntervalMs = 500;
+
+/**
+ * Podsumowanie histogramu: liczba pomiarów, p50, p99, p99.9 i maksimum w milisekundach.
+ */
+QString histogramSummary(const LatencyHistogram &histogram) {
+    return QObject::tr("%1 pomiarów, p50 %2 ms, p99 %3 ms, p99.9 %4 ms, maks. %5 ms")
+        .arg(histogram.count())
+        .arg(histogram.percentileNs(50.0) / 1e6, 0, 'f', 2)
+        .arg(histogram.percentileNs(99.0) / 1e6, 0, 'f', 2)
+        .arg(histogram.percentileNs(99.9) / 1e6, 0, 'f', 2)
+        .arg(histogram.maxNs() / 1e6, 0, 'f', 2);
+}
+}
+
+/**
+ * Układ: statystyki i próg u góry, pod nimi tabela zablokowań i szczegóły wybranego
+ * zablokowania rozdzielone suwakiem.
+ */
+StallPanel::StallPanel(StallWatchdog *watchdog, QWidget *parent) : QWidget(parent), watchdog(watchdog) {
+    latencyLabel = new QLabel(this);
+    framesLabel = new QLabel(this);
+    thresholdBox = new QSpinBox(this);
+    thresholdBox->setRange(10, 10000);
+    thresholdBox->setSuffix(" ms");
+    thresholdBox->setValue(watchdog->thresholdMs());
+    auto *resetButton = new QPushButton(tr("Wyzeruj"), this);
+
+    auto *form = new QHBoxLayout;
+    form->addWidget(new QLabel(tr("Próg zablokowania:"), this));
+    form->addWidget(thresholdBox);
+    form->addStretch();
+    form->addWidget(resetButton);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+    stallTable = new QTableWidget(0, 3, splitter);
+    stallTable->setHorizontalHeaderLabels({tr("Czas"), tr("Długość [ms]"), tr("Aktywność")});
+    stallTable->horizontalHeader()->setStretchLastSection(true);
+    stallTable->verticalHeader()->setVisible(false);
+    stallTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    stallTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    stallTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    detailView = new QPlainTextEdit(splitter);
+    detailView->setReadOnly(true);
+    detailView->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel(tr("Opóźnienie pętli zdarzeń:"), this));
+    layout->addWidget(latencyLabel);
+    layout->addWidget(new QLabel(tr("Czas klatek (rysowanie, odświeżanie):"), this));
+    layout->addWidget(framesLabel);
+    layout->addLayout(form);
+    layout->addWidget(splitter);
+
+    connect(thresholdBox, qOverload<int>(&QSpinBox::valueChanged), watchdog, &StallWatchdog::setThresholdMs);
+    connect(resetButton, &QPushButton::clicked, this, &StallPanel::resetStats);
+    connect(stallTable, &QTableWidget::itemSelectionChanged, this, &StallPanel::showSelected);
+    refreshTimer.setInterval(refreshIntervalMs);
+    connect(&refreshTimer, &QTimer::timeout, this, &StallPanel::refresh);
+}
+
+void StallPanel::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer.start();
+}
+
+void StallPanel::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    refreshTimer.stop();
+}
+
+/**
+ * Tabela jest przebudowywana tylko wtedy, gdy przybyło zablokowań, aby nie gubić zaznaczenia.
+ */
+void StallPanel::refresh() {
+    latencyLabel->setText(histogramSummary(watchdog->loopLatency()));
+    framesLabel->setText(histogramSummary(watchdog->frameTimes()));
+
+    const uint64_t count = watchdog->stallCount();
+    if (count == shownCount)
+        return;
+    shownCount = count;
+    const std::vector<StallRecord> stalls = watchdog->stalls();
+    shown.assign(stalls.rbegin(), stalls.rend());
+
+    const QSignalBlocker blocker(stallTable);
+    stallTable->setRowCount(static_cast<int>(shown.size()));
+    for (int row = 0; row < static_cast<int>(shown.size()); ++row) {
+        const StallRecord &stall = shown[static_cast<size_t>(row)];
+        const QStringList cells = {QDateTime::fromMSecsSinceEpoch(stall.startMs).toString("HH:mm:ss.zzz"),
+                                   QString::number(stall.durationNs / 1e6, 'f', 1),
+                                   stall.activity.empty() ? tr("(brak zakresów)") : QString::fromStdString(stall.activity)};
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = stallTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                stallTable->setItem(row, column, item);
+            }
+            item->setText(cells.at(column));
+        }
+    }
+    stallTable->clearSelection();
+    detailView->clear();
+}
+
+void StallPanel::showSelected() {
+    const int row = stallTable->currentRow();
+    if (row < 0 || row >= static_cast<int>(shown.size())) {
+        detailView->clear();
+        return;
+    }
+    const StallRecord &stall = shown[static_cast<size_t>(row)];
+    QString text = tr("Długość: %1 ms\nAktywność: %2\n").arg(stall.durationNs / 1e6, 0, 'f', 1)
+                       .arg(stall.activity.empty() ? tr("(brak zakresów)") : QString::fromStdString(stall.activity));
+    if (stall.stack.empty()) {
+        text += tr("Stos natywny: niedostępny\n");
+    } else {
+        text += tr("Stos natywny wątku GUI:\n");
+        for (size_t i = 0; i < stall.stack.size(); ++i)
+            text += QStringLiteral("#%1 %2\n").arg(i).arg(QString::fromStdString(stall.stack[i]));
+    }
+    detailView->setPlainText(text);
+}
+
+void StallPanel::resetStats() {
+    watchdog->reset();
+    shown.clear();
+    shownCount = 0;
+    stallTable->setRowCount(0);
+    detailView->clear();
+    refresh();
+}
@@ -0,0 +1,213 @@
+/**
+ * @file stallwatchdog.cpp
+ * @brief Implementacja klasy StallWatchdog.
+ *
+ * Na Linuksie stos wątku GUI próbkowany jest sygnałem czasu rzeczywistego: procedura obsługi
+ * wywołuje backtrace() do statycznego bufora, a nazwy funkcji rozwiązywane są już w wątku
+ * strażnika. Nazwy funkcji programu są widoczne, gdy plik wykonywalny eksportuje symbole
+ * (ENABLE_EXPORTS w CMake).
+ */
+
+#include "../inc/stallwatchdog.h"
+#include "../inc/logring.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <chrono>
+
+#ifdef __linux__
+#include <csignal>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <execinfo.h>
+#endif
+
+namespace {
+#ifdef __linux__
+/// Maksymalna głębokość próbkowanego stosu.
+constexpr int maxStackFrames = 48;
+/// Ramki procedury obsługi sygnału pomijane na początku stosu.
+constexpr int skippedStackFrames = 2;
+/// Maksymalny czas oczekiwania na próbkę stosu [ms].
+constexpr int stackSampleTimeoutMs = 50;
+
+void *stackFrames[maxStackFrames];      ///< Bufor próbki stosu (jeden strażnik naraz).
+std::atomic<int> stackFrameCount{-1};   ///< Liczba ramek próbki (-1 = brak).
+
+/**
+ * Sygnał próbkowania stosu; zakres zarezerwowany przez glibc jest już wyłączony z SIGRTMIN.
+ */
+int stackSignal() {
+    return SIGRTMIN + 7;
+}
+
+void sampleStackHandler(int) {
+    stackFrameCount.store(backtrace(stackFrames, maxStackFrames), std::memory_order_release);
+}
+
+/**
+ * Zamienia wiersz backtrace_symbols ("plik(symbol+0x1f) [adres]") na nazwę funkcji
+ * w postaci czytelnej (demangling), o ile symbol jest znany.
+ */
+std::string readableFrame(const char *line) {
+    const std::string text(line);
+    const size_t open = text.find('(');
+    const size_t plus = text.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+        return text;
+    const std::string mangled = text.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char *name = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    std::string result = status == 0 && name ? name : mangled;
+    std::free(name);
+    return result;
+}
+#endif
+}
+
+StallWatchdog::StallWatchdog(QObject *parent) : QObject(parent) {
+    activity.frameTimes = &frames;
+}
+
+StallWatchdog::~StallWatchdog() {
+    stop();
+}
+
+/**
+ * Stos aktywności rejestrowany jest dla bieżącego wątku, a na Linuksie instalowana jest
+ * procedura próbkowania stosu (backtrace() wywoływane jest raz wcześniej, aby załadowanie
+ * biblioteki rozwijającej stos nie nastąpiło w procedurze obsługi sygnału).
+ */
+void StallWatchdog::start(int heartbeatMs, int thresholdMs) {
+    stop();
+    setThresholdMs(thresholdMs);
+    Trace::setActivityStack(&activity);
+#ifdef __linux__
+    guiThread = pthread_self();
+    void *probe[1];
+    backtrace(probe, 1);
+    struct sigaction action = {};
+    action.sa_handler = sampleStackHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(stackSignal(), &action, nullptr);
+#endif
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = false;
+    }
+    pendingNs.store(0, std::memory_order_relaxed);
+    worker = std::thread(&StallWatchdog::run, this, heartbeatMs);
+}
+
+void StallWatchdog::stop() {
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    if (Trace::activityStack() == &activity)
+        Trace::setActivityStack(nullptr);
+}
+
+/**
+ * W obiegu jest najwyżej jeden puls: kolejny wysyłany jest dopiero po obsłużeniu poprzedniego,
+ * więc zablokowana pętla nie jest zasypywana zdarzeniami. Aktywność zapisywana jest raz
+ * na puls, w chwili przekroczenia progu.
+ */
+void StallWatchdog::run(int heartbeatMs) {
+    Trace::setThreadName("strażnik GUI");
+    int64_t capturedPulse = 0;
+    std::unique_lock<std::mutex> lock(wakeLock);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(heartbeatMs));
+        if (stopping)
+            break;
+        const int64_t now = Trace::nowNs();
+        const int64_t posted = pendingNs.load(std::memory_order_acquire);
+        if (posted == 0) {
+            pendingNs.store(now, std::memory_order_release);
+            QMetaObject::invokeMethod(this, [this, now]() { beat(now); }, Qt::QueuedConnection);
+        } else if (posted != capturedPulse && now - posted >= static_cast<int64_t>(thresholdMs()) * 1000000) {
+            capturedPulse = posted;
+            lock.unlock();
+            capture(posted);
+            lock.lock();
+        }
+    }
+}
+
+void StallWatchdog::capture(int64_t postedNs) {
+    StallRecord record;
+    record.startMs = QDateTime::currentMSecsSinceEpoch() - (Trace::nowNs() - postedNs) / 1000000;
+    record.activity = activity.snapshot();
+#ifdef __linux__
+    stackFrameCount.store(-1, std::memory_order_relaxed);
+    if (pthread_kill(guiThread, stackSignal()) == 0) {
+        int frameCount = -1;
+        for (int waited = 0; waited < stackSampleTimeoutMs; ++waited) {
+            frameCount = stackFrameCount.load(std::memory_order_acquire);
+            if (frameCount >= 0)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (frameCount > skippedStackFrames) {
+            char **symbols = backtrace_symbols(stackFrames + skippedStackFrames, frameCount - skippedStackFrames);
+            if (symbols) {
+                for (int i = 0; i < frameCount - skippedStackFrames; ++i)
+                    record.stack.push_back(readableFrame(symbols[i]));
+                std::free(symbols);
+            }
+        }
+    }
+#endif
+    std::lock_guard<std::mutex> guard(recordsLock);
+    captured = std::move(record);
+    capturedFor = postedNs;
+}
+
+/**
+ * Opóźnienie pulsu to czas od jego wysłania do obsłużenia; powyżej progu zablokowanie
+ * zapisywane jest z aktywnością zebraną przez strażnika (jeśli zdążył ją zebrać).
+ */
+void StallWatchdog::beat(int64_t postedNs) {
+    const int64_t delayNs = Trace::nowNs() - postedNs;
+    latency.record(delayNs);
+    pendingNs.store(0, std::memory_order_release);
+    if (delayNs < static_cast<int64_t>(thresholdMs()) * 1000000)
+        return;
+
+    StallRecord record;
+    {
+        std::lock_guard<std::mutex> guard(recordsLock);
+        if (capturedFor == postedNs)
+            record = std::move(captured);
+        else
+            record.startMs = QDateTime::currentMSecsSinceEpoch() - delayNs / 1000000;
+        record.durationNs = delayNs;
+        records.push_back(record);
+        if (records.size() > maxRecords)
+            records.pop_front();
+    }
+    stallsTotal.fetch_add(1, std::memory_order_relaxed);
+    if (Trace::isEnabled())
+        Trace::record("Zablokowanie pętli zdarzeń", postedNs, delayNs);
+    LOG_WARNING("Pętla zdarzeń GUI zablokowana na {} ms, aktywność: {}", delayNs / 1000000,
+                record.activity.empty() ? std::string("(brak zakresów)") : record.activity);
+    emit stallDetected(delayNs / 1e6);
+}
+
+std::vector<StallRecord> StallWatchdog::stalls() const {
+    std::lock_guard<std::mutex> guard(recordsLock);
+    return std::vector<StallRecord>(records.begin(), records.end());
+}
+
+void StallWatchdog::reset() {
+    latency.reset();
+    frames.reset();
+    stallsTotal.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(recordsLock);
+    records.clear();
+}
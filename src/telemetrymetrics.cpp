@@ -0,0 +1,224 @@
+/**
+ * @file telemetrymetrics.cpp
+ * @brief Implementacja klasy TelemetryMetrics.
+ *
+ * Odpowiedź zawiera stałą liczbę linii: liczniki, ostatnie wartości kanałów, percentyle
+ * czasu parsowania (odczytywane z kubełków histogramu) oraz czas CPU procesu (getrusage).
+ * Liczby formatowane są w locale "C" — QApplication ustawia locale systemowe, w którym
+ * separatorem dziesiętnym może być przecinek. Liczniki wypisywane są jako liczby całkowite
+ * bez zaokrąglania (9 cyfr znaczących obcięłoby duże wartości).
+ */
+
+#include "../inc/telemetrymetrics.h"
+
+#include <chrono>
+#include <locale>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream.precision(9);
+    stream << value;
+    return stream.str();
+}
+
+/**
+ * Czas [ns] jako sekundy z pełną częścią ułamkową (dokładnie, bez arytmetyki zmiennoprzecinkowej).
+ */
+std::string formatSeconds(uint64_t ns) {
+    std::string fraction = std::to_string(ns % 1000000000u);
+    fraction.insert(0, 9 - fraction.size(), '0');
+    return std::to_string(ns / 1000000000u) + '.' + fraction;
+}
+
+/**
+ * Dopisuje nagłówki HELP/TYPE i jedną próbkę metryki bez etykiet (wartość już sformatowana).
+ */
+void appendMetric(std::string &out, const char *name, const char *type, const char *help, const std::string &value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    out += name;
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+void appendMetric(std::string &out, const char *name, const char *type, const char *help, double value) {
+    appendMetric(out, name, type, help, formatNumber(value));
+}
+
+void appendMetric(std::string &out, const char *name, const char *type, const char *help, uint64_t value) {
+    appendMetric(out, name, type, help, std::to_string(value));
+}
+
+/// Kanał telemetrii eksportowany jako osobny wskaźnik.
+struct ChannelMetric {
+    Channel channel;
+    const char *name;
+    const char *help;
+};
+
+constexpr ChannelMetric channelMetrics[] = {
+    {Channel::Rpm, "wds_motor_rpm", "Obroty silnika [obr/min]."},
+    {Channel::Pwm, "wds_motor_pwm_raw", "Wypełnienie PWM (0-255)."},
+    {Channel::Current, "wds_motor_current_milliamperes", "Prąd silnika [mA]."},
+    {Channel::Voltage, "wds_motor_voltage_volts", "Napięcie zasilania [V]."},
+    {Channel::Power, "wds_motor_power", "Moc zgłaszana przez sterownik."},
+    {Channel::Kp, "wds_pid_kp", "Wzmocnienie Kp regulatora."},
+    {Channel::Ki, "wds_pid_ki", "Wzmocnienie Ki regulatora."},
+    {Channel::Kd, "wds_pid_kd", "Wzmocnienie Kd regulatora."},
+    {Channel::Mode, "wds_motor_mode", "Tryb pracy: 0 - ręczny, 1 - automatyczny."},
+};
+
+} // namespace
+
+TelemetryMetrics::TelemetryMetrics() : startNs(monotonicNs()) {
+    for (auto &value : channels)
+        value.store(0.0f, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::recordChunk(uint64_t rxBytes, uint64_t frames, uint64_t checksumErrors, uint64_t droppedBytes,
+                                   const SerialData *last, int64_t arrivalNs) {
+    rxBytesTotal.fetch_add(rxBytes, std::memory_order_relaxed);
+    if (checksumErrors > 0)
+        checksumErrorsTotal.fetch_add(checksumErrors, std::memory_order_relaxed);
+    if (droppedBytes > 0)
+        droppedBytesTotal.fetch_add(droppedBytes, std::memory_order_relaxed);
+    if (frames == 0 || !last)
+        return;
+
+    framesTotal.fetch_add(frames, std::memory_order_relaxed);
+    lastFrameNs.store(arrivalNs, std::memory_order_relaxed);
+    for (int i = 0; i < channelCount; ++i)
+        channels[i].store(channelValue(*last, static_cast<Channel>(i)), std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::setClockSync(bool synced, double offsetUs, double driftPpm, double jitterUs, uint64_t resyncs) {
+    clockOffsetUs.store(offsetUs, std::memory_order_relaxed);
+    clockDriftPpm.store(driftPpm, std::memory_order_relaxed);
+    clockJitterUs.store(jitterUs, std::memory_order_relaxed);
+    clockResyncsTotal.store(resyncs, std::memory_order_relaxed);
+    clockSynced.store(synced, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::setConnected(bool value) {
+    connected.store(value, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::addReconnect() {
+    reconnectsTotal.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::addLimitAlarm(bool emergencyStop) {
+    limitAlarmsTotal.fetch_add(1, std::memory_order_relaxed);
+    if (emergencyStop)
+        emergencyStopsTotal.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::setEmergencyStopped(bool stopped) {
+    emergencyStopped.store(stopped, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::addDeliveryDrops(uint64_t frames) {
+    deliveryDropsTotal.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void TelemetryMetrics::addReadBufferFull() {
+    readBufferFullTotal.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Częstotliwość ramek wyznacza się po stronie Prometheusa, np. rate(wds_frames_total[1m]).
+ */
+std::string TelemetryMetrics::renderPrometheus() const {
+    std::string out;
+    out.reserve(4096);
+    const int64_t nowNs = monotonicNs();
+
+    appendMetric(out, "wds_connected", "gauge", "Czy urządzenie jest połączone (1/0).",
+                 connected.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+    appendMetric(out, "wds_rx_bytes_total", "counter", "Bajty odebrane z portu szeregowego.",
+                 rxBytesTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_frames_total", "counter", "Poprawnie zdekodowane ramki telemetrii.",
+                 framesTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_checksum_errors_total", "counter", "Ramki odrzucone z powodu błędnej sumy kontrolnej.",
+                 checksumErrorsTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_dropped_bytes_total", "counter", "Bajty odrzucone podczas synchronizacji ramek.",
+                 droppedBytesTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_reconnects_total", "counter", "Automatyczne ponowne połączenia po odłączeniu urządzenia.",
+                 reconnectsTotal.load(std::memory_order_relaxed));
+
+    const int64_t last = lastFrameNs.load(std::memory_order_relaxed);
+    appendMetric(out, "wds_last_frame_age_seconds", "gauge", "Czas od ostatniej poprawnej ramki (-1 = brak ramek).",
+                 last > 0 ? static_cast<double>(nowNs - last) / 1e9 : -1.0);
+
+    for (const ChannelMetric &metric : channelMetrics)
+        appendMetric(out, metric.name, "gauge", metric.help,
+                     channels[static_cast<int>(metric.channel)].load(std::memory_order_relaxed));
+
+    appendMetric(out, "wds_clock_synced", "gauge", "Czy czas próbek pochodzi ze znacznika urządzenia (1/0).",
+                 clockSynced.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+    appendMetric(out, "wds_clock_offset_seconds", "gauge", "Przesunięcie zegara hosta względem zegara urządzenia.",
+                 clockOffsetUs.load(std::memory_order_relaxed) / 1e6);
+    appendMetric(out, "wds_clock_drift_ppm", "gauge", "Dryft zegara urządzenia względem hosta.",
+                 clockDriftPpm.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_clock_jitter_seconds", "gauge", "Odchylenie standardowe opóźnienia transmisji względem dopasowania zegarów.",
+                 clockJitterUs.load(std::memory_order_relaxed) / 1e6);
+    appendMetric(out, "wds_clock_resyncs_total", "counter", "Restarty synchronizacji zegara (restart urządzenia).",
+                 clockResyncsTotal.load(std::memory_order_relaxed));
+
+    appendMetric(out, "wds_limit_alarms_total", "counter", "Wyzwolone alarmy progowe (LimitMonitor).",
+                 limitAlarmsTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_emergency_stops_total", "counter", "Zatrzymania awaryjne wysłane przez monitor progów.",
+                 emergencyStopsTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_emergency_stop_active", "gauge", "Czy polecenia uruchomienia są zablokowane po zatrzymaniu awaryjnym (1/0).",
+                 emergencyStopped.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+    appendMetric(out, "wds_delivery_dropped_frames_total", "counter", "Próbki usunięte z pełnej kolejki dostarczania do GUI.",
+                 deliveryDropsTotal.load(std::memory_order_relaxed));
+    appendMetric(out, "wds_read_buffer_full_total", "counter", "Odczyty portu, przy których bufor odczytu był pełny.",
+                 readBufferFullTotal.load(std::memory_order_relaxed));
+
+    if (parseLatency) {
+        out += "# HELP wds_parse_latency_seconds Czas od odebrania bajtów do zdekodowania ramki.\n"
+               "# TYPE wds_parse_latency_seconds summary\n";
+        for (double percentile : {50.0, 90.0, 99.0}) {
+            const double seconds = static_cast<double>(parseLatency->percentileNs(percentile)) / 1e9;
+            out += "wds_parse_latency_seconds{quantile=\"" + formatNumber(percentile / 100.0) + "\"} "
+                   + formatNumber(seconds) + '\n';
+        }
+        const uint64_t count = parseLatency->count();
+        out += "wds_parse_latency_seconds_sum " + formatSeconds(parseLatency->sumNs()) + '\n';
+        out += "wds_parse_latency_seconds_count " + std::to_string(count) + '\n';
+    }
+
+    appendMetric(out, "wds_uptime_seconds", "gauge", "Czas działania aplikacji.",
+                 static_cast<double>(nowNs - startNs) / 1e9);
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        const double cpu = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+                           + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        appendMetric(out, "process_cpu_seconds_total", "counter", "Czas procesora zużyty przez proces (użytkownik + system).", cpu);
+    }
+#endif
+    return out;
+}
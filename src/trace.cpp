@@ -0,0 +1,170 @@
+/**
+ * @file trace.cpp
+ * @brief Implementacja rejestru śladów wykonania.
+ *
+ * Każdy wątek zapisuje zdarzenia do własnego bufora cyklicznego (traceBufferCapacity zdarzeń),
+ * chronionego własnym muteksem — w praktyce niezajętym, bo odczyt następuje tylko przy zapisie
+ * pliku. Globalny muteks chroni jedynie listę buforów i jest używany raz na wątek.
+ */
+
+#include "../inc/trace.h"
+#include "../inc/latencyhistogram.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/// Pojemność bufora jednego wątku (najstarsze zdarzenia są nadpisywane).
+constexpr size_t traceBufferCapacity = 1 << 16;
+
+struct TraceEvent {
+    const char *name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+struct TraceBuffer {
+    std::mutex lock;
+    std::vector<TraceEvent> events;
+    size_t next = 0;
+    bool wrapped = false;
+    int threadId = 0;
+    std::string threadName;
+};
+
+std::mutex registryLock;
+std::vector<std::shared_ptr<TraceBuffer>> registry;
+int nextThreadId = 1;
+
+/**
+ * Bufor tworzony jest przy pierwszym zdarzeniu w wątku i pozostaje w rejestrze
+ * po zakończeniu wątku, aby jego zdarzenia trafiły do pliku.
+ */
+TraceBuffer &threadBuffer() {
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> guard(registryLock);
+        buffer->threadId = nextThreadId++;
+        buffer->threadName = "wątek " + std::to_string(buffer->threadId);
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void writeEscaped(std::ostream &out, const std::string &text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Trace::enabledFlag{false};
+thread_local ActivityStack *Trace::currentActivity = nullptr;
+
+void ActivityStack::pop(int64_t durationNs) {
+    const int d = depth.load(std::memory_order_relaxed) - 1;
+    depth.store(d, std::memory_order_release);
+    if (d == 0 && frameTimes)
+        frameTimes->record(durationNs);
+}
+
+std::string ActivityStack::snapshot() const {
+    const int d = std::min(depth.load(std::memory_order_acquire), maxDepth);
+    std::string text;
+    for (int i = 0; i < d; ++i) {
+        const char *name = names[i].load(std::memory_order_relaxed);
+        if (!name)
+            continue;
+        if (!text.empty())
+            text += " > ";
+        text += name;
+    }
+    return text;
+}
+
+void Trace::setEnabled(bool enabled) {
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const char *name) {
+    TraceBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> guard(buffer.lock);
+    buffer.threadName = name;
+}
+
+int64_t Trace::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char *name, int64_t startNs, int64_t durationNs) {
+    TraceBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> guard(buffer.lock);
+    if (buffer.events.size() < traceBufferCapacity) {
+        buffer.events.push_back({name, startNs, durationNs});
+    } else {
+        buffer.events[buffer.next] = {name, startNs, durationNs};
+        buffer.wrapped = true;
+    }
+    buffer.next = (buffer.next + 1) % traceBufferCapacity;
+}
+
+/**
+ * Zdarzenia zapisywane są jako "complete events" (ph = "X") z czasami w mikrosekundach,
+ * a nazwy wątków jako metadane (ph = "M").
+ */
+bool Trace::writeChromeJson(const std::string &path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        buffers = registry;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto &buffer : buffers) {
+        std::lock_guard<std::mutex> guard(buffer->lock);
+
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->threadId << ",\"args\":{\"name\":\"";
+        writeEscaped(out, buffer->threadName);
+        out << "\"}}";
+        first = false;
+
+        const size_t count = buffer->events.size();
+        const size_t begin = buffer->wrapped ? buffer->next : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent &event = buffer->events[(begin + i) % count];
+            out << ",\n{\"name\":\"";
+            writeEscaped(out, event.name);
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << event.startNs / 1000 << '.' << (event.startNs % 1000) / 100
+                << ",\"dur\":" << event.durationNs / 1000 << '.' << (event.durationNs % 1000) / 100 << '}';
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    for (const auto &buffer : registry) {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        buffer->events.clear();
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
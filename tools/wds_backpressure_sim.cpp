@@ -0,0 +1,192 @@
+/**
+ * @file wds_backpressure_sim.cpp
+ * @brief Symulacja przeciążenia odbiorcy próbek (zablokowana pętla GUI) dla polityk SampleQueue.
+ *
+ * Wątek producenta dopisuje próbki ze stałą częstotliwością porcjami co 2 ms (jak wątek odczytu
+ * transportu POSIX). Wątek odbiorcy zabiera je i przetwarza ze stałym kosztem na próbkę
+ * (rysowanie), a co zadany okres zatrzymuje się na zadany czas (zablokowana pętla zdarzeń).
+ * Dla każdej polityki i dla kolejki bez limitu (dotychczasowe zachowanie) wypisywane są:
+ * największa głębokość i zajęta pamięć, liczba usuniętych próbek, wiek najstarszej i najnowszej
+ * próbki w pierwszej porcji po zablokowaniu oraz czas dogonienia — od końca zablokowania do
+ * przetworzenia pierwszej próbki wyprodukowanej po nim.
+ *
+ * Użycie:
+ *   wds_backpressure_sim [--rate HZ] [--capacity N] [--stall-ms MS] [--period-ms MS]
+ *                        [--cost-us US] [--duration-s S]
+ *
+ * @see SampleQueue
+ */
+
+#include "../inc/samplequeue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Czas od startu zegara monotonicznego [µs] (jak SerialData::timeUs).
+ */
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Parametry symulacji.
+ */
+struct SimOptions {
+    double rateHz = 5000.0;
+    size_t capacity = SampleQueue::defaultCapacity;
+    int stallMs = 1000;
+    int periodMs = 3000;
+    int costUs = 20;
+    double durationS = 10.0;
+};
+
+/**
+ * Wynik symulacji jednej konfiguracji (czasy w milisekundach, najgorszy przypadek z zablokowań).
+ */
+struct SimResult {
+    BackpressureStats stats;
+    int stalls = 0;
+    size_t firstBatch = 0;
+    double oldestAgeMs = 0.0;
+    double newestAgeMs = 0.0;
+    double catchUpMs = 0.0;
+};
+
+/**
+ * Aktywne oczekiwanie — koszt przetworzenia próbki przez odbiorcę.
+ */
+void spinUs(int us) {
+    const Clock::time_point end = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < end) {
+    }
+}
+
+/**
+ * Uruchamia producenta i odbiorcę na zadanej kolejce przez options.durationS sekund.
+ */
+SimResult simulate(SampleQueue &queue, const SimOptions &options) {
+    std::atomic<bool> running{true};
+    std::thread producer([&]() {
+        const int64_t chunkUs = 2000;
+        const double perChunk = options.rateHz * static_cast<double>(chunkUs) / 1e6;
+        std::vector<SerialData> raw;
+        double owed = 0.0;
+        Clock::time_point next = Clock::now();
+        while (running.load(std::memory_order_relaxed)) {
+            next += std::chrono::microseconds(chunkUs);
+            std::this_thread::sleep_until(next);
+            owed += perChunk;
+            const size_t count = static_cast<size_t>(owed);
+            owed -= static_cast<double>(count);
+            const int64_t stamp = nowUs();
+            raw.assign(count, SerialData());
+            for (size_t i = 0; i < count; ++i)
+                raw[i].timeUs = stamp - static_cast<int64_t>((count - 1 - i) * 1e6 / options.rateHz);
+            queue.push(raw.data(), raw.data(), count);
+        }
+    });
+
+    SimResult result;
+    std::vector<SamplePair> batch;
+    const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                     std::chrono::duration<double>(options.durationS));
+    Clock::time_point nextStall = Clock::now() + std::chrono::milliseconds(options.periodMs - options.stallMs);
+    int64_t stallEndUs = 0;
+    bool firstAfterStall = false;
+    while (Clock::now() < end) {
+        if (Clock::now() >= nextStall) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.stallMs));
+            nextStall += std::chrono::milliseconds(options.periodMs);
+            stallEndUs = nowUs();
+            firstAfterStall = true;
+            ++result.stalls;
+        }
+        if (queue.take(batch) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        const int64_t takenUs = nowUs();
+        if (firstAfterStall) {
+            firstAfterStall = false;
+            result.firstBatch = std::max(result.firstBatch, batch.size());
+            result.oldestAgeMs = std::max(result.oldestAgeMs, (takenUs - batch.front().raw.timeUs) / 1000.0);
+            result.newestAgeMs = std::max(result.newestAgeMs, (takenUs - batch.back().raw.timeUs) / 1000.0);
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            spinUs(options.costUs);
+            if (stallEndUs > 0 && batch[i].raw.timeUs >= stallEndUs) {
+                result.catchUpMs = std::max(result.catchUpMs, (nowUs() - stallEndUs) / 1000.0);
+                stallEndUs = 0;
+            }
+        }
+    }
+    running = false;
+    producer.join();
+    result.stats = queue.stats();
+    return result;
+}
+}
+
+int main(int argc, char *argv[]) {
+    SimOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.rateHz = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            options.capacity = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--stall-ms") == 0 && i + 1 < argc) {
+            options.stallMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--period-ms") == 0 && i + 1 < argc) {
+            options.periodMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--cost-us") == 0 && i + 1 < argc) {
+            options.costUs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            options.durationS = std::strtod(argv[++i], nullptr);
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--rate HZ] [--capacity N] [--stall-ms MS] [--period-ms MS] "
+                                 "[--cost-us US] [--duration-s S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.rateHz <= 0.0 || options.stallMs <= 0 || options.periodMs <= options.stallMs || options.costUs < 0) {
+        std::fprintf(stderr, "Wymagane: rate > 0, 0 < stall-ms < period-ms, cost-us >= 0\n");
+        return 2;
+    }
+
+    std::printf("Próbki %.0f Hz, pojemność %zu, zablokowanie %d ms co %d ms, koszt %d us/próbkę, %.1f s\n",
+                options.rateHz, options.capacity, options.stallMs, options.periodMs, options.costUs, options.durationS);
+    std::printf("%-10s %10s %10s %10s %10s %12s %12s %12s\n", "polityka", "maks.głęb.", "pamięć KiB", "usunięte",
+                "1.porcja", "najstarsza", "najnowsza", "dogonienie");
+
+    struct Config {
+        const char *name;
+        BackpressurePolicy policy;
+        size_t capacity;
+    };
+    const Config configs[] = {
+        {"bez limitu", BackpressurePolicy::DropOldest, std::numeric_limits<size_t>::max() / 2},
+        {SampleQueue::policyName(BackpressurePolicy::DropOldest), BackpressurePolicy::DropOldest, options.capacity},
+        {SampleQueue::policyName(BackpressurePolicy::DropNewest), BackpressurePolicy::DropNewest, options.capacity},
+        {SampleQueue::policyName(BackpressurePolicy::Decimate), BackpressurePolicy::Decimate, options.capacity},
+    };
+    for (const Config &config : configs) {
+        SampleQueue queue(config.capacity, config.policy);
+        const SimResult result = simulate(queue, options);
+        std::printf("%-10s %10zu %10.0f %10llu %10zu %9.1f ms %9.1f ms %9.1f ms\n", config.name,
+                    result.stats.maxDepth, result.stats.maxDepth * sizeof(SamplePair) / 1024.0,
+                    static_cast<unsigned long long>(result.stats.droppedFrames), result.firstBatch,
+                    result.oldestAgeMs, result.newestAgeMs, result.catchUpMs);
+    }
+    return 0;
+}
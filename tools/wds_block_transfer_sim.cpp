@@ -0,0 +1,459 @@
+/**
+ * @file wds_block_transfer_sim.cpp
+ * @brief Symulacja transferu blokowego na łączu szeregowym: przepustowość względem pojemności łącza.
+ *
+ * Program symuluje (w czasie wirtualnym, deterministycznie) dwukierunkowe łącze UART
+ * o zadanej prędkości i opóźnieniu konwertera USB, stronę hosta (BlockTransfer i FrameDecoder,
+ * jak w SerialReader) oraz urządzenie: odbiornik ramek 0xB6, nadawanie ramek 0xA7 i telemetrii
+ * 0xA5 z zadaną częstotliwością, zmniejszaną na czas transferu dzielnikiem z bloku otwarcia.
+ * Dla każdej prędkości i okna wykonywany jest zapis i odczyt; wypisywana jest przepustowość
+ * danych, jej stosunek do pojemności łącza (prędkość / 10) i do granicy wynikającej z narzutu
+ * ramek, liczba ramek telemetrii odebranych podczas transferu i liczba ponowień.
+ * Opcja --error wprowadza przekłamania bajtów w obu kierunkach (sprawdzenie ponowień i CRC).
+ *
+ * Użycie:
+ *   wds_block_transfer_sim [--size BAJTY] [--block N] [--latency-us US] [--telemetry-hz HZ]
+ *                          [--divider N] [--error P] [--seed S]
+ *
+ * @see BlockTransfer
+ */
+
+#include "../inc/blocktransfer.h"
+#include "../inc/framedecoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+/// Największa porcja bajtów dostarczana naraz (pakiet USB konwertera).
+constexpr size_t usbPacket = 64;
+/// Odstęp sprawdzania czasu oczekiwania po stronie hosta (timer SerialReader) [ns].
+constexpr int64_t hostPollNs = 5'000'000;
+
+/**
+ * Parametry symulacji.
+ */
+struct SimOptions {
+    size_t size = 65536;
+    int blockSize = 128;
+    int64_t latencyNs = 1'000'000;
+    double telemetryHz = 1000.0;
+    int divider = 10;
+    double error = 0.0;
+    uint32_t seed = 1;
+};
+
+/**
+ * Jeden kierunek łącza: bajty nadawane są kolejno z prędkością łącza, a odbiorca dostaje je
+ * porcjami po usbPacket bajtów po czasie opóźnienia.
+ */
+struct Direction {
+    double nsPerByte = 0.0;
+    int64_t latencyNs = 0;
+    int64_t busyUntilNs = 0;
+    std::multimap<int64_t, std::string> inFlight;
+    uint64_t bytes = 0;
+
+    void send(int64_t nowNs, const std::string &data, double error, std::mt19937 &rng) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (size_t pos = 0; pos < data.size(); pos += usbPacket) {
+            std::string packet = data.substr(pos, usbPacket);
+            for (char &byte : packet) {
+                if (error > 0.0 && uniform(rng) < error)
+                    byte = static_cast<char>(byte ^ (1 << (rng() % 8)));
+            }
+            busyUntilNs = std::max(busyUntilNs, nowNs) + static_cast<int64_t>(nsPerByte * static_cast<double>(packet.size()));
+            inFlight.emplace(busyUntilNs + latencyNs, std::move(packet));
+        }
+        bytes += data.size();
+    }
+};
+
+/**
+ * Ramka telemetrii 0xA5 z poprawną sumą XOR (wartości bez znaczenia).
+ */
+std::string telemetryFrame(uint32_t counter) {
+    std::string frame(static_cast<size_t>(FrameDecoder::frameSize), '\0');
+    frame[0] = static_cast<char>(FrameDecoder::startByte);
+    const float rpm = static_cast<float>(counter % 3000);
+    memcpy(&frame[1], &rpm, 4);
+    uint8_t checksum = 0;
+    for (int i = 0; i < FrameDecoder::frameSize - 1; ++i)
+        checksum ^= static_cast<uint8_t>(frame[static_cast<size_t>(i)]);
+    frame[static_cast<size_t>(FrameDecoder::frameSize - 1)] = static_cast<char>(checksum);
+    return frame;
+}
+
+uint32_t getLe32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8
+           | static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+/**
+ * Urządzenie: obszar pamięci, odbiór ramek hosta i nadawanie bloków odczytu z oknem Go-Back-N.
+ */
+class DeviceEmulator
+{
+public:
+    DeviceEmulator(size_t regionSize, double bytesPerSecond, uint32_t seed) : region(regionSize) {
+        std::mt19937 rng(seed);
+        for (uint8_t &byte : region)
+            byte = static_cast<uint8_t>(rng());
+        linkBytesPerSecond = bytesPerSecond;
+    }
+
+    /**
+     * Obsługuje bajty od hosta; ramki z błędnym CRC są pomijane bajt po bajcie.
+     */
+    void receive(const std::string &bytes, int64_t nowNs, std::string &out) {
+        buffer += bytes;
+        size_t pos = 0;
+        while (pos < buffer.size()) {
+            if (static_cast<uint8_t>(buffer[pos]) != BlockTransfer::hostStartByte) {
+                ++pos;
+                continue;
+            }
+            const int length = BlockTransfer::frameLength(buffer.data() + pos, static_cast<int>(buffer.size() - pos));
+            if (length == 0 || (length > 0 && buffer.size() - pos < static_cast<size_t>(length)))
+                break;
+            BlockFrame frame;
+            if (length < 0 || !BlockTransfer::parse(buffer.data() + pos, length, frame)) {
+                ++pos;
+                continue;
+            }
+            handle(frame, nowNs, out);
+            pos += static_cast<size_t>(length);
+        }
+        buffer.erase(0, pos);
+    }
+
+    /**
+     * Telemetria co period; podczas transferu co divider-ta ramka.
+     */
+    void telemetry(std::string &out) {
+        ++telemetryCounter;
+        if (mode != Mode::Idle && telemetryCounter % divider != 0)
+            return;
+        out += telemetryFrame(telemetryCounter);
+    }
+
+    /**
+     * Ponowienie bloków odczytu od najstarszego niepotwierdzonego po czasie bez postępu
+     * (powtórzone potwierdzenia obsługuje handle(), jak BlockTransfer po stronie hosta).
+     */
+    void poll(int64_t nowNs, std::string &out) {
+        if (mode != Mode::Read || nowNs - progressNs < timeoutNs)
+            return;
+        progressNs = nowNs;
+        if (base > blocks) {
+            sendDone(out);
+            return;
+        }
+        next = base;
+        fillWindow(out);
+    }
+
+    const std::vector<uint8_t> &memory() const { return region; }
+
+private:
+    enum class Mode { Idle, Write, Read };
+
+    void handle(const BlockFrame &frame, int64_t nowNs, std::string &out) {
+        const bool current = mode != Mode::Idle && frame.transfer == transfer;
+        switch (frame.op) {
+        case BlockOpenWrite:
+        case BlockOpenRead:
+            if (frame.payload.size() != 12)
+                return;
+            if (!current) {
+                open(frame, nowNs);
+                if (mode == Mode::Read)
+                    fillWindow(out);
+            }
+            if (mode == Mode::Write)
+                ack(out);
+            break;
+        case BlockData:
+            if (!current || mode != Mode::Write)
+                return;
+            if (frame.seq == expected && expected <= blocks) {
+                received.insert(received.end(), frame.payload.begin(), frame.payload.end());
+                ++expected;
+            }
+            ack(out);
+            if (expected > blocks)
+                sendDone(out);
+            break;
+        case BlockAck:
+            if (!current || mode != Mode::Read)
+                return;
+            if (frame.seq > base && frame.seq <= next) {
+                base = frame.seq;
+                progressNs = nowNs;
+                duplicateAcks = 0;
+                if (base > blocks)
+                    sendDone(out);
+                else
+                    fillWindow(out);
+            } else if (frame.seq == base && base < next && ++duplicateAcks >= 2 && recoveryBase != base) {
+                recoveryBase = base;
+                next = base;
+                fillWindow(out);
+            }
+            break;
+        case BlockAbort:
+            if (current)
+                mode = Mode::Idle;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void open(const BlockFrame &frame, int64_t nowNs) {
+        const uint8_t *p = frame.payload.data();
+        transfer = frame.transfer;
+        divider = std::max<int>(1, p[1]);
+        blockSize = std::max<int>(1, p[2]);
+        window = std::max<int>(1, p[3]);
+        if (frame.op == BlockOpenWrite) {
+            mode = Mode::Write;
+            total = getLe32(p + 4);
+            expectedCrc = getLe32(p + 8);
+            received.clear();
+            expected = 1;
+        } else {
+            mode = Mode::Read;
+            offset = getLe32(p + 4);
+            total = std::min<size_t>(getLe32(p + 8), region.size() - std::min<size_t>(offset, region.size()));
+            base = 1;
+            next = 1;
+            duplicateAcks = 0;
+            recoveryBase = -1;
+            progressNs = nowNs;
+            const double windowBytes = static_cast<double>(window) * (blockSize + BlockTransfer::overhead);
+            timeoutNs = static_cast<int64_t>(3.0 * windowBytes / linkBytesPerSecond * 1e9) + 50'000'000;
+        }
+        blocks = static_cast<uint16_t>((total + static_cast<size_t>(blockSize) - 1) / static_cast<size_t>(blockSize));
+    }
+
+    void ack(std::string &out) {
+        BlockTransfer::encode(BlockTransfer::deviceStartByte, BlockAck, transfer, expected, nullptr, 0, out);
+    }
+
+    void fillWindow(std::string &out) {
+        while (next <= blocks && next < base + window) {
+            const size_t at = static_cast<size_t>(next - 1) * static_cast<size_t>(blockSize);
+            const int size = static_cast<int>(std::min(static_cast<size_t>(blockSize), total - at));
+            BlockTransfer::encode(BlockTransfer::deviceStartByte, BlockData, transfer, next, region.data() + offset + at,
+                                  size, out);
+            ++next;
+        }
+    }
+
+    void sendDone(std::string &out) {
+        uint8_t payload[5];
+        uint32_t crc;
+        if (mode == Mode::Write) {
+            crc = BlockTransfer::crc32(received.data(), received.size());
+            payload[0] = crc == expectedCrc && received.size() == total ? 0 : 1;
+            if (payload[0] == 0)
+                std::copy(received.begin(), received.end(), region.begin());
+        } else {
+            crc = BlockTransfer::crc32(region.data() + offset, total);
+            payload[0] = 0;
+        }
+        for (int i = 0; i < 4; ++i)
+            payload[1 + i] = static_cast<uint8_t>(crc >> (8 * i));
+        BlockTransfer::encode(BlockTransfer::deviceStartByte, BlockDone, transfer, 0, payload, 5, out);
+    }
+
+    std::vector<uint8_t> region;
+    std::string buffer;
+    double linkBytesPerSecond = 0.0;
+    Mode mode = Mode::Idle;
+    uint8_t transfer = 0;
+    int divider = 1;
+    int blockSize = 1;
+    int window = 1;
+    size_t total = 0;
+    size_t offset = 0;
+    uint16_t blocks = 0;
+    uint32_t expectedCrc = 0;
+    std::vector<uint8_t> received;
+    uint16_t expected = 1;
+    uint16_t base = 1;
+    uint16_t next = 1;
+    int64_t progressNs = 0;
+    int64_t timeoutNs = 0;
+    int duplicateAcks = 0;
+    int recoveryBase = -1;
+    uint32_t telemetryCounter = 0;
+};
+
+/**
+ * Wynik jednego transferu.
+ */
+struct RunResult {
+    bool ok = false;
+    double seconds = 0.0;
+    double throughput = 0.0;
+    uint64_t telemetryFrames = 0;
+    uint64_t retransmits = 0;
+    uint64_t timeouts = 0;
+    std::string error;
+};
+
+/**
+ * Wykonuje zapis (upload = true) lub odczyt całego obszaru przy zadanej prędkości i oknie.
+ */
+RunResult runTransfer(const SimOptions &options, int baud, int window, bool upload) {
+    const double bytesPerSecond = baud / 10.0;
+    std::mt19937 rng(options.seed);
+    Direction toDevice, toHost;
+    toDevice.nsPerByte = toHost.nsPerByte = 1e9 / bytesPerSecond;
+    toDevice.latencyNs = toHost.latencyNs = options.latencyNs;
+    DeviceEmulator device(options.size, bytesPerSecond, options.seed);
+
+    std::vector<uint8_t> data(options.size);
+    for (uint8_t &byte : data)
+        byte = static_cast<uint8_t>(rng());
+
+    BlockTransferOptions transferOptions;
+    transferOptions.blockSize = options.blockSize;
+    transferOptions.window = window;
+    transferOptions.telemetryDivider = options.divider;
+    transferOptions.linkBytesPerSecond = bytesPerSecond;
+
+    BlockTransfer host;
+    FrameDecoder decoder;
+    QVector<SerialData> samples;
+    std::vector<BlockFrame> frames;
+    std::string out;
+    int64_t nowNs = 0;
+    const bool started = upload ? host.startUpload(1, data, transferOptions, nowNs, out)
+                                : host.startDownload(1, 0, static_cast<uint32_t>(options.size), transferOptions, nowNs, out);
+    RunResult result;
+    if (!started) {
+        result.error = host.error();
+        return result;
+    }
+    toDevice.send(nowNs, out, options.error, rng);
+
+    const int64_t telemetryPeriodNs = static_cast<int64_t>(1e9 / options.telemetryHz);
+    int64_t nextTelemetryNs = telemetryPeriodNs;
+    int64_t nextPollNs = hostPollNs;
+    const int64_t limitNs = 600'000'000'000;
+    while (host.isActive() && nowNs < limitNs) {
+        int64_t eventNs = std::min(nextTelemetryNs, nextPollNs);
+        if (!toDevice.inFlight.empty())
+            eventNs = std::min(eventNs, toDevice.inFlight.begin()->first);
+        if (!toHost.inFlight.empty())
+            eventNs = std::min(eventNs, toHost.inFlight.begin()->first);
+        nowNs = eventNs;
+
+        std::string deviceOut;
+        while (!toDevice.inFlight.empty() && toDevice.inFlight.begin()->first <= nowNs) {
+            device.receive(toDevice.inFlight.begin()->second, nowNs, deviceOut);
+            toDevice.inFlight.erase(toDevice.inFlight.begin());
+        }
+        if (nowNs >= nextTelemetryNs) {
+            device.telemetry(deviceOut);
+            nextTelemetryNs += telemetryPeriodNs;
+        }
+        device.poll(nowNs, deviceOut);
+        if (!deviceOut.empty())
+            toHost.send(nowNs, deviceOut, options.error, rng);
+
+        out.clear();
+        while (!toHost.inFlight.empty() && toHost.inFlight.begin()->first <= nowNs) {
+            const std::string &packet = toHost.inFlight.begin()->second;
+            frames.clear();
+            result.telemetryFrames += static_cast<uint64_t>(
+                decoder.feed(packet.data(), static_cast<int>(packet.size()), samples, &frames));
+            for (const BlockFrame &frame : frames)
+                host.handleFrame(frame, nowNs, out);
+            toHost.inFlight.erase(toHost.inFlight.begin());
+        }
+        if (nowNs >= nextPollNs) {
+            host.poll(nowNs, out);
+            nextPollNs += hostPollNs;
+        }
+        if (!out.empty())
+            toDevice.send(nowNs, out, options.error, rng);
+    }
+
+    const BlockTransferStats &stats = host.stats();
+    result.ok = host.state() == BlockTransfer::State::Done
+                && (upload ? device.memory() == data : host.data() == device.memory());
+    result.error = host.error();
+    result.seconds = static_cast<double>((stats.endNs > 0 ? stats.endNs : nowNs) - stats.startNs) / 1e9;
+    result.throughput = stats.throughput(nowNs);
+    result.retransmits = stats.retransmits;
+    result.timeouts = stats.timeouts;
+    return result;
+}
+}
+
+int main(int argc, char *argv[]) {
+    SimOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            options.size = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+            options.blockSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--latency-us") == 0 && i + 1 < argc) {
+            options.latencyNs = std::strtoll(argv[++i], nullptr, 10) * 1000;
+        } else if (std::strcmp(argv[i], "--telemetry-hz") == 0 && i + 1 < argc) {
+            options.telemetryHz = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--divider") == 0 && i + 1 < argc) {
+            options.divider = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--error") == 0 && i + 1 < argc) {
+            options.error = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--size BAJTY] [--block N] [--latency-us US] [--telemetry-hz HZ] "
+                                 "[--divider N] [--error P] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.size == 0 || options.blockSize < 1 || options.blockSize > BlockTransfer::maxPayload
+        || options.telemetryHz <= 0.0 || options.divider < 1 || options.divider > 255 || options.latencyNs < 0) {
+        std::fprintf(stderr, "Niepoprawne parametry\n");
+        return 2;
+    }
+
+    std::printf("Dane %zu B, blok %d B, opóźnienie %.0f us, telemetria %.0f Hz (podczas transferu /%d), "
+                "przekłamania %.0e\n", options.size, options.blockSize, options.latencyNs / 1000.0,
+                options.telemetryHz, options.divider, options.error);
+    const double frameLimit = static_cast<double>(options.blockSize) / (options.blockSize + BlockTransfer::overhead);
+    std::printf("%-7s %8s %5s %9s %10s %8s %8s %10s %9s\n", "kier.", "Bd", "okno", "czas [s]", "kB/s",
+                "łącza", "granicy", "telemetria", "ponowień");
+    bool allOk = true;
+    for (const int baud : {115200, 1000000, 3000000}) {
+        for (const int window : {1, 2, 4, 8, 16}) {
+            for (const bool upload : {true, false}) {
+                const RunResult result = runTransfer(options, baud, window, upload);
+                const double link = baud / 10.0;
+                double limit = frameLimit;
+                if (!upload)
+                    limit *= std::max(0.0, 1.0 - options.telemetryHz / options.divider * FrameDecoder::frameSize / link);
+                allOk = allOk && result.ok;
+                std::printf("%-7s %8d %5d %9.3f %10.1f %7.1f%% %7.1f%% %10llu %9llu%s\n", upload ? "zapis" : "odczyt",
+                            baud, window, result.seconds, result.throughput / 1000.0, 100.0 * result.throughput / link,
+                            100.0 * result.throughput / (link * limit),
+                            static_cast<unsigned long long>(result.telemetryFrames),
+                            static_cast<unsigned long long>(result.retransmits),
+                            result.ok ? "" : ("  BŁĄD: " + result.error).c_str());
+            }
+        }
+    }
+    return allOk ? 0 : 1;
+}
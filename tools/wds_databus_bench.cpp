@@ -0,0 +1,345 @@
+/**
+ * @file wds_databus_bench.cpp
+ * @brief Porównanie kosztu dostarczania próbek: sygnał Qt dla każdej ramki a porcje z DataBus.
+ *
+ * Strumień próbek o zadanej częstotliwości (domyślnie 5 kHz) przez zadany czas dostarczany
+ * jest porcjami (jak deliverSamples() co odczyt portu) do 1, 4 i 16 subskrybentów:
+ *  - sygnał: sygnał QObject emitowany dla każdej ramki, odbiorcy połączeni Qt::DirectConnection,
+ *  - sygnał kolejkowany: ten sam sygnał z Qt::QueuedConnection — dla każdej ramki i odbiorcy
+ *    zdarzenie z kopią argumentów, obsługiwane po porcji przez QCoreApplication::sendPostedEvents()
+ *    (odbiorcy w tym samym wątku, więc mierzony jest pełny koszt wysłania i obsługi zdarzeń),
+ *  - bus: publikacja porcji w DataBus<SamplePair> i jedno wywołanie na porcję i subskrybenta,
+ *  - bus read: subskrybenci bez funkcji zwrotnej kopiują porcję przez DataBus::read(),
+ *  - z innego wątku: strumień wysyłany jest z osobnego wątku do odbiorców w wątku głównym —
+ *    sygnałem kolejkowanym dla każdej ramki (dotychczasowa droga z wątku odczytu do GUI) albo
+ *    jak w SerialReader: porcje w SampleQueue, jedno zdarzenie na porcje zebrane od poprzedniego
+ *    dostarczenia, publikacja i dispatch() magistrali w wątku głównym.
+ * Odbiorca sumuje jedno pole próbki, więc mierzony jest głównie koszt dostarczania.
+ * Wypisywany jest czas na ramkę, zajętość wątku w czasie rzeczywistym strumienia oraz stosunek
+ * czasu sygnału bezpośredniego, kolejkowanego i kolejkowanego z innego wątku do magistrali.
+ * Wartość poniżej 1 oznacza, że magistrala jest wolniejsza — tak bywa przy jednym subskrybencie
+ * i połączeniu bezpośrednim, bo magistrala kopiuje próbki do bufora pierścieniowego. Połączenie
+ * bezpośrednie nie jest jednak dostępne dla wątku odczytu, więc magistrala zastępuje w aplikacji
+ * sygnał kolejkowany z innego wątku (ostatnia kolumna). Pomiar z innego wątku obejmuje czas do
+ * obsłużenia ostatniej ramki w wątku głównym, który czeka na zdarzenia (bez aktywnego odpytywania).
+ *
+ * Użycie:
+ *   wds_databus_bench [--rate HZ] [--batch N] [--duration-s S] [--repeat N]
+ *
+ * @see DataBus
+ */
+
+#include "../inc/databus.h"
+#include "../inc/samplequeue.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QObject>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Źródło sygnału próbek — odpowiednik sygnału z jedną ramką na emisję.
+ */
+class SampleSource : public QObject
+{
+    Q_OBJECT
+signals:
+    void sampleReady(const SerialData &raw, const SerialData &filtered);
+};
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Parametry pomiaru.
+ */
+struct BenchOptions {
+    double rateHz = 5000.0;
+    size_t batch = 10;
+    double durationS = 5.0;
+    int repeat = 5;
+};
+
+/**
+ * Przygotowuje próbki strumienia (znaczniki czasu co 1/rate).
+ */
+std::vector<SamplePair> makeStream(const BenchOptions &options) {
+    std::vector<SamplePair> stream(static_cast<size_t>(options.rateHz * options.durationS));
+    for (size_t i = 0; i < stream.size(); ++i) {
+        stream[i].raw.timeUs = static_cast<int64_t>(i * 1e6 / options.rateHz);
+        stream[i].raw.rpm = static_cast<float>(i % 1000);
+        stream[i].filtered = stream[i].raw;
+    }
+    return stream;
+}
+
+/**
+ * Czas dostarczenia całego strumienia sygnałem dla każdej ramki [ns] (najlepszy z powtórzeń).
+ * @param type Qt::DirectConnection lub Qt::QueuedConnection (zdarzenia obsługiwane po każdej porcji).
+ */
+double runSignal(const std::vector<SamplePair> &stream, int subscribers, Qt::ConnectionType type,
+                 const BenchOptions &options, double &checksum) {
+    std::vector<double> sums(static_cast<size_t>(subscribers), 0.0);
+    SampleSource source;
+    std::vector<std::unique_ptr<QObject>> receivers;
+    for (int s = 0; s < subscribers; ++s) {
+        receivers.push_back(std::make_unique<QObject>());
+        QObject::connect(&source, &SampleSource::sampleReady, receivers.back().get(),
+                         [&sums, s](const SerialData &, const SerialData &filtered) { sums[s] += filtered.rpm; }, type);
+    }
+    const bool queued = type == Qt::QueuedConnection;
+
+    double best = 0.0;
+    for (int r = 0; r < options.repeat; ++r) {
+        const Clock::time_point start = Clock::now();
+        for (size_t offset = 0; offset < stream.size(); offset += options.batch) {
+            const size_t end = std::min(stream.size(), offset + options.batch);
+            for (size_t i = offset; i < end; ++i)
+                emit source.sampleReady(stream[i].raw, stream[i].filtered);
+            if (queued)
+                QCoreApplication::sendPostedEvents();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    for (double sum : sums)
+        checksum += sum;
+    return best;
+}
+
+/**
+ * Czas dostarczenia całego strumienia porcjami przez DataBus [ns] (najlepszy z powtórzeń).
+ */
+double runBus(const std::vector<SamplePair> &stream, int subscribers, const BenchOptions &options, double &checksum) {
+    std::vector<double> sums(static_cast<size_t>(subscribers), 0.0);
+    DataBus<SamplePair> bus;
+    for (int s = 0; s < subscribers; ++s) {
+        bus.subscribe([&sums, s](const SamplePair *samples, size_t count, uint64_t) {
+            double sum = 0.0;
+            for (size_t i = 0; i < count; ++i)
+                sum += samples[i].filtered.rpm;
+            sums[s] += sum;
+        });
+    }
+
+    double best = 0.0;
+    for (int r = 0; r < options.repeat; ++r) {
+        const Clock::time_point start = Clock::now();
+        for (size_t offset = 0; offset < stream.size(); offset += options.batch) {
+            const size_t count = std::min(options.batch, stream.size() - offset);
+            bus.publish(stream.data() + offset, count);
+            bus.dispatch();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    const DataBusStats totals = bus.totals();
+    if (totals.overruns > 0)
+        std::fprintf(stderr, "Nieoczekiwane pominięcia: %llu\n", static_cast<unsigned long long>(totals.overruns));
+    for (double sum : sums)
+        checksum += sum;
+    return best;
+}
+
+/**
+ * Czas dostarczenia strumienia z osobnego wątku sygnałem kolejkowanym dla każdej ramki [ns]
+ * (najlepszy z powtórzeń). Odbiorcy należą do wątku głównego, więc połączenie automatyczne
+ * kolejkuje zdarzenie z kopią argumentów dla każdej ramki i odbiorcy.
+ */
+double runCrossThreadSignal(const std::vector<SamplePair> &stream, int subscribers, const BenchOptions &options,
+                            double &checksum) {
+    std::vector<double> sums(static_cast<size_t>(subscribers), 0.0);
+    size_t received = 0;
+    SampleSource source;
+    std::vector<std::unique_ptr<QObject>> receivers;
+    for (int s = 0; s < subscribers; ++s) {
+        receivers.push_back(std::make_unique<QObject>());
+        QObject::connect(&source, &SampleSource::sampleReady, receivers.back().get(),
+                         [&sums, &received, s](const SerialData &, const SerialData &filtered) {
+                             sums[s] += filtered.rpm;
+                             ++received;
+                         });
+    }
+    const size_t expected = stream.size() * static_cast<size_t>(subscribers);
+
+    double best = 0.0;
+    for (int r = 0; r < options.repeat; ++r) {
+        received = 0;
+        const Clock::time_point start = Clock::now();
+        std::thread producer([&]() {
+            for (const SamplePair &sample : stream)
+                emit source.sampleReady(sample.raw, sample.filtered);
+        });
+        while (received < expected)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        producer.join();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    for (double sum : sums)
+        checksum += sum;
+    return best;
+}
+
+/**
+ * Czas dostarczenia strumienia z osobnego wątku przez SampleQueue i DataBus [ns] (najlepszy
+ * z powtórzeń). Wątek wysyłający dopisuje porcje do kolejki bez limitu i wysyła zdarzenie tylko
+ * przy pierwszym dopisaniu od ostatniego odbioru; wątek główny zabiera kolejkę, publikuje ją
+ * w magistrali (po pojemność naraz) i wywołuje dispatch() — tak jak deliverSamples().
+ */
+double runCrossThreadBus(const std::vector<SamplePair> &stream, int subscribers, const BenchOptions &options,
+                         double &checksum) {
+    std::vector<double> sums(static_cast<size_t>(subscribers), 0.0);
+    size_t received = 0;
+    DataBus<SamplePair> bus;
+    for (int s = 0; s < subscribers; ++s) {
+        bus.subscribe([&sums, &received, s](const SamplePair *samples, size_t count, uint64_t) {
+            double sum = 0.0;
+            for (size_t i = 0; i < count; ++i)
+                sum += samples[i].filtered.rpm;
+            sums[s] += sum;
+            received += count;
+        });
+    }
+    SampleQueue queue(SampleQueue::unbounded);
+    QObject receiver;
+    std::vector<SamplePair> taken;
+    std::vector<SerialData> raw;
+    std::vector<SerialData> filtered;
+    const auto deliver = [&]() {
+        queue.take(taken);
+        for (size_t first = 0; first < taken.size(); first += bus.capacity()) {
+            bus.publish(taken.data() + first, std::min(taken.size() - first, bus.capacity()));
+            bus.dispatch();
+        }
+    };
+    const size_t expected = stream.size() * static_cast<size_t>(subscribers);
+
+    double best = 0.0;
+    for (int r = 0; r < options.repeat; ++r) {
+        received = 0;
+        const Clock::time_point start = Clock::now();
+        std::thread producer([&]() {
+            for (size_t offset = 0; offset < stream.size(); offset += options.batch) {
+                const size_t count = std::min(options.batch, stream.size() - offset);
+                raw.resize(count);
+                filtered.resize(count);
+                for (size_t i = 0; i < count; ++i) {
+                    raw[i] = stream[offset + i].raw;
+                    filtered[i] = stream[offset + i].filtered;
+                }
+                if (queue.push(raw.data(), filtered.data(), count))
+                    QMetaObject::invokeMethod(&receiver, deliver, Qt::QueuedConnection);
+            }
+        });
+        while (received < expected)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        producer.join();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    for (double sum : sums)
+        checksum += sum;
+    return best;
+}
+
+/**
+ * Czas dostarczenia całego strumienia przez DataBus::read() subskrybentów [ns] (najlepszy z powtórzeń).
+ */
+double runBusRead(const std::vector<SamplePair> &stream, int subscribers, const BenchOptions &options, double &checksum) {
+    std::vector<double> sums(static_cast<size_t>(subscribers), 0.0);
+    DataBus<SamplePair> bus;
+    std::vector<int> ids;
+    for (int s = 0; s < subscribers; ++s)
+        ids.push_back(bus.subscribe());
+    std::vector<SamplePair> batch;
+
+    double best = 0.0;
+    for (int r = 0; r < options.repeat; ++r) {
+        const Clock::time_point start = Clock::now();
+        for (size_t offset = 0; offset < stream.size(); offset += options.batch) {
+            const size_t count = std::min(options.batch, stream.size() - offset);
+            bus.publish(stream.data() + offset, count);
+            for (int s = 0; s < subscribers; ++s) {
+                bus.read(ids[s], batch);
+                double sum = 0.0;
+                for (const SamplePair &sample : batch)
+                    sum += sample.filtered.rpm;
+                sums[s] += sum;
+            }
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    for (double sum : sums)
+        checksum += sum;
+    return best;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<SerialData>("SerialData");
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.rateHz = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            options.batch = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            options.durationS = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            options.repeat = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--rate HZ] [--batch N] [--duration-s S] [--repeat N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.rateHz <= 0.0 || options.batch == 0 || options.durationS <= 0.0 || options.repeat <= 0) {
+        std::fprintf(stderr, "Wymagane: rate > 0, batch > 0, duration-s > 0, repeat > 0\n");
+        return 2;
+    }
+
+    const std::vector<SamplePair> stream = makeStream(options);
+    const double streamNs = options.durationS * 1e9;
+    std::printf("Próbki %.0f Hz, porcje po %zu, %zu ramek (%.1f s), najlepszy z %d przebiegów\n", options.rateHz,
+                options.batch, stream.size(), options.durationS, options.repeat);
+    std::printf("%-8s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", "subskr.", "sygnał", "kolejkowany",
+                "bus", "bus read", "bus CPU", "przysp.", "przysp.", "sygnał", "bus", "przysp.");
+    std::printf("%-8s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", "", "ns/ramkę", "ns/ramkę", "ns/ramkę",
+                "ns/ramkę", "", "bezp./bus", "kolejk./bus", "inny wątek", "inny wątek", "wątek/bus");
+
+    double checksumSignal = 0.0;
+    double checksumQueued = 0.0;
+    double checksumBus = 0.0;
+    double checksumRead = 0.0;
+    double checksumCrossSignal = 0.0;
+    double checksumCrossBus = 0.0;
+    for (int subscribers : {1, 4, 16}) {
+        const double signalNs = runSignal(stream, subscribers, Qt::DirectConnection, options, checksumSignal);
+        const double queuedNs = runSignal(stream, subscribers, Qt::QueuedConnection, options, checksumQueued);
+        const double busNs = runBus(stream, subscribers, options, checksumBus);
+        const double readNs = runBusRead(stream, subscribers, options, checksumRead);
+        const double crossSignalNs = runCrossThreadSignal(stream, subscribers, options, checksumCrossSignal);
+        const double crossBusNs = runCrossThreadBus(stream, subscribers, options, checksumCrossBus);
+        const double frames = static_cast<double>(stream.size());
+        std::printf("%-8d %12.1f %12.1f %12.1f %12.1f %11.3f%% %11.2fx %11.1fx %12.1f %12.1f %11.1fx\n", subscribers,
+                    signalNs / frames, queuedNs / frames, busNs / frames, readNs / frames, 100.0 * busNs / streamNs,
+                    signalNs / busNs, queuedNs / busNs, crossSignalNs / frames, crossBusNs / frames,
+                    crossSignalNs / crossBusNs);
+    }
+    if (checksumSignal != checksumBus || checksumQueued != checksumBus || checksumRead != checksumBus
+        || checksumCrossSignal != checksumBus || checksumCrossBus != checksumBus) {
+        std::fprintf(stderr, "Różne sumy kontrolne odbiorców\n");
+        return 1;
+    }
+    return 0;
+}
+
+#include "wds_databus_bench.moc"
@@ -0,0 +1,228 @@
+/**
+ * @file wds_decoder_fuzz.cpp
+ * @brief Test odporności dekodera ramek na zakłócenia transmisji (wstrzykiwanie błędów).
+ *
+ * Program generuje strumień ramek telemetrii 0xA5/0xA6 (z bajtami startu celowo częstymi
+ * w danych), wprowadza przekłamania bitów, gubi i wstawia bajty z zadanym prawdopodobieństwem,
+ * a następnie podaje strumień do FrameDecoder porcjami losowej długości. Wypisuje odsetek
+ * odzyskanych ramek (względem wszystkich i względem ramek nienaruszonych), liczbę ramek
+ * fałszywych oraz przepustowość dekodowania strumienia zakłóconego i czystego.
+ *
+ * Użycie:
+ *   wds_decoder_fuzz [--frames N] [--flip P] [--drop P] [--insert P] [--extended P]
+ *                    [--chunk MAKS] [--seed S]
+ *
+ * Prawdopodobieństwa P dotyczą pojedynczego bajtu (np. 1e-4); --extended to udział ramek 0xA6.
+ *
+ * @see FrameDecoder
+ */
+
+#include "../inc/framedecoder.h"
+
+#include <QtEndian>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+/**
+ * Składa ramkę w formacie opisanym w framedecoder.cpp (z sumą kontrolną XOR).
+ */
+std::string encodeFrame(const SerialData &data) {
+    const int size = data.hasDeviceTime ? FrameDecoder::extendedFrameSize : FrameDecoder::frameSize;
+    std::string frame(static_cast<size_t>(size), '\0');
+    frame[0] = static_cast<char>(data.hasDeviceTime ? FrameDecoder::extendedStartByte : FrameDecoder::startByte);
+    memcpy(&frame[1], &data.rpm, 4);
+    memcpy(&frame[5], &data.pwm, 1);
+    memcpy(&frame[6], &data.current, 4);
+    memcpy(&frame[10], &data.voltage, 4);
+    memcpy(&frame[14], &data.power, 4);
+    memcpy(&frame[18], &data.kp, 4);
+    memcpy(&frame[22], &data.ki, 4);
+    memcpy(&frame[26], &data.kd, 4);
+    memcpy(&frame[30], &data.mode, 1);
+    if (data.hasDeviceTime)
+        qToLittleEndian<quint32>(data.deviceTimeUs, &frame[31]);
+    quint8 checksum = 0;
+    for (int i = 0; i < size - 1; ++i)
+        checksum ^= static_cast<quint8>(frame[static_cast<size_t>(i)]);
+    frame[static_cast<size_t>(size - 1)] = static_cast<char>(checksum);
+    return frame;
+}
+
+/**
+ * Pole float z losowych bajtów, z częstymi bajtami 0xA5/0xA6 (fałszywe początki ramek).
+ */
+float noisyFloat(std::mt19937 &rng) {
+    unsigned char bytes[4];
+    for (unsigned char &byte : bytes) {
+        const unsigned r = rng();
+        byte = (r & 7) == 0 ? ((r & 8) ? FrameDecoder::startByte : FrameDecoder::extendedStartByte)
+                            : static_cast<unsigned char>(r >> 8);
+    }
+    float value;
+    memcpy(&value, bytes, 4);
+    return value;
+}
+
+/**
+ * Dekoduje strumień porcjami o długości 1..maxChunk i zwraca czas dekodowania [ns].
+ */
+int64_t decodeStream(const std::string &stream, int maxChunk, uint32_t seed, QVector<SerialData> &out,
+                     DecoderStats &stats) {
+    std::mt19937 rng(seed);
+    std::vector<int> chunks;
+    for (size_t pos = 0; pos < stream.size();) {
+        const int chunk = static_cast<int>(std::min<size_t>(1 + rng() % static_cast<unsigned>(maxChunk),
+                                                            stream.size() - pos));
+        chunks.push_back(chunk);
+        pos += static_cast<size_t>(chunk);
+    }
+
+    FrameDecoder decoder;
+    out.clear();
+    const auto start = std::chrono::steady_clock::now();
+    const char *data = stream.data();
+    for (int chunk : chunks) {
+        decoder.feed(data, chunk, out);
+        data += chunk;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    stats = decoder.stats();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+}
+
+int main(int argc, char *argv[]) {
+    long frames = 200000;
+    double flip = 1e-4, drop = 1e-4, insert = 1e-4, extended = 0.5;
+    int maxChunk = 64;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--flip") == 0 && i + 1 < argc) {
+            flip = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--drop") == 0 && i + 1 < argc) {
+            drop = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--insert") == 0 && i + 1 < argc) {
+            insert = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--extended") == 0 && i + 1 < argc) {
+            extended = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            maxChunk = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--frames N] [--flip P] [--drop P] [--insert P] [--extended P] "
+                                 "[--chunk MAKS] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames <= 0 || frames >= (1L << 24)) {
+        std::fprintf(stderr, "Liczba ramek musi być z zakresu 1..%ld\n", (1L << 24) - 1);
+        return 2;
+    }
+
+    // Ramki wzorcowe: numer ramki w polu rpm, pozostałe pola losowe
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::string> originals(static_cast<size_t>(frames));
+    std::string clean;
+    for (long n = 0; n < frames; ++n) {
+        SerialData data;
+        data.rpm = static_cast<float>(n);
+        data.pwm = static_cast<uint8_t>(rng());
+        data.current = noisyFloat(rng);
+        data.voltage = noisyFloat(rng);
+        data.power = noisyFloat(rng);
+        data.kp = noisyFloat(rng);
+        data.ki = noisyFloat(rng);
+        data.kd = noisyFloat(rng);
+        data.mode = static_cast<uint8_t>(rng() & 1);
+        data.hasDeviceTime = uniform(rng) < extended;
+        data.deviceTimeUs = static_cast<uint32_t>(rng());
+        originals[static_cast<size_t>(n)] = encodeFrame(data);
+        clean += originals[static_cast<size_t>(n)];
+    }
+
+    // Zakłócenia: przekłamanie bitu, zgubienie bajtu, wstawienie bajtu (często bajtu startu)
+    std::string noisy;
+    noisy.reserve(clean.size() + clean.size() / 100);
+    std::vector<bool> intact(static_cast<size_t>(frames), true);
+    size_t flips = 0, drops = 0, inserts = 0;
+    for (long n = 0; n < frames; ++n) {
+        const std::string &frame = originals[static_cast<size_t>(n)];
+        for (size_t i = 0; i < frame.size(); ++i) {
+            if (uniform(rng) < drop) {
+                intact[static_cast<size_t>(n)] = false;
+                ++drops;
+                continue;
+            }
+            char byte = frame[i];
+            if (uniform(rng) < flip) {
+                byte = static_cast<char>(byte ^ (1 << (rng() % 8)));
+                intact[static_cast<size_t>(n)] = false;
+                ++flips;
+            }
+            noisy += byte;
+            if (uniform(rng) < insert) {
+                const unsigned r = rng();
+                noisy += static_cast<char>((r & 3) == 0 ? FrameDecoder::startByte : static_cast<unsigned char>(r >> 8));
+                if (i + 1 < frame.size())
+                    intact[static_cast<size_t>(n)] = false;
+                ++inserts;
+            }
+        }
+    }
+
+    QVector<SerialData> decoded;
+    DecoderStats stats;
+    const int64_t noisyNs = decodeStream(noisy, maxChunk, seed, decoded, stats);
+
+    // Ramka odzyskana = zdekodowana bajt w bajt jak wzorzec o numerze z pola rpm
+    std::vector<bool> recovered(static_cast<size_t>(frames), false);
+    size_t recoveredCount = 0, falseFrames = 0, duplicates = 0;
+    for (const SerialData &data : decoded) {
+        const float id = data.rpm;
+        const bool inRange = id >= 0.0f && id < static_cast<float>(frames) && id == static_cast<float>(static_cast<long>(id));
+        const size_t n = inRange ? static_cast<size_t>(id) : 0;
+        if (!inRange || encodeFrame(data) != originals[n]) {
+            ++falseFrames;
+        } else if (recovered[n]) {
+            ++duplicates;
+        } else {
+            recovered[n] = true;
+            ++recoveredCount;
+        }
+    }
+    size_t intactCount = 0, intactRecovered = 0;
+    for (size_t n = 0; n < intact.size(); ++n) {
+        intactCount += intact[n] ? 1 : 0;
+        intactRecovered += intact[n] && recovered[n] ? 1 : 0;
+    }
+
+    QVector<SerialData> cleanDecoded;
+    DecoderStats cleanStats;
+    const int64_t cleanNs = decodeStream(clean, maxChunk, seed, cleanDecoded, cleanStats);
+
+    const auto mbps = [](size_t bytes, int64_t ns) { return ns > 0 ? static_cast<double>(bytes) * 1e3 / ns : 0.0; };
+    std::printf("ramek: %ld (%zu B), zakłócenia: %zu przekłamań, %zu zgubionych, %zu wstawionych bajtów\n",
+                frames, clean.size(), flips, drops, inserts);
+    std::printf("odzyskane: %zu (%.3f%% wszystkich), nienaruszone: %zu, odzyskane nienaruszone: %zu (%.3f%%)\n",
+                recoveredCount, 100.0 * recoveredCount / frames, intactCount, intactRecovered,
+                intactCount > 0 ? 100.0 * intactRecovered / intactCount : 100.0);
+    std::printf("fałszywe ramki: %zu, duplikaty: %zu\n", falseFrames, duplicates);
+    std::printf("dekoder: %llu ramek, %llu błędów sumy, %llu odrzuconych bajtów, %llu utrat synchronizacji\n",
+                static_cast<unsigned long long>(stats.validFrames), static_cast<unsigned long long>(stats.checksumErrors),
+                static_cast<unsigned long long>(stats.droppedBytes), static_cast<unsigned long long>(stats.resyncs));
+    std::printf("przepustowość: zakłócony %.1f MB/s (%.1f ns/ramkę), czysty %.1f MB/s (%.1f ns/ramkę, %d ramek)\n",
+                mbps(noisy.size(), noisyNs), static_cast<double>(noisyNs) / frames,
+                mbps(clean.size(), cleanNs), static_cast<double>(cleanNs) / frames, cleanDecoded.size());
+    return 0;
+}
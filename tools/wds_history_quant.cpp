@@ -0,0 +1,266 @@
+/**
+ * @file wds_history_quant.cpp
+ * @brief Pomiar historii skwantowanej (HistoryEncoding::Quantized) względem zapisu Gorilla.
+ *
+ * Program zapisuje ten sam przebieg do HistoryStore w obu trybach i wypisuje:
+ * - bajty na próbkę (struktura HistorySample, bloki Gorilla, bloki skwantowane; rozmiar bloku
+ *   z HistoryStore::compressedBytes() — nagłówek, kodery kanałów trybu bloku i dane),
+ * - dla każdego kanału największy błąd odczytu względem rozdzielczości czujnika (LSB)
+ *   i rozdzielczości zaobserwowanej w danych (najmniejsza niezerowa różnica wartości),
+ * - czas odczytu wszystkich kanałów (channelColumns()) i samej pętli dequantize().
+ * Błąd sprawdzany jest niezależnie — przez porównanie odczytanych próbek z oryginałem.
+ *
+ * Bez --session przebieg jest syntetyczny: próbki 5 kHz kwantowane do rozdzielczości
+ * czujników (domyślnie: RPM 0.1 obr/min, prąd 0.1 mA i napięcie 4 mV jak INA219,
+ * moc 2 mW = 20 LSB prądu, PWM i tryb całkowite, nastawy PID zmieniane co 10 s).
+ *
+ * Użycie:
+ *   wds_history_quant [--session PLIK.wds] [--seconds S] [--resolution KANAŁ=LSB]... [--seed S]
+ *
+ * @see QuantizedColumn
+ * @see HistoryStore
+ */
+
+#include "../inc/historystore.h"
+#include "../inc/sessionfile.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Rozdzielczość czujników [jednostki kanału]; 0 — kanał bez przyjętej rozdzielczości.
+ */
+std::array<float, channelCount> defaultResolution() {
+    std::array<float, channelCount> lsb = {};
+    lsb[static_cast<int>(Channel::Rpm)] = 0.1f;
+    lsb[static_cast<int>(Channel::Pwm)] = 1.0f;
+    lsb[static_cast<int>(Channel::Current)] = 0.1f;
+    lsb[static_cast<int>(Channel::Voltage)] = 0.004f;
+    lsb[static_cast<int>(Channel::Power)] = 2.0f;
+    lsb[static_cast<int>(Channel::Mode)] = 1.0f;
+    return lsb;
+}
+
+/**
+ * Zaokrągla wartość do wielokrotności rozdzielczości czujnika.
+ */
+float toSensor(double value, float lsb) {
+    return lsb > 0.0f ? static_cast<float>(std::round(value / lsb) * lsb) : static_cast<float>(value);
+}
+
+/**
+ * Przebieg syntetyczny: 5 kHz z fluktuacją odstępu, sinusoida i szum na kanałach pomiarowych.
+ */
+void makeSynthetic(double seconds, uint32_t seed, const std::array<float, channelCount> &lsb,
+                   std::vector<HistorySample> &out) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const size_t count = static_cast<size_t>(seconds * 5000.0);
+    out.resize(count);
+    qint64 t = 0;
+    for (size_t i = 0; i < count; ++i) {
+        t += 200 + static_cast<qint64>(noise(rng) * 10.0);
+        const double s = static_cast<double>(t) / 1e6;
+        SerialData &d = out[i].data;
+        out[i].timeUs = t;
+        d.rpm = toSensor(300.0 + 50.0 * std::sin(s) + 3.0 * noise(rng), lsb[static_cast<int>(Channel::Rpm)]);
+        d.pwm = static_cast<uint8_t>(128 + 40 * std::sin(s));
+        d.current = toSensor(250.0 + 40.0 * std::sin(s) + 15.0 * noise(rng), lsb[static_cast<int>(Channel::Current)]);
+        d.voltage = toSensor(7.4 - 0.1 * std::sin(s) + 0.01 * noise(rng), lsb[static_cast<int>(Channel::Voltage)]);
+        d.power = toSensor(d.current * d.voltage, lsb[static_cast<int>(Channel::Power)]);
+        const int step = static_cast<int>(s / 10.0);
+        d.kp = 1.5f + 0.1f * step;
+        d.ki = 0.05f * (1 + step % 3);
+        d.kd = 0.01f;
+        d.mode = 1;
+    }
+}
+
+/**
+ * Wczytuje próbki nagrania sesji (.wds).
+ */
+bool loadSession(const char *path, std::vector<HistorySample> &out) {
+    SessionFile file;
+    if (!file.open(QString::fromUtf8(path))) {
+        std::fprintf(stderr, "Nie można otworzyć %s: %s\n", path, file.errorString().toUtf8().constData());
+        return false;
+    }
+    out.clear();
+    for (int b = 0; b < file.blockCount(); ++b) {
+        const SessionBlockData block = file.blockData(b);
+        for (int i = 0; i < block.count; ++i) {
+            HistorySample sample;
+            sample.timeUs = block.timeUs[i];
+            for (int c = 0; c < channelCount; ++c)
+                setChannelValue(sample.data, static_cast<Channel>(c), block.columns[c][i]);
+            out.push_back(sample);
+        }
+    }
+    return true;
+}
+
+/**
+ * Najmniejsza niezerowa różnica między wartościami kanału (0 dla kanału stałego).
+ */
+float observedResolution(const std::vector<HistorySample> &samples, Channel channel) {
+    std::vector<float> values;
+    values.reserve(samples.size());
+    for (const HistorySample &sample : samples)
+        values.push_back(channelValue(sample.data, channel));
+    std::sort(values.begin(), values.end());
+    float best = 0.0f;
+    for (size_t i = 1; i < values.size(); ++i) {
+        const float diff = values[i] - values[i - 1];
+        if (diff > 0.0f && (best == 0.0f || diff < best))
+            best = diff;
+    }
+    return best;
+}
+
+/**
+ * Czas odczytu wszystkich kanałów całej historii [ns/próbkę] (najlepszy z powtórzeń).
+ */
+double readNsPerSample(const HistoryStore &store, qint64 toUs) {
+    std::vector<Channel> all;
+    for (int c = 0; c < channelCount; ++c)
+        all.push_back(static_cast<Channel>(c));
+    std::vector<qint64> times;
+    std::array<std::vector<float>, channelCount> columns;
+    double best = 0.0;
+    for (int r = 0; r < 5; ++r) {
+        const Clock::time_point start = Clock::now();
+        store.channelColumns(all, 0, toUs, times, columns);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = r == 0 ? ns : std::min(best, ns);
+    }
+    return best / static_cast<double>(std::max<size_t>(1, times.size()));
+}
+}
+
+int main(int argc, char *argv[]) {
+    const char *sessionPath = nullptr;
+    double seconds = 60.0;
+    uint32_t seed = 1;
+    std::array<float, channelCount> lsb = defaultResolution();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--session") == 0 && i + 1 < argc) {
+            sessionPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            const std::string spec = argv[++i];
+            const size_t eq = spec.find('=');
+            Channel channel;
+            if (eq == std::string::npos || !channelFromName(spec.substr(0, eq), channel)) {
+                std::fprintf(stderr, "Nieprawidłowa rozdzielczość: %s (oczekiwano KANAŁ=LSB)\n", spec.c_str());
+                return 2;
+            }
+            lsb[static_cast<int>(channel)] = std::strtof(spec.c_str() + eq + 1, nullptr);
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--session PLIK.wds] [--seconds S] [--resolution KANAŁ=LSB]... "
+                                 "[--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<HistorySample> samples;
+    if (sessionPath) {
+        if (!loadSession(sessionPath, samples))
+            return 1;
+    } else {
+        if (seconds <= 0.0) {
+            std::fprintf(stderr, "Wymagane: seconds > 0\n");
+            return 2;
+        }
+        makeSynthetic(seconds, seed, lsb, samples);
+    }
+    if (samples.empty()) {
+        std::fprintf(stderr, "Brak próbek\n");
+        return 1;
+    }
+
+    HistoryStore gorilla(1024, HistoryEncoding::Gorilla);
+    HistoryStore quantized(1024, HistoryEncoding::Quantized);
+    for (int c = 0; c < channelCount; ++c)
+        quantized.setResolution(static_cast<Channel>(c), lsb[c]);
+    for (const HistorySample &sample : samples) {
+        gorilla.append(sample.timeUs, sample.data);
+        quantized.append(sample.timeUs, sample.data);
+    }
+    const qint64 lastUs = samples.back().timeUs;
+
+    std::printf("%zu próbek (%s)\n", samples.size(), sessionPath ? sessionPath : "przebieg syntetyczny 5 kHz");
+    std::printf("Pamięć: HistorySample %zu B, Gorilla %.2f B, skwantowane %.2f B na próbkę (bloki)\n",
+                sizeof(HistorySample), gorilla.bytesPerSample(), quantized.bytesPerSample());
+
+    // Niezależne sprawdzenie błędu: próbki odczytane z historii skwantowanej a oryginał
+    const QVector<HistorySample> decoded = quantized.samples(0, lastUs);
+    if (static_cast<size_t>(decoded.size()) != samples.size()) {
+        std::fprintf(stderr, "Liczba odczytanych próbek %d != %zu\n", decoded.size(), samples.size());
+        return 1;
+    }
+    std::array<float, channelCount> measured = {};
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (decoded[static_cast<int>(i)].timeUs != samples[i].timeUs) {
+            std::fprintf(stderr, "Różny czas próbki %zu\n", i);
+            return 1;
+        }
+        for (int c = 0; c < channelCount; ++c) {
+            const Channel channel = static_cast<Channel>(c);
+            const float error = std::fabs(channelValue(decoded[static_cast<int>(i)].data, channel) -
+                                          channelValue(samples[i].data, channel));
+            measured[c] = std::max(measured[c], error);
+        }
+    }
+
+    std::printf("%-8s %12s %12s %12s %12s %10s\n", "kanał", "LSB czujn.", "LSB obserw.", "maks. błąd",
+                "błąd/LSB", "wynik");
+    bool ok = true;
+    for (int c = 0; c < channelCount; ++c) {
+        const Channel channel = static_cast<Channel>(c);
+        const float observed = observedResolution(samples, channel);
+        // Względna tolerancja na zaokrąglenie float przy odczycie (offset + step * q)
+        const bool within = measured[c] == 0.0f || lsb[c] <= 0.0f || measured[c] <= 0.5f * lsb[c] * 1.001f;
+        const bool consistent = measured[c] <= quantized.maxQuantizationError(channel);
+        ok = ok && within && consistent;
+        const char *verdict = !consistent ? "NIEZGODNY"
+                              : measured[c] == 0.0f ? "bezstratny"
+                              : lsb[c] <= 0.0f ? "brak LSB"
+                              : within ? "<= 1/2 LSB" : "> 1/2 LSB";
+        std::printf("%-8s %12g %12g %12g %12.4f %10s\n", channelName(channel), lsb[c], observed, measured[c],
+                    lsb[c] > 0.0f ? measured[c] / lsb[c] : 0.0, verdict);
+        if (observed > 0.0f && observed < 0.5f * lsb[c])
+            std::printf("         uwaga: dane drobniejsze od LSB czujnika — krok LSB zaokrągla je o najwyżej 1/2 LSB\n");
+    }
+
+    const double gorillaNs = readNsPerSample(gorilla, lastUs);
+    const double quantizedNs = readNsPerSample(quantized, lastUs);
+    std::vector<int16_t> levels(1 << 16);
+    for (size_t i = 0; i < levels.size(); ++i)
+        levels[i] = static_cast<int16_t>(i);
+    std::vector<float> values(levels.size());
+    double kernelNs = 0.0;
+    for (int r = 0; r < 20; ++r) {
+        const Clock::time_point start = Clock::now();
+        QuantizedColumn::dequantize(levels.data(), levels.size(), 1.0f, 0.5f, values.data());
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        kernelNs = r == 0 ? ns : std::min(kernelNs, ns);
+    }
+    std::printf("Odczyt 9 kanałów: Gorilla %.1f ns/próbkę, skwantowane %.1f ns/próbkę (%.1fx); "
+                "dequantize() %.3f ns/wartość (%g)\n", gorillaNs, quantizedNs, gorillaNs / quantizedNs,
+                kernelNs / levels.size(), values[12345]);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/**
+ * @file wds_plant_ident_sim.cpp
+ * @brief Symulacja silnika FOPDT dla PlantIdentifier: dokładność K, T, θ i koszt analizy okna.
+ *
+ * Obiekt K·e^(-θs)/(T·s + 1) całkowany jest dokładnie (dyskretyzacja ZOH) z krokiem ramki
+ * telemetrii. Polecenia PWM zmieniają się skokowo w losowych chwilach; ramki docierają porcjami
+ * (czas próbki = czas odebrania porcji), a polecenie dociera do urządzenia z opóźnieniem łącza,
+ * więc mierzone opóźnienie to θ + łącze + średnie opóźnienie porcji. Co 0,5 s symulacji
+ * wywoływana jest identyfikacja (jak w PlantAnalysisWorker); wypisywany jest przebieg
+ * oszacowań, nastawy PID oraz czas analizy okna przez FFT w porównaniu z sumami liczonymi
+ * bezpośrednio dla każdego opóźnienia.
+ *
+ * Użycie:
+ *   wds_plant_ident_sim [--gain K] [--tau S] [--dead S] [--noise RPM] [--rate HZ]
+ *                       [--link-ms MS] [--batch-ms MS] [--seconds S] [--window S] [--seed N]
+ *
+ * @see PlantIdentifier
+ */
+
+#include "../inc/plantidentifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Parametry symulacji.
+ */
+struct SimOptions {
+    double gain = 18.0;    ///< Wzmocnienie [obr/min na jednostkę PWM].
+    double tauS = 0.35;    ///< Stała czasowa [s].
+    double deadS = 0.08;   ///< Opóźnienie obiektu [s].
+    double noise = 40.0;   ///< Odchylenie standardowe szumu pomiaru [obr/min].
+    double rateHz = 1000.0; ///< Częstotliwość ramek telemetrii.
+    double linkMs = 1.0;   ///< Opóźnienie polecenia na łączu [ms].
+    double batchMs = 2.0;  ///< Okres porcji odbioru [ms].
+    double seconds = 120.0; ///< Czas symulacji [s].
+    double windowS = 60.0; ///< Okno analizy [s].
+    unsigned seed = 1;     ///< Ziarno generatora.
+};
+
+/**
+ * Polecenie PWM w chwili wysłania (oś hosta) [µs].
+ */
+struct Command {
+    int64_t timeUs;
+    float value;
+};
+
+/**
+ * Wartość PWM obowiązująca w urządzeniu w chwili timeUs (polecenia po opóźnieniu łącza).
+ */
+double appliedPwm(const std::vector<Command> &commands, int64_t timeUs, int64_t linkUs) {
+    double value = 0.0;
+    for (const Command &command : commands) {
+        if (command.timeUs + linkUs > timeUs)
+            break;
+        value = command.value;
+    }
+    return value;
+}
+
+/**
+ * Sumy równań normalnych liczone bezpośrednio dla każdego opóźnienia (O(N·D), cztery sumy
+ * częściowe jak w PlantIdentifier::identify() dla małych okien) — punkt odniesienia dla
+ * korelacji przez FFT.
+ */
+double directSums(const std::vector<double> &u, const std::vector<double> &y, size_t maxDelay) {
+    const size_t equations = y.size() - 1 - maxDelay;
+    const double *yk = y.data() + maxDelay;
+    double checksum = 0.0;
+    for (size_t d = 0; d <= maxDelay; ++d) {
+        const double *x = u.data() + (maxDelay - d);
+        double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+        size_t j = 0;
+        for (; j + 4 <= equations; j += 4) {
+            a0 += x[j] * yk[j];
+            b0 += x[j] * yk[j + 1];
+            a1 += x[j + 1] * yk[j + 1];
+            b1 += x[j + 1] * yk[j + 2];
+            a2 += x[j + 2] * yk[j + 2];
+            b2 += x[j + 2] * yk[j + 3];
+            a3 += x[j + 3] * yk[j + 3];
+            b3 += x[j + 3] * yk[j + 4];
+        }
+        for (; j < equations; ++j) {
+            a0 += x[j] * yk[j];
+            b0 += x[j] * yk[j + 1];
+        }
+        checksum += (a0 + a1) + (a2 + a3) + (b0 + b1) + (b2 + b3);
+    }
+    return checksum;
+}
+
+/**
+ * Czas jednego wywołania funkcji [ms] (mediana z kilku powtórzeń).
+ */
+template <typename Function>
+double timeMs(Function function) {
+    std::vector<double> runs;
+    for (int i = 0; i < 5; ++i) {
+        const Clock::time_point start = Clock::now();
+        function();
+        runs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    std::sort(runs.begin(), runs.end());
+    return runs[runs.size() / 2];
+}
+}
+
+int main(int argc, char *argv[]) {
+    SimOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--gain") == 0 && i + 1 < argc) {
+            options.gain = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--tau") == 0 && i + 1 < argc) {
+            options.tauS = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--dead") == 0 && i + 1 < argc) {
+            options.deadS = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+            options.noise = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.rateHz = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--link-ms") == 0 && i + 1 < argc) {
+            options.linkMs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--batch-ms") == 0 && i + 1 < argc) {
+            options.batchMs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            options.windowS = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--gain K] [--tau S] [--dead S] [--noise RPM] [--rate HZ] "
+                                 "[--link-ms MS] [--batch-ms MS] [--seconds S] [--window S] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.tauS <= 0.0 || options.deadS < 0.0 || options.rateHz <= 0.0 || options.batchMs <= 0.0 || options.seconds <= 0.0) {
+        std::fprintf(stderr, "Wymagane: tau > 0, dead >= 0, rate > 0, batch-ms > 0, seconds > 0\n");
+        return 1;
+    }
+
+    std::mt19937 random(options.seed);
+    std::normal_distribution<double> noise(0.0, options.noise);
+    std::uniform_real_distribution<double> holdS(2.0, 6.0);
+    std::uniform_int_distribution<int> level(40, 220);
+
+    // Polecenia PWM: skoki w losowych chwilach (pierwsze po 1 s)
+    const int64_t endUs = static_cast<int64_t>(options.seconds * 1e6);
+    std::vector<Command> commands;
+    for (double t = 1.0; t < options.seconds; t += holdS(random))
+        commands.push_back({static_cast<int64_t>(t * 1e6), static_cast<float>(level(random))});
+
+    const double expectedDeadS = options.deadS + options.linkMs / 1e3 + options.batchMs / 2e3;
+    std::printf("Obiekt: K %.2f obr/min/PWM, T %.3f s, θ %.3f s (oczekiwane θ z łączem i porcjami %.3f s)\n",
+                options.gain, options.tauS, options.deadS, expectedDeadS);
+    std::printf("Ramki %.0f Hz, porcje co %.1f ms, szum %.0f obr/min, %zu poleceń w %.0f s, okno %.0f s\n\n",
+                options.rateHz, options.batchMs, options.noise, commands.size(), options.seconds, options.windowS);
+
+    PlantIdentifierConfig config;
+    config.windowS = options.windowS;
+    PlantIdentifier identifier(config);
+    identifier.reset(PlantInput::Pwm);
+
+    const int64_t frameUs = static_cast<int64_t>(1e6 / options.rateHz);
+    const int64_t linkUs = static_cast<int64_t>(options.linkMs * 1e3);
+    const int64_t deadUs = static_cast<int64_t>(options.deadS * 1e6);
+    const int64_t batchUs = std::max<int64_t>(1, static_cast<int64_t>(options.batchMs * 1e3));
+    const double decay = std::exp(-static_cast<double>(frameUs) / 1e6 / options.tauS);
+    const int64_t analysisUs = 500000;
+    const int64_t reportUs = static_cast<int64_t>(options.seconds * 1e6 / 8.0);
+
+    std::printf("%8s %10s %10s %10s %10s %8s %10s\n", "czas [s]", "K", "T [s]", "θ [s]", "dopas. %", "skoki", "analiza ms");
+    double output = 0.0;
+    size_t nextCommand = 0;
+    int64_t nextAnalysis = analysisUs;
+    int64_t nextReport = reportUs;
+    std::vector<float> batch;
+    PlantModel model;
+    for (int64_t t = 0; t < endUs; t += frameUs) {
+        while (nextCommand < commands.size() && commands[nextCommand].timeUs <= t) {
+            identifier.addCommand(commands[nextCommand].timeUs, commands[nextCommand].value);
+            ++nextCommand;
+        }
+        output = decay * output + (1.0 - decay) * options.gain * appliedPwm(commands, t - deadUs, linkUs);
+        batch.push_back(static_cast<float>(output + noise(random)));
+        // Porcja dociera na końcu okresu odbioru — wszystkie jej ramki mają czas odebrania
+        if ((t + frameUs) / batchUs != t / batchUs) {
+            const int64_t arrivalUs = ((t + frameUs) / batchUs) * batchUs;
+            for (float rpm : batch)
+                identifier.addMeasurement(arrivalUs, rpm);
+            batch.clear();
+        }
+        if (t >= nextAnalysis) {
+            nextAnalysis += analysisUs;
+            const Clock::time_point start = Clock::now();
+            model = identifier.identify();
+            const double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (t >= nextReport) {
+                nextReport += reportUs;
+                if (model.valid)
+                    std::printf("%8.1f %10.3f %10.3f %10.3f %10.1f %8zu %10.2f\n", t / 1e6, model.gain,
+                                model.timeConstantS, model.deadTimeS, model.fitPercent, model.steps, elapsedMs);
+                else
+                    std::printf("%8.1f %s\n", t / 1e6, model.reason.c_str());
+            }
+        }
+    }
+
+    model = identifier.identify();
+    if (!model.valid) {
+        std::printf("\nBrak modelu: %s\n", model.reason.c_str());
+        return 2;
+    }
+    std::printf("\nBłąd: K %+.1f %%, T %+.1f %%, θ %+.1f ms względem oczekiwanego\n",
+                100.0 * (model.gain / options.gain - 1.0), 100.0 * (model.timeConstantS / options.tauS - 1.0),
+                1e3 * (model.deadTimeS - expectedDeadS));
+    const PidSuggestion pid = PlantIdentifier::suggestPid(model);
+    std::printf("Nastawy IMC (λ %.3f s): Kp %.4f, Ki %.4f 1/s, Kd %.5f s\n", pid.lambdaS, pid.kp, pid.ki, pid.kd);
+
+    // Koszt analizy okna (dane tylko do pomiaru czasu): cała identyfikacja, korelacja przez FFT
+    // i te same sumy liczone bezpośrednio dla każdego opóźnienia
+    std::printf("\n%10s %8s %10s %14s %16s %16s\n", "okno [s]", "Ts [ms]", "próbki", "identify() ms", "korelacja FFT ms",
+                "sumy wprost ms");
+    const std::pair<double, double> windows[] = {{10.0, 0.01}, {60.0, 0.01}, {300.0, 0.01}, {60.0, 0.001}};
+    for (const auto &[windowS, sampleS] : windows) {
+        PlantIdentifierConfig longConfig;
+        longConfig.windowS = windowS;
+        longConfig.sampleS = sampleS;
+        PlantIdentifier window(longConfig);
+        window.reset(PlantInput::Pwm);
+        double pwm = 100.0;
+        window.addCommand(0, static_cast<float>(pwm));
+        std::vector<double> u;
+        std::vector<double> y;
+        const int64_t cells = static_cast<int64_t>(windowS / longConfig.sampleS);
+        for (int64_t cell = 0; cell <= cells; ++cell) {
+            const int64_t timeUs = cell * static_cast<int64_t>(sampleS * 1e6);
+            if (cell % 400 == 0) {
+                pwm = level(random);
+                window.addCommand(timeUs, static_cast<float>(pwm));
+            }
+            const double rpm = options.gain * pwm + noise(random);
+            window.addMeasurement(timeUs, static_cast<float>(rpm));
+            u.push_back(pwm);
+            y.push_back(rpm);
+        }
+        const size_t maxDelay = static_cast<size_t>(longConfig.maxDeadTimeS / longConfig.sampleS);
+        volatile double sink = 0.0;
+        const double fftMs = timeMs([&]() { sink = window.identify().gain; });
+        const double correlationMs = timeMs([&]() { sink = PlantIdentifier::crossCorrelation(u, y, maxDelay)[0]; });
+        const double directMs = timeMs([&]() { sink = directSums(u, y, maxDelay); });
+        std::printf("%10.0f %8.0f %10zu %14.3f %16.3f %16.3f\n", windowS, sampleS * 1e3, window.gridSize(), fftMs,
+                    correlationMs, directMs);
+    }
+    return 0;
+}
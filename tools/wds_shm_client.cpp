@@ -0,0 +1,76 @@
+/**
+ * @file wds_shm_client.cpp
+ * @brief Przykładowy klient telemetrii udostępnianej przez pamięć współdzieloną.
+ *
+ * Program dołącza do segmentu publikowanego przez aplikację (opcja --shm lub menu Narzędzia),
+ * wypisuje odbierane próbki i opcjonalnie wysyła polecenie do mikrokontrolera.
+ *
+ * Użycie:
+ *   wds_shm_client [--name /wds_motor_telemetry] [--count N] [--command TYP WARTOŚĆ]
+ *
+ * TYP to wartość DataType (1 - PWM, 2 - RPM, 3 - Kp, 4 - Ki, 5 - Kd, 6 - tryb, 7 - start/stop).
+ *
+ * @see ShmTelemetryReader
+ */
+
+#include "../inc/shmtelemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+int main(int argc, char *argv[]) {
+    std::string name = shmDefaultName;
+    long count = -1;
+    int commandType = 0;
+    float commandValue = 0.0f;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--command") == 0 && i + 2 < argc) {
+            commandType = std::atoi(argv[++i]);
+            commandValue = std::strtof(argv[++i], nullptr);
+        } else {
+            std::fprintf(stderr, "Użycie: %s [--name SEGMENT] [--count N] [--command TYP WARTOŚĆ]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ShmTelemetryReader reader;
+    if (!reader.open(name)) {
+        std::fprintf(stderr, "Nie można dołączyć do %s: %s\n", name.c_str(), reader.errorString().c_str());
+        return 1;
+    }
+
+    if (commandType != 0) {
+        if (!reader.sendCommand(static_cast<uint8_t>(commandType), commandValue)) {
+            std::fprintf(stderr, "Nie wysłano polecenia: %s\n", reader.errorString().c_str());
+            return 1;
+        }
+        if (count < 0)
+            return 0;
+    }
+
+    ShmSample samples[256];
+    long received = 0;
+    while (count < 0 || received < count) {
+        const size_t n = reader.read(samples, sizeof(samples) / sizeof(samples[0]));
+        if (n == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        for (size_t i = 0; i < n && (count < 0 || received < count); ++i, ++received) {
+            const SerialData &d = samples[i].data;
+            std::printf("%llu t=%lld us rpm=%.0f pwm=%u I=%.2f U=%.2f P=%.2f mode=%u\n",
+                        static_cast<unsigned long long>(samples[i].index), static_cast<long long>(samples[i].timeUs),
+                        d.rpm, d.pwm, d.current, d.voltage, d.power, d.mode);
+        }
+    }
+    std::printf("pominięte próbki: %llu\n", static_cast<unsigned long long>(reader.lostSamples()));
+    return 0;
+}